@@ -219,42 +219,147 @@ class BacktestOrchestrator:
                 return []
             
             dates = [
-                datetime.strptime(f.stem, "%Y-%m-%d")
+                datetime.strptime(f.name[:-len(".jsonl.gz")], "%Y-%m-%d")
                 for f in jsonl_files
             ]
         
         print(f"Running backtest for {symbol}: {len(dates)} days, strategy={strategy}")
         
-        results = []
+        if strategy != "MovingAverage":
+            print(f"ERROR: backtest_runner only supports MovingAverage (got {strategy})")
+            return []
         
+        # Prefer the binary archive for a day when one has been converted
+        inputs = []
         for date in dates:
             date_str = date.strftime("%Y-%m-%d")
             data_file = self._get_symbol_dir(symbol) / f"{date_str}.jsonl.gz"
-            
-            if not data_file.exists():
+            archive = data_file.with_suffix("").with_suffix(".trades")
+            if archive.exists():
+                inputs.append(str(archive))
+            elif data_file.exists():
+                inputs.append(str(data_file))
+            else:
                 print(f"  [skip] {date_str} - data file not found")
-                continue
-            
-            print(f"  [run] {date_str}")
-            
-            # TODO: Invoke the C++ engine with KrakenFileReplayAdapter
-            # For now, we'll create a placeholder result
+        
+        if not inputs:
+            return []
+        
+        # One process for every day: backtest_runner runs the days in parallel,
+        # each with its own engine, broker and strategy
+        self.reports_dir.mkdir(parents=True, exist_ok=True)
+        runner_report = self.reports_dir / f".{symbol}_runner.json"
+        runner_bin = self.build_dir / "src" / "backtest" / "backtest_runner"
+        cmd = [
+            str(runner_bin),
+            "--window", str(config.get("window", 5)),
+            "--threshold", str(config.get("threshold", 1.0)),
+            "--output", str(runner_report),
+            "--symbol", symbol,
+        ] + inputs
+        
+        result = subprocess.run(cmd, text=True)
+        if not runner_report.exists():
+            print(f"ERROR: backtest_runner exited with {result.returncode} and wrote no report")
+            return []
+        
+        with open(runner_report) as f:
+            runner_results = json.load(f)
+        runner_report.unlink()
+        
+        results = []
+        for part in runner_results["partitions"]:
+            status = "completed" if part["ok"] else "failed"
+            print(f"  [{status}] {part['label']}: pnl={part['pnl']:.2f} orders={part['orders']}")
             daily_result = {
                 "symbol": symbol,
-                "date": date_str,
+                "date": part["label"],
                 "strategy": strategy,
-                "data_file": str(data_file),
-                "trades": [],
-                "pnl": 0.0,
-                "pnl_pct": 0.0,
-                "max_drawdown": 0.0,
-                "status": "placeholder",  # TODO: Update after real backtest
+                "data_file": part["data_file"],
+                "trades_replayed": part["trades"],
+                "orders": part["orders"],
+                "filled": part["filled"],
+                "rejected": part["rejected"],
+                "final_balance": part["final_balance"],
+                "pnl": part["pnl"],
+                "pnl_pct": part["pnl_pct"],
+                "max_drawdown": part["max_drawdown"],
+                "status": status,
             }
-            
+            if not part["ok"]:
+                daily_result["error"] = part.get("error", "")
             results.append(daily_result)
         
         return results
 
+    def run_sweep(
+        self,
+        symbol: str,
+        windows: str,
+        thresholds: str,
+        dates: Optional[List[datetime]] = None,
+        output_file: Optional[Path] = None
+    ) -> Optional[Path]:
+        """
+        Run a MovingAverage parameter sweep in a single strategy_sweep process.
+        
+        Each day is loaded once and every window x threshold combination is
+        evaluated over it, instead of one engine run per configuration.
+        Uses the .trades archive for a day when one exists next to the
+        .jsonl.gz file.
+        
+        Args:
+            symbol: Symbol to backtest
+            windows: SMA windows, "5,10,20" or "start:stop:step"
+            thresholds: Thresholds, same list/range syntax
+            dates: Dates to sweep (if None, use all cached dates)
+            output_file: Report path (auto-generated if None)
+        
+        Returns:
+            Path to the sweep report, or None on failure
+        """
+        symbol_dir = self._get_symbol_dir(symbol)
+        if dates is None:
+            day_files = sorted(symbol_dir.glob("*.jsonl.gz"))
+        else:
+            day_files = [symbol_dir / f"{d.strftime('%Y-%m-%d')}.jsonl.gz" for d in dates]
+        
+        inputs = []
+        for f in day_files:
+            archive = f.with_name(f.name.replace(".jsonl.gz", ".trades"))
+            if archive.exists():
+                inputs.append(str(archive))
+            elif f.exists():
+                inputs.append(str(f))
+            else:
+                print(f"  [skip] {f.name} - data file not found")
+        
+        if not inputs:
+            print(f"ERROR: No cached data for {symbol}")
+            return None
+        
+        if output_file is None:
+            timestamp = datetime.now().strftime("%Y%m%d_%H%M%S")
+            output_file = self.reports_dir / f"{symbol}_sweep_{timestamp}.json"
+        output_file.parent.mkdir(parents=True, exist_ok=True)
+        
+        sweep_bin = self.build_dir / "src" / "strategies" / "strategy_sweep"
+        cmd = [
+            str(sweep_bin),
+            "--symbol", symbol,
+            "--windows", windows,
+            "--thresholds", thresholds,
+            "--output", str(output_file),
+        ] + inputs
+        
+        print(f"Running sweep for {symbol}: {len(inputs)} days, windows={windows}, thresholds={thresholds}")
+        result = subprocess.run(cmd, text=True)
+        if result.returncode != 0:
+            print(f"ERROR: strategy_sweep exited with {result.returncode}")
+            return None
+        
+        return output_file
+
     def generate_report(
         self,
         symbol: str,
@@ -278,7 +383,7 @@ class BacktestOrchestrator:
         
         # Aggregate results
         total_pnl = sum(r.get("pnl", 0.0) for r in results)
-        total_trades = sum(len(r.get("trades", [])) for r in results)
+        total_trades = sum(r.get("orders", 0) for r in results)
         max_dd = min((r.get("max_drawdown", 0.0) for r in results), default=0.0)
         
         report = {
@@ -313,6 +418,10 @@ def main():
     parser.add_argument("--strategy", default="MovingAverage", help="Strategy name")
     parser.add_argument("--force", action="store_true", help="Re-download cached data")
     parser.add_argument("--output", type=str, help="Output report file")
+    parser.add_argument("--sweep-windows", type=str,
+                        help="Sweep MovingAverage windows in-process (e.g. 5:100:5 or 5,10,20)")
+    parser.add_argument("--sweep-thresholds", type=str, default="1.0",
+                        help="Thresholds for --sweep-windows (same syntax)")
     
     args = parser.parse_args()
     
@@ -342,6 +451,22 @@ def main():
         print("ERROR: No data downloaded")
         return 1
     
+    # Parameter sweep: one process for the whole grid
+    if args.sweep_windows:
+        print(f"\n=== Running Parameter Sweep ===")
+        output_file = Path(args.output) if args.output else None
+        report_path = orch.run_sweep(
+            args.symbol,
+            args.sweep_windows,
+            args.sweep_thresholds,
+            dates=dates,
+            output_file=output_file
+        )
+        if report_path is None:
+            return 1
+        print(f"Report generated: {report_path}")
+        return 0
+    
     # Run backtest
     print(f"\n=== Running Backtest ===")
     results = orch.run_backtest(
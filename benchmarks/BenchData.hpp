@@ -0,0 +1,136 @@
+#pragma once
+#include "engine/MarketDataTypes.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <zlib.h>
+
+/*
+Synthetic inputs shared by the benchmarks.
+
+Everything is generated from a fixed seed so runs are comparable across
+machines and releases: a BTC-like random walk starting 2024-01-01 00:00 UTC
+at roughly one trade every 290ms (about the 300k trades/day of a busy
+Kraken XBTUSD session).
+*/
+
+namespace bench {
+
+struct SyntheticTrade {
+    double price;
+    double qty;
+    long long ts_us;      // Microseconds since the epoch
+    bool buy;
+};
+
+inline std::vector<SyntheticTrade> make_trades(size_t n, uint64_t seed = 42) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 2.5);
+    std::exponential_distribution<double> gap_ms(1.0 / 290.0);
+    std::lognormal_distribution<double> size(-3.0, 1.2);
+
+    std::vector<SyntheticTrade> out;
+    out.reserve(n);
+    double price = 43000.0;
+    double ts_us = 1704067200.0 * 1e6;
+    for (size_t i = 0; i < n; ++i) {
+        price = std::max(1.0, price + step(rng));
+        ts_us += gap_ms(rng) * 1000.0;
+        out.push_back({price, size(rng), static_cast<long long>(ts_us), (rng() & 1) != 0});
+    }
+    return out;
+}
+
+inline eng::TradePrint to_trade_print(const SyntheticTrade& t, const std::string& symbol,
+                                      eng::InstrumentId id = 1) {
+    eng::TradePrint tp;
+    tp.instrument_id = id;
+    tp.symbol = symbol;
+    tp.price = t.price;
+    tp.qty = t.qty;
+    tp.ts = eng::TimePoint(std::chrono::microseconds(t.ts_us));
+    tp.side = t.buy ? eng::TradeSide::Buy : eng::TradeSide::Sell;
+    return tp;
+}
+
+inline std::vector<eng::TradePrint> make_trade_prints(size_t n, const std::string& symbol = "XBTUSD") {
+    std::vector<eng::TradePrint> out;
+    out.reserve(n);
+    for (const auto& t : make_trades(n)) out.push_back(to_trade_print(t, symbol));
+    return out;
+}
+
+// One line in the scripts/kraken_day_capture.py layout
+inline std::string to_kraken_line(const SyntheticTrade& t, const std::string& pair = "XBTUSD") {
+    char buf[256];
+    int n = std::snprintf(buf, sizeof(buf),
+        "{\"pair\":\"%s\",\"price\":%.1f,\"volume\":%.8f,\"time\":%.4f,"
+        "\"side\":\"%s\",\"ordertype\":\"market\",\"misc\":\"\"}",
+        pair.c_str(), t.price, t.qty, static_cast<double>(t.ts_us) / 1e6, t.buy ? "buy" : "sell");
+    return std::string(buf, static_cast<size_t>(n));
+}
+
+inline std::vector<std::string> make_kraken_lines(size_t n) {
+    std::vector<std::string> out;
+    out.reserve(n);
+    for (const auto& t : make_trades(n)) out.push_back(to_kraken_line(t));
+    return out;
+}
+
+// Scratch path under the system temp dir, unique to this process
+inline std::string temp_path(const std::string& name) {
+    auto dir = std::filesystem::temp_directory_path();
+    return (dir / ("eng_bench_" + std::to_string(::getpid()) + "_" + name)).string();
+}
+
+// Remove a SQLite database and its WAL/SHM side files
+inline void remove_db(const std::string& path) {
+    std::error_code ec;
+    for (const char* suffix : {"", "-wal", "-shm", "-journal"}) {
+        std::filesystem::remove(path + suffix, ec);
+    }
+}
+
+/**
+ * A Kraken JSONL.GZ day file of n synthetic trades, written on construction
+ * and deleted on destruction.
+ */
+class TempTradeFile {
+public:
+    explicit TempTradeFile(size_t n, const std::string& name = "trades.jsonl.gz")
+        : path_(temp_path(name)), trades_(n) {
+        gzFile f = gzopen(path_.c_str(), "wb6");
+        if (!f) throw std::runtime_error("Cannot create " + path_);
+        for (const auto& t : make_trades(n)) {
+            std::string line = to_kraken_line(t);
+            line.push_back('\n');
+            raw_bytes_ += line.size();
+            gzwrite(f, line.data(), static_cast<unsigned>(line.size()));
+        }
+        gzclose(f);
+    }
+
+    ~TempTradeFile() {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+
+    TempTradeFile(const TempTradeFile&) = delete;
+    TempTradeFile& operator=(const TempTradeFile&) = delete;
+
+    const std::string& path() const { return path_; }
+    size_t trades() const { return trades_; }
+    size_t raw_bytes() const { return raw_bytes_; }   // Uncompressed size
+
+private:
+    std::string path_;
+    size_t trades_;
+    size_t raw_bytes_{0};
+};
+
+}  // namespace bench
@@ -0,0 +1,34 @@
+#include "BenchData.hpp"
+#include "engine/BarBuilder.hpp"
+#include <benchmark/benchmark.h>
+
+// BarBuilder::on_trade with 1 (1s), 3 (1s/1m/5m) or 5 intervals; bars are
+// published to one counting subscriber, as the persister would consume them.
+static void BM_BarBuilderOnTrade(benchmark::State& state) {
+    static const std::vector<long long> kIntervals = {1000, 60'000, 300'000, 3'600'000, 86'400'000};
+    std::vector<long long> intervals(kIntervals.begin(), kIntervals.begin() + state.range(0));
+
+    eng::EventBus bus;
+    size_t bars = 0;
+    bus.subscribe<eng::Bar>([&bars](const eng::Bar&) { ++bars; });
+    eng::BarBuilder builder(bus, intervals);
+
+    // One synthetic day, replayed with its timestamps shifted forward each
+    // lap so bars keep rolling instead of restarting
+    auto trades = bench::make_trade_prints(1 << 16);
+    const auto span = trades.back().ts - trades.front().ts + std::chrono::hours(24);
+    size_t i = 0;
+    for (auto _ : state) {
+        auto& tp = trades[i & (trades.size() - 1)];
+        builder.on_trade(tp);
+        if ((++i & (trades.size() - 1)) == 0) {
+            state.PauseTiming();
+            for (auto& t : trades) t.ts += std::chrono::duration_cast<eng::TimePoint::duration>(span);
+            state.ResumeTiming();
+        }
+    }
+    benchmark::DoNotOptimize(bars);
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bars"] = benchmark::Counter(static_cast<double>(bars));
+}
+BENCHMARK(BM_BarBuilderOnTrade)->Arg(1)->Arg(3)->Arg(5);
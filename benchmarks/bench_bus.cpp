@@ -0,0 +1,44 @@
+#include "BenchData.hpp"
+#include "engine/EventBus.hpp"
+#include <benchmark/benchmark.h>
+
+// Typed-channel publish of a TradePrint to N inline subscribers
+static void BM_EventBusPublish(benchmark::State& state) {
+    const int subscribers = static_cast<int>(state.range(0));
+    eng::EventBus bus;
+    double sink = 0.0;
+    for (int i = 0; i < subscribers; ++i) {
+        bus.subscribe<eng::TradePrint>([&sink](const eng::TradePrint& tp) { sink += tp.qty; });
+    }
+
+    const auto trades = bench::make_trade_prints(4096);
+    size_t i = 0;
+    for (auto _ : state) {
+        bus.publish(trades[i++ & 4095]);
+    }
+    benchmark::DoNotOptimize(sink);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EventBusPublish)->Arg(1)->Arg(4)->Arg(16);
+
+// Same, with every subscriber on its own async queue + worker (lossless)
+static void BM_EventBusPublishAsync(benchmark::State& state) {
+    const int subscribers = static_cast<int>(state.range(0));
+    eng::EventBus bus;
+    std::vector<double> sinks(static_cast<size_t>(subscribers), 0.0);
+    for (int i = 0; i < subscribers; ++i) {
+        double* sink = &sinks[static_cast<size_t>(i)];
+        bus.subscribe_async<eng::TradePrint>([sink](const eng::TradePrint& tp) { *sink += tp.qty; },
+            {"bench" + std::to_string(i), 1 << 14, eng::EventBus::Backpressure::Block});
+    }
+
+    const auto trades = bench::make_trade_prints(4096);
+    size_t i = 0;
+    for (auto _ : state) {
+        bus.publish(trades[i++ & 4095]);
+    }
+    bus.wait_idle();   // Count the consumers' work too
+    benchmark::DoNotOptimize(sinks.data());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EventBusPublishAsync)->Arg(1)->Arg(4)->UseRealTime();
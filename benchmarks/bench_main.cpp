@@ -0,0 +1,17 @@
+#include "engine/Logger.hpp"
+#include <benchmark/benchmark.h>
+
+// Google Benchmark's main, with engine logging held to warnings so the
+// engine's own per-order/per-batch lines don't land in the timings.
+// Pass --benchmark_format=json (or --benchmark_out=<file>) for JSON results.
+int main(int argc, char** argv) {
+    eng::Logger::instance().set_level(eng::LogLevel::Warn);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    eng::Logger::instance().flush();
+    return 0;
+}
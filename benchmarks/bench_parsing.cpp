@@ -0,0 +1,106 @@
+#include "BenchData.hpp"
+#include "adapters/GzipLineReader.hpp"
+#include "adapters/KrakenTradeParser.hpp"
+#include "adapters/TradeFileSources.hpp"
+#include <benchmark/benchmark.h>
+
+namespace {
+
+constexpr size_t kLines = 1 << 14;
+
+size_t total_bytes(const std::vector<std::string>& lines) {
+    size_t n = 0;
+    for (const auto& l : lines) n += l.size();
+    return n;
+}
+
+}  // namespace
+
+// Single-pass fixed-schema parse of one Kraken trade line
+static void BM_ParseKrakenTrade(benchmark::State& state) {
+    const auto lines = bench::make_kraken_lines(kLines);
+    adapter::KrakenTradeParser parser(std::make_shared<eng::InstrumentRegistry>(), false);
+    eng::TradePrint tp;
+    if (!parser.parse(lines.front(), tp)) {
+        state.SkipWithError("synthetic line rejected by the fast parser");
+        return;
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.parse(lines[i++ & (kLines - 1)], tp));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * (total_bytes(lines) / kLines)));
+}
+BENCHMARK(BM_ParseKrakenTrade);
+
+// The nlohmann fallback for lines outside the fixed layout, for comparison
+static void BM_ParseKrakenTradeJson(benchmark::State& state) {
+    const auto lines = bench::make_kraken_lines(kLines);
+    adapter::KrakenTradeParser parser(std::make_shared<eng::InstrumentRegistry>(), false);
+    eng::TradePrint tp;
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.parse_json(lines[i++ & (kLines - 1)], tp));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * (total_bytes(lines) / kLines)));
+}
+BENCHMARK(BM_ParseKrakenTradeJson);
+
+// Inflate a JSONL.GZ day file line by line (no parsing)
+static void BM_ReadJsonlGz(benchmark::State& state) {
+    bench::TempTradeFile file(static_cast<size_t>(state.range(0)));
+    size_t lines = 0;
+    for (auto _ : state) {
+        adapter::GzipLineReader reader(file.path());
+        std::string_view line;
+        while (reader.next_line(line)) ++lines;
+    }
+    benchmark::DoNotOptimize(lines);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * file.trades()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.raw_bytes()));
+}
+BENCHMARK(BM_ReadJsonlGz)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+// Inflate + parse through the same ITradeSource the merged replay uses
+static void BM_ReadAndParseJsonlGz(benchmark::State& state) {
+    bench::TempTradeFile file(static_cast<size_t>(state.range(0)));
+    auto registry = std::make_shared<eng::InstrumentRegistry>();
+    std::vector<eng::TradePrint> batch(256);
+    size_t trades = 0;
+    for (auto _ : state) {
+        adapter::KrakenFileTradeSource source(file.path(), registry);
+        while (size_t n = source.read(batch.data(), batch.size())) trades += n;
+    }
+    if (trades != state.iterations() * file.trades()) {
+        state.SkipWithError("trades were skipped while parsing");
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * file.trades()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.raw_bytes()));
+}
+BENCHMARK(BM_ReadAndParseJsonlGz)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+// Inflate + parse of a 100k-trade file with 1 MB chunks, inflating inline
+// (0) or on GzipLineReader's background worker (1)
+static void BM_InflateAndParse(benchmark::State& state) {
+    bench::TempTradeFile file(100'000);
+    const auto inflate = state.range(0) ? adapter::GzipLineReader::Inflate::Background
+                                        : adapter::GzipLineReader::Inflate::Inline;
+    adapter::KrakenTradeParser parser(std::make_shared<eng::InstrumentRegistry>(), false);
+    eng::TradePrint tp;
+    size_t trades = 0;
+    for (auto _ : state) {
+        adapter::GzipLineReader reader(file.path(), adapter::GzipLineReader::PREFETCH_CHUNK_SIZE, inflate);
+        std::string_view line;
+        while (reader.next_line(line)) trades += parser.parse(line, tp);
+    }
+    if (trades != state.iterations() * file.trades()) {
+        state.SkipWithError("trades were skipped while parsing");
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * file.trades()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.raw_bytes()));
+}
+BENCHMARK(BM_InflateAndParse)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,101 @@
+#include "BenchData.hpp"
+#include "adapters/KrakenFileReplayAdapter.hpp"
+#include "brokers/NullBroker.hpp"
+#include "engine/AllocationCounter.hpp"
+#include "engine/BarBuilder.hpp"
+#include "engine/CandlePersister.hpp"
+#include "engine/CandleStore.hpp"
+#include "engine/Engine.hpp"
+#include "strategies/MovingAverage.hpp"
+#include <benchmark/benchmark.h>
+
+/*
+End to end: a JSONL.GZ day file replayed unthrottled through the same wiring
+main.cpp builds (minus the websocket server) -- adapter -> EventBus ->
+BarBuilder -> CandlePersister -> CandleStore, and Tick -> MovingAverage ->
+NullBroker -- until every bar is committed. Reports trades/sec and heap
+allocations per trade (steady state should be ~0).
+range(0) = 1 runs the strategy and bar builder on async bus workers
+(--async-bus).
+*/
+static void BM_EndToEndReplay(benchmark::State& state) {
+    const bool async_bus = state.range(0) != 0;
+    bench::TempTradeFile file(100'000);
+    const std::string db_path = bench::temp_path("replay.db");
+    size_t orders = 0;
+    uint64_t allocations = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        bench::remove_db(db_path);
+        auto engine = std::make_unique<eng::Engine>();
+        engine->set_verbose(false);
+        auto& bus = engine->get_bus();
+
+        auto broker = std::make_unique<broker::NullBroker>(bus);
+        broker->set_verbose(false);
+        auto* broker_ptr = broker.get();
+
+        auto registry = std::make_shared<eng::InstrumentRegistry>();
+        auto kraken = std::make_unique<adapter::KrakenFileReplayAdapter>(registry);
+        kraken->set_keep_metadata(false);
+        kraken->start();
+        auto* kraken_ptr = kraken.get();
+        auto provider = std::make_unique<eng::ProviderMarketData>();
+        provider->attach(std::move(kraken));
+        provider->subscribe_trades({"XBTUSD"}, [&bus](const eng::TradePrint& tp) {
+            bus.publish(tp);
+            eng::Tick tick{
+                .symbol = tp.symbol,
+                .last = tp.price,
+                .ts = tp.ts,
+                .instrument_id = tp.instrument_id,
+                .qty = tp.qty,
+                .side = tp.side
+            };
+            bus.publish(tick);
+        });
+
+        eng::CandleStoreConfig config;
+        config.db_path = db_path;
+        auto store = std::make_shared<eng::CandleStore>(config);
+        auto bars = std::make_unique<eng::BarBuilder>(bus, std::vector<long long>{eng::CandleStore::kBaseResolutionMs});
+        auto persister = std::make_unique<eng::CandlePersister>(bus, store, eng::CandleStore::kBaseResolutionMs);
+        if (async_bus) {
+            bars->set_async_dispatch({"BarBuilder", 1 << 16, eng::EventBus::Backpressure::Block});
+            engine->set_async_dispatch({"Strategy", 1 << 16, eng::EventBus::Backpressure::Block});
+        }
+        persister->start();
+        bars->start();
+
+        engine->set_broker(std::move(broker));
+        engine->set_market_data(std::move(provider));
+        engine->set_strategy(std::make_unique<strategy::MovingAverageStrategy>("XBTUSD", 5, 1.0, 0.01));
+        engine->start();
+        state.ResumeTiming();
+
+        const uint64_t allocs_before = eng::allocation_count();
+        size_t trades = kraken_ptr->replay(file.path(), 0.0, nullptr);
+        bus.wait_idle();
+        bars->flush();
+        persister->flush_pending_data();
+
+        state.PauseTiming();
+        allocations += eng::allocation_count() - allocs_before;
+        if (trades != file.trades()) state.SkipWithError("replay skipped trades");
+        orders += broker_ptr->get_orders_since(0, 0).size();
+        bars.reset();
+        persister.reset();
+        store.reset();
+        engine.reset();
+        state.ResumeTiming();
+    }
+
+    bench::remove_db(db_path);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * file.trades()));
+    state.counters["orders"] = benchmark::Counter(static_cast<double>(orders) / static_cast<double>(state.iterations()));
+    state.counters["allocs_per_trade"] = benchmark::Counter(
+        static_cast<double>(allocations) / static_cast<double>(state.iterations() * file.trades()));
+}
+BENCHMARK(BM_EndToEndReplay)->Arg(0)->Arg(1)->ArgName("async_bus")
+    ->Unit(benchmark::kMillisecond)->UseRealTime()->Iterations(3);
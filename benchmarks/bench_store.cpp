@@ -0,0 +1,120 @@
+#include "BenchData.hpp"
+#include "engine/CandleStore.hpp"
+#include "server/CandleEncoding.hpp"
+#include <benchmark/benchmark.h>
+
+namespace {
+
+constexpr long long kDayStartMs = 1704067200LL * 1000;   // 2024-01-01 00:00 UTC
+constexpr long long kBaseMs = eng::CandleStore::kBaseResolutionMs;
+
+eng::Candle make_candle(long long open_ms, double price) {
+    return eng::Candle{
+        .symbol = "XBTUSD",
+        .open_time = eng::TimePoint(std::chrono::milliseconds(open_ms)),
+        .open = price,
+        .high = price + 3.0,
+        .low = price - 2.0,
+        .close = price + 1.0,
+        .volume = 0.5,
+        .instrument_id = 1
+    };
+}
+
+/**
+ * A store on a scratch database holding `seconds` consecutive 1s candles
+ * (plus their rollups) from kDayStartMs on.
+ */
+struct PopulatedStore {
+    std::string path;
+    std::unique_ptr<eng::CandleStore> store;
+
+    PopulatedStore(long long seconds, size_t cache_bytes) : path(bench::temp_path("query.db")) {
+        bench::remove_db(path);
+        eng::CandleStoreConfig config;
+        config.db_path = path;
+        config.candle_cache_bytes = cache_bytes;
+        store = std::make_unique<eng::CandleStore>(config);
+        const auto trades = bench::make_trades(static_cast<size_t>(seconds));
+        for (long long s = 0; s < seconds; ++s) {
+            store->add_candle("XBTUSD", kBaseMs, make_candle(kDayStartMs + s * kBaseMs,
+                              trades[static_cast<size_t>(s)].price), "backtest");
+        }
+        store->flush_all();
+    }
+
+    ~PopulatedStore() {
+        store.reset();
+        bench::remove_db(path);
+    }
+};
+
+}  // namespace
+
+// add_candle + flush_all of 20k 1s candles; the writer wakes once range(0)
+// candles are pending and commits everything queued by then
+static void BM_CandleStoreInsert(benchmark::State& state) {
+    constexpr long long kRows = 20'000;
+    const std::string path = bench::temp_path("insert.db");
+    bench::remove_db(path);
+
+    eng::CandleStoreConfig config;
+    config.db_path = path;
+    config.candle_buffer_size = static_cast<size_t>(state.range(0));
+    config.flush_interval_ms = 60'000;   // Batch size alone decides when the writer commits
+    const auto trades = bench::make_trades(kRows);
+
+    {
+        eng::CandleStore store(config);
+        long long next_ms = kDayStartMs;
+        for (auto _ : state) {
+            for (long long i = 0; i < kRows; ++i, next_ms += kBaseMs) {
+                store.add_candle("XBTUSD", kBaseMs, make_candle(next_ms, trades[static_cast<size_t>(i)].price),
+                                 "backtest");
+            }
+            store.flush_all();
+        }
+        state.counters["batches"] = benchmark::Counter(static_cast<double>(store.writer_stats().batches));
+    }
+    state.SetItemsProcessed(state.iterations() * kRows);
+    bench::remove_db(path);
+}
+BENCHMARK(BM_CandleStoreInsert)->Arg(100)->Arg(1000)->Arg(5000)->Arg(20'000)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// query_candles of range(0) seconds at 1s. range(1) = 1 serves it from the
+// candle cache after the first call; 0 goes to SQLite every time.
+static void BM_CandleStoreQuery(benchmark::State& state) {
+    const long long seconds = state.range(0);
+    const bool cached = state.range(1) != 0;
+    PopulatedStore db(24 * 3600, cached ? 64 * 1024 * 1024 : 0);
+
+    size_t rows = 0;
+    for (auto _ : state) {
+        auto candles = db.store->query_candles("XBTUSD", kBaseMs, kDayStartMs,
+                                               kDayStartMs + (seconds - 1) * kBaseMs);
+        rows += candles.size();
+        benchmark::DoNotOptimize(candles.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(rows));
+}
+BENCHMARK(BM_CandleStoreQuery)
+    ->ArgsProduct({{60, 3600, 24 * 3600}, {0, 1}})
+    ->ArgNames({"seconds", "cached"})
+    ->Unit(benchmark::kMicrosecond);
+
+// The QueryCandles request path: one day at 1s squeezed into range(0) points
+// by query_candles_downsampled, then encoded as the columnar response
+static void BM_QueryCandlesDownsampled(benchmark::State& state) {
+    const size_t max_points = static_cast<size_t>(state.range(0));
+    PopulatedStore db(24 * 3600, 0);
+
+    for (auto _ : state) {
+        auto result = db.store->query_candles_downsampled("XBTUSD", kBaseMs, kDayStartMs,
+                                                          kDayStartMs + 24 * 3600 * kBaseMs - 1, max_points);
+        auto body = server::encode_candles_columnar(result.candles).dump();
+        benchmark::DoNotOptimize(body);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueryCandlesDownsampled)->Arg(500)->Arg(2000)->Arg(20'000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,65 @@
+#include "BenchData.hpp"
+#include "engine/TickStore.hpp"
+#include <benchmark/benchmark.h>
+
+namespace {
+
+constexpr size_t kDayTrades = 300'000;
+
+// A TickStore holding one synthetic day (~24h) for XBTUSD
+const eng::TickStore& day_store() {
+    static const eng::TickStore* store = [] {
+        auto* s = new eng::TickStore();
+        for (const auto& tp : bench::make_trade_prints(kDayTrades)) s->append(tp);
+        return s;
+    }();
+    return *store;
+}
+
+}  // namespace
+
+// Recording cost on the replay path; eviction keeps the store at 1M trades
+static void BM_TickStoreAppend(benchmark::State& state) {
+    eng::TickStoreConfig config;
+    config.max_ticks_per_instrument = 1 << 20;
+    eng::TickStore store(config);
+    auto trades = bench::make_trade_prints(1 << 16);
+    size_t i = 0;
+    for (auto _ : state) {
+        store.append(trades[i++ & (trades.size() - 1)]);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["evicted_chunks"] = benchmark::Counter(static_cast<double>(store.stats().evicted_chunks));
+}
+BENCHMARK(BM_TickStoreAppend);
+
+// Strategy warm-up: the last N hours of 1m candles from a full day
+static void BM_TickStoreLastCandles(benchmark::State& state) {
+    const auto& store = day_store();
+    const int limit = static_cast<int>(state.range(0) * 60);
+    size_t candles = 0;
+    for (auto _ : state) {
+        auto out = store.last_candles("XBTUSD", 60'000, limit);
+        candles = out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.counters["candles"] = benchmark::Counter(static_cast<double>(candles));
+}
+BENCHMARK(BM_TickStoreLastCandles)->Arg(1)->Arg(4)->Unit(benchmark::kMicrosecond);
+
+// Raw-tick range scan over the last hour (binary search + column walk)
+static void BM_TickStoreScanHour(benchmark::State& state) {
+    const auto& store = day_store();
+    const eng::TimePoint end = store.last_time("XBTUSD") + std::chrono::milliseconds(1);
+    const eng::TimePoint from = end - std::chrono::hours(1);
+    size_t ticks = 0;
+    for (auto _ : state) {
+        double sum = 0.0;
+        ticks = store.scan("XBTUSD", from, end, [&sum](eng::TimePoint, double px, double, eng::TradeSide) {
+            sum += px;
+        });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ticks));
+}
+BENCHMARK(BM_TickStoreScanHour)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,132 @@
+/**
+ * Compact QueryCandlesResponse decoding
+ *
+ * The backend can answer QueryCandles in three encodings, chosen per request
+ * with data.encoding (layouts documented in include/server/CandleEncoding.hpp):
+ *   - 'json':     one object per candle (default, legacy)
+ *   - 'columnar': JSON with data.columns = { ms, open, high, low, close, volume }
+ *   - 'binary':   one binary frame with packed int64/float64 columns
+ *
+ * Both compact forms are expanded back into the usual QueryCandlesResponse
+ * shape here, so message handlers don't need to care which one was used.
+ *
+ * A query with sparse: true gets only the bars that had trades; the empty
+ * buckets are filled in here too (fillSparseResponse), so they never cross
+ * the wire.
+ */
+
+import { fillCandleGaps } from '../utils/timeBuckets';
+
+export type CandleEncoding = 'json' | 'columnar' | 'binary';
+
+export interface CandleColumns {
+  ms: ArrayLike<number>;
+  open: ArrayLike<number>;
+  high: ArrayLike<number>;
+  low: ArrayLike<number>;
+  close: ArrayLike<number>;
+  volume: ArrayLike<number>;
+}
+
+export interface DecodedCandle {
+  ms: number;
+  open: number;
+  high: number;
+  low: number;
+  close: number;
+  volume: number;
+}
+
+const BINARY_MAGIC = 'CND1';
+const FIXED_HEADER_BYTES = 40;
+
+export function candlesFromColumns(columns: CandleColumns): DecodedCandle[] {
+  const n = columns.ms.length;
+  const candles: DecodedCandle[] = new Array(n);
+  for (let i = 0; i < n; i++) {
+    candles[i] = {
+      ms: columns.ms[i],
+      open: columns.open[i],
+      high: columns.high[i],
+      low: columns.low[i],
+      close: columns.close[i],
+      volume: columns.volume[i],
+    };
+  }
+  return candles;
+}
+
+/**
+ * Expand a columnar JSON response in place (no-op for other encodings)
+ */
+export function expandColumnarResponse(msg: any): any {
+  if (msg?.type === 'QueryCandlesResponse' && msg.data?.encoding === 'columnar' && msg.data.columns) {
+    msg.data.candles = candlesFromColumns(msg.data.columns);
+    delete msg.data.columns;
+  }
+  return msg;
+}
+
+/**
+ * Fill the gaps of a sparse candle response in place (no-op otherwise)
+ */
+export function fillSparseResponse(msg: any): any {
+  const isCandles = msg?.type === 'QueryCandlesResponse' || msg?.type === 'SubscribeCandlesResponse';
+  if (isCandles && msg.data?.sparse && Array.isArray(msg.data.candles)) {
+    msg.data.candles = fillCandleGaps(msg.data.candles, msg.data.resolutionMs);
+    msg.data.count = msg.data.candles.length;
+    delete msg.data.sparse;
+  }
+  return msg;
+}
+
+/**
+ * Decode a binary candle frame into a QueryCandlesResponse-shaped message.
+ * Returns null if the buffer isn't a candle frame.
+ */
+export function decodeBinaryCandles(buffer: ArrayBuffer): any | null {
+  if (buffer.byteLength < FIXED_HEADER_BYTES) return null;
+  const view = new DataView(buffer);
+  const magic = String.fromCharCode(view.getUint8(0), view.getUint8(1), view.getUint8(2), view.getUint8(3));
+  if (magic !== BINARY_MAGIC) return null;
+
+  const headerLen = view.getUint32(4, true);
+  const count = view.getUint32(8, true);
+  const flags = view.getUint32(12, true);
+  const resolutionMs = Number(view.getBigInt64(16, true));
+  const requestedResolutionMs = Number(view.getBigInt64(24, true));
+  const requestIdLen = view.getUint16(32, true);
+  const symbolLen = view.getUint16(34, true);
+
+  const text = new TextDecoder();
+  const requestId = text.decode(new Uint8Array(buffer, FIXED_HEADER_BYTES, requestIdLen));
+  const symbol = text.decode(new Uint8Array(buffer, FIXED_HEADER_BYTES + requestIdLen, symbolLen));
+
+  // Columns are 8-byte aligned, so they can be viewed without copying
+  const ms64 = new BigInt64Array(buffer, headerLen, count);
+  const ms = new Float64Array(count);
+  for (let i = 0; i < count; i++) ms[i] = Number(ms64[i]);
+  const column = (index: number) => new Float64Array(buffer, headerLen + 8 * count * (index + 1), count);
+
+  return {
+    type: 'QueryCandlesResponse',
+    requestId,
+    data: {
+      symbol,
+      resolutionMs,
+      requestedResolutionMs,
+      downsampled: (flags & 1) !== 0,
+      sparse: (flags & 2) !== 0,
+      count,
+      isTruncated: false,
+      candles: candlesFromColumns({
+        ms,
+        open: column(0),
+        high: column(1),
+        low: column(2),
+        close: column(3),
+        volume: column(4),
+      }),
+    },
+  };
+}
@@ -7,6 +7,7 @@
  */
 
 import type { EngineTickClient } from './engineWS';
+import type { CandleEncoding } from './candleEncoding';
 
 export interface CandleQueryRequest {
   symbol: string;
@@ -14,6 +15,9 @@ export interface CandleQueryRequest {
   startMs: number;
   endMs: number;
   limit?: number;
+  maxPoints?: number; // Bar budget; the backend downsamples to fit
+  encoding?: CandleEncoding; // Response wire format (default 'json')
+  sparse?: boolean; // Skip empty buckets on the wire; they're filled in on arrival
 }
 
 export interface EventQueryRequest {
@@ -41,6 +45,8 @@ export interface CandlesResponse {
   candles: Candle[];
   count: number;
   isTruncated: boolean;
+  requestedResolutionMs?: number;
+  downsampled?: boolean;
 }
 
 export interface StoredEvent {
@@ -113,6 +119,7 @@ export class CandleQueryClient {
       // Set timeout
       timeoutHandle = setTimeout(() => {
         this.responseHandlers.delete(requestId);
+        this.ws.cancelQuery(requestId);
         reject(new Error(`Query timeout after ${timeoutMs}ms`));
       }, timeoutMs);
 
@@ -156,6 +163,7 @@ export class CandleQueryClient {
       // Set timeout
       timeoutHandle = setTimeout(() => {
         this.responseHandlers.delete(requestId);
+        this.ws.cancelQuery(requestId);
         reject(new Error(`Query timeout after ${timeoutMs}ms`));
       }, timeoutMs);
 
@@ -185,6 +193,10 @@ export class CandleQueryClient {
    * Clean up pending requests (e.g., on disconnect)
    */
   cancelAllRequests() {
+    // Let the backend stop work nobody is waiting for
+    for (const requestId of this.responseHandlers.keys()) {
+      this.ws.cancelQuery(requestId);
+    }
     this.responseHandlers.clear();
   }
 }
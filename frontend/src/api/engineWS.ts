@@ -1,6 +1,9 @@
 // frontend/src/api/engineWS.ts
 // WebSocket client for receiving market data from C++ engine backend
 
+import { decodeBinaryCandles, expandColumnarResponse, fillSparseResponse } from './candleEncoding';
+import type { CandleEncoding } from './candleEncoding';
+
 export interface ProviderTickMessage {
   type: 'ProviderTick';
   data: {
@@ -81,6 +84,7 @@ export interface ChartCandleMessage {
     volume: number;
     open_time: string;
     ms: number; // Millisecond epoch for precise viewport positioning
+    resolutionMs?: number; // Bar interval (set by the engine's bar builder)
   };
 }
 
@@ -108,6 +112,8 @@ export interface QueryOrdersResponseMessage {
     timestamp: string;
     rejectionReason?: string;
   }>;
+  nextSinceId?: number;  // Pass back as sinceId for the next page / only newer orders
+  hasMore?: boolean;
   error?: string;
 }
 
@@ -123,15 +129,64 @@ export interface QueryCandlesResponseMessage {
       low: number;
       close: number;
       volume: number;
-      open_time: string;
+      open_time?: string; // Only present in the 'json' encoding
       ms: number;
     }>;
     count: number;
     isTruncated: boolean;
+    requestedResolutionMs?: number;
+    downsampled?: boolean; // resolutionMs was widened to fit maxPoints
   };
   error?: string;
 }
 
+// Backfill for a SubscribeCandles request; CandleDelta messages follow
+export interface SubscribeCandlesResponseMessage {
+  type: 'SubscribeCandlesResponse';
+  requestId: string;
+  data?: {
+    subscriptionId: string;
+    symbol: string;
+    resolutionMs: number;
+    candles: Array<{
+      open: number;
+      high: number;
+      low: number;
+      close: number;
+      volume: number;
+      openTime: string;
+      ms: number;
+    }>;
+    count: number;
+    isTruncated: boolean; // Starts later than fromMs (maxPoints reached)
+    error?: boolean;
+    errorCode?: string;
+    errorMessage?: string;
+  };
+}
+
+// Bars of a subscription that changed since the previous delta: the ones
+// that closed (final) and the bar in progress (last, not final)
+export interface CandleDeltaMessage {
+  type: 'CandleDelta';
+  data: {
+    subscriptionId: string;
+    symbol: string;
+    resolutionMs: number;
+    candles: Array<{
+      open: number;
+      high: number;
+      low: number;
+      close: number;
+      volume: number;
+      openTime: string;
+      ms: number;
+      final: boolean;
+    }>;
+    resync?: boolean; // Bars were skipped; subscribe again for a fresh backfill
+  };
+}
+
 export interface QueryDefaultViewportResponseMessage {
   type: 'QueryDefaultViewportResponse';
   requestId: string;
@@ -143,7 +198,27 @@ export interface QueryDefaultViewportResponseMessage {
   error?: string;
 }
 
-export type EngineMessage = ProviderTickMessage | RunStartMessage | OrderPlacedMessage | OrderFilledMessage | OrderRejectedMessage | PositionUpdatedMessage | ChartCandleMessage | QueryOrdersResponseMessage | QueryPositionsResponseMessage | QueryCandlesResponseMessage | QueryDefaultViewportResponseMessage;
+export interface QueryMetricsResponseMessage {
+  type: 'QueryMetricsResponse';
+  requestId: string;
+  data?: {
+    enabled: boolean; // False when the engine was built with ENG_ENABLE_METRICS=OFF
+    stages: Array<{
+      stage: string; // feed, ingress, dispatch, strategy, broker_ack, tick_to_order, persist_flush
+      count: number;
+      meanNs: number;
+      minNs: number;
+      p50Ns: number;
+      p90Ns: number;
+      p99Ns: number;
+      p999Ns: number;
+      maxNs: number;
+    }>;
+  };
+  error?: string;
+}
+
+export type EngineMessage = ProviderTickMessage | RunStartMessage | OrderPlacedMessage | OrderFilledMessage | OrderRejectedMessage | PositionUpdatedMessage | ChartCandleMessage | QueryOrdersResponseMessage | QueryPositionsResponseMessage | QueryCandlesResponseMessage | QueryDefaultViewportResponseMessage | QueryMetricsResponseMessage | SubscribeCandlesResponseMessage | CandleDeltaMessage;
 
 export type ConnectionStatus = 'connecting' | 'connected' | 'disconnected' | 'error';
 
@@ -197,6 +272,9 @@ export class EngineTickClient {
   };
   private readonly STATS_LOG_INTERVAL = 5000; // Log stats every 5 seconds
 
+  // Wire format requested for QueryCandles responses (see candleEncoding.ts)
+  private candleEncoding: CandleEncoding = 'binary';
+
   /**
    * Connect to the WebSocket server
    */
@@ -220,6 +298,7 @@ export class EngineTickClient {
     return new Promise((resolve, reject) => {
       try {
         const newWs = new WebSocket(this.wsUrl);
+        newWs.binaryType = 'arraybuffer'; // Binary candle frames
 
         newWs.onopen = () => {
           // Only update if this is still the current WebSocket
@@ -341,20 +420,37 @@ export class EngineTickClient {
   }
 
   /**
-   * Send a QueryOrders request to get all orders from backend
+   * Send a QueryOrders request. Without options the backend returns every
+   * order; sinceId/limit page through the history (or fetch only new orders).
    */
-  queryOrders(requestId: string): void {
-    const msg = {
+  queryOrders(requestId: string, options?: { sinceId?: number; limit?: number }): void {
+    const msg: Record<string, unknown> = {
       type: 'QueryOrders',
       requestId,
     };
+    if (options) msg.data = options;
     this.send(msg);
   }
 
   /**
-   * Send a QueryCandles request to get candles for a symbol/timeframe/range
+   * Send a QueryMetrics request for the engine's per-stage latency
+   * percentiles. With reset the backend clears the histograms after replying.
    */
-  queryCandles(requestId: string, symbol: string, resolutionMs: number, startMs: number, endMs: number): void {
+  queryMetrics(requestId: string, options?: { reset?: boolean }): void {
+    const msg: Record<string, unknown> = {
+      type: 'QueryMetrics',
+      requestId,
+    };
+    if (options) msg.data = options;
+    this.send(msg);
+  }
+
+  /**
+   * Send a QueryCandles request to get candles for a symbol/timeframe/range.
+   * With maxPoints the backend widens the resolution (keeping true OHLC per
+   * bar) so at most that many bars come back.
+   */
+  queryCandles(requestId: string, symbol: string, resolutionMs: number, startMs: number, endMs: number, maxPoints?: number): void {
     const msg = {
       type: 'QueryCandles',
       requestId,
@@ -363,11 +459,52 @@ export class EngineTickClient {
         resolutionMs,
         startMs,
         endMs,
+        encoding: this.candleEncoding,
+        sparse: true, // Empty buckets are filled in on arrival (fillSparseResponse)
+        ...(maxPoints !== undefined ? { maxPoints } : {}),
       },
     };
     this.send(msg);
   }
 
+  /**
+   * Subscribe to live candles: the backend answers with a
+   * SubscribeCandlesResponse (bars since fromMs, newest maxPoints at most)
+   * and then pushes CandleDelta messages, at most maxRateHz per second.
+   * Subscribing again with the same requestId replaces the subscription.
+   */
+  subscribeCandles(requestId: string, symbol: string, resolutionMs: number, fromMs: number,
+                   options?: { maxPoints?: number; maxRateHz?: number }): void {
+    this.send({
+      type: 'SubscribeCandles',
+      requestId,
+      data: { symbol, resolutionMs, fromMs, sparse: true, ...(options ?? {}) },
+    });
+  }
+
+  /**
+   * Stop a candle subscription (and its backfill, if still running)
+   */
+  unsubscribeCandles(requestId: string): void {
+    this.send({ type: 'UnsubscribeCandles', requestId });
+  }
+
+  /**
+   * Cancel an in-flight query. The backend drops it if it hasn't started and
+   * aborts its database scan if it has; no response is sent either way.
+   * (Re-sending a query with the same requestId supersedes the old one too.)
+   */
+  cancelQuery(requestId: string): void {
+    this.send({ type: 'CancelQuery', requestId });
+  }
+
+  /**
+   * Choose the QueryCandles response encoding ('json' for the legacy format)
+   */
+  setCandleEncoding(encoding: CandleEncoding): void {
+    this.candleEncoding = encoding;
+  }
+
   /**
    * Query the default viewport from backend (e.g., last 24h of data)
    */
@@ -436,9 +573,20 @@ export class EngineTickClient {
   /**
    * Handle incoming messages from the server
    */
-  private onMessageReceived(rawData: string) {
+  private onMessageReceived(rawData: string | ArrayBuffer) {
     try {
-      const msg = JSON.parse(rawData) as EngineMessage;
+      let msg: EngineMessage;
+      if (rawData instanceof ArrayBuffer) {
+        const decoded = decodeBinaryCandles(rawData);
+        if (!decoded) {
+          console.warn('[EngineTickClient] Ignoring unknown binary frame of', rawData.byteLength, 'bytes');
+          return;
+        }
+        msg = decoded as EngineMessage;
+      } else {
+        msg = expandColumnarResponse(JSON.parse(rawData)) as EngineMessage;
+      }
+      msg = fillSparseResponse(msg) as EngineMessage;
       
       // Track statistics
       this.messageStats.totalReceived++;
@@ -448,7 +596,7 @@ export class EngineTickClient {
       this.messageStats.queueDepth = this.messageQueue.length;
       
       // Log query responses
-      if (msgType === 'QueryOrdersResponse' || msgType === 'QueryPositionsResponse' || msgType === 'QueryDefaultViewportResponse' || msgType === 'QueryCandlesResponse') {
+      if (msgType === 'QueryOrdersResponse' || msgType === 'QueryPositionsResponse' || msgType === 'QueryDefaultViewportResponse' || msgType === 'QueryCandlesResponse' || msgType === 'QueryMetricsResponse' || msgType === 'SubscribeCandlesResponse') {
         console.log(`[EngineTickClient] Received ${msgType} with requestId:`, (msg as any).requestId);
         
         // Try to handle via registry first (for manual queries, etc)
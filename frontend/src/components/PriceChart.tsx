@@ -133,8 +133,10 @@ export function PriceChart() {
         }
       });
       
-      // Send the query
-      engineWS.queryCandles(requestId, 'BTCUSD', resolutionMs, startMs, endMs);
+      // Send the query; cap bars at roughly one per pixel so wide ranges
+      // come back downsampled instead of as every bar in the range
+      const maxPoints = Math.max(200, Math.floor(containerWidth));
+      engineWS.queryCandles(requestId, 'BTCUSD', resolutionMs, startMs, endMs, maxPoints);
       setManualQueryStatus(`Query sent. Waiting for response...`);
     } catch (err) {
       setManualQueryStatus('Error: ' + (err instanceof Error ? err.message : String(err)));
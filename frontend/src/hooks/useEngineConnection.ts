@@ -2,7 +2,7 @@
 // React hook to manage WebSocket connection and RPC queries to C++ engine
 
 import { useEffect, useRef } from 'react';
-import { engineWS, type RunStartMessage, type QueryOrdersResponseMessage, type QueryPositionsResponseMessage, type QueryCandlesResponseMessage, type QueryDefaultViewportResponseMessage, type EngineMessage } from '../api/engineWS';
+import { engineWS, type RunStartMessage, type QueryOrdersResponseMessage, type QueryPositionsResponseMessage, type QueryCandlesResponseMessage, type QueryDefaultViewportResponseMessage, type SubscribeCandlesResponseMessage, type CandleDeltaMessage, type EngineMessage } from '../api/engineWS';
 import { useOrderStore } from '../store/orderStore';
 import { useChartStore } from '../store/chartStore';
 
@@ -23,6 +23,9 @@ export function useEngineConnection() {
   // Store response handlers keyed by requestId
   const responseHandlersRef = useRef<Map<string, (data: any) => void>>(new Map());
 
+  // The chart's live candle subscription (its requestId is the subscription id)
+  const candleSubRef = useRef<{ id: string; resolutionMs: number; fromMs: number } | null>(null);
+
   useEffect(() => {
     let isMounted = true;
 
@@ -114,6 +117,43 @@ export function useEngineConnection() {
             console.warn('[useEngineConnection] No handler found for QueryCandlesResponse requestId:', response.requestId);
           }
         }
+        // Candle subscription backfill replaces the chart's bars
+        else if (msg.type === 'SubscribeCandlesResponse') {
+          const response = msg as SubscribeCandlesResponseMessage;
+          if (response.requestId !== candleSubRef.current?.id) return;  // Superseded
+          if (!response.data || response.data.error) {
+            console.error('[useEngineConnection] SubscribeCandles error:', response.data?.errorMessage);
+            candleSubRef.current = null;  // Retried on the next poll
+            return;
+          }
+          console.log('[useEngineConnection] SubscribeCandles backfill:', response.data.count, 'candles');
+          useChartStore.getState().setCandles(response.data.candles.map((c) => ({
+            time: c.ms,
+            open: c.open,
+            high: c.high,
+            low: c.low,
+            close: c.close,
+            volume: c.volume || 0,
+          })));
+        }
+        // Candle deltas update only the bars that changed
+        else if (msg.type === 'CandleDelta') {
+          const delta = msg as CandleDeltaMessage;
+          if (delta.data.subscriptionId !== candleSubRef.current?.id) return;
+          useChartStore.getState().mergeCandles(delta.data.candles.map((c) => ({
+            time: c.ms,
+            open: c.open,
+            high: c.high,
+            low: c.low,
+            close: c.close,
+            volume: c.volume || 0,
+          })));
+          if (delta.data.resync) {
+            // The backend skipped bars for us; subscribe again on the next poll
+            engineWS.unsubscribeCandles(delta.data.subscriptionId);
+            candleSubRef.current = null;
+          }
+        }
         // Handle QueryDefaultViewportResponse
         else if (msg.type === 'QueryDefaultViewportResponse') {
           const response = msg as QueryDefaultViewportResponseMessage;
@@ -192,8 +232,7 @@ export function useEngineConnection() {
         });
         engineWS.queryPositions(positionsRequestId);
 
-        // Query candles for the current viewport (1-second resolution)
-        const candlesRequestId = generateRequestId();
+        // Candles for the current viewport come from a live subscription
         // Calculate optimal resolution based on viewport width
         // Goal: Keep candle count between ~100-2000 for good performance
         const calculateResolution = (viewportWidthMs: number): number => {
@@ -244,31 +283,17 @@ export function useEngineConnection() {
                      (viewportWidthMs / 3600000).toFixed(2), 'hours, requesting resolution =', 
                      formatResolution(resolutionMs), `(${resolutionMs}ms)`);
           
-          responseHandlersRef.current.set(candlesRequestId, (response: QueryCandlesResponseMessage) => {
-            if (response.error) {
-              console.error('[useEngineConnection] QueryCandles error:', response.error);
-              return;
-            }
-            if (response.data && response.data.candles) {
-              console.log('[useEngineConnection] QueryCandles returned', response.data.count, 
-                         'candles at resolution', formatResolution(resolutionMs));
-              
-              // Store candles in chart store
-              const candles = response.data.candles.map((c: any) => ({
-                time: c.ms, // Backend sends 'ms' not 'time'
-                open: c.open,
-                high: c.high,
-                low: c.low,
-                close: c.close,
-                volume: c.volume || 0,
-              }));
-              
-              useChartStore.getState().setCandles(candles);
-            }
-          });
-          
-          // Query candles for the current viewport range
-          engineWS.queryCandles(candlesRequestId, 'BTCUSD', resolutionMs, currentViewportStartMs, currentViewportEndMs);
+          // The backend pushes changed bars as they happen; only a new
+          // resolution or viewport start needs a new subscription (and backfill)
+          const current = candleSubRef.current;
+          if (!current || current.resolutionMs !== resolutionMs || current.fromMs !== currentViewportStartMs) {
+            if (current) engineWS.unsubscribeCandles(current.id);
+            const subscriptionId = generateRequestId();
+            candleSubRef.current = { id: subscriptionId, resolutionMs, fromMs: currentViewportStartMs };
+            console.log('[useEngineConnection] Subscribing to candles at', formatResolution(resolutionMs),
+                        'from', currentViewportStartMs);
+            engineWS.subscribeCandles(subscriptionId, 'BTCUSD', resolutionMs, currentViewportStartMs);
+          }
         } else {
           console.warn('[useEngineConnection] Skipping candle query - invalid viewport:', { viewportStartMs: currentViewportStartMs, viewportEndMs: currentViewportEndMs });
         }
@@ -393,6 +418,9 @@ export function useEngineConnection() {
       console.log('[useEngineConnection] Connection status changed to:', status);
       
       if (status === 'disconnected' || status === 'error') {
+        // The backend dropped our subscription with the connection
+        candleSubRef.current = null;
+
         // Clear polling interval on disconnect
         if (pollingIntervalRef.current) {
           console.log('[useEngineConnection] Clearing polling interval due to disconnection');
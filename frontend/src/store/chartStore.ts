@@ -34,6 +34,7 @@ type ChartState = {
   
   // Methods
   setCandles: (candles: Candle[]) => void;
+  mergeCandles: (updates: Candle[]) => void;
   setDataBounds: (minMs: number | null, maxMs: number | null) => void;
   setViewportStartMs: (ms: number) => void;
   setViewportEndMs: (ms: number) => void;
@@ -72,6 +73,24 @@ export const useChartStore = create<ChartState>((set) => ({
       return { candles };
     }),
 
+  // Live updates: replace bars with the same time, insert the others in order
+  mergeCandles: (updates: Candle[]) =>
+    set((state) => {
+      if (updates.length === 0) return {};
+      const candles = state.candles.slice();
+      for (const update of updates) {
+        // Updates land at (or near) the end, so search from there
+        let i = candles.length - 1;
+        while (i >= 0 && candles[i].time > update.time) i--;
+        if (i >= 0 && candles[i].time === update.time) {
+          candles[i] = update;
+        } else {
+          candles.splice(i + 1, 0, update);
+        }
+      }
+      return { candles };
+    }),
+
   setViewportStartMs: (ms: number) =>
     set(() => ({ viewportStartMs: ms })),
 
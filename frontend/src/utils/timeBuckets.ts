@@ -192,3 +192,33 @@ export function generateTimeBuckets(viewportStartMs: number, viewportEndMs: numb
   
   return buckets;
 }
+
+/**
+ * Forward-fill a sparse candle series: every empty intervalMs bucket between
+ * two candles becomes a flat, zero-volume candle at the previous close (what
+ * the backend sends unless a query asks for sparse bars)
+ */
+export function fillCandleGaps<T extends { ms: number; open: number; high: number; low: number; close: number; volume: number; openTime?: string }>(candles: T[], intervalMs: number): T[] {
+  if (candles.length < 2 || !(intervalMs > 0)) return candles;
+
+  const filled: T[] = [];
+  for (let i = 0; i < candles.length; i++) {
+    if (i > 0) {
+      const prev = candles[i - 1];
+      for (let ms = prev.ms + intervalMs; ms < candles[i].ms; ms += intervalMs) {
+        filled.push({
+          ...prev,
+          ms,
+          open: prev.close,
+          high: prev.close,
+          low: prev.close,
+          volume: 0,
+          // Same second-resolution ISO form as the backend's openTime
+          ...(prev.openTime !== undefined ? { openTime: new Date(ms).toISOString().replace(/\.\d{3}Z$/, 'Z') } : {}),
+        } as T);
+      }
+    }
+    filled.push(candles[i]);
+  }
+  return filled;
+}
@@ -35,13 +35,6 @@ public:
     void subscribe_trades(const std::vector<std::string>&,
                           std::function<void(const eng::TradePrint&)>) override {}
 
-    virtual std::vector<eng::Candle> get_hist_candles(
-            const std::string& symbol,
-            const std::string& interval,   // "1m","5m","1h","1d", etc.
-            int limit) override {
-                return std::vector<eng::Candle>{}; // return nothing vector for now
-            };                 
-    
     void start(int seconds);
 
 private:
@@ -0,0 +1,306 @@
+#pragma once
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace adapter {
+
+/**
+ * GzipLineReader
+ *
+ * Streaming line reader over a gzip-compressed text file (e.g. JSONL.GZ).
+ * Decompresses into a single reusable buffer and hands out one line at a
+ * time as a string_view, so memory stays bounded by the chunk size (plus the
+ * longest line) no matter how large the file is.
+ *
+ * Usage:
+ *   GzipLineReader reader(path);
+ *   std::string_view line;
+ *   while (reader.next_line(line)) { ... }
+ *
+ * The returned view is only valid until the next call to next_line().
+ *
+ * Inflate::Background moves decompression onto a worker thread: it inflates
+ * the next chunk while the caller is still splitting the current one, and
+ * the two buffers are swapped rather than copied. Only a line that straddles
+ * two chunks is copied (into a small carry buffer). Use it with large chunks
+ * (PREFETCH_CHUNK_SIZE) on a replay whose parsing and dispatch would
+ * otherwise wait on zlib.
+ */
+class GzipLineReader {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+    static constexpr size_t PREFETCH_CHUNK_SIZE = 1024 * 1024;
+
+    enum class Inflate {
+        Inline,       // gzread() on the calling thread, when the buffer runs dry
+        Background    // A worker thread inflates one chunk ahead
+    };
+
+    /**
+     * Open a gzip file for streaming.
+     * @param filepath Path to the .gz file
+     * @param chunk_size Number of decompressed bytes requested per gzread()
+     * @param inflate Where decompression runs
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    explicit GzipLineReader(const std::string& filepath, size_t chunk_size = DEFAULT_CHUNK_SIZE,
+                            Inflate inflate = Inflate::Inline)
+        : _chunk_size(chunk_size > 0 ? chunk_size : DEFAULT_CHUNK_SIZE) {
+        _file = gzopen(filepath.c_str(), "rb");
+        if (!_file) {
+            throw std::runtime_error("Cannot open gzip file: " + filepath);
+        }
+        // zlib's default 8 KB input buffer costs a read() per 8 KB of
+        // compressed data; must be set before the first gzread()
+        gzbuffer(_file, INPUT_BUFFER_SIZE);
+        _buffer.resize(_chunk_size);
+        if (inflate == Inflate::Background) {
+            _prefetch = std::make_unique<Prefetcher>(_file, _chunk_size);
+        }
+    }
+
+    ~GzipLineReader() {
+        _prefetch.reset();  // Joins the worker before the file goes away
+        if (_file) gzclose(_file);
+    }
+
+    GzipLineReader(const GzipLineReader&) = delete;
+    GzipLineReader& operator=(const GzipLineReader&) = delete;
+
+    /**
+     * Fetch the next non-empty line (without the trailing "\n" or "\r\n").
+     * A final line without a trailing newline is still returned.
+     * @param line Set to a view into the internal buffer on success
+     * @return false once the file is exhausted
+     * @throws std::runtime_error on a decompression error
+     */
+    bool next_line(std::string_view& line) {
+        if (_carry_out) {
+            _carry.clear();
+            _carry_out = false;
+        }
+
+        while (true) {
+            const char* base = _buffer.data();
+            const void* nl = (_end > _scan)
+                ? std::memchr(base + _scan, '\n', _end - _scan)
+                : nullptr;
+
+            if (nl) {
+                size_t pos = static_cast<const char*>(nl) - base;
+                size_t start = _begin;
+                _begin = pos + 1;
+                _scan = _begin;
+                if (!_carry.empty()) {
+                    // Finish the line that started in the previous chunk
+                    _carry.append(base + start, pos - start);
+                    if (emit_carry(line)) return true;
+                    continue;
+                }
+                if (emit(start, pos, line)) return true;
+                continue;  // Skip empty lines
+            }
+
+            // No complete line buffered; remember how far we searched
+            _scan = _end;
+
+            if (_eof) {
+                if (!_carry.empty()) {
+                    return emit_carry(line);
+                }
+                if (_begin < _end) {
+                    size_t start = _begin;
+                    _begin = _end;
+                    if (emit(start, _end, line)) return true;
+                }
+                return false;
+            }
+
+            fill();
+        }
+    }
+
+    /**
+     * Total number of decompressed bytes handed out so far (consumed lines
+     * including their newlines). Useful as a resumable replay offset.
+     */
+    size_t bytes_consumed() const {
+        return _consumed_base + _begin - (_carry_out ? 0 : _carry.size());
+    }
+
+private:
+    static constexpr unsigned INPUT_BUFFER_SIZE = 128 * 1024;
+
+    /**
+     * Background inflate for Inflate::Background. The worker owns the
+     * gzFile: it inflates into a spare buffer, then waits until the ready
+     * slot is free and swaps the spare in. next() swaps the ready chunk out
+     * for the caller's finished one, which becomes the worker's next spare.
+     */
+    class Prefetcher {
+    public:
+        Prefetcher(gzFile file, size_t chunk_size)
+            : _file(file), _chunk_size(chunk_size), _ready(chunk_size) {
+            _thread = std::thread([this] { run(); });
+        }
+
+        ~Prefetcher() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _cv.notify_all();
+            if (_thread.joinable()) _thread.join();
+        }
+
+        Prefetcher(const Prefetcher&) = delete;
+        Prefetcher& operator=(const Prefetcher&) = delete;
+
+        /**
+         * Block until the next chunk is inflated and swap it into chunk.
+         * @return false at end of file
+         * @throws std::runtime_error if the worker hit a decompression error
+         */
+        bool next(std::vector<char>& chunk, size_t& length) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this] { return _ready_full || _done; });
+            if (!_ready_full) {
+                if (_failed) throw std::runtime_error("Error reading gzip file");
+                return false;
+            }
+            chunk.swap(_ready);
+            length = _ready_length;
+            _ready_full = false;
+            lock.unlock();
+            _cv.notify_all();
+            return true;
+        }
+
+    private:
+        gzFile _file;
+        size_t _chunk_size;
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        std::vector<char> _ready;     // Inflated chunk waiting for next(), once _ready_full
+        size_t _ready_length{0};
+        bool _ready_full{false};
+        bool _done{false};            // Worker reached end of file (or an error)
+        bool _failed{false};
+        bool _stop{false};
+        std::thread _thread;
+
+        void run() {
+            std::vector<char> spare(_chunk_size);
+            while (true) {
+                // Inflate outside the lock: this is the work that overlaps parsing
+                int bytes_read = gzread(_file, spare.data(), static_cast<unsigned>(_chunk_size));
+
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (bytes_read <= 0) {
+                    _failed = bytes_read < 0;
+                    _done = true;
+                    lock.unlock();
+                    _cv.notify_all();
+                    return;
+                }
+                _cv.wait(lock, [this] { return !_ready_full || _stop; });
+                if (_stop) return;
+                _ready.swap(spare);
+                _ready_length = static_cast<size_t>(bytes_read);
+                _ready_full = true;
+                lock.unlock();
+                _cv.notify_all();
+
+                if (spare.size() < _chunk_size) spare.resize(_chunk_size);
+            }
+        }
+    };
+
+    gzFile _file{nullptr};
+    size_t _chunk_size;
+    std::vector<char> _buffer;
+    size_t _begin{0};   // First unconsumed byte
+    size_t _scan{0};    // Position up to which we already searched for '\n'
+    size_t _end{0};     // One past the last valid byte
+    size_t _consumed_base{0};
+    bool _eof{false};
+    std::unique_ptr<Prefetcher> _prefetch;
+    std::string _carry;       // Background: a line split across two chunks
+    bool _carry_out{false};   // _carry was handed out and is cleared on the next call
+
+    bool emit(size_t start, size_t stop, std::string_view& line) {
+        if (stop > start && _buffer[stop - 1] == '\r') --stop;
+        if (stop == start) return false;
+        line = std::string_view(_buffer.data() + start, stop - start);
+        return true;
+    }
+
+    bool emit_carry(std::string_view& line) {
+        size_t stop = _carry.size();
+        if (stop > 0 && _carry[stop - 1] == '\r') --stop;
+        if (stop == 0) {
+            _carry.clear();
+            return false;
+        }
+        line = std::string_view(_carry.data(), stop);
+        _carry_out = true;
+        return true;
+    }
+
+    /**
+     * Background: swap in the next prefetched chunk.
+     * Inline: shift the unconsumed tail to the front (once per chunk, not per line),
+     * grow if a single line exceeds the buffer, then read the next chunk.
+     */
+    void fill() {
+        if (_prefetch) {
+            // The tail of this chunk is the start of a line; keep it, hand
+            // the chunk back and take the next one
+            if (_begin < _end) _carry.append(_buffer.data() + _begin, _end - _begin);
+            _consumed_base += _end;
+            _begin = _scan = _end = 0;
+            size_t length = 0;
+            if (!_prefetch->next(_buffer, length)) {
+                _eof = true;
+                return;
+            }
+            _end = length;
+            return;
+        }
+
+        if (_begin > 0) {
+            size_t remaining = _end - _begin;
+            if (remaining > 0) {
+                std::memmove(_buffer.data(), _buffer.data() + _begin, remaining);
+            }
+            _consumed_base += _begin;
+            _scan -= _begin;
+            _end = remaining;
+            _begin = 0;
+        }
+
+        if (_buffer.size() - _end < _chunk_size) {
+            _buffer.resize(_end + _chunk_size);
+        }
+
+        int bytes_read = gzread(_file, _buffer.data() + _end, static_cast<unsigned>(_chunk_size));
+        if (bytes_read < 0) {
+            throw std::runtime_error("Error reading gzip file");
+        }
+        if (bytes_read == 0) {
+            _eof = true;
+            return;
+        }
+        _end += static_cast<size_t>(bytes_read);
+    }
+};
+
+}
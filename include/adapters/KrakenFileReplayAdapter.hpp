@@ -3,10 +3,13 @@
 #include <vector>
 #include <fstream>
 #include <sstream>
-#include <zlib.h>
+#include <atomic>
 #include <nlohmann/json.hpp>
+#include "GzipLineReader.hpp"
+#include "KrakenTradeParser.hpp"
 #include "../engine/IMarketData.hpp"
 #include "../engine/InstrumentRegistry.hpp"
+#include "../engine/ReplayClock.hpp"
 
 namespace adapter {
 
@@ -37,7 +40,7 @@ public:
      * The registry's lifetime must exceed this adapter's.
      */
     explicit KrakenFileReplayAdapter(std::shared_ptr<eng::InstrumentRegistry> registry)
-        : _registry(registry), _is_running(false), _filepath("") {}
+        : _registry(registry), _is_running(false), _filepath(""), _parser(registry) {}
 
     /**
      * Create adapter with filepath (for backtest mode).
@@ -47,7 +50,7 @@ public:
         const std::string& filepath,
         std::shared_ptr<eng::InstrumentRegistry> registry
     )
-        : _registry(registry), _is_running(false), _filepath(filepath) {}
+        : _registry(registry), _is_running(false), _filepath(filepath), _parser(registry) {}
 
     ~KrakenFileReplayAdapter() {
         stop();
@@ -77,6 +80,7 @@ public:
         std::function<void(const eng::TradePrint&)> callback
     ) override {
         _trade_callbacks[symbol] = callback;
+        _cached_callback_id = 0;
     }
 
     void subscribe_quotes(
@@ -109,15 +113,7 @@ public:
         for (const auto& symbol : symbols) {
             _trade_callbacks[symbol] = callback;
         }
-    }
-
-    // Candle queries (not used in backtest, but required by interface)
-    std::vector<eng::Candle> get_hist_candles(
-        const std::string& symbol,
-        const std::string& interval,
-        int limit
-    ) override {
-        return {};
+        _cached_callback_id = 0;
     }
 
     // ---- Backtest API ----
@@ -126,55 +122,90 @@ public:
      * Replay trades from a Kraken JSONL.GZ file.
      * 
      * @param filepath Path to trades_*.jsonl.gz or YYYY-MM-DD.jsonl.gz
-     * @param pace Replay speed: 1.0 = real-time, 10.0 = 10x, 0.0 = instant
+     * @param pace Replay speed by trade timestamp: 1.0 = real-time, 10.0 = 10x,
+     *             0.0 (or negative) = unthrottled (see eng::ReplayClock)
      * @param on_trade Optional callback for each replayed trade
-     * @return Number of trades replayed
+     * @param skip Trades to pass over first (parsed, but not paced, stored or
+     *             emitted), to resume at a checkpoint's position
+     * @return Number of trades replayed, skipped ones included
      */
     size_t replay(
         const std::string& filepath,
         double pace = 1.0,
-        std::function<void(const eng::TradePrint&)> on_trade = nullptr
+        std::function<void(const eng::TradePrint&)> on_trade = nullptr,
+        size_t skip = 0
     ) {
         if (!_is_running) {
             throw std::runtime_error("Adapter not started; call start() first");
         }
 
         size_t trade_count = 0;
-        std::vector<json> trades;
+        eng::ReplayClock clock(pace);
 
         try {
-            // Read and decompress JSONL.GZ
-            trades = read_jsonl_gz(filepath);
+            // Stream the file: a worker inflates the next 1 MB chunk while
+            // this thread parses one line, emits it, and drops it before
+            // touching the next one.
+            GzipLineReader reader(filepath, GzipLineReader::PREFETCH_CHUNK_SIZE,
+                                  GzipLineReader::Inflate::Background);
+            std::string_view line;
+            eng::TradePrint tp;  // Reused across lines so its storage is recycled
+
+            while (_is_running && reader.next_line(line)) {
+                try {
+                    // Unexpected layout falls back to the full JSON parser;
+                    // lines neither can read are skipped
+                    if (!_parser.parse(line, tp) && !_parser.parse_json(line, tp)) {
+                        continue;
+                    }
+                    if (trade_count < skip) {
+                        trade_count++;
+                        continue;
+                    }
+
+                    // Hold the trade until its timestamp is due (no-op when unthrottled)
+                    if (!clock.wait_until(tp.ts, _is_running)) break;
+
+                    // Recorded before it's emitted, so handlers can query it
+                    if (tick_store_) tick_store_->append(tp);
+
+                    // Emit via callback if subscribed
+                    if (auto* cb = callback_for(tp)) {
+                        (*cb)(tp);
+                    }
+
+                    // Emit via on_trade if provided
+                    if (on_trade) {
+                        on_trade(tp);
+                    }
+
+                    trade_count++;
+                } catch (const std::exception& e) {
+                    // Skip malformed trades
+                    // In production, might want to log warning
+                }
+            }
         } catch (const std::exception& e) {
             throw std::runtime_error(
                 "Failed to read Kraken file '" + filepath + "': " + std::string(e.what())
             );
         }
 
-        // Replay each trade
-        for (const auto& trade_json : trades) {
-            try {
-                eng::TradePrint tp = parse_kraken_trade(trade_json);
-                
-                // Emit via callback if subscribed
-                auto it = _trade_callbacks.find(tp.symbol);
-                if (it != _trade_callbacks.end()) {
-                    it->second(tp);
-                }
-
-                // Emit via on_trade if provided
-                if (on_trade) {
-                    on_trade(tp);
-                }
+        _last_clock_stats = clock.stats();
+        return trade_count;
+    }
 
-                trade_count++;
-            } catch (const std::exception& e) {
-                // Skip malformed trades
-                // In production, might want to log warning
-            }
-        }
+    // Pacing stats from the last replay() (all zero when unthrottled)
+    const eng::ReplayClock::Stats& last_replay_clock_stats() const {
+        return _last_clock_stats;
+    }
 
-        return trade_count;
+    /**
+     * Keep the raw Kraken "misc" flags in TradePrint::metadata.
+     * Disable for throughput: it costs a map lookup per trade.
+     */
+    void set_keep_metadata(bool keep) {
+        _parser.set_keep_metadata(keep);
     }
 
     // ---- Instrument Registry Access ----
@@ -185,153 +216,24 @@ public:
 
 private:
     std::shared_ptr<eng::InstrumentRegistry> _registry;
-    bool _is_running;
+    std::atomic<bool> _is_running;
+    eng::ReplayClock::Stats _last_clock_stats;
     std::string _filepath;
     std::unordered_map<std::string, std::function<void(const eng::TradePrint&)>> _trade_callbacks;
-
-    /**
-     * Read and decompress JSONL.GZ file.
-     * Returns vector of JSON objects (one per line).
-     */
-    std::vector<json> read_jsonl_gz(const std::string& filepath) const {
-        std::vector<json> result;
-
-        gzFile file = gzopen(filepath.c_str(), "rb");
-        if (!file) {
-            throw std::runtime_error("Cannot open gzip file: " + filepath);
+    KrakenTradeParser _parser;
+
+    // Last callback resolved, keyed by instrument id, so the per-trade path
+    // doesn't hash the symbol string. Reset whenever subscriptions change.
+    eng::InstrumentId _cached_callback_id{0};
+    const std::function<void(const eng::TradePrint&)>* _cached_callback{nullptr};
+
+    const std::function<void(const eng::TradePrint&)>* callback_for(const eng::TradePrint& tp) {
+        if (tp.instrument_id == 0 || tp.instrument_id != _cached_callback_id) {
+            auto it = _trade_callbacks.find(tp.symbol);
+            _cached_callback = (it != _trade_callbacks.end()) ? &it->second : nullptr;
+            _cached_callback_id = tp.instrument_id;
         }
-
-        try {
-            char buffer[4096];
-            std::string line_buffer;
-
-            while (true) {
-                int bytes_read = gzread(file, buffer, sizeof(buffer));
-                if (bytes_read < 0) {
-                    throw std::runtime_error("Error reading gzip file");
-                }
-                if (bytes_read == 0) {
-                    break; // EOF
-                }
-
-                line_buffer.append(buffer, bytes_read);
-
-                // Process complete lines
-                size_t pos = 0;
-                while ((pos = line_buffer.find('\n')) != std::string::npos) {
-                    std::string line = line_buffer.substr(0, pos);
-                    if (!line.empty() && line.back() == '\r') {
-                        line.pop_back();
-                    }
-
-                    if (!line.empty()) {
-                        try {
-                            result.push_back(json::parse(line));
-                        } catch (const json::exception& e) {
-                            // Skip malformed JSON lines
-                        }
-                    }
-
-                    line_buffer.erase(0, pos + 1);
-                }
-            }
-
-            // Process remaining line (if file doesn't end with \n)
-            if (!line_buffer.empty()) {
-                try {
-                    result.push_back(json::parse(line_buffer));
-                } catch (const json::exception& e) {
-                    // Skip malformed JSON
-                }
-            }
-
-        } catch (...) {
-            gzclose(file);
-            throw;
-        }
-
-        gzclose(file);
-        return result;
-    }
-
-    /**
-     * Parse a Kraken trade JSON object into generic TradePrint.
-     * 
-     * Kraken format (per trade):
-     * {
-     *   "pair": "BTCUSD",
-     *   "price": 43500.5,
-     *   "volume": 0.123,
-     *   "time": 1234567890.123,  // Unix timestamp with fractional seconds
-     *   "side": "buy" or "sell",
-     *   "ordertype": "market" or "limit",
-     *   "misc": "m" (maker) | "M" (missing maker) | etc.
-     * }
-     */
-    eng::TradePrint parse_kraken_trade(const json& j) const {
-        eng::TradePrint tp;
-
-        // Extract symbol from "pair" field
-        std::string pair = j.at("pair").get<std::string>();
-        tp.symbol = pair;
-
-        // Register/lookup instrument
-        eng::InstrumentId instr_id = _registry->lookup_id(pair);
-        if (instr_id == 0) {
-            // Register new instrument as Crypto from Kraken exchange
-            instr_id = _registry->register_instrument(
-                pair,
-                eng::AssetClass::Crypto,
-                "KRAKEN",
-                "USD"
-            );
-        }
-        tp.instrument_id = instr_id;
-
-        // Extract price, volume, timestamp
-        tp.price = j.at("price").get<double>();
-        tp.qty = j.at("volume").get<double>();
-
-        // Convert Unix timestamp (seconds.fractional) to TimePoint
-        double unix_timestamp = j.at("time").get<double>();
-        auto seconds = static_cast<long>(unix_timestamp);
-        auto micros = static_cast<long>((unix_timestamp - seconds) * 1e6);
-        tp.ts = eng::TimePoint(std::chrono::duration_cast<std::chrono::system_clock::duration>(
-            std::chrono::seconds(seconds) + std::chrono::microseconds(micros)
-        ));
-
-        // Parse side: "buy" or "sell"
-        std::string side_str = j.at("side").get<std::string>();
-        if (side_str == "buy") {
-            tp.side = eng::TradeSide::Buy;
-        } else if (side_str == "sell") {
-            tp.side = eng::TradeSide::Sell;
-        } else {
-            tp.side = eng::TradeSide::Unknown;
-        }
-
-        // Parse ordertype: "market" or "limit"
-        std::string ordertype_str = j.at("ordertype").get<std::string>();
-        if (ordertype_str == "market") {
-            tp.order_type = eng::OrderType::Market;
-        } else if (ordertype_str == "limit") {
-            tp.order_type = eng::OrderType::Limit;
-        } else {
-            tp.order_type = eng::OrderType::Unknown;
-        }
-
-        // Parse misc field for liquidity: "m" = maker, others = taker/unknown
-        std::string misc_str = j.at("misc").get<std::string>();
-        if (misc_str.find('m') != std::string::npos) {
-            tp.liquidity = eng::TradeLiquidity::Maker;
-        } else {
-            tp.liquidity = eng::TradeLiquidity::Taker;
-        }
-
-        // Store original Kraken misc in metadata for debugging
-        tp.metadata["kraken_misc"] = misc_str;
-
-        return tp;
+        return _cached_callback;
     }
 };
 
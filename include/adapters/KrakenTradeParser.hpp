@@ -0,0 +1,542 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <memory>
+#include <chrono>
+#include <charconv>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include "../engine/MarketDataTypes.hpp"
+#include "../engine/InstrumentRegistry.hpp"
+
+namespace adapter {
+
+/**
+ * KrakenTradeParser
+ *
+ * Fixed-schema parser for one Kraken trade line, as written by
+ * scripts/kraken_day_capture.py:
+ *
+ *   {"pair":"XBTUSD","price":43500.5,"volume":0.123,"time":1704110400.123,
+ *    "side":"buy","ordertype":"market","misc":"m"}
+ *
+ * Scans the flat object in a single pass directly from the line buffer and
+ * fills a caller-owned TradePrint. Keys may appear in any order and unknown
+ * keys are skipped. Nothing is allocated in steady state: the symbol string
+ * is only reassigned when the pair changes, the InstrumentRegistry lookup is
+ * cached for the last pair seen, and the metadata map can be skipped.
+ *
+ * parse() returns false for anything outside the known layout (nested
+ * values, escaped strings, missing fields); parse_json() handles those lines
+ * through a full nlohmann parse.
+ *
+ * parse_ws() reads the live feed (websocket v2 trade channel) the same way,
+ * straight from the frame payload.
+ */
+class KrakenTradeParser {
+public:
+    /**
+     * @param registry Registry used to map pairs to dense InstrumentIds
+     * @param keep_metadata Store the raw "misc" flags in tp.metadata["kraken_misc"]
+     */
+    explicit KrakenTradeParser(std::shared_ptr<eng::InstrumentRegistry> registry,
+                               bool keep_metadata = true)
+        : _registry(std::move(registry)), _keep_metadata(keep_metadata) {}
+
+    void set_keep_metadata(bool keep) { _keep_metadata = keep; }
+    bool keep_metadata() const { return _keep_metadata; }
+
+    /**
+     * Parse one JSONL line into tp (reusing its storage).
+     * @return true on success; false if the line doesn't match the schema
+     */
+    bool parse(std::string_view line, eng::TradePrint& tp) {
+        const char* p = line.data();
+        const char* end = p + line.size();
+
+        std::string_view pair, side, ordertype, misc;
+        double price = 0.0, volume = 0.0;
+        std::int64_t ts_ns = 0;
+        unsigned seen = 0;
+
+        p = skip_ws(p, end);
+        if (p == end || *p != '{') return false;
+        ++p;
+
+        while (true) {
+            p = skip_ws(p, end);
+            if (p == end) return false;
+            if (*p == '}') break;
+
+            std::string_view key;
+            if (!parse_string(p, end, key)) return false;
+            p = skip_ws(p, end);
+            if (p == end || *p != ':') return false;
+            p = skip_ws(p + 1, end);
+            if (p == end) return false;
+
+            switch (field_of(key)) {
+                case Field::Pair:      if (!parse_string(p, end, pair)) return false; seen |= 1u << 0; break;
+                case Field::Price:     if (!parse_double(p, end, price)) return false; seen |= 1u << 1; break;
+                case Field::Volume:    if (!parse_double(p, end, volume)) return false; seen |= 1u << 2; break;
+                case Field::Time:      if (!parse_time(p, end, ts_ns)) return false; seen |= 1u << 3; break;
+                case Field::Side:      if (!parse_string(p, end, side)) return false; seen |= 1u << 4; break;
+                case Field::OrderType: if (!parse_string(p, end, ordertype)) return false; seen |= 1u << 5; break;
+                case Field::Misc:      if (!parse_string(p, end, misc)) return false; seen |= 1u << 6; break;
+                case Field::Other:     if (!skip_scalar(p, end)) return false; break;
+            }
+
+            p = skip_ws(p, end);
+            if (p == end) return false;
+            if (*p == ',') { ++p; continue; }
+            if (*p == '}') break;
+            return false;
+        }
+
+        if (seen != ALL_FIELDS) return false;
+
+        // Symbol + instrument id: only touch the string/registry when the pair changes
+        if (pair != _last_pair || _last_id == 0) {
+            _last_pair.assign(pair.data(), pair.size());
+            _last_id = resolve_instrument(_last_pair);
+            _last_ws_symbol.clear();
+        }
+        if (tp.symbol != _last_pair) {
+            tp.symbol.assign(_last_pair);
+        }
+        tp.instrument_id = _last_id;
+
+        tp.price = price;
+        tp.qty = volume;
+        tp.ts = eng::TimePoint(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(ts_ns)));
+
+        tp.side = (side == "buy") ? eng::TradeSide::Buy
+                : (side == "sell") ? eng::TradeSide::Sell
+                : eng::TradeSide::Unknown;
+
+        tp.order_type = (ordertype == "market") ? eng::OrderType::Market
+                      : (ordertype == "limit") ? eng::OrderType::Limit
+                      : eng::OrderType::Unknown;
+
+        // "m" = maker, anything else = taker
+        tp.liquidity = (misc.find('m') != std::string_view::npos)
+            ? eng::TradeLiquidity::Maker
+            : eng::TradeLiquidity::Taker;
+
+        if (_keep_metadata) {
+            auto it = tp.metadata.find(MISC_KEY);
+            if (it == tp.metadata.end()) {
+                tp.metadata.emplace(MISC_KEY, std::string(misc));
+            } else {
+                it->second.assign(misc.data(), misc.size());
+            }
+        } else if (!tp.metadata.empty()) {
+            tp.metadata.clear();
+        }
+
+        return true;
+    }
+
+    /**
+     * Slow path: full JSON parse of one line, for lines parse() rejects.
+     * @return false if the line isn't valid JSON or misses a required field
+     */
+    bool parse_json(std::string_view line, eng::TradePrint& tp) {
+        try {
+            auto j = nlohmann::json::parse(line.begin(), line.end());
+
+            std::string pair = j.at("pair").get<std::string>();
+            double price = j.at("price").get<double>();
+            double volume = j.at("volume").get<double>();
+            double unix_timestamp = j.at("time").get<double>();
+            std::string side_str = j.at("side").get<std::string>();
+            std::string ordertype_str = j.at("ordertype").get<std::string>();
+            std::string misc_str = j.at("misc").get<std::string>();
+
+            tp.symbol = pair;
+            tp.instrument_id = resolve_instrument(pair);
+            tp.price = price;
+            tp.qty = volume;
+            tp.ts = eng::TimePoint(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(static_cast<std::int64_t>(unix_timestamp * 1e9))));
+
+            tp.side = (side_str == "buy") ? eng::TradeSide::Buy
+                    : (side_str == "sell") ? eng::TradeSide::Sell
+                    : eng::TradeSide::Unknown;
+            tp.order_type = (ordertype_str == "market") ? eng::OrderType::Market
+                          : (ordertype_str == "limit") ? eng::OrderType::Limit
+                          : eng::OrderType::Unknown;
+            tp.liquidity = (misc_str.find('m') != std::string::npos)
+                ? eng::TradeLiquidity::Maker
+                : eng::TradeLiquidity::Taker;
+
+            if (_keep_metadata) {
+                tp.metadata[MISC_KEY] = misc_str;
+            } else {
+                tp.metadata.clear();
+            }
+            return true;
+        } catch (const nlohmann::json::exception&) {
+            return false;
+        }
+    }
+
+    // What parse_ws() made of a websocket message
+    enum class WsMessage { Trades, Other, Malformed };
+
+    /**
+     * Parse one Kraken websocket v2 message in place:
+     *
+     *   {"channel":"trade","type":"update","data":[{"symbol":"BTC/USD","side":"buy",
+     *    "price":43500.5,"qty":0.123,"ord_type":"market","trade_id":1,
+     *    "timestamp":"2024-01-01T12:00:00.123456Z"}, ...]}
+     *
+     * Each trade is parsed into tp (reusing its storage) and handed to
+     * on_trade(tp) before the next one is read. Pairs lose their slash
+     * ("BTC/USD" -> "BTCUSD"), matching the file feed's naming. Other channels
+     * (heartbeat, status, acks) are skipped without allocating and reported
+     * as Other; Kraken sends "channel" before "data", so a message that
+     * doesn't is Other too.
+     */
+    template <typename F>
+    WsMessage parse_ws(std::string_view msg, eng::TradePrint& tp, F&& on_trade) {
+        const char* p = msg.data();
+        const char* end = p + msg.size();
+        bool trade_channel = false;
+        bool saw_data = false;
+
+        p = skip_ws(p, end);
+        if (p == end || *p != '{') return WsMessage::Malformed;
+        ++p;
+
+        while (true) {
+            p = skip_ws(p, end);
+            if (p == end) return WsMessage::Malformed;
+            if (*p == '}') break;
+
+            std::string_view key;
+            if (!parse_string(p, end, key)) return WsMessage::Malformed;
+            p = skip_ws(p, end);
+            if (p == end || *p != ':') return WsMessage::Malformed;
+            p = skip_ws(p + 1, end);
+
+            if (key == "channel") {
+                std::string_view channel;
+                if (!parse_string(p, end, channel)) return WsMessage::Malformed;
+                trade_channel = channel == "trade";
+            } else if (key == "data" && trade_channel) {
+                if (!parse_ws_trades(p, end, tp, on_trade)) return WsMessage::Malformed;
+                saw_data = true;
+            } else if (!skip_value(p, end)) {
+                return WsMessage::Malformed;
+            }
+
+            p = skip_ws(p, end);
+            if (p == end) return WsMessage::Malformed;
+            if (*p == ',') { ++p; continue; }
+            if (*p == '}') break;
+            return WsMessage::Malformed;
+        }
+        return saw_data ? WsMessage::Trades : WsMessage::Other;
+    }
+
+    /**
+     * Register/lookup the instrument for a Kraken pair.
+     */
+    eng::InstrumentId resolve_instrument(const std::string& pair) {
+        eng::InstrumentId id = _registry->lookup_id(pair);
+        if (id == 0) {
+            // Register new instrument as Crypto from Kraken exchange
+            id = _registry->register_instrument(pair, eng::AssetClass::Crypto, "KRAKEN", "USD");
+        }
+        return id;
+    }
+
+private:
+    enum class Field { Pair, Price, Volume, Time, Side, OrderType, Misc, Other };
+    static constexpr unsigned ALL_FIELDS = (1u << 7) - 1;
+    static constexpr const char* MISC_KEY = "kraken_misc";
+
+    std::shared_ptr<eng::InstrumentRegistry> _registry;
+    bool _keep_metadata;
+    std::string _last_pair;
+    eng::InstrumentId _last_id{0};
+    std::string _last_ws_symbol;   // Live feed's spelling of _last_pair ("BTC/USD")
+
+    static Field field_of(std::string_view key) {
+        if (key == "pair") return Field::Pair;
+        if (key == "price") return Field::Price;
+        if (key == "volume") return Field::Volume;
+        if (key == "time") return Field::Time;
+        if (key == "side") return Field::Side;
+        if (key == "ordertype") return Field::OrderType;
+        if (key == "misc") return Field::Misc;
+        return Field::Other;
+    }
+
+    static const char* skip_ws(const char* p, const char* end) {
+        while (p != end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+        return p;
+    }
+
+    // Unescaped string only; escapes fall back to the full JSON parser
+    static bool parse_string(const char*& p, const char* end, std::string_view& out) {
+        if (p == end || *p != '"') return false;
+        const char* start = ++p;
+        while (p != end && *p != '"') {
+            if (*p == '\\') return false;
+            ++p;
+        }
+        if (p == end) return false;
+        out = std::string_view(start, static_cast<size_t>(p - start));
+        ++p;
+        return true;
+    }
+
+    static bool parse_double(const char*& p, const char* end, double& out) {
+        auto res = std::from_chars(p, end, out);
+        if (res.ec != std::errc()) return false;
+        p = res.ptr;
+        return true;
+    }
+
+    /**
+     * Parse "seconds.fraction" straight into integer nanoseconds so no
+     * precision is lost to a double round-trip. Exponent or negative forms
+     * go through from_chars<double>.
+     */
+    static bool parse_time(const char*& p, const char* end, std::int64_t& ns) {
+        const char* q = p;
+        std::int64_t secs = 0;
+        int digits = 0;
+        while (q != end && *q >= '0' && *q <= '9') {
+            secs = secs * 10 + (*q - '0');
+            ++q; ++digits;
+        }
+        if (digits == 0 || digits > 12) return parse_time_slow(p, end, ns);
+
+        std::int64_t frac = 0;
+        int frac_digits = 0;
+        if (q != end && *q == '.') {
+            ++q;
+            while (q != end && *q >= '0' && *q <= '9') {
+                if (frac_digits < 9) { frac = frac * 10 + (*q - '0'); ++frac_digits; }
+                ++q;
+            }
+        }
+        if (q != end && (*q == 'e' || *q == 'E')) return parse_time_slow(p, end, ns);
+
+        for (int i = frac_digits; i < 9; ++i) frac *= 10;
+        ns = secs * 1'000'000'000LL + frac;
+        p = q;
+        return true;
+    }
+
+    static bool parse_time_slow(const char*& p, const char* end, std::int64_t& ns) {
+        double unix_timestamp = 0.0;
+        if (!parse_double(p, end, unix_timestamp)) return false;
+        ns = static_cast<std::int64_t>(unix_timestamp * 1e9);
+        return true;
+    }
+
+    // "data":[{...},...] of a trade message; on_trade(tp) per entry
+    template <typename F>
+    bool parse_ws_trades(const char*& p, const char* end, eng::TradePrint& tp, F& on_trade) {
+        if (p == end || *p != '[') return false;
+        ++p;
+        while (true) {
+            p = skip_ws(p, end);
+            if (p == end) return false;
+            if (*p == ']') { ++p; return true; }
+            if (!parse_ws_trade(p, end, tp)) return false;
+            on_trade(static_cast<const eng::TradePrint&>(tp));
+            p = skip_ws(p, end);
+            if (p == end) return false;
+            if (*p == ',') { ++p; continue; }
+            if (*p == ']') { ++p; return true; }
+            return false;
+        }
+    }
+
+    // One trade object of the v2 trade channel
+    bool parse_ws_trade(const char*& p, const char* end, eng::TradePrint& tp) {
+        std::string_view symbol, side, ordertype, timestamp;
+        double price = 0.0, qty = 0.0;
+        unsigned seen = 0;
+
+        if (p == end || *p != '{') return false;
+        ++p;
+        while (true) {
+            p = skip_ws(p, end);
+            if (p == end) return false;
+            if (*p == '}') { ++p; break; }
+
+            std::string_view key;
+            if (!parse_string(p, end, key)) return false;
+            p = skip_ws(p, end);
+            if (p == end || *p != ':') return false;
+            p = skip_ws(p + 1, end);
+
+            if (key == "symbol") {
+                if (!parse_string(p, end, symbol)) return false;
+                seen |= 1u << 0;
+            } else if (key == "price") {
+                if (!parse_double(p, end, price)) return false;
+                seen |= 1u << 1;
+            } else if (key == "qty") {
+                if (!parse_double(p, end, qty)) return false;
+                seen |= 1u << 2;
+            } else if (key == "timestamp") {
+                if (!parse_string(p, end, timestamp)) return false;
+                seen |= 1u << 3;
+            } else if (key == "side") {
+                if (!parse_string(p, end, side)) return false;
+                seen |= 1u << 4;
+            } else if (key == "ord_type") {
+                if (!parse_string(p, end, ordertype)) return false;
+            } else if (!skip_value(p, end)) {
+                return false;
+            }
+
+            p = skip_ws(p, end);
+            if (p == end) return false;
+            if (*p == ',') { ++p; continue; }
+            if (*p == '}') { ++p; break; }
+            return false;
+        }
+        std::int64_t ts_ns = 0;
+        if (seen != WS_FIELDS || !parse_rfc3339(timestamp, ts_ns)) return false;
+
+        if (symbol != _last_ws_symbol || _last_id == 0) {
+            _last_ws_symbol.assign(symbol.data(), symbol.size());
+            _last_pair.clear();
+            for (char c : symbol) {
+                if (c != '/') _last_pair.push_back(c);
+            }
+            _last_id = resolve_instrument(_last_pair);
+        }
+        if (tp.symbol != _last_pair) {
+            tp.symbol.assign(_last_pair);
+        }
+        tp.instrument_id = _last_id;
+
+        tp.price = price;
+        tp.qty = qty;
+        tp.ts = eng::TimePoint(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(ts_ns)));
+        tp.side = (side == "buy") ? eng::TradeSide::Buy
+                : (side == "sell") ? eng::TradeSide::Sell
+                : eng::TradeSide::Unknown;
+        tp.order_type = (ordertype == "market") ? eng::OrderType::Market
+                      : (ordertype == "limit") ? eng::OrderType::Limit
+                      : eng::OrderType::Unknown;
+        // The feed reports the taker's side; there is no maker/taker flag
+        tp.liquidity = eng::TradeLiquidity::Taker;
+        if (!tp.metadata.empty()) tp.metadata.clear();
+        return true;
+    }
+
+    static constexpr unsigned WS_FIELDS = (1u << 5) - 1;
+
+    // "2024-01-01T12:00:00.123456Z" (UTC only) -> ns since the epoch
+    static bool parse_rfc3339(std::string_view s, std::int64_t& ns) {
+        if (s.size() < 20 || s[4] != '-' || s[7] != '-' || (s[10] != 'T' && s[10] != 't') ||
+            s[13] != ':' || s[16] != ':') {
+            return false;
+        }
+        auto digits = [&s](size_t pos, size_t len, int& out) {
+            out = 0;
+            for (size_t i = pos; i < pos + len; ++i) {
+                if (s[i] < '0' || s[i] > '9') return false;
+                out = out * 10 + (s[i] - '0');
+            }
+            return true;
+        };
+        int year, month, day, hour, minute, second;
+        if (!digits(0, 4, year) || !digits(5, 2, month) || !digits(8, 2, day) ||
+            !digits(11, 2, hour) || !digits(14, 2, minute) || !digits(17, 2, second)) {
+            return false;
+        }
+        if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+
+        size_t i = 19;
+        std::int64_t frac = 0;
+        int frac_digits = 0;
+        if (s[i] == '.') {
+            ++i;
+            while (i < s.size() && s[i] >= '0' && s[i] <= '9') {
+                if (frac_digits < 9) { frac = frac * 10 + (s[i] - '0'); ++frac_digits; }
+                ++i;
+            }
+        }
+        if (i + 1 != s.size() || (s[i] != 'Z' && s[i] != 'z')) return false;
+        for (int k = frac_digits; k < 9; ++k) frac *= 10;
+
+        const std::int64_t days = days_from_civil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+        ns = (days * 86400 + hour * 3600 + minute * 60 + second) * 1'000'000'000LL + frac;
+        return true;
+    }
+
+    // Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant's algorithm)
+    static std::int64_t days_from_civil(int y, unsigned m, unsigned d) {
+        y -= m <= 2;
+        const int era = (y >= 0 ? y : y - 399) / 400;
+        const unsigned yoe = static_cast<unsigned>(y - era * 400);
+        const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return static_cast<std::int64_t>(era) * 146097 + static_cast<std::int64_t>(doe) - 719468;
+    }
+
+    // Skip any value, nested objects/arrays and escaped strings included
+    static bool skip_value(const char*& p, const char* end) {
+        if (p == end) return false;
+        if (*p != '{' && *p != '[') return skip_scalar_or_escaped(p, end);
+        int depth = 0;
+        while (p != end) {
+            const char c = *p;
+            if (c == '"') {
+                if (!skip_string(p, end)) return false;
+                continue;
+            }
+            ++p;
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) return true;
+            }
+        }
+        return false;
+    }
+
+    static bool skip_scalar_or_escaped(const char*& p, const char* end) {
+        if (*p == '"') return skip_string(p, end);
+        return skip_scalar(p, end);
+    }
+
+    // A string, escapes allowed
+    static bool skip_string(const char*& p, const char* end) {
+        ++p;
+        while (p != end && *p != '"') {
+            if (*p == '\\' && ++p == end) return false;
+            ++p;
+        }
+        if (p == end) return false;
+        ++p;
+        return true;
+    }
+
+    // Skip an unknown scalar value (string, number, true/false/null)
+    static bool skip_scalar(const char*& p, const char* end) {
+        if (p == end) return false;
+        if (*p == '"') {
+            std::string_view ignored;
+            return parse_string(p, end, ignored);
+        }
+        if (*p == '{' || *p == '[') return false;
+        while (p != end && *p != ',' && *p != '}' && *p != ' ') ++p;
+        return true;
+    }
+};
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include "adapters/KrakenTradeParser.hpp"
+#include "engine/BoundedQueue.hpp"
+#include "engine/IMarketData.hpp"
+#include "engine/InstrumentRegistry.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace adapter {
+
+/**
+ * KrakenWsAdapter
+ *
+ * Live trades from Kraken's websocket v2 "trade" channel.
+ *
+ * An ingest thread owns the WebSocketClient: it parses each frame in place
+ * from the receive buffer with KrakenTradeParser::parse_ws() (no JSON DOM,
+ * nothing allocated per trade) and pushes the TradePrints onto a lock-free
+ * BoundedQueue. A dispatch thread pops them and calls the subscribers, so
+ * a slow handler never stops the socket from being read. The queue blocks
+ * the ingest thread when full (lossless); the kernel's socket buffer takes
+ * up the slack.
+ *
+ * The connection is watched for silence (Kraken heartbeats every second):
+ * on a close, an error or a stale feed the ingest thread reconnects with
+ * capped exponential backoff and subscribes again, without restarting
+ * either thread. Subscriptions ask for no snapshot, so a reconnect doesn't
+ * replay trades already delivered; trades during the outage are lost.
+ *
+ * Pairs are subscribed by Kraken's name ("BTC/USD") and delivered without
+ * the slash ("BTCUSD"). Subscribe handlers with that name, before start().
+ * Each trade's wire-to-handler time is recorded under the Feed metric.
+ */
+class KrakenWsAdapter : public eng::IMarketData {
+public:
+    struct Options {
+        std::string url{"wss://ws.kraken.com/v2"};
+        std::vector<std::string> pairs;          // Kraken names, e.g. "BTC/USD"
+        std::size_t queue_capacity{1 << 14};     // Trades between the ingest and dispatch threads
+        int connect_timeout_ms{10000};
+        int stale_after_ms{10000};               // No frame for this long: reconnect
+        int max_backoff_ms{30000};
+        bool busy_poll{false};                   // Dispatcher spins instead of parking (a core of its own)
+    };
+
+    struct Stats {
+        uint64_t frames{0};
+        uint64_t trades{0};
+        uint64_t malformed{0};                   // Frames parse_ws() couldn't read
+        uint64_t connects{0};
+        uint64_t reconnects{0};
+    };
+
+    KrakenWsAdapter(Options opts, std::shared_ptr<eng::InstrumentRegistry> registry);
+    ~KrakenWsAdapter() override { stop(); }
+
+    // Handlers for trades on the listed symbols ("BTCUSD")
+    void subscribe_trades(const std::vector<std::string>& symbols,
+                          std::function<void(const eng::TradePrint&)> on_trade) override;
+
+    // Ticks derived from trades, for consumers that want only the price
+    void subscribe_ticks(const std::vector<std::string>& symbols,
+                         std::function<void(const eng::Tick&)> on_tick) override;
+
+    void subscribe_quotes(const std::vector<std::string>&,
+                          std::function<void(const eng::Quote&)>) override {}
+
+    // Spawn the ingest and dispatch threads; returns immediately
+    void start() override;
+    void start(int /*seconds*/) override { start(); }
+
+    // Close the connection, deliver what's queued, join both threads
+    void stop() override;
+
+    Stats stats() const;
+
+    std::shared_ptr<eng::InstrumentRegistry> get_registry() const override { return registry_; }
+
+private:
+    struct Item {
+        eng::TradePrint tp;
+        int64_t recv_ns{0};                      // Steady-clock ns the frame was read
+    };
+
+    struct Handlers {
+        std::vector<std::function<void(const eng::TradePrint&)>> trades;
+        std::vector<std::function<void(const eng::Tick&)>> ticks;
+    };
+
+    static constexpr int SPIN_BEFORE_SLEEP = 256;
+
+    Options opts_;
+    std::shared_ptr<eng::InstrumentRegistry> registry_;
+    KrakenTradeParser parser_;                   // Ingest thread only
+    eng::TradePrint scratch_;                    // Ingest thread: parse target, reused
+    Item pending_;                               // Ingest thread: staged for the queue
+    eng::Tick tick_;                             // Dispatch thread, reused
+    eng::InstrumentId cached_id_{0};             // Dispatch thread: last symbol's handlers
+    const Handlers* cached_{nullptr};
+    eng::BoundedQueue<Item> queue_;
+    std::unordered_map<std::string, Handlers> handlers_;   // Fixed once started
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> ingest_done_{false};
+    std::thread ingest_;
+    std::thread dispatch_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;            // Parks the dispatcher; also cuts backoff sleeps short
+    std::atomic<bool> sleeping_{false};
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> trades_{0};
+    std::atomic<uint64_t> malformed_{0};
+    std::atomic<uint64_t> connects_{0};
+    std::atomic<uint64_t> reconnects_{0};
+
+    void run_ingest();
+    void run_dispatch();
+    void on_frame(std::string_view payload);
+    void enqueue(const eng::TradePrint& tp, int64_t recv_ns);
+    void deliver(const Item& item);
+    std::string subscribe_message() const;
+    // Sleep up to ms, or until stop(); false if stopped
+    bool backoff(int ms);
+};
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include "GzipLineReader.hpp"
+#include "KrakenTradeParser.hpp"
+#include "TradeArchive.hpp"
+
+namespace adapter {
+
+/**
+ * Load every trade price for one symbol from a recorded day into a single
+ * contiguous column, in replay order.
+ *
+ * This is the same trade sequence the engine's Tick stream sees for that
+ * symbol, but without the bus: in-process sweeps read a day once and then
+ * run any number of strategy configurations over the flat array.
+ *
+ * Accepts a binary trade archive (.trades) or a Kraken JSONL.GZ day.
+ */
+inline std::vector<double> load_price_column(const std::string& path, const std::string& symbol) {
+    std::vector<double> prices;
+
+    const std::string archive_ext = ".trades";
+    bool is_archive = path.size() > archive_ext.size() &&
+        path.compare(path.size() - archive_ext.size(), archive_ext.size(), archive_ext) == 0;
+
+    if (is_archive) {
+        TradeArchiveView archive(path);
+
+        std::uint32_t wanted = 0;
+        for (std::uint32_t local = 1; local <= archive.symbol_count(); ++local) {
+            if (archive.symbol(local) == symbol) { wanted = local; break; }
+        }
+        if (wanted == 0) return prices;
+
+        const TradeRecord* rec = archive.records();
+        size_t n = archive.size();
+        prices.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            if (rec[i].instrument == wanted) prices.push_back(rec[i].price);
+        }
+        return prices;
+    }
+
+    auto registry = std::make_shared<eng::InstrumentRegistry>();
+    KrakenTradeParser parser(registry, false);
+    GzipLineReader reader(path, GzipLineReader::PREFETCH_CHUNK_SIZE,
+                          GzipLineReader::Inflate::Background);
+    std::string_view line;
+    eng::TradePrint tp;
+    while (reader.next_line(line)) {
+        // Same fast-path/fallback split as KrakenFileReplayAdapter::replay()
+        if ((parser.parse(line, tp) || parser.parse_json(line, tp)) && tp.symbol == symbol) {
+            prices.push_back(tp.price);
+        }
+    }
+    return prices;
+}
+
+}  // namespace adapter
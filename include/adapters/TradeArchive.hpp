@@ -0,0 +1,276 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../engine/MarketDataTypes.hpp"
+
+namespace adapter {
+
+/**
+ * Trade archive: compact fixed-record binary trade format.
+ *
+ * Converted once from the cached Kraken JSONL.GZ days (see
+ * trade_archive_convert) so repeated backtests over the same files skip
+ * zlib and JSON entirely and just stream records out of an mmap.
+ *
+ * File layout (little-endian, native struct layout):
+ *
+ *   [TradeArchiveHeader]                64 bytes
+ *   [TradeRecord x record_count]        32 bytes each, starting at offset 64
+ *   [symbol table x symbol_count]       u32 local id, u16 length, bytes
+ *
+ * Instrument ids inside the file are file-local (1..symbol_count); readers
+ * map them onto their own InstrumentRegistry through the symbol table.
+ */
+
+constexpr char TRADE_ARCHIVE_MAGIC[8] = {'E', 'N', 'G', 'T', 'R', 'D', 'S', '\0'};
+constexpr std::uint32_t TRADE_ARCHIVE_VERSION = 1;
+
+struct TradeArchiveHeader {
+    char          magic[8];
+    std::uint32_t version{TRADE_ARCHIVE_VERSION};
+    std::uint32_t record_size{0};
+    std::uint64_t record_count{0};
+    std::uint64_t symbol_table_offset{0};
+    std::uint32_t symbol_count{0};
+    std::uint32_t reserved0{0};
+    std::int64_t  first_ts_ns{0};
+    std::int64_t  last_ts_ns{0};
+    std::uint64_t reserved1{0};
+};
+static_assert(sizeof(TradeArchiveHeader) == 64, "TradeArchiveHeader must be 64 bytes");
+
+struct TradeRecord {
+    std::int64_t  ts_ns{0};          // Unix epoch, nanoseconds
+    double        price{0.0};
+    double        qty{0.0};
+    std::uint32_t instrument{0};     // File-local instrument id
+    std::uint8_t  flags{0};          // Packed side/ordertype/liquidity, see pack_flags()
+    std::uint8_t  pad[3]{0, 0, 0};
+};
+static_assert(sizeof(TradeRecord) == 32, "TradeRecord must be 32 bytes");
+
+// Flag layout: bits 0-1 side, bits 2-3 order type, bits 4-5 liquidity.
+// Each field stores the underlying enum value.
+inline std::uint8_t pack_flags(eng::TradeSide side, eng::OrderType type, eng::TradeLiquidity liq) {
+    return static_cast<std::uint8_t>(
+        (static_cast<unsigned>(side) & 0x3u) |
+        ((static_cast<unsigned>(type) & 0x3u) << 2) |
+        ((static_cast<unsigned>(liq) & 0x3u) << 4));
+}
+
+inline eng::TradeSide flags_side(std::uint8_t f) { return static_cast<eng::TradeSide>(f & 0x3u); }
+inline eng::OrderType flags_order_type(std::uint8_t f) { return static_cast<eng::OrderType>((f >> 2) & 0x3u); }
+inline eng::TradeLiquidity flags_liquidity(std::uint8_t f) { return static_cast<eng::TradeLiquidity>((f >> 4) & 0x3u); }
+
+inline std::int64_t to_epoch_ns(eng::TimePoint tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+/**
+ * TradeArchiveWriter
+ *
+ * Appends TradePrints to a new archive file. The header is rewritten with
+ * the final counts and the symbol table is appended on close().
+ */
+class TradeArchiveWriter {
+public:
+    explicit TradeArchiveWriter(const std::string& filepath) : _filepath(filepath) {
+        _file = std::fopen(filepath.c_str(), "wb");
+        if (!_file) {
+            throw std::runtime_error("Cannot create trade archive: " + filepath);
+        }
+        // Placeholder header; finalized in close()
+        TradeArchiveHeader header{};
+        write_raw(&header, sizeof(header));
+        std::setvbuf(_file, nullptr, _IOFBF, 1 << 20);
+    }
+
+    ~TradeArchiveWriter() {
+        try { close(); } catch (...) {}
+    }
+
+    TradeArchiveWriter(const TradeArchiveWriter&) = delete;
+    TradeArchiveWriter& operator=(const TradeArchiveWriter&) = delete;
+
+    /**
+     * Append one trade. Symbols get file-local ids in order of first appearance.
+     */
+    void append(const eng::TradePrint& tp) {
+        TradeRecord rec;
+        rec.ts_ns = to_epoch_ns(tp.ts);
+        rec.price = tp.price;
+        rec.qty = tp.qty;
+        rec.instrument = local_id(tp.symbol);
+        rec.flags = pack_flags(tp.side, tp.order_type, tp.liquidity);
+        write_raw(&rec, sizeof(rec));
+
+        if (_count == 0) _first_ts = rec.ts_ns;
+        _last_ts = rec.ts_ns;
+        ++_count;
+    }
+
+    /**
+     * Write the symbol table and final header. Idempotent.
+     */
+    void close() {
+        if (!_file) return;
+
+        TradeArchiveHeader header{};
+        std::memcpy(header.magic, TRADE_ARCHIVE_MAGIC, sizeof(header.magic));
+        header.record_size = sizeof(TradeRecord);
+        header.record_count = _count;
+        header.symbol_table_offset = sizeof(TradeArchiveHeader) + _count * sizeof(TradeRecord);
+        header.symbol_count = static_cast<std::uint32_t>(_symbols.size());
+        header.first_ts_ns = _first_ts;
+        header.last_ts_ns = _last_ts;
+
+        for (std::uint32_t i = 0; i < _symbols.size(); ++i) {
+            std::uint32_t id = i + 1;
+            std::uint16_t len = static_cast<std::uint16_t>(_symbols[i].size());
+            write_raw(&id, sizeof(id));
+            write_raw(&len, sizeof(len));
+            write_raw(_symbols[i].data(), len);
+        }
+
+        if (std::fseek(_file, 0, SEEK_SET) != 0) {
+            std::fclose(_file);
+            _file = nullptr;
+            throw std::runtime_error("Failed to finalize trade archive: " + _filepath);
+        }
+        write_raw(&header, sizeof(header));
+        std::fclose(_file);
+        _file = nullptr;
+    }
+
+    std::uint64_t record_count() const { return _count; }
+
+private:
+    std::string _filepath;
+    std::FILE* _file{nullptr};
+    std::uint64_t _count{0};
+    std::int64_t _first_ts{0};
+    std::int64_t _last_ts{0};
+    std::vector<std::string> _symbols;   // index = local id - 1
+    std::string _last_symbol;
+    std::uint32_t _last_local_id{0};
+
+    std::uint32_t local_id(const std::string& symbol) {
+        if (_last_local_id != 0 && symbol == _last_symbol) return _last_local_id;
+        std::uint32_t id = 0;
+        for (std::uint32_t i = 0; i < _symbols.size(); ++i) {
+            if (_symbols[i] == symbol) { id = i + 1; break; }
+        }
+        if (id == 0) {
+            _symbols.push_back(symbol);
+            id = static_cast<std::uint32_t>(_symbols.size());
+        }
+        _last_symbol = symbol;
+        _last_local_id = id;
+        return id;
+    }
+
+    void write_raw(const void* data, size_t len) {
+        if (len > 0 && std::fwrite(data, 1, len, _file) != len) {
+            throw std::runtime_error("Failed to write trade archive: " + _filepath);
+        }
+    }
+};
+
+/**
+ * TradeArchiveView
+ *
+ * Read-only mmap of an archive file. Records are accessed in place.
+ */
+class TradeArchiveView {
+public:
+    explicit TradeArchiveView(const std::string& filepath) {
+        int fd = ::open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open trade archive: " + filepath);
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TradeArchiveHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Trade archive too small: " + filepath);
+        }
+        _size = static_cast<size_t>(st.st_size);
+        void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            throw std::runtime_error("Cannot mmap trade archive: " + filepath);
+        }
+        _base = static_cast<const char*>(addr);
+        ::madvise(addr, _size, MADV_SEQUENTIAL);
+
+        std::memcpy(&_header, _base, sizeof(_header));
+        if (std::memcmp(_header.magic, TRADE_ARCHIVE_MAGIC, sizeof(_header.magic)) != 0 ||
+            _header.version != TRADE_ARCHIVE_VERSION ||
+            _header.record_size != sizeof(TradeRecord) ||
+            _header.symbol_table_offset != sizeof(TradeArchiveHeader) + _header.record_count * sizeof(TradeRecord) ||
+            _header.symbol_table_offset > _size) {
+            unmap();
+            throw std::runtime_error("Not a valid trade archive: " + filepath);
+        }
+
+        // Symbol table: local id -> symbol
+        _symbols.resize(_header.symbol_count + 1);
+        size_t off = _header.symbol_table_offset;
+        for (std::uint32_t i = 0; i < _header.symbol_count; ++i) {
+            std::uint32_t id = 0;
+            std::uint16_t len = 0;
+            if (off + sizeof(id) + sizeof(len) > _size) break;
+            std::memcpy(&id, _base + off, sizeof(id)); off += sizeof(id);
+            std::memcpy(&len, _base + off, sizeof(len)); off += sizeof(len);
+            if (off + len > _size || id == 0 || id > _header.symbol_count) {
+                unmap();
+                throw std::runtime_error("Corrupt trade archive symbol table: " + filepath);
+            }
+            _symbols[id].assign(_base + off, len);
+            off += len;
+        }
+    }
+
+    ~TradeArchiveView() { unmap(); }
+
+    TradeArchiveView(const TradeArchiveView&) = delete;
+    TradeArchiveView& operator=(const TradeArchiveView&) = delete;
+
+    const TradeArchiveHeader& header() const { return _header; }
+    size_t size() const { return static_cast<size_t>(_header.record_count); }
+
+    const TradeRecord* records() const {
+        return reinterpret_cast<const TradeRecord*>(_base + sizeof(TradeArchiveHeader));
+    }
+
+    // Symbol for a file-local instrument id ("" if unknown)
+    const std::string& symbol(std::uint32_t local_id) const {
+        static const std::string empty;
+        return local_id < _symbols.size() ? _symbols[local_id] : empty;
+    }
+
+    std::uint32_t symbol_count() const { return _header.symbol_count; }
+
+private:
+    const char* _base{nullptr};
+    size_t _size{0};
+    TradeArchiveHeader _header{};
+    std::vector<std::string> _symbols;   // index = local id
+
+    void unmap() {
+        if (_base) {
+            ::munmap(const_cast<char*>(_base), _size);
+            _base = nullptr;
+        }
+    }
+};
+
+}
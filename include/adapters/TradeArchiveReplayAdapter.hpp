@@ -0,0 +1,160 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include "TradeArchive.hpp"
+#include "../engine/IMarketData.hpp"
+#include "../engine/InstrumentRegistry.hpp"
+#include "../engine/ReplayClock.hpp"
+
+namespace adapter {
+
+/**
+ * TradeArchiveReplayAdapter
+ *
+ * Replays trades from a binary trade archive (see TradeArchive.hpp) produced
+ * by trade_archive_convert. The file is mmap'd and records are turned into
+ * TradePrints in place -- no decompression, no parsing -- so repeated
+ * backtests over the same day are bound by memory bandwidth.
+ *
+ * Emits the same TradePrint stream as KrakenFileReplayAdapter for the file
+ * it was converted from, and exposes the same replay() entry point.
+ */
+class TradeArchiveReplayAdapter : public eng::IMarketData {
+public:
+    /**
+     * Create adapter with reference to shared InstrumentRegistry.
+     * The registry's lifetime must exceed this adapter's.
+     */
+    explicit TradeArchiveReplayAdapter(std::shared_ptr<eng::InstrumentRegistry> registry)
+        : _registry(std::move(registry)), _is_running(false) {}
+
+    ~TradeArchiveReplayAdapter() override {
+        stop();
+    }
+
+    // ---- Lifecycle ----
+
+    void start() override { _is_running = true; }
+    void stop() override { _is_running = false; }
+
+    // ---- Subscription ----
+
+    void subscribe_ticks(const std::vector<std::string>&,
+                         std::function<void(const eng::Tick&)>) override {
+        // Not used in file replay
+    }
+
+    void subscribe_quotes(const std::vector<std::string>&,
+                          std::function<void(const eng::Quote&)>) override {
+        // Archives only carry trades
+    }
+
+    void subscribe_trades(const std::vector<std::string>& symbols,
+                          std::function<void(const eng::TradePrint&)> callback) override {
+        for (const auto& symbol : symbols) {
+            _trade_callbacks[symbol] = callback;
+        }
+    }
+
+    std::shared_ptr<eng::InstrumentRegistry> get_registry() const override {
+        return _registry;
+    }
+
+    // ---- Backtest API ----
+
+    /**
+     * Replay trades from a trade archive file.
+     *
+     * @param filepath Path to a .trades archive
+     * @param pace Replay speed by trade timestamp: 1.0 = real-time, 10.0 = 10x,
+     *             0.0 (or negative) = unthrottled (see eng::ReplayClock)
+     * @param on_trade Optional callback for each replayed trade
+     * @param skip Trades to pass over first (not paced, stored or emitted),
+     *             to resume at a checkpoint's position
+     * @return Number of trades replayed, skipped ones included
+     */
+    size_t replay(
+        const std::string& filepath,
+        double pace = 1.0,
+        std::function<void(const eng::TradePrint&)> on_trade = nullptr,
+        size_t skip = 0
+    ) {
+        if (!_is_running) {
+            throw std::runtime_error("Adapter not started; call start() first");
+        }
+
+        TradeArchiveView archive(filepath);
+
+        // Map file-local ids onto the shared registry, and resolve each
+        // instrument's callback once instead of per trade.
+        std::vector<eng::InstrumentId> ids(archive.symbol_count() + 1, 0);
+        std::vector<const std::function<void(const eng::TradePrint&)>*> callbacks(ids.size(), nullptr);
+        for (std::uint32_t local = 1; local <= archive.symbol_count(); ++local) {
+            const std::string& sym = archive.symbol(local);
+            if (sym.empty()) continue;
+            ids[local] = _registry->register_instrument(sym, eng::AssetClass::Crypto, "KRAKEN", "USD");
+            auto it = _trade_callbacks.find(sym);
+            if (it != _trade_callbacks.end()) callbacks[local] = &it->second;
+        }
+
+        const TradeRecord* rec = archive.records();
+        const size_t n = archive.size();
+        eng::TradePrint tp;  // Reused; symbol only reassigned when the instrument changes
+        std::uint32_t last_local = 0;
+        size_t trade_count = 0;
+        eng::ReplayClock clock(pace);
+
+        for (size_t i = 0; i < n && _is_running; ++i, ++rec) {
+            std::uint32_t local = rec->instrument;
+            if (local == 0 || local >= ids.size()) continue;  // Skip corrupt records
+            if (trade_count < skip) {
+                ++trade_count;
+                continue;
+            }
+
+            if (local != last_local) {
+                tp.symbol = archive.symbol(local);
+                tp.instrument_id = ids[local];
+                last_local = local;
+            }
+            tp.price = rec->price;
+            tp.qty = rec->qty;
+            tp.ts = eng::TimePoint(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(rec->ts_ns)));
+            tp.side = flags_side(rec->flags);
+            tp.order_type = flags_order_type(rec->flags);
+            tp.liquidity = flags_liquidity(rec->flags);
+
+            // Hold the trade until its timestamp is due (no-op when unthrottled)
+            if (!clock.wait_until(tp.ts, _is_running)) break;
+
+            if (tick_store_) tick_store_->append(tp);
+            if (auto* cb = callbacks[local]) {
+                (*cb)(tp);
+            }
+            if (on_trade) {
+                on_trade(tp);
+            }
+            ++trade_count;
+        }
+
+        _last_clock_stats = clock.stats();
+        return trade_count;
+    }
+
+    // Pacing stats from the last replay() (all zero when unthrottled)
+    const eng::ReplayClock::Stats& last_replay_clock_stats() const {
+        return _last_clock_stats;
+    }
+
+private:
+    std::shared_ptr<eng::InstrumentRegistry> _registry;
+    std::atomic<bool> _is_running;
+    eng::ReplayClock::Stats _last_clock_stats;
+    std::unordered_map<std::string, std::function<void(const eng::TradePrint&)>> _trade_callbacks;
+};
+
+}
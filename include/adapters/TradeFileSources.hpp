@@ -0,0 +1,129 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "GzipLineReader.hpp"
+#include "KrakenTradeParser.hpp"
+#include "TradeArchive.hpp"
+#include "../engine/ITradeSource.hpp"
+#include "../engine/InstrumentRegistry.hpp"
+#include "../engine/PrefetchingTradeSource.hpp"
+
+namespace adapter {
+
+/**
+ * KrakenFileTradeSource
+ *
+ * Pull-style reader over a Kraken JSONL.GZ day: the same decode path as
+ * KrakenFileReplayAdapter::replay(), but handing out batches instead of
+ * driving callbacks. Lines neither parser can read are skipped.
+ *
+ * Decompression dominates, so this is normally wrapped in an
+ * eng::PrefetchingTradeSource (see open_trade_source()).
+ */
+class KrakenFileTradeSource : public eng::ITradeSource {
+public:
+    KrakenFileTradeSource(const std::string& filepath,
+                          std::shared_ptr<eng::InstrumentRegistry> registry,
+                          bool keep_metadata = false)
+        : _filepath(filepath), _reader(filepath), _parser(std::move(registry), keep_metadata) {}
+
+    size_t read(eng::TradePrint* out, size_t max_trades) override {
+        size_t n = 0;
+        std::string_view line;
+        while (n < max_trades && _reader.next_line(line)) {
+            try {
+                if (_parser.parse(line, out[n]) || _parser.parse_json(line, out[n])) ++n;
+            } catch (const std::exception&) {
+                // Skip malformed trades
+            }
+        }
+        return n;
+    }
+
+    std::string name() const override { return _filepath; }
+
+private:
+    std::string _filepath;
+    GzipLineReader _reader;
+    KrakenTradeParser _parser;
+};
+
+/**
+ * TradeArchiveTradeSource
+ *
+ * Pull-style reader over a .trades archive. Records are decoded straight
+ * out of the mmap, so there is nothing worth prefetching.
+ */
+class TradeArchiveTradeSource : public eng::ITradeSource {
+public:
+    TradeArchiveTradeSource(const std::string& filepath,
+                            std::shared_ptr<eng::InstrumentRegistry> registry)
+        : _filepath(filepath), _archive(filepath), _ids(_archive.symbol_count() + 1, 0) {
+        for (std::uint32_t local = 1; local <= _archive.symbol_count(); ++local) {
+            const std::string& sym = _archive.symbol(local);
+            if (sym.empty()) continue;
+            _ids[local] = registry->register_instrument(sym, eng::AssetClass::Crypto, "KRAKEN", "USD");
+        }
+    }
+
+    size_t read(eng::TradePrint* out, size_t max_trades) override {
+        const TradeRecord* rec = _archive.records();
+        const size_t total = _archive.size();
+        size_t n = 0;
+        for (; _next < total && n < max_trades; ++_next) {
+            const TradeRecord& r = rec[_next];
+            if (r.instrument == 0 || r.instrument >= _ids.size()) continue;  // Skip corrupt records
+
+            eng::TradePrint& tp = out[n++];
+            if (tp.instrument_id != _ids[r.instrument]) {
+                tp.symbol = _archive.symbol(r.instrument);
+                tp.instrument_id = _ids[r.instrument];
+            }
+            tp.price = r.price;
+            tp.qty = r.qty;
+            tp.ts = eng::TimePoint(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(r.ts_ns)));
+            tp.side = flags_side(r.flags);
+            tp.order_type = flags_order_type(r.flags);
+            tp.liquidity = flags_liquidity(r.flags);
+            tp.metadata.clear();
+        }
+        return n;
+    }
+
+    std::string name() const override { return _filepath; }
+
+private:
+    std::string _filepath;
+    TradeArchiveView _archive;
+    std::vector<eng::InstrumentId> _ids;   // File-local id -> registry id
+    size_t _next{0};
+};
+
+/**
+ * Open a recorded day as a trade source, picking the reader by extension
+ * (.trades archive, otherwise Kraken JSONL.GZ). Gzip days are wrapped in a
+ * PrefetchingTradeSource when `prefetch` is set so inflate runs on its own
+ * thread.
+ */
+inline std::unique_ptr<eng::ITradeSource> open_trade_source(
+    const std::string& path,
+    std::shared_ptr<eng::InstrumentRegistry> registry,
+    bool prefetch = true
+) {
+    const std::string archive_ext = ".trades";
+    bool is_archive = path.size() > archive_ext.size() &&
+        path.compare(path.size() - archive_ext.size(), archive_ext.size(), archive_ext) == 0;
+
+    if (is_archive) {
+        return std::make_unique<TradeArchiveTradeSource>(path, std::move(registry));
+    }
+    auto source = std::make_unique<KrakenFileTradeSource>(path, std::move(registry));
+    if (!prefetch) return source;
+    return std::make_unique<eng::PrefetchingTradeSource>(std::move(source));
+}
+
+}
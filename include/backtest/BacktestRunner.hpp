@@ -0,0 +1,95 @@
+#pragma once
+#include "brokers/FillSimulator.hpp"
+#include "engine/IStrategy.hpp"
+#include "engine/Types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+BacktestRunner:
+  Runs many independent (symbol, day) backtests in one process. Each
+  partition gets its own EventBus (inside its Engine), NullBroker, strategy
+  instance and InstrumentRegistry, and replays its file unthrottled on a
+  worker thread, so partitions share nothing and scale with core count.
+
+  Per-partition results (P&L, drawdown, order counts and optionally the
+  order history) are collected into one vector at the end; summarize()
+  folds them into totals.
+
+  Engines and brokers run quiet: with dozens of engines in one process the
+  per-order stdout logging would serialize them on the stream lock.
+*/
+
+namespace backtest {
+
+struct Partition {
+    std::string symbol;
+    std::string data_file;   // .trades archive or Kraken .jsonl.gz
+    std::string label;       // Free-form tag carried into the result (e.g. the date)
+};
+
+struct PartitionResult {
+    Partition partition;
+    bool ok{false};
+    std::string error;       // Set when ok is false
+
+    size_t trades{0};        // Trades replayed for the partition's symbol
+    double initial_balance{0.0};
+    double final_balance{0.0};
+    double position{0.0};    // Open quantity at the end of the day
+    double last_price{0.0};
+    double equity{0.0};      // final_balance + position marked at last_price
+    double pnl{0.0};         // equity - initial_balance
+    double max_drawdown{0.0};  // Worst peak-to-trough equity move as a fraction (<= 0)
+
+    size_t orders{0};
+    size_t filled{0};
+    size_t rejected{0};
+    std::vector<eng::Order> order_history;   // Only if Config::keep_orders
+
+    double elapsed_s{0.0};
+};
+
+struct Summary {
+    size_t partitions{0};
+    size_t failed{0};
+    size_t trades{0};
+    size_t orders{0};
+    double total_pnl{0.0};
+    double worst_drawdown{0.0};
+};
+
+class BacktestRunner {
+public:
+    // Builds a fresh strategy for one partition (called on worker threads)
+    using StrategyFactory = std::function<std::unique_ptr<eng::IStrategy>(const Partition&)>;
+
+    struct Config {
+        size_t num_threads{0};             // 0 = hardware concurrency
+        double initial_balance{1'000'000.0};
+        bool keep_orders{false};           // Copy each partition's order history into its result
+        bool fill_sim{false};              // Fill limit orders from the tape (NullBroker::enable_fill_simulation)
+        broker::FillSimulator::Config fill_config;
+    };
+
+    explicit BacktestRunner(StrategyFactory factory);
+    BacktestRunner(StrategyFactory factory, Config config);
+
+    // Run every partition; results are in the same order as the input.
+    // A partition that throws is reported with ok = false and doesn't stop the rest.
+    std::vector<PartitionResult> run(const std::vector<Partition>& partitions) const;
+
+    static Summary summarize(const std::vector<PartitionResult>& results);
+
+private:
+    StrategyFactory factory_;
+    Config config_;
+
+    PartitionResult run_partition(const Partition& partition) const;
+};
+
+}  // namespace backtest
@@ -0,0 +1,184 @@
+#pragma once
+#include "engine/InstrumentTable.hpp"
+#include "engine/MarketDataTypes.hpp"
+#include "engine/Types.hpp"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace broker {
+
+/*
+FillSimulator:
+  Resting-order matching against the replayed trade tape. Brokers submit
+  limit orders; every trade (on_trade) then:
+
+    1. activates orders whose entry latency has elapsed. An order that
+       crosses the trade price on arrival takes liquidity immediately at the
+       trade price; otherwise it joins the back of its price level with
+       `queue_ahead` of unknown size in front of it,
+    2. fills every resting order the trade printed through (a trade below a
+       bid or above an ask) in full at the order's limit,
+    3. works the queue at the trade's own price level: trade size first eats
+       the queue ahead of each order, then fills it, FIFO, so large orders
+       fill partially across several trades. Only trades from the opposite
+       aggressor side touch a level (unknown aggressor touches both),
+    4. expires orders past their time in force.
+
+  There is no displayed book in the recordings, so resting orders never
+  interact with each other; the tape is the only counterparty.
+
+  Orders live in a pooled node array recycled through a free list, and each
+  side of a book is a flat array of price levels indexed by tick, holding
+  intrusive FIFO lists. After warm-up a full-day replay does no per-order
+  allocation. Not thread-safe; the owning broker serializes access.
+
+  Each instrument's book has its own tick size (Config::tick_sizes, else
+  Config::tick_size), which should be the venue's price increment: prices
+  closer than a tick share a level. Limits more than max_ticks_from_market
+  ticks from the book's last trade (or, before its first trade, its first
+  order) are refused, so a stray price can't grow the level arrays without
+  bound.
+*/
+class FillSimulator {
+public:
+    using Side = eng::Order::Side;
+
+    struct Config {
+        double tick_size{0.1};                       // Price grid of books not in tick_sizes
+        std::unordered_map<std::string, double> tick_sizes;   // Per-symbol price grid
+        int64_t max_ticks_from_market{1 << 16};      // Band around the market accepted by submit()
+        std::chrono::nanoseconds latency{0};         // Entry latency, in event time
+        double queue_ahead{0.0};                     // Qty assumed ahead of each new order at its level
+        std::chrono::nanoseconds time_in_force{0};   // 0 = good till cancel
+    };
+
+    // One fill or expiry, reported back to the broker
+    struct Execution {
+        uint64_t order_id{0};
+        uint64_t tag{0};           // Caller's cookie from submit()
+        Side side{Side::Buy};
+        double limit_price{0.0};
+        double qty{0.0};           // Filled by this execution (0 for an expiry)
+        double price{0.0};         // Fill price
+        double remaining{0.0};     // Still open afterwards; 0 = order done
+        bool taker{false};         // Crossed on arrival
+        bool expired{false};       // Time in force ran out; `remaining` is released
+        eng::TimePoint ts{};       // Trade time that caused it
+    };
+
+    FillSimulator();
+    explicit FillSimulator(Config config);
+
+    const Config& config() const { return config_; }
+
+    // Whether submit() would take a limit at this price (inside the band)
+    bool accepts(eng::InstrumentId instrument_id, const std::string& symbol, double limit_price);
+
+    // Queue an order; it becomes live at ts + latency. Returns false, and
+    // queues nothing, for a price accepts() refuses.
+    bool submit(uint64_t order_id, uint64_t tag, eng::InstrumentId instrument_id,
+                const std::string& symbol, Side side, double limit_price, double qty,
+                eng::TimePoint ts);
+
+    /**
+     * Run one trade through the book for its instrument.
+     * Executions are appended to `out` (the caller reuses the vector).
+     */
+    void on_trade(eng::InstrumentId instrument_id, const std::string& symbol,
+                  double price, double qty, eng::TradeSide aggressor, eng::TimePoint ts,
+                  std::vector<Execution>& out);
+
+    // Pull an open order (pending or resting). Rare path: scans the pool.
+    bool cancel(uint64_t order_id, Execution* out = nullptr);
+
+    size_t open_orders() const { return live_; }
+
+private:
+    static constexpr int32_t kNil = -1;
+    static constexpr int64_t kNoLevel = std::numeric_limits<int64_t>::min();
+
+    enum class State : uint8_t { Free, Pending, Resting };
+
+    struct Node {
+        uint64_t order_id{0};
+        uint64_t tag{0};
+        double limit{0.0};
+        double remaining{0.0};
+        double ahead{0.0};
+        int64_t tick{0};
+        int64_t active_ns{0};
+        int64_t expire_ns{0};      // 0 = never
+        uint32_t book{0};
+        uint32_t gen{0};           // Bumped on release so stale queue entries can be spotted
+        int32_t prev{kNil};
+        int32_t next{kNil};        // Level FIFO link, or free-list link
+        Side side{Side::Buy};
+        State state{State::Free};
+    };
+
+    struct Level {
+        int32_t head{kNil};
+        int32_t tail{kNil};
+    };
+
+    // One side of a book: levels[tick - base], best = most aggressive live tick
+    struct BookSide {
+        int64_t base{0};
+        std::vector<Level> levels;
+        int64_t best{kNoLevel};
+        size_t orders{0};
+    };
+
+    struct Ref {
+        int64_t ns;
+        int32_t node;
+        uint32_t gen;
+    };
+
+    struct Book {
+        BookSide bids;
+        BookSide asks;
+        std::deque<Ref> pending;   // Submission order == activation order
+        std::deque<Ref> expiries;  // Submission order == expiry order
+        double tick_size{0.1};
+        int64_t market_tick{kNoLevel};   // Last trade, else first order; centre of the band
+    };
+
+    Config config_;
+    std::vector<Node> nodes_;
+    int32_t free_head_{kNil};
+    size_t live_{0};
+    std::vector<Book> books_;
+    eng::InstrumentTable<uint32_t> book_index_;   // 1-based index into books_
+
+    uint32_t book_for(eng::InstrumentId instrument_id, const std::string& symbol);
+    int32_t alloc_node();
+    void release_node(int32_t idx);
+    static int64_t to_tick(const Book& book, double price);
+    bool in_band(const Book& book, double price) const;
+
+    static Level& level_at(BookSide& side, int64_t tick);
+    static void push_back(BookSide& side, std::vector<Node>& nodes, int32_t idx);
+    static void unlink(BookSide& side, std::vector<Node>& nodes, int32_t idx, bool is_bid);
+
+    void activate(Book& book, int64_t trade_tick, double price, int64_t ts_ns,
+                  eng::TimePoint ts, std::vector<Execution>& out);
+    void match_side(BookSide& side, bool is_bid, int64_t trade_tick, double qty,
+                    bool queue_eligible, eng::TimePoint ts, std::vector<Execution>& out);
+    void expire(Book& book, int64_t ts_ns, eng::TimePoint ts, std::vector<Execution>& out);
+    void emit(const Node& node, double qty, double price, bool taker, bool expired,
+              eng::TimePoint ts, std::vector<Execution>& out) const;
+};
+
+/**
+ * Apply a --fill-tick-size flag value to config: "<size>" sets the default
+ * tick size, "<symbol>=<size>" one symbol's. Throws std::invalid_argument.
+ */
+void parse_tick_size_flag(const std::string& value, FillSimulator::Config& config);
+
+}  // namespace broker
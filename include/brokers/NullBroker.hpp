@@ -1,8 +1,14 @@
 #pragma once
+#include "engine/AppendArena.hpp"
+#include "engine/FixedPoint.hpp"
 #include "engine/IBroker.hpp"
+#include "engine/InstrumentTable.hpp"
+#include "brokers/FillSimulator.hpp"
+#include "brokers/OrderJournal.hpp"
+#include <atomic>
 #include <functional>
 #include <iostream>
-#include <mutex>
+#include <memory>
 #include <unordered_map>
 
 namespace eng {
@@ -11,6 +17,14 @@ class EventBus;
 
 namespace broker {
 
+// Threading: orders (place_*, cancel_order, on_market_tick) come from one
+// thread at a time -- the engine's tick path -- and need no lock. Balance,
+// positions and the order history can be read from any thread while that
+// happens (the frontend's query pool does): they are published through
+// atomics and an append-only OrderJournal rather than a broker-wide mutex.
+//
+// Cash and positions are kept as eng::Money / eng::Quantity: exact integer
+// ticks in ENG_FIXED_POINT builds, doubles otherwise (see FixedPoint.hpp).
 class NullBroker : public eng::IBroker {
 public:
     explicit NullBroker(double initial_balance = 1'000'000.0);
@@ -25,13 +39,45 @@ public:
 
     double get_balance() override;
 
-    eng::PriceData get_current_price(const std::string& symbol) override;
+    eng::PriceQuote get_current_price(const std::string& symbol) override;
 
     // Get all current positions (symbol -> quantity)
-    std::unordered_map<std::string, double> get_positions() const;
+    std::unordered_map<std::string, double> get_positions() const override;
 
     // Get all orders (including historical)
-    std::vector<eng::Order> get_orders() const;
+    std::vector<eng::Order> get_orders() const override;
+
+    // Orders with id > after_id, oldest first, at most limit (0 = all)
+    std::vector<eng::Order> get_orders_since(uint64_t after_id, size_t limit = 0) const override;
+
+    const OrderJournal& journal() const { return journal_; }
+
+    // Per-order stdout logging (on by default); batch backtests turn it off
+    void set_verbose(bool verbose) { verbose_ = verbose; }
+
+    // Rest limit orders in a FillSimulator and fill them from the trade tape
+    // (on_market_tick) instead of filling them on the spot at their limit.
+    // Buys reserve cash at their limit; sells close order.qty (capped at the
+    // unreserved position) rather than the whole position. Call before the
+    // first order.
+    void enable_fill_simulation(const FillSimulator::Config& config = FillSimulator::Config{});
+    bool fill_simulation_enabled() const { return sim_ != nullptr; }
+
+    // Cancel an open simulated order; false if it is no longer open
+    bool cancel_order(uint64_t order_id);
+
+    // Simulated orders still pending or resting
+    size_t open_orders() const { return open_orders_.load(std::memory_order_relaxed); }
+
+    // Balance, positions, order history and the next order id. Not
+    // supported with fill simulation (resting orders aren't saved): false.
+    bool save_state(eng::CheckpointWriter& out) const override;
+    // Before the first order; throws std::runtime_error after one
+    void load_state(eng::CheckpointReader& in) override;
+
+    // Set before the first order
+    void set_fill_handler(FillHandler handler) override;
+    void on_market_tick(const eng::Tick& tick) override;
 
     /*
     void subscribe_to_ticks(const std::string& symbol,
@@ -39,17 +85,61 @@ public:
     */
 
 private:
+    struct PositionSlot {
+        std::string symbol;
+        std::atomic<eng::Quantity> qty{eng::Quantity{}};
+    };
+
     eng::EventBus* bus_{nullptr};
-    double balance_;
-    std::unordered_map<std::string, double> positions_;  // track qty held per symbol
-    std::vector<eng::Order> orders_;                      // track all orders (history)
-    mutable std::mutex mutex_;
+    std::atomic<eng::Money> balance_;
+    eng::AppendArena<PositionSlot, 6> positions_{1024};   // Track qty held per instrument
+    eng::InstrumentTable<size_t> position_index_;         // Order thread only; 1-based slot in positions_
+    OrderJournal journal_;                                // Track all orders (history)
     uint64_t next_order_id_{1};
-    
+    bool verbose_{true};
+
+    // Fill simulation (off unless enable_fill_simulation() was called)
+    struct Notice {
+        eng::OrderEvent::Kind kind; // Event published for `order`
+        eng::Order order;           // Order record after the change
+        eng::Order fill;            // This fill only (qty / fill_price), for the fill handler
+        bool is_fill;
+    };
+    std::unique_ptr<FillSimulator> sim_;
+    FillHandler fill_handler_;
+    eng::Money reserved_cash_{};                      // Held for open buys, at their limit
+    eng::InstrumentTable<eng::Quantity> reserved_qty_;   // Held for open sells, per instrument
+    std::vector<FillSimulator::Execution> executions_;   // Reused per tick
+    std::vector<Notice> notices_;                     // Published once the tick is applied
+    eng::TimePoint last_tick_ts_{};                   // Tape time, for cancels
+    std::atomic<size_t> open_orders_{0};
+
     // Helper to generate unique order IDs
     uint64_t generate_order_id();
+
+    // Position slot for an order's instrument (by id, or symbol if unregistered).
+    // Only the order thread writes it, so plain load/store is enough.
+    std::atomic<eng::Quantity>& position_for(const eng::Order& order);
+
+    void add_balance(eng::Money delta) {
+        balance_.store(balance_.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+    static void add_qty(std::atomic<eng::Quantity>& slot, eng::Quantity delta) {
+        slot.store(slot.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    // Journal the order (and publish it on the bus as `event`)
+    size_t record(const eng::Order& order);
+    size_t record(const eng::Order& order, eng::OrderEvent::Kind event);
+
+    // Typed OrderEvent, plus the legacy string-topic Event if anyone listens to it
+    void publish(eng::OrderEvent::Kind kind, const eng::Order& order);
+
+    double place_simulated_limit(eng::Order& exec_order, double limit_price);
+    void apply_execution(const FillSimulator::Execution& e);
+    void publish_notices();
 };
 
 
 
-}
\ No newline at end of file
+}
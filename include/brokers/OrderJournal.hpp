@@ -0,0 +1,69 @@
+#pragma once
+#include "engine/AppendArena.hpp"
+#include "engine/Types.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace broker {
+
+/*
+OrderJournal:
+  A broker's order history as an append-only AppendArena, written by
+  the broker's order thread and read by anyone (frontend queries, reports)
+  without a lock.
+
+  Everything about an order is fixed when it is appended except its fill
+  state (status, filled_qty, fill_price), which resting orders keep
+  changing. Those three are atomics guarded by a per-entry sequence
+  counter, so a reader never sees a half-applied fill.
+
+  Order ids only grow, so since() finds the first new order by binary
+  search and paging through the history costs O(log n + page).
+*/
+class OrderJournal {
+public:
+    struct FillState {
+        eng::OrderStatus status{eng::OrderStatus::NEW};
+        double filled_qty{0.0};
+        double fill_price{0.0};
+    };
+
+    // ---- Writer (order thread) ----
+
+    // Record an order; returns its journal index
+    size_t append(const eng::Order& order);
+
+    // Change the fill state of an appended order
+    void update(size_t index, const FillState& state);
+
+    // Immutable fields of an appended order (its fill fields are stale; see fill_state)
+    const eng::Order& header(size_t index) const { return entries_[index].order; }
+
+    // ---- Readers (any thread) ----
+
+    size_t size() const { return entries_.size(); }
+
+    FillState fill_state(size_t index) const;
+    eng::Order get(size_t index) const;
+
+    // Up to `limit` orders with id > after_id, oldest first (limit 0 = no limit)
+    std::vector<eng::Order> since(uint64_t after_id, size_t limit = 0) const;
+
+    // Whole history
+    std::vector<eng::Order> snapshot() const { return since(0); }
+
+private:
+    struct Entry {
+        eng::Order order;
+        std::atomic<uint32_t> seq{0};     // Odd while the writer is updating
+        std::atomic<eng::OrderStatus> status{eng::OrderStatus::NEW};
+        std::atomic<double> filled_qty{0.0};
+        std::atomic<double> fill_price{0.0};
+    };
+
+    eng::AppendArena<Entry> entries_;
+};
+
+}  // namespace broker
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+namespace eng {
+
+/**
+ * Heap allocations (operator new) made by the whole process so far.
+ *
+ * Counting replaces the global operator new/delete, so it only exists in
+ * executables that link the alloc_counter object library (trading_engine,
+ * benchmarks); linking it costs one relaxed atomic add per allocation.
+ */
+std::uint64_t allocation_count();
+
+}  // namespace eng
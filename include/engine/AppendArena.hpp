@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+namespace eng {
+
+/**
+ * AppendArena
+ *
+ * Append-only array with stable element addresses, for one writer and any
+ * number of concurrent readers. Elements live in fixed-size chunks that
+ * are never moved or freed before the arena is, so an index (or a
+ * reference) handed out once stays valid, and growing never copies.
+ *
+ * The writer fills the next slot and then publishes it by bumping size()
+ * with release semantics; readers that load size() with acquire may read
+ * any slot below it without a lock. Fields the writer changes after
+ * publishing must be atomics (or otherwise synchronized) by the caller.
+ *
+ * Capacity is max_chunks * 2^ChunkShift elements; T must be default
+ * constructible (chunks are allocated as arrays).
+ */
+template <typename T, size_t ChunkShift = 12>
+class AppendArena {
+public:
+    static constexpr size_t kChunkSize = size_t{1} << ChunkShift;
+
+    explicit AppendArena(size_t max_chunks = 4096)
+        : chunks_(std::make_unique<std::atomic<T*>[]>(max_chunks)), max_chunks_(max_chunks) {
+        for (size_t i = 0; i < max_chunks_; ++i) chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~AppendArena() {
+        for (size_t i = 0; i < max_chunks_; ++i) {
+            delete[] chunks_[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    AppendArena(const AppendArena&) = delete;
+    AppendArena& operator=(const AppendArena&) = delete;
+
+    /**
+     * Writer only: fill the next slot with fill(T&), then publish it.
+     * @return Index of the new element
+     */
+    template <typename F>
+    size_t append(F&& fill) {
+        size_t i = size_.load(std::memory_order_relaxed);
+        size_t c = i >> ChunkShift;
+        if (c >= max_chunks_) throw std::length_error("AppendArena is full");
+        T* chunk = chunks_[c].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new T[kChunkSize];
+            chunks_[c].store(chunk, std::memory_order_release);
+        }
+        fill(chunk[i & (kChunkSize - 1)]);
+        size_.store(i + 1, std::memory_order_release);
+        return i;
+    }
+
+    // Published elements; safe from any thread
+    size_t size() const { return size_.load(std::memory_order_acquire); }
+
+    // i must be below a size() the caller has observed
+    T& operator[](size_t i) {
+        return chunks_[i >> ChunkShift].load(std::memory_order_acquire)[i & (kChunkSize - 1)];
+    }
+    const T& operator[](size_t i) const {
+        return chunks_[i >> ChunkShift].load(std::memory_order_acquire)[i & (kChunkSize - 1)];
+    }
+
+private:
+    std::unique_ptr<std::atomic<T*>[]> chunks_;
+    size_t max_chunks_;
+    std::atomic<size_t> size_{0};
+};
+
+}  // namespace eng
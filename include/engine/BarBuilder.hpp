@@ -0,0 +1,234 @@
+#pragma once
+
+#include "engine/Checkpoint.hpp"
+#include "engine/EventBus.hpp"
+#include "engine/FixedPoint.hpp"
+#include "engine/MarketDataTypes.hpp"
+#include "engine/InstrumentTable.hpp"
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace eng {
+
+/**
+ * BarBuilder
+ *
+ * The one stage that turns TradePrints into OHLCV bars. It subscribes to
+ * TradePrint once and updates a bar for every configured interval in the
+ * same pass, then publishes each finished bar as a Bar on the EventBus
+ * (typed channel). Consumers pick the intervals they care about:
+ * CandlePersister writes the store's base resolution, FrontendBridge
+ * streams the chart intervals.
+ *
+ * Event-driven design: a bar is emitted when a trade arrives in the NEXT
+ * bucket for that interval, so only complete, finalized bars go out
+ * (flush() and stop() are the exceptions, see below).
+ *
+ * State is flat: each instrument owns intervals().size() consecutive
+ * BarState entries in one vector, found through an InstrumentTable, so a
+ * trade costs one index lookup plus one compare per interval while its
+ * bars stay open. Adding a 1m and 5m chart adds two compares, not two
+ * more subscribers each copying and hashing every trade.
+ */
+class BarBuilder {
+public:
+    /**
+     * @param bus EventBus carrying TradePrint in and Bar out
+     * @param intervals_ms Bar intervals in milliseconds (duplicates are ignored)
+     */
+    explicit BarBuilder(EventBus& bus, std::vector<long long> intervals_ms = {1000})
+        : bus_(bus), intervals_(std::move(intervals_ms)) {
+        std::sort(intervals_.begin(), intervals_.end());
+        intervals_.erase(std::unique(intervals_.begin(), intervals_.end()), intervals_.end());
+        if (intervals_.empty() || intervals_.front() <= 0) {
+            throw std::invalid_argument("BarBuilder: intervals must be positive");
+        }
+    }
+
+    ~BarBuilder() {
+        stop();
+    }
+
+    BarBuilder(const BarBuilder&) = delete;
+    BarBuilder& operator=(const BarBuilder&) = delete;
+
+    /**
+     * Handle trades on a dedicated worker thread instead of the publisher's.
+     * Bars are then published from that worker. Must be called before start().
+     */
+    void set_async_dispatch(EventBus::AsyncOptions opts) {
+        async_dispatch_ = std::move(opts);
+    }
+
+    // Intervals being built, ascending
+    const std::vector<long long>& intervals() const { return intervals_; }
+
+    /**
+     * Start building bars from TradePrint events.
+     */
+    void start() {
+        if (running_) return;
+        running_ = true;
+
+        bus_.subscribe<TradePrint>([this](const TradePrint& tp) {
+            on_trade(tp);
+        }, async_dispatch_);
+    }
+
+    /**
+     * Stop building and emit every bar still open.
+     */
+    void stop() {
+        if (!running_) return;
+        running_ = false;
+        flush();
+    }
+
+    /**
+     * Emit every open bar now, e.g. once a replay has finished. A later trade
+     * in the same bucket starts a fresh bar (its open_time repeats, and the
+     * store keeps the newer row).
+     * Must not race on_trade: with async dispatch, drain the bus first
+     * (EventBus::wait_idle).
+     */
+    void flush() {
+        const size_t n = intervals_.size();
+        slots_.for_each([this, n](auto& slot) {
+            for (size_t k = 0; k < n; ++k) {
+                BarState& bar = bars_[slot.value - 1 + k];
+                emit(slot, k, bar);
+                bar.has_data = false;
+            }
+        });
+    }
+
+    /**
+     * Checkpoints: every instrument's open bars, so a restored builder
+     * finishes them instead of emitting partial ones. Must not race
+     * on_trade (see flush()).
+     */
+    void save_state(CheckpointWriter& out) const {
+        out.put<uint64_t>(intervals_.size());
+        for (long long iv : intervals_) out.put<long long>(iv);
+        uint64_t instruments = 0;
+        slots_.for_each([&instruments](const auto&) { ++instruments; });
+        out.put<uint64_t>(instruments);
+        const size_t n = intervals_.size();
+        slots_.for_each([this, &out, n](const auto& slot) {
+            out.put_string(slot.symbol);
+            out.put<InstrumentId>(slot.id);
+            for (size_t k = 0; k < n; ++k) out.put<BarState>(bars_[slot.value - 1 + k]);
+        });
+    }
+
+    /**
+     * Restore what save_state() wrote, into a builder with the same
+     * intervals, before the first trade.
+     */
+    void load_state(CheckpointReader& in) {
+        if (!bars_.empty()) in.fail("BarBuilder has already seen trades");
+        std::vector<long long> intervals(in.get<uint64_t>());
+        for (long long& iv : intervals) iv = in.get<long long>();
+        if (intervals != intervals_) in.fail("BarBuilder checkpoint has other intervals");
+        const size_t n = intervals_.size();
+        const auto instruments = in.get<uint64_t>();
+        for (uint64_t i = 0; i < instruments; ++i) {
+            const std::string symbol = in.get_string();
+            auto& slot = slots_.get(in.get<InstrumentId>(), symbol);
+            slot.value = bars_.size() + 1;
+            bars_.resize(bars_.size() + n);
+            for (size_t k = 0; k < n; ++k) bars_[slot.value - 1 + k] = in.get<BarState>();
+        }
+        if (!in.done()) in.fail("unexpected trailing data");
+    }
+
+    /**
+     * Fold one trade into every interval's bar. Called from the bus; public
+     * so a replay loop or benchmark can drive the builder directly.
+     */
+    void on_trade(const TradePrint& tp) {
+        const long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            tp.ts.time_since_epoch()).count();
+        const size_t n = intervals_.size();
+
+        auto& slot = slots_.get(tp.instrument_id, tp.symbol);
+        if (slot.value == 0) {
+            slot.value = bars_.size() + 1;
+            bars_.resize(bars_.size() + n);
+        }
+        BarState* bars = &bars_[slot.value - 1];
+        const Price price(tp.price);
+        const Quantity qty(tp.qty);
+
+        for (size_t k = 0; k < n; ++k) {
+            BarState& bar = bars[k];
+
+            // Trade outside the current bucket: emit the bar, start the next
+            if (ms < bar.start_ms || ms >= bar.end_ms) {
+                emit(slot, k, bar);
+                bar.start_ms = (ms / intervals_[k]) * intervals_[k];
+                bar.end_ms = bar.start_ms + intervals_[k];
+                bar.has_data = false;
+            }
+
+            if (!bar.has_data) {
+                // First trade in this bucket
+                bar.open = price;
+                bar.high = price;
+                bar.low = price;
+                bar.close = price;
+                bar.volume = qty;
+                bar.has_data = true;
+            } else {
+                bar.high = std::max(bar.high, price);
+                bar.low = std::min(bar.low, price);
+                bar.close = price;
+                bar.volume += qty;
+            }
+        }
+    }
+
+private:
+    // Integer ticks in ENG_FIXED_POINT builds, so volume sums exactly
+    struct BarState {
+        Price open{};
+        Price high{};
+        Price low{};
+        Price close{};
+        Quantity volume{};
+        long long start_ms{0};    // Current bucket [start_ms, end_ms); empty before the first trade
+        long long end_ms{0};
+        bool has_data{false};
+    };
+
+    EventBus& bus_;
+    std::vector<long long> intervals_;
+    bool running_{false};
+    std::optional<EventBus::AsyncOptions> async_dispatch_;
+
+    InstrumentTable<size_t> slots_;   // 1-based offset of the instrument's first BarState
+    std::vector<BarState> bars_;      // intervals_.size() entries per instrument, in interval order
+
+    /**
+     * Publish an instrument's bar for interval k if it has data.
+     */
+    void emit(const InstrumentTable<size_t>::Slot& slot, size_t k, const BarState& bar) {
+        if (!bar.has_data) return;
+        Bar out;
+        out.candle.symbol = slot.symbol;
+        out.candle.open_time = TimePoint(std::chrono::milliseconds(bar.start_ms));
+        out.candle.open = to_double(bar.open);
+        out.candle.high = to_double(bar.high);
+        out.candle.low = to_double(bar.low);
+        out.candle.close = to_double(bar.close);
+        out.candle.volume = to_double(bar.volume);
+        out.candle.instrument_id = slot.id;
+        out.interval_ms = intervals_[k];
+        bus_.publish(out);
+    }
+};
+
+}  // namespace eng
@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace eng {
+
+/**
+ * BroadcastRing
+ *
+ * Fixed-capacity single-producer ring where every item goes to every
+ * consumer (a broadcast, not a work queue). Each consumer owns a cursor on
+ * its own cache line and reads items in place; the producer only reuses a
+ * slot once the slowest cursor has passed it, so one push costs a copy
+ * into the slot and a release store, however many consumers there are.
+ * Capacity is rounded up to a power of two.
+ *
+ * Like BoundedQueue, slots keep their T alive between uses, so pushing a
+ * Tick reuses the slot's string capacity.
+ *
+ * Threading: try_push() from one producer thread; available/peek/release
+ * for consumer c from c's thread only.
+ */
+template <typename T>
+class BroadcastRing {
+public:
+    BroadcastRing(std::size_t capacity, std::size_t consumers)
+        : consumers_(consumers) {
+        std::size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        slots_ = std::make_unique<T[]>(cap);
+        cursors_ = std::make_unique<Cursor[]>(consumers);
+    }
+
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+    // Returns false if the slowest consumer is a full ring behind.
+    template <typename U>
+    bool try_push(U&& value) {
+        const std::uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - min_tail_ > mask_) {
+            min_tail_ = slowest();
+            if (head - min_tail_ > mask_) return false;
+        }
+        slots_[head & mask_] = std::forward<U>(value);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Items consumer c has yet to release
+    std::size_t available(std::size_t c) const {
+        return static_cast<std::size_t>(head_.load(std::memory_order_acquire) -
+                                        cursors_[c].pos.load(std::memory_order_relaxed));
+    }
+
+    // Consumer c's i-th unreleased item (i < available(c)); valid until released
+    const T& peek(std::size_t c, std::size_t i) const {
+        return slots_[(cursors_[c].pos.load(std::memory_order_relaxed) + i) & mask_];
+    }
+
+    // Consumer c is done with its next n items
+    void release(std::size_t c, std::size_t n) {
+        cursors_[c].pos.fetch_add(n, std::memory_order_release);
+    }
+
+    // Items ever pushed
+    std::uint64_t published() const { return head_.load(std::memory_order_acquire); }
+
+    // Items the slowest consumer has yet to release (exact when quiescent)
+    std::size_t size_approx() const {
+        return static_cast<std::size_t>(head_.load(std::memory_order_acquire) - slowest());
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+    std::size_t consumers() const { return consumers_; }
+
+private:
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    struct alignas(CACHE_LINE) Cursor {
+        std::atomic<std::uint64_t> pos{0};
+    };
+
+    std::uint64_t slowest() const {
+        std::uint64_t min = head_.load(std::memory_order_relaxed);
+        for (std::size_t c = 0; c < consumers_; ++c) {
+            const std::uint64_t pos = cursors_[c].pos.load(std::memory_order_acquire);
+            if (pos < min) min = pos;
+        }
+        return min;
+    }
+
+    std::unique_ptr<T[]> slots_;
+    std::unique_ptr<Cursor[]> cursors_;
+    std::size_t mask_{0};
+    std::size_t consumers_{0};
+    alignas(CACHE_LINE) std::atomic<std::uint64_t> head_{0};
+    alignas(CACHE_LINE) std::uint64_t min_tail_{0};   // Producer's last view of the slowest cursor
+};
+
+} // namespace eng
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "engine/MarketDataTypes.hpp"
+#include <cstdint>
+#include <list>
+#include <map>
+#include <tuple>
+#include <string>
+#include <vector>
+
+/*
+CandleCache:
+  In-memory read cache for CandleStore::query_candles.
+
+  Per (symbol, resolution) it keeps a set of non-overlapping, sorted
+  segments, each remembering the exact [start_ms, end_ms] range it was
+  loaded for (so an empty segment is a valid "no candles here" answer).
+  A query fully inside one segment is answered by binary search on the
+  segment's open times: O(log n + k), no DB access. New DB results are
+  merged with any overlapping or adjacent segments, so panning across the
+  chart grows one contiguous segment instead of many fragments.
+
+  Eviction is true LRU over segments with a memory budget in bytes.
+
+  The cache mirrors what is committed, as EventCache does. The writer
+  brackets every candle of a batch with begin_commit()/end_commit():
+  committed candles are applied in place to any segment covering their
+  time, and each bracket bumps the series' generation. A DB result read
+  under an older generation, or landing while a batch is being written, is
+  not cached, so the cache never keeps data that predates a write it raced
+  with. Candles still waiting in the write buffer are missing from a DB
+  result, but they reach the cached segment when their batch commits.
+
+  Not thread-safe: CandleStore guards it with cache_mutex_.
+*/
+
+namespace eng {
+
+class CandleCache {
+public:
+  struct Stats {
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t evictions{0};
+    size_t bytes{0};
+    size_t segments{0};
+  };
+
+  explicit CandleCache(size_t budget_bytes) : budget_bytes_(budget_bytes) {}
+
+  // Copy candles in [start_ms, end_ms] into out if a cached segment covers
+  // the whole range. Returns false on a miss (out untouched).
+  bool lookup(const std::string& symbol, long long resolution_ms,
+              long long start_ms, long long end_ms, std::vector<Candle>& out);
+
+  // Current write generation for a series; pass it back to insert()
+  uint64_t generation(const std::string& symbol, long long resolution_ms);
+
+  // Cache a DB result covering [start_ms, end_ms] (candles sorted by open time).
+  // Dropped if the series had commits since `generation` was read, or has
+  // one in flight.
+  void insert(const std::string& symbol, long long resolution_ms,
+              long long start_ms, long long end_ms,
+              std::vector<Candle> candles, uint64_t generation);
+
+  // Around each candle of a writer batch. end_commit() applies the candle to
+  // any segment covering its open time; with committed=false it drops the
+  // series instead, as part of the batch may have landed.
+  void begin_commit(const std::string& symbol, long long resolution_ms);
+  void end_commit(const std::string& symbol, long long resolution_ms,
+                  const Candle& candle, bool committed);
+
+  void clear();
+
+  const Stats& stats() const { return stats_; }
+
+private:
+  struct Key {
+    std::string symbol;
+    long long resolution_ms;
+
+    bool operator<(const Key& other) const {
+      return std::tie(symbol, resolution_ms) < std::tie(other.symbol, other.resolution_ms);
+    }
+  };
+
+  struct Series;
+
+  struct LruEntry {
+    Series* series;
+    long long start_ms;
+  };
+
+  struct Segment {
+    long long start_ms{0};
+    long long end_ms{0};                 // Inclusive
+    std::vector<long long> times;        // open_time in ms, parallel to candles
+    std::vector<Candle> candles;
+    size_t bytes{0};
+    std::list<LruEntry>::iterator lru;
+  };
+
+  struct Series {
+    std::map<long long, Segment> segments;   // keyed by start_ms
+    uint64_t generation{0};
+    size_t committing{0};                    // Candles of batches being written
+  };
+
+  size_t budget_bytes_;
+  std::map<Key, Series> series_;
+  std::list<LruEntry> lru_;                  // front = most recently used
+  Stats stats_;
+
+  static long long to_ms(const Candle& c);
+  static size_t segment_bytes(const Segment& seg);
+
+  void touch(Segment& seg);
+  void account(Segment& seg);                // Recompute seg.bytes and the total
+  void erase_segment(Series& series, std::map<long long, Segment>::iterator it);
+  void drop(Series& series);
+  void evict_to_budget(const Segment* keep);
+};
+
+} // namespace eng
@@ -1,12 +1,20 @@
 #pragma once
 
+#include "engine/Checkpoint.hpp"
 #include "engine/MarketDataTypes.hpp"
 #include "engine/Types.hpp"
+#include "engine/CandleCache.hpp"
+#include "engine/EventCache.hpp"
 #include <sqlite3.h>
 #include <nlohmann/json.hpp>
 #include <vector>
 #include <map>
+#include <array>
+#include <tuple>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -15,14 +23,40 @@ CandleStore:
   Persistent SQLite storage + in-memory LRU cache for candles and events.
   
   Write path (during backtest):
-    - Events/candles buffered in memory
-    - Flushed to SQLite when buffers reach threshold (50K items)
-    - Also broadcast via WebSocket (live update)
+    - add_candle()/add_event() only append to an in-memory buffer
+    - A dedicated writer thread owns its own SQLite connection and
+      long-lived prepared statements, and commits everything pending in one
+      transaction once a buffer reaches its size threshold or every
+      flush_interval_ms, whichever comes first
+    - Callers on the replay/strategy path never wait for disk;
+      flush_all() is the explicit "wait until committed" barrier
   
   Read path (frontend queries):
-    - Check in-memory cache first (fast)
-    - Fall back to SQLite (persistent)
+    - Check in-memory cache first (fast; see CandleCache and EventCache)
+    - Fall back to SQLite (persistent) through a pool of read-only
+      connections, so queries run alongside each other and the writer
+      (WAL) instead of queueing on one connection
     - Cache query results for future reuse
+
+  Partitions (partition_by_day):
+    - Each (source, UTC day) gets its own file,
+      <db_path>.d/<source>/<YYYY-MM-DD>.db, with its own writer connection
+      and read pool; a query only opens the days it covers
+    - A day holds every rollup tier up to 1d, so no bar spans two files
+    - clear_all() unlinks the files instead of deleting rows
+    - Off (the default): one file at db_path, same schema
+  
+  Rollup tiers:
+    - 1s candles (the base resolution) are folded into 1m, 5m, 1h and 1d
+      candles as they are added, so every tier is stored alongside the raw
+    - Coarser tiers are rewritten once per writer batch, not once per second
+    - Queries read the coarsest tier that divides the requested resolution
+      (rollup_resolution_for), so cost scales with the bars returned
+  
+  Events:
+    - Order fields (id, side, qty, price, status) have their own columns;
+      only anything else goes into the JSON `extra` column, so reading
+      an order event back parses nothing
   
   Supports two data sources: 'live' (real-time trading) and 'backtest' (historical data)
 */
@@ -33,22 +67,49 @@ using json = nlohmann::json;
 
 struct CandleStoreConfig {
   std::string db_path{"backtest.db"};
-  size_t candle_buffer_size{20};   // Flush candles when buffer reaches this size
-  size_t event_buffer_size{20};    // Flush events when buffer reaches this size
-  size_t max_candle_cache_entries{100};  // LRU limit for candle queries
-  size_t max_event_cache_entries{100};   // LRU limit for event queries
+  size_t candle_buffer_size{5000}; // Writer commits once this many candles are pending...
+  size_t event_buffer_size{1000};  // ...or this many events...
+  int flush_interval_ms{250};      // ...or at least this often
+  size_t candle_cache_bytes{64 * 1024 * 1024};  // LRU memory budget for cached candle ranges
+  size_t max_cached_events{1 << 20};     // LRU budget for cached event ranges
+  bool maintain_rollups{true};     // Fold base candles into the rollup tiers on add_candle
+  bool partition_by_day{false};    // One file per (source, UTC day) under <db_path>.d/
+  size_t read_connections{4};      // Read-only connections per file, opened on demand
 };
 
-struct StoredEvent {
-  std::string event_type;      // 'OrderPlaced', 'OrderFilled', 'OrderRejected', etc.
-  long long timestamp_ms{0};
-  std::string symbol;
-  std::string source;          // 'live' or 'backtest'
-  json data;                   // Flexible JSON payload
+// Background writer throughput counters
+struct CandleStoreWriterStats {
+  uint64_t candles_written{0};
+  uint64_t events_written{0};
+  uint64_t batches{0};             // Committed transactions
+  uint64_t failed_batches{0};      // Rolled back (rows dropped, error logged)
+  double last_batch_rows_per_sec{0.0};
+  double avg_rows_per_sec{0.0};    // Rows / time spent inside write transactions
+  uint64_t late_rollup_candles{0}; // Base candles older than their open 1m bucket (stored, not rolled up)
+};
+
+// Result of query_candles_downsampled
+struct DownsampledCandles {
+  std::vector<Candle> candles;     // One OHLCV bar per non-empty bucket, oldest first
+  long long bucket_ms{0};          // Bar width returned (>= the requested resolution)
+  long long source_resolution_ms{0};  // Stored tier the bars were built from
+  size_t rows_scanned{0};
+  bool downsampled{false};         // bucket_ms was widened to fit max_points
+  bool cancelled{false};           // Stopped early via the cancel flag (candles incomplete)
 };
 
 class CandleStore {
 public:
+  // Resolution persisted by CandlePersister; the rollups are built from it
+  static constexpr long long kBaseResolutionMs = 1000;
+  // Coarser tiers maintained from the base, finest first
+  static constexpr long long kRollupTiersMs[] = {60'000, 300'000, 3'600'000, 86'400'000};
+  static constexpr size_t kNumRollupTiers = sizeof(kRollupTiersMs) / sizeof(kRollupTiersMs[0]);
+
+  // Coarsest stored resolution that evenly divides resolution_ms
+  // (kBaseResolutionMs when none does, e.g. sub-second resolutions)
+  static long long rollup_resolution_for(long long resolution_ms);
+
   explicit CandleStore(const CandleStoreConfig& config = CandleStoreConfig());
   ~CandleStore();
 
@@ -59,91 +120,203 @@ public:
   void add_candle(const std::string& symbol, long long resolution_ms,
                   const Candle& candle, const std::string& source);
   
+  void add_event(StoredEvent event);
+
+  // JSON form: orderId, side, qty (or filledQty), fillPrice and status go
+  // into their columns, every other key into `extra`; `symbol` is dropped.
+  // A fill keeps its order qty in `extra`.
   void add_event(const std::string& event_type, long long timestamp_ms,
                  const std::string& symbol, const std::string& source,
                  const json& data);
 
-  // Flush buffered writes to database
+  // Block until every write added so far is committed
   void flush_all();
-  void flush_candles();
+  void flush_candles();   // Same as flush_all(): the writer commits both together
   void flush_events();
 
+  CandleStoreWriterStats writer_stats() const;
+  CandleCache::Stats candle_cache_stats();
+  EventCache::Stats event_cache_stats();
+
   // Read operations (cache-aware)
   std::vector<Candle> query_candles(const std::string& symbol,
                                      long long resolution_ms,
                                      long long start_ms, long long end_ms);
 
+  // Bars in [start_ms, end_ms] at resolution_ms, or at the smallest wider
+  // bucket that keeps the bar count within max_points. Bars keep the true
+  // open/high/low/close/volume of everything they cover, and are built in one
+  // pass over the stored tier (cached range or SQLite cursor).
+  // If `cancel` becomes true the scan stops early and nothing is cached.
+  DownsampledCandles query_candles_downsampled(const std::string& symbol,
+                                               long long resolution_ms,
+                                               long long start_ms, long long end_ms,
+                                               size_t max_points,
+                                               const std::atomic<bool>* cancel = nullptr);
+
+  // Bar width query_candles_downsampled uses for this range and budget
+  static long long downsample_bucket_for(long long resolution_ms,
+                                         long long start_ms, long long end_ms,
+                                         size_t max_points);
+
   std::vector<StoredEvent> query_events(const std::string& symbol,
                                          long long start_ms, long long end_ms,
                                          const std::vector<std::string>& event_types = {});
 
   // Metadata queries
   json get_run_meta(const std::string& symbol) const;
+  // Partitions on disk, newest day first: {source, day, path} (one entry,
+  // {path}, when not partitioned)
   std::vector<json> list_runs(int limit = 20) const;
 
   // Clear all data (for starting fresh backtest)
   void clear_all();
 
+  // Checkpoints: the in-progress rollup buckets, so a resumed run keeps
+  // folding base candles into them rather than restarting them from the
+  // next one. flush_all() first, so the database matches the checkpoint.
+  void save_state(CheckpointWriter& out) const;
+  // Before the next add_candle()
+  void load_state(CheckpointReader& in);
+
 private:
+  static constexpr long long kDayMs = 86'400'000;
+
   CandleStoreConfig config_;
-  sqlite3* db_{nullptr};
-  
+
+  // One database file: its writer connection and read pool (defined in the .cpp)
+  struct Partition;
+  class ReadLease;
+
+  struct PartitionKey {
+    long long day_ms{-1};        // UTC day start; -1 for the single unpartitioned file
+    std::string source;
+
+    bool operator<(const PartitionKey& other) const {
+      return std::tie(day_ms, source) < std::tie(other.day_ms, other.source);
+    }
+  };
+
+  // Held by shared_ptr so a query can finish on a partition clear_all() just dropped
+  std::map<PartitionKey, std::shared_ptr<Partition>> partitions_;   // Day order
+  mutable std::mutex partitions_mutex_;
+
   // Thread safety
-  std::mutex buffer_mutex_;
-  std::mutex db_mutex_;
+  mutable std::mutex buffer_mutex_;
   std::mutex cache_mutex_;
-  
-  // Write buffers (accumulate before flushing to DB)
-  std::vector<std::pair<std::string, Candle>> candles_write_buffer_;  // (symbol, candle)
-  std::vector<std::pair<long long, std::string>> candles_resolution_buffer_;  // Track resolutions
-  std::vector<StoredEvent> events_write_buffer_;
 
-  // LRU caches
-  struct CandleCacheKey {
+  struct PendingCandle {
     std::string symbol;
     long long resolution_ms;
-    
-    bool operator<(const CandleCacheKey& other) const {
-      return std::tie(symbol, resolution_ms) < 
-             std::tie(other.symbol, other.resolution_ms);
-    }
+    std::string source;
+    Candle candle;
   };
   
-  struct EventCacheKey {
+  // One candle folded into a rollup bucket: a base candle for the first
+  // tier, the (possibly still open) bucket of the tier below for the others
+  struct RollupPart {
+    long long open_ms{0};
+    double open{0.0};
+    double high{0.0};
+    double low{0.0};
+    double close{0.0};
+    double volume{0.0};
+  };
+
+  // Bumped when save_state()'s rollup layout changes
+  static constexpr uint32_t kRollupCheckpointLayout = 2;
+
+  // In-progress rollup candle for one tier (guarded by buffer_mutex_). The
+  // candle is rebuilt from its parts on every fold, so a part written again
+  // (a base candle re-persisted after more trades) replaces its old values
+  // instead of adding to them. At most 60 parts per bucket with the tiers
+  // above, and the vector keeps its capacity across buckets. The first
+  // bucket a tier opens (without a resumed checkpoint) is seeded from the
+  // stored rows of the tier below, so a restart mid-bucket doesn't
+  // overwrite the stored rollup with only the parts seen since.
+  struct RollupBucket {
+    long long bucket_ms{-1};     // -1 before the first base candle
+    std::vector<RollupPart> parts;   // One per open_ms, oldest first
+    bool dirty{false};           // Changed since the writer last took it
+    Candle candle;
+  };
+
+  struct RollupKey {
     std::string symbol;
-    long long start_ms;
-    long long end_ms;
-    
-    bool operator<(const EventCacheKey& other) const {
-      return std::tie(symbol, start_ms, end_ms) < 
-             std::tie(other.symbol, other.start_ms, other.end_ms);
+    std::string source;
+
+    bool operator<(const RollupKey& other) const {
+      return std::tie(symbol, source) < std::tie(other.symbol, other.source);
     }
   };
-  
-  std::map<CandleCacheKey, std::vector<Candle>> candles_cache_;
-  std::map<EventCacheKey, std::vector<StoredEvent>> events_cache_;
-
-  // DB operations (must hold db_mutex_)
-  void db_ensure_schema();
-  void db_batch_insert_candles(const std::vector<std::pair<std::string, Candle>>& batch,
-                                const std::vector<std::pair<long long, std::string>>& resolutions);
-  void db_batch_insert_events(const std::vector<StoredEvent>& batch);
-  
-  std::vector<Candle> db_query_candles(const std::string& symbol,
-                                        long long resolution_ms,
-                                        long long start_ms, long long end_ms);
-  
+
+  using RollupState = std::array<RollupBucket, kNumRollupTiers>;
+  std::map<RollupKey, RollupState> rollups_;
+
+  // Write buffers (accumulate until the writer thread takes them)
+  std::vector<PendingCandle> candles_write_buffer_;
+  std::vector<StoredEvent> events_write_buffer_;
+
+  // Background writer (buffers/sequence numbers guarded by buffer_mutex_)
+  std::thread writer_thread_;
+  std::condition_variable writer_cv_;          // Wakes the writer
+  std::condition_variable committed_cv_;       // Signals flush_all() waiters
+  uint64_t enqueued_seq_{0};                   // Rows added so far
+  uint64_t committed_seq_{0};                  // Rows the writer has finished with
+  bool flush_requested_{false};
+  bool writer_busy_{false};
+  bool stop_writer_{false};
+  CandleStoreWriterStats writer_stats_;
+  double writer_busy_seconds_{0.0};
+
+  // Read caches (guarded by cache_mutex_)
+  CandleCache candle_cache_;
+
+  EventCache event_cache_;
+
+  // Schema setup and migrations on one connection
+  static void db_ensure_schema(sqlite3* db);
+  static void db_rebuild_rollups(sqlite3* db);
+
+  // Partitions
+  std::string partition_root() const { return config_.db_path + ".d"; }
+  PartitionKey partition_key(long long timestamp_ms, const std::string& source) const;
+  std::shared_ptr<Partition> make_partition(const PartitionKey& key) const;
+  std::shared_ptr<Partition> writer_partition(const PartitionKey& key);    // Writer thread
+  void discover_partitions();
+  // Partitions that may hold rows in [start_ms, end_ms], in day order
+  std::vector<std::shared_ptr<Partition>> partitions_for(long long start_ms, long long end_ms) const;
+
+  // Rollups (must hold buffer_mutex_)
+  void fold_into_rollups(const std::string& symbol, const std::string& source,
+                         const Candle& candle);
+  void take_dirty_rollups(std::vector<PendingCandle>& out);
+  // Stored rows of one symbol/source in [start_ms, end_ms], as rollup parts
+  void db_query_rollup_parts(const RollupKey& key, long long resolution_ms,
+                             long long start_ms, long long end_ms,
+                             std::vector<RollupPart>& out);
+
+  // Writer thread
+  void writer_loop();
+  void write_batch(const std::vector<PendingCandle>& candles, const std::vector<StoredEvent>& events);
+  static void write_partition(Partition& partition, const std::vector<const PendingCandle*>& candles,
+                              const std::vector<const StoredEvent*>& events);
+
+  // Rows from every partition covering the range, oldest first. Returns
+  // false if `cancel` stopped the scan (out is then incomplete).
+  bool db_query_candles(const std::string& symbol,
+                        long long resolution_ms,
+                        long long start_ms, long long end_ms,
+                        std::vector<Candle>& out,
+                        const std::atomic<bool>* cancel = nullptr);
+
   std::vector<StoredEvent> db_query_events(const std::string& symbol,
                                             long long start_ms, long long end_ms,
                                             const std::vector<std::string>& event_types);
 
-  // Cache management
-  void evict_old_candle_cache();
-  void evict_old_event_cache();
-
   // Utility
-  void exec_sql(const std::string& sql);
-  int query_int(const std::string& sql, int default_value = 0);
+  static void exec_sql(sqlite3* db, const std::string& sql);
+  static int query_int(sqlite3* db, const std::string& sql, int default_value = 0);
 };
 
 } // namespace eng
@@ -0,0 +1,149 @@
+#pragma once
+#include "engine/FixedPoint.hpp"
+#include "engine/MarketDataTypes.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace eng {
+
+/**
+ * Checkpoint
+ *
+ * Binary snapshot of engine state, so a restart resumes where the last run
+ * stopped instead of replaying the day from its first trade.
+ *
+ * A checkpoint is a set of named sections ("registry", "broker",
+ * "strategy.0", "bars", "ticks", "candles", "replay"), each an opaque blob written and read
+ * back by the component that owns it through CheckpointWriter /
+ * CheckpointReader. Components put their own kind or layout fields first
+ * and refuse to load a section that doesn't match.
+ *
+ * File layout (little-endian, native layout):
+ *
+ *   magic "ENGCKPT\0", u32 version, u32 flags, u32 section count
+ *   per section: u16 name length, name, u64 blob length, blob
+ *   u64 FNV-1a of everything before it
+ *
+ * Sections hold eng::Money / eng::Quantity as is, so flags records whether
+ * they were written by an ENG_FIXED_POINT build and load() refuses a file
+ * from the other kind.
+ *
+ * save() writes `<path>.tmp` and renames it over `path`, so a crash while
+ * writing leaves the previous checkpoint in place. load() throws
+ * std::runtime_error on a missing, truncated or corrupt file.
+ */
+
+constexpr char CHECKPOINT_MAGIC[8] = {'E', 'N', 'G', 'C', 'K', 'P', 'T', '\0'};
+constexpr std::uint32_t CHECKPOINT_VERSION = 2;
+constexpr std::uint32_t CHECKPOINT_FIXED_POINT = 1;   // flags bit
+constexpr std::uint32_t CHECKPOINT_FLAGS = ENG_FIXED_POINT ? CHECKPOINT_FIXED_POINT : 0;
+
+class CheckpointWriter {
+public:
+    template <typename T>
+    void put(const T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "put() takes plain values");
+        bytes_.append(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    void put_string(std::string_view s) {
+        put<std::uint32_t>(static_cast<std::uint32_t>(s.size()));
+        bytes_.append(s.data(), s.size());
+    }
+
+    // n raw bytes, read back with CheckpointReader::get_bytes()
+    void put_bytes(const void* data, size_t n) {
+        bytes_.append(static_cast<const char*>(data), n);
+    }
+
+    void put_time(TimePoint tp) {
+        put<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count());
+    }
+
+    const std::string& bytes() const { return bytes_; }
+
+private:
+    friend class Checkpoint;   // load() fills sections in directly
+    std::string bytes_;
+};
+
+class CheckpointReader {
+public:
+    CheckpointReader(std::string_view section, std::string_view bytes) : section_(section), bytes_(bytes) {}
+
+    template <typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "get() returns plain values");
+        T v;
+        std::memcpy(&v, take(sizeof(T)), sizeof(T));
+        return v;
+    }
+
+    std::string get_string() {
+        const auto n = get<std::uint32_t>();
+        return std::string(take(n), n);
+    }
+
+    // Next n raw bytes, as a view into the section
+    std::string_view get_bytes(size_t n) { return std::string_view(take(n), n); }
+
+    TimePoint get_time() {
+        return TimePoint(std::chrono::duration_cast<TimePoint::duration>(
+            std::chrono::nanoseconds(get<std::int64_t>())));
+    }
+
+    bool done() const { return pos_ == bytes_.size(); }
+
+    // Throw a std::runtime_error naming the section
+    [[noreturn]] void fail(const std::string& why) const {
+        throw std::runtime_error("Checkpoint section '" + std::string(section_) + "': " + why);
+    }
+
+private:
+    std::string_view section_;
+    std::string_view bytes_;
+    size_t pos_{0};
+
+    const char* take(size_t n) {
+        if (bytes_.size() - pos_ < n) fail("truncated");
+        const char* p = bytes_.data() + pos_;
+        pos_ += n;
+        return p;
+    }
+};
+
+class Checkpoint {
+public:
+    // Writer for a new (or replaced) section
+    CheckpointWriter& section(const std::string& name) {
+        auto& w = sections_[name];
+        w = CheckpointWriter();
+        return w;
+    }
+
+    bool has(const std::string& name) const { return sections_.count(name) != 0; }
+
+    // Reader over a section; throws if it is missing. Valid while the Checkpoint is.
+    CheckpointReader reader(const std::string& name) const {
+        auto it = sections_.find(name);
+        if (it == sections_.end()) throw std::runtime_error("Checkpoint: no section '" + name + "'");
+        return CheckpointReader(it->first, it->second.bytes());
+    }
+
+    // Total size of the section blobs
+    size_t size() const;
+
+    void save(const std::string& path) const;
+    static Checkpoint load(const std::string& path);
+
+private:
+    std::map<std::string, CheckpointWriter> sections_;
+};
+
+}  // namespace eng
@@ -1,14 +1,17 @@
 #pragma once
 
+#include "Checkpoint.hpp"
 #include "EventBus.hpp"
 #include "IStrategy.hpp"
 #include "IBroker.hpp"
 #include "IMarketData.hpp"
 #include "ProviderMarketData.hpp"
+#include "StrategyFanOut.hpp"
 
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <optional>
 
 
 namespace eng {
@@ -21,10 +24,45 @@ public:
     void set_broker(std::unique_ptr<IBroker> brkr);
     void set_market_data(std::unique_ptr<ProviderMarketData> md);
 
+    // Fan-out mode (see StrategyFanOut.hpp): many strategies, each group of
+    // them on a worker thread of its own (pinned to `cpu` if >= 0), fed from
+    // one broadcast ring; their orders go through a single broker thread
+    // (set_broker_cpu). Exclusive with set_strategy(). Must be called
+    // before start()/run().
+    std::size_t add_strategy_worker(int cpu = -1);
+    std::size_t add_strategy(std::unique_ptr<IStrategy> strat, std::size_t worker);
+    void set_broker_cpu(int cpu);
+
+    // Run the strategy on its own bus worker thread instead of the tick
+    // publisher's. Must be called before start()/run().
+    void set_async_dispatch(EventBus::AsyncOptions opts) { async_dispatch_ = std::move(opts); }
+
     // Get a reference to the EventBus for external subscribers (e.g., FrontendBridge)
     EventBus& get_bus() { return bus_; }
 
-    // Start the engine; returns when shutting down
+    // Per-tick/per-order logging to stdout (on by default). Batch runs turn
+    // it off; with many engines in one process the shared stream serializes them.
+    void set_verbose(bool verbose) { verbose_ = verbose; }
+
+    // Wire strategy and broker to the bus and return immediately; ticks
+    // published afterwards drive the strategy. Returns false if a strategy,
+    // broker or market data stream is missing. Safe to call more than once.
+    bool start();
+
+    // Block until async bus subscribers and fan-out strategies have caught
+    // up with everything published so far. Only meaningful once the feed stops.
+    void wait_idle();
+
+    // Checkpoints: the broker ("broker") and every strategy ("strategy.<n>",
+    // in the order they were added). Only at a quiet point: on the tick
+    // publisher's thread, after wait_idle(). False if the broker or a
+    // strategy can't be checkpointed.
+    bool save_state(Checkpoint& cp) const;
+    // Restore them before start(); throws std::runtime_error if the
+    // checkpoint was taken with other strategies or another broker
+    void load_state(const Checkpoint& cp);
+
+    // start(), then block until request_shutdown()
     void run();
 
     // Request shutdown - safe to call from signal handlers
@@ -39,6 +77,14 @@ private:
     std::unique_ptr<IBroker>   broker_;
     std::unique_ptr<ProviderMarketData> market_data_;
     std::atomic<bool> shutdown_requested_{false};
+    std::optional<EventBus::AsyncOptions> async_dispatch_;
+    bool verbose_{true};
+    bool started_{false};
+    std::unique_ptr<StrategyFanOut> fan_out_;   // Last: its threads use broker_
+
+    // The single strategy, or the fan-out's
+    std::size_t strategy_count() const;
+    IStrategy& strategy_at(std::size_t i) const;
 
 };
 
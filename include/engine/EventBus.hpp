@@ -1,23 +1,95 @@
 #pragma once
 #include <string>
 #include <any>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
+#include "BoundedQueue.hpp"
+#include "Logger.hpp"
 
 namespace eng {
 
 struct Event {
     std::string type;
-    std::any data; 
+    std::any data;
 };
 
 
+/*
+ * Two ways to use the bus:
+ *
+ *  - String topics + Event/std::any: subscribe("OrderFilled", ...) / publish(Event{...}).
+ *    Flexible, but every publish hashes the topic and copies the payload into
+ *    the any (a heap allocation for anything bigger than a pointer). Fine for
+ *    low-rate events (lifecycle); publishers can skip building the Event when
+ *    has_subscribers(topic) is false.
+ *
+ *  - Typed channels: subscribe<TradePrint>(...) / publish(tp). One channel per
+ *    payload type, looked up by a dense per-type index; handlers get a
+ *    const T& to the publisher's object. No hashing, no copies, no allocation.
+ *    Use this for the per-trade / per-tick hot path.
+ *
+ * The two are independent: a typed publish reaches typed subscribers only.
+ *
+ * Threading: publish/subscribe/unsubscribe may be called from any thread.
+ * Handler lists are copy-on-write snapshots, so publish holds a shared lock
+ * only long enough to grab the snapshot and handlers run with no lock held
+ * (they may publish or subscribe themselves).
+ *
+ * Inline handlers run on the publisher's thread. subscribe_async<T>() instead
+ * gives the subscriber its own bounded lock-free queue and worker thread, so
+ * a slow consumer (SQLite, websocket fan-out) can't stall the publisher; the
+ * publisher only pays for copying T into the queue. What happens when the
+ * queue is full is set per subscriber (see Backpressure).
+ */
 class EventBus {
 public:
     using Handler   = std::function<void(const Event&)>;
     using HandlerId = std::uint64_t;
 
+    template <typename T>
+    using TypedHandler = std::function<void(const T&)>;
+
+    // What an async subscriber's queue does when it is full
+    enum class Backpressure {
+        Block,       // Publisher waits for space (lossless; a slow consumer throttles producers)
+        DropNewest,  // Discard the event being published
+        DropOldest   // Evict the oldest queued event to make room
+    };
+
+    struct AsyncOptions {
+        std::string name{"async"};          // Label for queue_stats() and logs
+        std::size_t capacity{1 << 14};      // Rounded up to a power of two
+        Backpressure policy{Backpressure::Block};
+    };
+
+    // Snapshot of one async subscriber's queue
+    struct QueueStats {
+        std::string name;
+        std::size_t capacity{0};
+        std::size_t depth{0};          // Events currently queued
+        std::size_t max_depth{0};      // High-water mark
+        std::uint64_t enqueued{0};     // Events accepted into the queue
+        std::uint64_t processed{0};    // Events the handler has finished
+        std::uint64_t dropped{0};      // Events discarded by DropNewest/DropOldest
+    };
+
+    EventBus() = default;
+    ~EventBus() { stop_async(); }
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
     // Subscribe to a topic. Returns an id you can use to unsubscribe.
     HandlerId subscribe(const std::string& topic, Handler handler);
 
@@ -27,10 +99,295 @@ public:
     // Publish an event to all handlers for its topic.
     void publish(const Event& ev) const;
 
+    // True if any handler is subscribed to the topic
+    bool has_subscribers(const std::string& topic) const;
+
+    // ---- Typed channels ----
+
+    // Subscribe to every published T. Returns an id you can use to unsubscribe<T>.
+    template <typename T>
+    HandlerId subscribe(TypedHandler<T> handler) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        const HandlerId id = next_id_++;
+        add_typed_handler<T>(id, std::move(handler));
+        return id;
+    }
+
+    // Subscribe inline, or on a dedicated queue/thread when async is set.
+    template <typename T>
+    HandlerId subscribe(TypedHandler<T> handler, const std::optional<AsyncOptions>& async) {
+        return async ? subscribe_async<T>(std::move(handler), *async)
+                     : subscribe<T>(std::move(handler));
+    }
+
+    /**
+     * Subscribe to T on a dedicated worker thread. Each publish copies the
+     * event into this subscriber's queue; the handler runs on the worker in
+     * publish order (per producer).
+     *
+     * A handler must not publish T back into its own queue with Block
+     * policy: a full queue would then wait on itself.
+     */
+    template <typename T>
+    HandlerId subscribe_async(TypedHandler<T> handler, AsyncOptions opts = {}) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        const HandlerId id = next_id_++;
+        auto worker = std::make_unique<AsyncWorker<T>>(id, std::move(handler), std::move(opts));
+        AsyncWorker<T>* w = worker.get();
+        add_typed_handler<T>(id, [w](const T& value) { w->push(value); });
+        workers_.push_back(std::move(worker));
+        return id;
+    }
+
+    // Unsubscribe a typed handler; returns true if a handler was removed.
+    // For async subscribers this drains and joins the worker.
+    template <typename T>
+    bool unsubscribe(HandlerId id) {
+        AsyncWorkerBase* worker = nullptr;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            const std::size_t idx = type_index<T>();
+            if (idx >= channels_.size() || !channels_[idx]) return false;
+            auto& chan = static_cast<Channel<T>&>(*channels_[idx]);
+            auto list = std::make_shared<TypedList<T>>(*chan.handlers);
+            bool removed = false;
+            for (auto vit = list->begin(); vit != list->end(); ++vit) {
+                if (vit->first == id) { list->erase(vit); removed = true; break; }
+            }
+            if (!removed) return false;
+            chan.handlers = std::move(list);
+            for (auto& w : workers_) {
+                if (w->id() == id) { worker = w.get(); break; }
+            }
+        }
+        if (worker) worker->stop();  // Outside the lock: the handler may still be publishing
+        return true;
+    }
+
+    // Publish value to all handlers subscribed to T.
+    template <typename T>
+    void publish(const T& value) const {
+        std::shared_ptr<const TypedList<T>> snapshot;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            const std::size_t idx = type_index<T>();
+            if (idx >= channels_.size() || !channels_[idx]) return;
+            snapshot = static_cast<const Channel<T>&>(*channels_[idx]).handlers;
+        }
+        for (auto& pair : *snapshot) {
+            pair.second(value); // invoke handler
+        }
+    }
+
+    // ---- Async subscriber control ----
+
+    // Block until every async queue is empty and its handler has returned.
+    // Only meaningful once producers have stopped publishing.
+    void wait_idle() const;
+
+    // Drain and join all async workers. Called by the destructor; call it
+    // earlier if subscribers are destroyed before the bus.
+    void stop_async();
+
+    // Depth/throughput counters for every async subscriber.
+    std::vector<QueueStats> queue_stats() const;
+
 private:
-    std::unordered_map<std::string,
-        std::vector<std::pair<HandlerId, Handler>>> handlers_;
+    template <typename T>
+    using TypedList = std::vector<std::pair<HandlerId, TypedHandler<T>>>;
+    using HandlerList = std::vector<std::pair<HandlerId, Handler>>;
+
+    struct ChannelBase {
+        virtual ~ChannelBase() = default;
+    };
+
+    template <typename T>
+    struct Channel : ChannelBase {
+        std::shared_ptr<const TypedList<T>> handlers{std::make_shared<TypedList<T>>()};
+    };
+
+    struct AsyncWorkerBase {
+        virtual ~AsyncWorkerBase() = default;
+        virtual HandlerId id() const = 0;
+        virtual void stop() = 0;
+        virtual bool idle() const = 0;
+        virtual QueueStats stats() const = 0;
+    };
+
+    template <typename T>
+    class AsyncWorker : public AsyncWorkerBase {
+    public:
+        AsyncWorker(HandlerId id, TypedHandler<T> handler, AsyncOptions opts)
+            : id_(id), handler_(std::move(handler)), opts_(std::move(opts)),
+              queue_(opts_.capacity) {
+            thread_ = std::thread([this] { run(); });
+        }
+
+        ~AsyncWorker() override { stop(); }
+
+        HandlerId id() const override { return id_; }
+
+        // Called on the publisher's thread. The push is counted in flight
+        // before running_ is checked (both seq_cst), so a publisher racing
+        // stop() either sees it cleared and backs off, or is waited for by
+        // the worker's final drain; nothing is left in the queue unprocessed.
+        void push(const T& value) {
+            pushers_.fetch_add(1);
+            if (running_.load()) enqueue(value);
+            pushers_.fetch_sub(1);
+        }
+
+        void stop() override {
+            if (!running_.exchange(false)) return;
+            {
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+                wake_cv_.notify_one();
+            }
+            if (thread_.joinable()) thread_.join();
+        }
+
+        bool idle() const override {
+            return enqueued_.load(std::memory_order_acquire) ==
+                   processed_.load(std::memory_order_acquire) + evicted_.load(std::memory_order_acquire);
+        }
+
+        QueueStats stats() const override {
+            QueueStats s;
+            s.name = opts_.name;
+            s.capacity = queue_.capacity();
+            s.depth = queue_.size_approx();
+            s.max_depth = max_depth_.load(std::memory_order_relaxed);
+            s.enqueued = enqueued_.load(std::memory_order_relaxed);
+            s.processed = processed_.load(std::memory_order_relaxed);
+            s.dropped = dropped_.load(std::memory_order_relaxed);
+            return s;
+        }
+
+    private:
+        static constexpr int SPIN_BEFORE_SLEEP = 256;
+
+        HandlerId id_;
+        TypedHandler<T> handler_;
+        AsyncOptions opts_;
+        BoundedQueue<T> queue_;
+        std::thread thread_;
+        std::atomic<bool> running_{true};
+        std::atomic<bool> sleeping_{false};
+        std::mutex wake_mutex_;
+        std::condition_variable wake_cv_;
+        std::atomic<std::uint64_t> enqueued_{0};
+        std::atomic<std::uint64_t> processed_{0};
+        std::atomic<std::uint64_t> dropped_{0};
+        std::atomic<std::uint64_t> evicted_{0};
+        std::atomic<std::size_t> max_depth_{0};
+        std::atomic<std::size_t> pushers_{0};   // push() calls in progress
+
+        // push() past the running_ check
+        void enqueue(const T& value) {
+            switch (opts_.policy) {
+                case Backpressure::Block:
+                    while (!queue_.try_push(value)) {
+                        if (!running_.load(std::memory_order_acquire)) return;
+                        std::this_thread::yield();
+                    }
+                    break;
+                case Backpressure::DropNewest:
+                    if (!queue_.try_push(value)) {
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+                    break;
+                case Backpressure::DropOldest:
+                    while (!queue_.try_push(value)) {
+                        T evicted;
+                        if (queue_.try_pop(evicted)) {
+                            dropped_.fetch_add(1, std::memory_order_relaxed);
+                            evicted_.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                    break;
+            }
+            enqueued_.fetch_add(1, std::memory_order_release);
+
+            std::size_t depth = queue_.size_approx();
+            std::size_t prev = max_depth_.load(std::memory_order_relaxed);
+            while (depth > prev && !max_depth_.compare_exchange_weak(prev, depth, std::memory_order_relaxed)) {}
+
+            if (sleeping_.load(std::memory_order_acquire)) {
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+                wake_cv_.notify_one();
+            }
+        }
+
+        void run() {
+            T item;
+            int idle_spins = 0;
+            while (true) {
+                if (queue_.try_pop(item)) {
+                    dispatch(item);
+                    idle_spins = 0;
+                    continue;
+                }
+                if (!running_.load(std::memory_order_acquire)) break;
+                if (++idle_spins < SPIN_BEFORE_SLEEP) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                // Park until a publisher wakes us; the timeout covers a
+                // wakeup racing with sleeping_ being set.
+                std::unique_lock<std::mutex> lock(wake_mutex_);
+                sleeping_.store(true, std::memory_order_release);
+                if (queue_.size_approx() == 0 && running_.load(std::memory_order_acquire)) {
+                    wake_cv_.wait_for(lock, std::chrono::milliseconds(1));
+                }
+                sleeping_.store(false, std::memory_order_release);
+                idle_spins = 0;
+            }
+            // Drain whatever was queued before stop(), once no publisher
+            // that got past the running_ check is still pushing
+            while (pushers_.load() != 0) std::this_thread::yield();
+            while (queue_.try_pop(item)) dispatch(item);
+        }
+
+        void dispatch(const T& item) {
+            try {
+                handler_(item);
+            } catch (const std::exception& e) {
+                ENG_LOG_ERROR("[EventBus] async handler '" << opts_.name << "' threw: " << e.what());
+            }
+            processed_.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    // Dense process-wide index per payload type, assigned on first use
+    static std::size_t next_type_index() {
+        static std::atomic<std::size_t> counter{0};
+        return counter++;
+    }
+
+    template <typename T>
+    static std::size_t type_index() {
+        static const std::size_t idx = next_type_index();
+        return idx;
+    }
+
+    // Requires mutex_ held exclusively
+    template <typename T>
+    void add_typed_handler(HandlerId id, TypedHandler<T> handler) {
+        const std::size_t idx = type_index<T>();
+        if (idx >= channels_.size()) channels_.resize(idx + 1);
+        if (!channels_[idx]) channels_[idx] = std::make_unique<Channel<T>>();
+        auto& chan = static_cast<Channel<T>&>(*channels_[idx]);
+        auto list = std::make_shared<TypedList<T>>(*chan.handlers);
+        list->emplace_back(id, std::move(handler));
+        chan.handlers = std::move(list);
+    }
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const HandlerList>> handlers_;
+    std::vector<std::unique_ptr<ChannelBase>> channels_;
+    std::vector<std::unique_ptr<AsyncWorkerBase>> workers_;
     HandlerId next_id_{1};
 };
 
-} // namespace eng
\ No newline at end of file
+} // namespace eng
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+EventCache:
+  In-memory read cache for CandleStore::query_events.
+
+  Per symbol it keeps one contiguous range of committed events (all event
+  types, sorted by timestamp) together with the exact [start_ms, end_ms] it
+  covers. A query inside the range is a binary search; a query that
+  overlaps or touches it only fetches the missing ends (missing()) and
+  grows the range, so panning across the chart reads each event once.
+  A query nowhere near the range replaces it.
+
+  The cache mirrors what is committed. The writer brackets every batch
+  with begin_commit()/end_commit(): committed events inside a cached range
+  are inserted in place, and each bracket bumps the symbol's generation.
+  A fetch read under an older generation, or landing while a batch is
+  being written, is dropped instead of merged, since it may or may not
+  have seen those rows.
+
+  Eviction is LRU over symbols with a budget in events.
+
+  Not thread-safe: CandleStore guards it with cache_mutex_.
+*/
+
+namespace eng {
+
+struct StoredEvent {
+  std::string event_type;      // 'OrderPlaced', 'OrderFilled', 'OrderRejected', etc.
+  long long timestamp_ms{0};
+  std::string symbol;
+  std::string source;          // 'live' or 'backtest'
+
+  // Order fields, stored in their own columns
+  long long order_id{0};
+  std::string side;            // 'Buy' / 'Sell' (empty if none)
+  double qty{0.0};             // Order qty; the filled qty for OrderFilled
+  double price{0.0};           // Fill price (0 if none)
+  std::string status;
+
+  nlohmann::json extra;        // Anything else (e.g. a rejection reason); null when none
+};
+
+class EventCache {
+public:
+  struct Stats {
+    uint64_t hits{0};
+    uint64_t partial_hits{0};    // Only the missing ends were fetched
+    uint64_t misses{0};
+    uint64_t evictions{0};
+    size_t events{0};
+  };
+
+  explicit EventCache(size_t max_events) : max_events_(max_events) {}
+
+  // Events in [start_ms, end_ms] of the given types (all when empty), if the
+  // cached range covers it. Returns false on a miss (out untouched).
+  bool lookup(const std::string& symbol, long long start_ms, long long end_ms,
+              const std::vector<std::string>& event_types, std::vector<StoredEvent>& out);
+
+  // Sub-ranges of [start_ms, end_ms] to fetch so that insert() can extend
+  // the cached range over it: the ends it doesn't cover, or the whole range
+  std::vector<std::pair<long long, long long>> missing(const std::string& symbol,
+                                                       long long start_ms, long long end_ms);
+
+  // Current write generation for a symbol; pass it back to insert()
+  uint64_t generation(const std::string& symbol);
+
+  // Cache fetched sub-ranges (each with all event types, sorted by
+  // timestamp). Dropped if the symbol had commits since `generation`.
+  void insert(const std::string& symbol,
+              std::vector<std::pair<std::pair<long long, long long>, std::vector<StoredEvent>>> fetched,
+              uint64_t generation);
+
+  // Around each writer batch. end_commit() with committed=false drops the
+  // batch's symbols, as part of it may have landed.
+  void begin_commit(const std::vector<StoredEvent>& events);
+  void end_commit(const std::vector<StoredEvent>& events, bool committed);
+
+  void clear();
+
+  const Stats& stats() const { return stats_; }
+
+private:
+  struct Range {
+    long long start_ms{0};
+    long long end_ms{-1};                // Inclusive; empty when end_ms < start_ms
+    std::vector<StoredEvent> events;
+    std::list<std::string>::iterator lru;
+  };
+
+  struct Series {
+    uint64_t generation{0};
+    size_t committing{0};                // Events of batches being written
+    bool cached{false};
+    Range range;
+  };
+
+  size_t max_events_;
+  std::unordered_map<std::string, Series> series_;
+  std::list<std::string> lru_;           // Symbols with a cached range, most recent first
+  Stats stats_;
+
+  void touch(Series& s, const std::string& symbol);
+  void drop(Series& s);
+  void evict();
+};
+
+}  // namespace eng
@@ -0,0 +1,96 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+
+/*
+FixedPoint:
+  Number types for broker accounting and bar aggregation, chosen at compile
+  time.
+
+  By default Price, Quantity and Money are plain doubles. Configure with
+  -DENG_FIXED_POINT=ON and they become Fixed: an int64 count of 1e-8 ticks,
+  so sums, compares and min/max are exact integer ops and a position that
+  was bought and sold back in pieces nets to exactly zero. 1e-8 is finer
+  than any Kraken price or lot increment, so every value on the tape lands
+  on the grid; the range is +/-9.2e10, plenty for cash balances.
+
+  Market data and orders stay double at the interfaces (TradePrint, Order,
+  IBroker); code converts at its edge with Price(x) / Quantity(x) (rounds to
+  the nearest tick, or is a no-op in double builds) and to_double(). Write
+  price * qty as notional(price, qty): exact in fixed builds (128-bit
+  product, rounded once).
+*/
+
+#ifndef ENG_FIXED_POINT
+#define ENG_FIXED_POINT 0
+#endif
+
+namespace eng {
+
+/**
+ * Fixed
+ *
+ * Signed decimal fixed-point value: ticks() units of 10^-kDecimals.
+ * Trivially copyable, so it fits in std::atomic and checkpoints as is.
+ */
+class Fixed {
+public:
+    static constexpr int kDecimals = 8;
+    static constexpr std::int64_t kScale = 100'000'000;
+
+    constexpr Fixed() = default;
+    // Nearest tick, halves away from zero
+    explicit Fixed(double v) : ticks_(std::llround(v * static_cast<double>(kScale))) {}
+
+    static constexpr Fixed from_ticks(std::int64_t ticks) { Fixed f; f.ticks_ = ticks; return f; }
+    constexpr std::int64_t ticks() const { return ticks_; }
+    constexpr double to_double() const { return static_cast<double>(ticks_) / static_cast<double>(kScale); }
+
+    constexpr Fixed operator-() const { return from_ticks(-ticks_); }
+    constexpr Fixed operator+(Fixed o) const { return from_ticks(ticks_ + o.ticks_); }
+    constexpr Fixed operator-(Fixed o) const { return from_ticks(ticks_ - o.ticks_); }
+    Fixed& operator+=(Fixed o) { ticks_ += o.ticks_; return *this; }
+    Fixed& operator-=(Fixed o) { ticks_ -= o.ticks_; return *this; }
+
+    constexpr bool operator==(Fixed o) const { return ticks_ == o.ticks_; }
+    constexpr bool operator!=(Fixed o) const { return ticks_ != o.ticks_; }
+    constexpr bool operator<(Fixed o) const { return ticks_ < o.ticks_; }
+    constexpr bool operator<=(Fixed o) const { return ticks_ <= o.ticks_; }
+    constexpr bool operator>(Fixed o) const { return ticks_ > o.ticks_; }
+    constexpr bool operator>=(Fixed o) const { return ticks_ >= o.ticks_; }
+
+private:
+    std::int64_t ticks_{0};
+};
+
+inline std::ostream& operator<<(std::ostream& os, Fixed f) { return os << f.to_double(); }
+
+constexpr double to_double(double v) { return v; }
+constexpr double to_double(Fixed f) { return f.to_double(); }
+
+__extension__ typedef __int128 FixedWide;   // (quiet under -Wpedantic)
+
+// a * b on the tick grid, rounded half away from zero
+inline Fixed notional(Fixed a, Fixed b) {
+    const FixedWide p = static_cast<FixedWide>(a.ticks()) * b.ticks();
+    const FixedWide half = Fixed::kScale / 2;
+    return Fixed::from_ticks(static_cast<std::int64_t>((p >= 0 ? p + half : p - half) / Fixed::kScale));
+}
+constexpr double notional(double a, double b) { return a * b; }
+
+#if ENG_FIXED_POINT
+using Price = Fixed;
+using Quantity = Fixed;
+using Money = Fixed;
+#else
+using Price = double;
+using Quantity = double;
+using Money = double;
+#endif
+
+// Net position the engine treats as flat when gating sells. Double sums
+// leave dust (0.03 - 0.01 * 3 != 0); fixed-point positions are exact.
+constexpr double kFlatPosition = ENG_FIXED_POINT ? 0.0 : 0.001;
+
+}  // namespace eng
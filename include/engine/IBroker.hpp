@@ -1,5 +1,7 @@
 #pragma once
+#include "engine/Checkpoint.hpp"
 #include "engine/Types.hpp"
+#include "engine/MarketDataTypes.hpp"
 #include <string>
 #include <functional>
 #include <memory>
@@ -34,8 +36,19 @@ public:
         // default: not executed
         return 0.0;
     }
+    // Brokers that fill resting orders later (against the replayed tape, say)
+    // report those fills through this handler. The Order carries the
+    // quantity and price of that one fill in qty / fill_price.
+    using FillHandler = std::function<void(const Order&)>;
+    virtual void set_fill_handler(FillHandler /*handler*/) {}
+
+    // Market data for brokers that simulate fills against it; the engine
+    // calls this for every tick before the strategy sees it. Any fills are
+    // reported through the fill handler before this returns.
+    virtual void on_market_tick(const Tick& /*tick*/) {}
+
     virtual double get_balance() = 0;
-    virtual PriceData get_current_price(const std::string& symbol) = 0;
+    virtual PriceQuote get_current_price(const std::string& symbol) = 0;
     
     // Get all current positions (symbol -> quantity)
     // Default implementation returns empty map for brokers that don't track positions
@@ -48,6 +61,25 @@ public:
     virtual std::vector<Order> get_orders() const {
         return {};
     }
+
+    // Orders with id > after_id, oldest first, at most `limit` (0 = no limit).
+    // Lets callers page through or tail the history instead of copying all of it.
+    virtual std::vector<Order> get_orders_since(uint64_t after_id, size_t limit = 0) const {
+        std::vector<Order> out;
+        for (auto& o : get_orders()) {
+            if (o.id <= after_id) continue;
+            out.push_back(std::move(o));
+            if (limit != 0 && out.size() == limit) break;
+        }
+        return out;
+    }
+    // Checkpoints (see Checkpoint.hpp): balances, positions and order
+    // history, so a restart carries on from this point. False if the broker
+    // can't (the default). Called between orders, from the order thread.
+    virtual bool save_state(CheckpointWriter& /*out*/) const { return false; }
+    // Restore what save_state() wrote, before the first order
+    virtual void load_state(CheckpointReader& in) { in.fail("this broker can't restore checkpoints"); }
+
     /*
     virtual void subscribe_to_ticks(const std::string& symbol,
                                     std::function<void(const PriceData&)> cb) = 0;
@@ -1,5 +1,6 @@
 #pragma once
 #include "engine/MarketDataTypes.hpp"
+#include "engine/TickStore.hpp"
 #include <functional>
 #include <string>
 #include <vector>
@@ -65,21 +66,34 @@ public:
         return nullptr;  // Default: not available
     }
 
+    // Recent-trade history (see TickStore). Adapters append every trade they
+    // emit to it; the candle queries below are answered from it.
+    void set_tick_store(std::shared_ptr<TickStore> store) { tick_store_ = std::move(store); }
+    const std::shared_ptr<TickStore>& tick_store() const { return tick_store_; }
+
     // Historical/backfill (e.g., for warm-up / indicators / backtest)
-    
+    // Default: built from the tick store (empty without one)
     virtual std::vector<Candle> get_hist_candles(
         const std::string& symbol,
         const std::string& interval,   // "1m","5m","1h","1d", etc.
-        int limit) = 0;                 // last N bars
+        int limit) {                   // last N bars
+        if (!tick_store_) return {};
+        return tick_store_->last_candles(symbol, TickStore::parse_interval(interval), limit);
+    }
 
-    // Backtest-friendly candle query by time range
+    // Backtest-friendly candle query by time range: 1m candles from `since`
     virtual std::vector<Candle> get_candles(
-        const std::string& /*symbol*/,
-        TimePoint /*since*/,
-        int /*count*/ = -1) const {
-        return {};  // Default: not available
+        const std::string& symbol,
+        TimePoint since,
+        int count = -1) const {
+        if (!tick_store_) return {};
+        return tick_store_->candles(symbol, DEFAULT_CANDLE_MS, since, count);
     }
-    
+
+    static constexpr long long DEFAULT_CANDLE_MS = 60 * 1000;
+
+protected:
+    std::shared_ptr<TickStore> tick_store_;
 };
 
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
+#include "engine/Checkpoint.hpp"
 #include "engine/Types.hpp"
+#include <cstddef>
 
 namespace eng {
 
@@ -8,11 +10,32 @@ public:
     virtual void on_price_tick(const PriceData&) = 0;
     virtual TradeAction get_trade_action() = 0;
     virtual void on_order_fill(const Order&) = 0;
+
+    // Feed ticks[0..n) in order, stopping after the first one that yields an
+    // action. Returns how many were consumed; `action` is the last one's.
+    // Strategies behind a boundary (plugins) override it to take a whole
+    // span in one call; the engine calls it once per tick.
+    virtual size_t on_price_ticks(const PriceData* ticks, size_t n, TradeAction& action) {
+        action = TradeAction::None;
+        for (size_t i = 0; i < n; ++i) {
+            on_price_tick(ticks[i]);
+            action = get_trade_action();
+            if (action != TradeAction::None) return i + 1;
+        }
+        return n;
+    }
     
     // Get current net position (total bought - total sold)
     // Used by engine to validate sell orders before submission
     // Compatible with: long/short equities, crypto, futures, options (delta-adjusted)
     virtual double get_net_position() const { return 0.0; }
+
+    // Checkpoints (see Checkpoint.hpp): write everything needed to carry on
+    // from exactly this point. False if the strategy can't (the default).
+    virtual bool save_state(CheckpointWriter& /*out*/) const { return false; }
+    // Restore what save_state() wrote, into a strategy built with the same
+    // parameters; throws std::runtime_error if it doesn't match
+    virtual void load_state(CheckpointReader& in) { in.fail("this strategy can't restore checkpoints"); }
     
     virtual ~IStrategy() = default;
 };
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "MarketDataTypes.hpp"
+
+namespace eng {
+
+/**
+ * ITradeSource
+ *
+ * Pull-style trade stream, in timestamp order, consumed in batches. It is
+ * the replay counterpart of IMarketData's push callbacks: a merge (see
+ * TradeMerger) decides when to read from each source instead of every
+ * source driving its own loop.
+ *
+ * read() overwrites out[0..n) in place and returns n; callers hand back
+ * the same slots every time, so string/map storage inside each TradePrint
+ * is recycled and a steady-state replay does not allocate.
+ */
+class ITradeSource {
+public:
+    virtual ~ITradeSource() = default;
+
+    /**
+     * Fill up to max_trades slots starting at out.
+     * @return Number of trades written; 0 means the source is exhausted
+     */
+    virtual size_t read(TradePrint* out, size_t max_trades) = 0;
+
+    // Label for logs (usually the file path)
+    virtual std::string name() const = 0;
+};
+
+} // namespace eng
@@ -1,11 +1,17 @@
 #pragma once
+#include <algorithm>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <vector>
+#include "Checkpoint.hpp"
 #include "MarketDataTypes.hpp"
 
 namespace eng {
 
+// Thread-safe: replay sources may register instruments from their prefetch
+// threads. Returned references stay valid (map nodes don't move) until clear().
 class InstrumentRegistry {
 public:
     InstrumentRegistry() : _next_id(1) {}
@@ -21,6 +27,7 @@ public:
         const std::string& exchange = "UNKNOWN",
         const std::string& currency = "USD"
     ) {
+        std::lock_guard<std::mutex> lock(_mutex);
         auto it = _symbol_to_id.find(symbol);
         if (it != _symbol_to_id.end()) {
             return it->second;
@@ -44,6 +51,7 @@ public:
      * Throws std::out_of_range if not found.
      */
     const Instrument& get(InstrumentId id) const {
+        std::lock_guard<std::mutex> lock(_mutex);
         return _instruments.at(id);
     }
 
@@ -52,6 +60,7 @@ public:
      * Throws std::out_of_range if not found.
      */
     const Instrument& get(const std::string& symbol) const {
+        std::lock_guard<std::mutex> lock(_mutex);
         InstrumentId id = _symbol_to_id.at(symbol);
         return _instruments.at(id);
     }
@@ -61,6 +70,7 @@ public:
      * Returns nullptr if not found.
      */
     const Instrument* try_get(InstrumentId id) const {
+        std::lock_guard<std::mutex> lock(_mutex);
         auto it = _instruments.find(id);
         return (it != _instruments.end()) ? &it->second : nullptr;
     }
@@ -70,6 +80,7 @@ public:
      * Returns nullptr if not found.
      */
     const Instrument* try_get(const std::string& symbol) const {
+        std::lock_guard<std::mutex> lock(_mutex);
         auto it = _symbol_to_id.find(symbol);
         if (it == _symbol_to_id.end()) {
             return nullptr;
@@ -83,6 +94,7 @@ public:
      * Returns 0 if not found.
      */
     InstrumentId lookup_id(const std::string& symbol) const {
+        std::lock_guard<std::mutex> lock(_mutex);
         auto it = _symbol_to_id.find(symbol);
         return (it != _symbol_to_id.end()) ? it->second : 0;
     }
@@ -92,6 +104,7 @@ public:
      * Throws std::out_of_range if not found.
      */
     void set_metadata(InstrumentId id, const std::string& key, const std::string& value) {
+        std::lock_guard<std::mutex> lock(_mutex);
         _instruments.at(id).metadata[key] = value;
     }
 
@@ -99,6 +112,7 @@ public:
      * Clear all instruments.
      */
     void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
         _instruments.clear();
         _symbol_to_id.clear();
         _next_id = 1;
@@ -108,13 +122,64 @@ public:
      * Get total number of registered instruments.
      */
     size_t size() const {
+        std::lock_guard<std::mutex> lock(_mutex);
         return _instruments.size();
     }
 
+    /**
+     * Checkpoints: every instrument, in id order. Everything else in a
+     * checkpoint keys state by these ids, so they must come back unchanged.
+     */
+    void save_state(CheckpointWriter& out) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<const Instrument*> by_id;
+        for (const auto& [id, instr] : _instruments) by_id.push_back(&instr);
+        std::sort(by_id.begin(), by_id.end(), [](auto* a, auto* b) { return a->id < b->id; });
+        out.put<uint64_t>(by_id.size());
+        for (const Instrument* instr : by_id) {
+            out.put<InstrumentId>(instr->id);
+            out.put_string(instr->symbol);
+            out.put<int32_t>(static_cast<int32_t>(instr->asset_class));
+            out.put_string(instr->exchange);
+            out.put_string(instr->currency);
+            out.put<uint64_t>(instr->metadata.size());
+            for (const auto& [key, value] : instr->metadata) {
+                out.put_string(key);
+                out.put_string(value);
+            }
+        }
+    }
+
+    /**
+     * Re-register a checkpoint's instruments under their saved ids. Call
+     * before anything else registers; throws std::runtime_error if an
+     * instrument would get another id.
+     */
+    void load_state(CheckpointReader& in) {
+        const auto count = in.get<uint64_t>();
+        for (uint64_t i = 0; i < count; ++i) {
+            const auto id = in.get<InstrumentId>();
+            const std::string symbol = in.get_string();
+            const auto asset_class = static_cast<AssetClass>(in.get<int32_t>());
+            const std::string exchange = in.get_string();
+            const std::string currency = in.get_string();
+            if (register_instrument(symbol, asset_class, exchange, currency) != id) {
+                in.fail("instrument " + symbol + " is already registered under another id");
+            }
+            const auto entries = in.get<uint64_t>();
+            for (uint64_t k = 0; k < entries; ++k) {
+                const std::string key = in.get_string();
+                set_metadata(id, key, in.get_string());
+            }
+        }
+        if (!in.done()) in.fail("unexpected trailing data");
+    }
+
 private:
     std::unordered_map<InstrumentId, Instrument> _instruments;
     std::unordered_map<std::string, InstrumentId> _symbol_to_id;
     InstrumentId _next_id{1};
+    mutable std::mutex _mutex;
 };
 
 }
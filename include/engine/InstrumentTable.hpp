@@ -0,0 +1,90 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "MarketDataTypes.hpp"
+
+namespace eng {
+
+/**
+ * InstrumentTable
+ *
+ * Per-instrument state stored in a flat array indexed by the dense
+ * InstrumentId from InstrumentRegistry, so the per-trade lookup is an index
+ * instead of a string hash. Each slot remembers its symbol for the edges
+ * (persistence, frontend, logging).
+ *
+ * Events that arrive without an id (instrument_id == 0, e.g. from an adapter
+ * that doesn't use the registry) fall back to a symbol-keyed map.
+ */
+template <typename T>
+class InstrumentTable {
+public:
+    struct Slot {
+        std::string  symbol;
+        InstrumentId id{0};
+        T            value{};
+        bool         used{false};
+    };
+
+    /**
+     * Slot for an instrument, created on first use.
+     * The symbol is only copied when the slot is created.
+     */
+    Slot& get(InstrumentId id, const std::string& symbol) {
+        Slot* slot;
+        if (id != 0) {
+            if (id >= by_id_.size()) by_id_.resize(id + 1);
+            slot = &by_id_[id];
+        } else {
+            slot = &by_symbol_[symbol];
+        }
+        if (!slot->used) {
+            slot->symbol = symbol;
+            slot->id = id;
+            slot->used = true;
+        }
+        return *slot;
+    }
+
+    // Existing slot or nullptr
+    const Slot* find(InstrumentId id, const std::string& symbol) const {
+        if (id != 0) {
+            return (id < by_id_.size() && by_id_[id].used) ? &by_id_[id] : nullptr;
+        }
+        auto it = by_symbol_.find(symbol);
+        return it != by_symbol_.end() ? &it->second : nullptr;
+    }
+
+    // Visit every used slot: f(Slot&)
+    template <typename F>
+    void for_each(F&& f) {
+        for (auto& slot : by_id_) {
+            if (slot.used) f(slot);
+        }
+        for (auto& [symbol, slot] : by_symbol_) {
+            f(slot);
+        }
+    }
+
+    template <typename F>
+    void for_each(F&& f) const {
+        for (const auto& slot : by_id_) {
+            if (slot.used) f(slot);
+        }
+        for (const auto& [symbol, slot] : by_symbol_) {
+            f(slot);
+        }
+    }
+
+    void clear() {
+        by_id_.clear();
+        by_symbol_.clear();
+    }
+
+private:
+    std::vector<Slot> by_id_;
+    std::unordered_map<std::string, Slot> by_symbol_;
+};
+
+}  // namespace eng
@@ -0,0 +1,164 @@
+#pragma once
+#include "engine/BoundedQueue.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+/*
+Logger:
+  Process-wide asynchronous logger. Call sites use the ENG_LOG_* macros:
+
+    ENG_LOG_DEBUG("[NullBroker] Filled " << qty << " " << symbol);
+
+  Two filters, cheapest first:
+    - Compile time: levels below ENG_LOG_LEVEL are compiled out entirely;
+      the stream expression is never evaluated. The floor defaults to DEBUG
+      when ENG_DEBUG is defined (Debug builds) and INFO otherwise; set the
+      ENG_LOG_LEVEL cache variable (TRACE..OFF) to override it.
+    - Run time: Logger::instance().set_level() raises the floor further
+      (one relaxed load per call site).
+
+  A line that passes both is formatted into a thread-local buffer and
+  pushed into a lock-free MPSC ring (BoundedQueue). A background thread
+  writes lines to stdout (TRACE..INFO) or stderr (WARN, ERROR). Producers
+  never block and never touch the terminal: if the ring is full the line is
+  dropped and counted, and the writer reports the count.
+*/
+
+#define ENG_LOG_LEVEL_TRACE 0
+#define ENG_LOG_LEVEL_DEBUG 1
+#define ENG_LOG_LEVEL_INFO  2
+#define ENG_LOG_LEVEL_WARN  3
+#define ENG_LOG_LEVEL_ERROR 4
+#define ENG_LOG_LEVEL_OFF   5
+
+#ifndef ENG_LOG_LEVEL
+#ifdef ENG_DEBUG
+#define ENG_LOG_LEVEL ENG_LOG_LEVEL_DEBUG
+#else
+#define ENG_LOG_LEVEL ENG_LOG_LEVEL_INFO
+#endif
+#endif
+
+namespace eng {
+
+enum class LogLevel : int {
+    Trace = ENG_LOG_LEVEL_TRACE,
+    Debug = ENG_LOG_LEVEL_DEBUG,
+    Info  = ENG_LOG_LEVEL_INFO,
+    Warn  = ENG_LOG_LEVEL_WARN,
+    Error = ENG_LOG_LEVEL_ERROR,
+    Off   = ENG_LOG_LEVEL_OFF,
+};
+
+// "trace", "debug", "info", "warn", "error", "off"; throws std::invalid_argument otherwise
+LogLevel parse_log_level(const std::string& name);
+
+// One queued line (no trailing newline)
+struct LogRecord {
+    LogLevel level{LogLevel::Info};
+    std::string text;
+};
+
+class Logger {
+public:
+    struct Stats {
+        uint64_t written{0};
+        uint64_t dropped{0};     // Ring was full
+    };
+
+    // The process-wide logger; its writer thread starts on first use
+    static Logger& instance();
+
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    void set_level(LogLevel level) { level_.store(static_cast<int>(level), std::memory_order_relaxed); }
+    LogLevel level() const { return static_cast<LogLevel>(level_.load(std::memory_order_relaxed)); }
+
+    bool enabled(LogLevel level) const {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    // Queue one line; never blocks. The ring slot copy-assigns the record,
+    // so a caller that reuses its record (as LogLine does) doesn't allocate.
+    void write(const LogRecord& record);
+
+    // Block until everything queued so far has been written
+    void flush();
+
+    Stats stats() const;
+
+private:
+    static constexpr size_t kCapacity = 1 << 14;
+    static constexpr int SPIN_BEFORE_SLEEP = 256;
+
+    Logger();
+    void run();
+
+    std::atomic<int> level_{ENG_LOG_LEVEL};
+    BoundedQueue<LogRecord> queue_{kCapacity};
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> running_{true};
+    std::atomic<bool> sleeping_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::thread thread_;
+};
+
+/**
+ * One log statement: formats into a reused thread-local buffer and hands
+ * the finished line to the Logger when it goes out of scope.
+ * Use through the ENG_LOG_* macros.
+ */
+class LogLine {
+public:
+    explicit LogLine(LogLevel level);
+    ~LogLine();
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    std::ostream& stream() { return stream_; }
+
+private:
+    // Appends to a record whose text capacity survives between lines
+    class Buffer : public std::streambuf {
+    public:
+        LogRecord record;
+    protected:
+        int_type overflow(int_type ch) override;
+        std::streamsize xsputn(const char* s, std::streamsize n) override;
+    };
+
+    Buffer& buffer_;
+    std::ostream stream_;
+
+    static Buffer& thread_buffer();
+};
+
+}  // namespace eng
+
+#define ENG_LOG_AT(level_value, level, expr)                                   \
+    do {                                                                      \
+        if ((level_value) >= ENG_LOG_LEVEL &&                                 \
+            ::eng::Logger::instance().enabled(level)) {                       \
+            ::eng::LogLine eng_log_line_(level);                              \
+            eng_log_line_.stream() << expr;                                   \
+        }                                                                     \
+    } while (0)
+
+#define ENG_LOG_TRACE(expr) ENG_LOG_AT(ENG_LOG_LEVEL_TRACE, ::eng::LogLevel::Trace, expr)
+#define ENG_LOG_DEBUG(expr) ENG_LOG_AT(ENG_LOG_LEVEL_DEBUG, ::eng::LogLevel::Debug, expr)
+#define ENG_LOG_INFO(expr)  ENG_LOG_AT(ENG_LOG_LEVEL_INFO,  ::eng::LogLevel::Info,  expr)
+#define ENG_LOG_WARN(expr)  ENG_LOG_AT(ENG_LOG_LEVEL_WARN,  ::eng::LogLevel::Warn,  expr)
+#define ENG_LOG_ERROR(expr) ENG_LOG_AT(ENG_LOG_LEVEL_ERROR, ::eng::LogLevel::Error, expr)
@@ -59,10 +59,19 @@ struct Instrument {
 
 // ---- Price/trade tick types ----
 
+// instrument_id is the registry id for hot-path lookups (0 = not registered);
+// symbol is kept for the edges (persistence, frontend, logging).
+
 struct Tick {
     std::string symbol;
     double last{0.0};
     TimePoint ts{};
+    InstrumentId instrument_id{0};
+    // Set when the tick is derived from a trade (used by simulated brokers)
+    double qty{0.0};
+    TradeSide side{TradeSide::Unknown};   // Aggressor side
+    // Steady-clock ns when the feed handed the trade over (0 = not stamped); see Metrics.hpp
+    int64_t ingress_ns{0};
 };
 
 struct Quote {
@@ -70,6 +79,7 @@ struct Quote {
     double bid{0.0};
     double ask{0.0};
     TimePoint ts{};
+    InstrumentId instrument_id{0};
 };
 
 struct TradePrint {
@@ -96,6 +106,13 @@ struct Candle {
     double      low{0.0};
     double      close{0.0};
     double      volume{0.0};
+    InstrumentId instrument_id{0};
+};
+
+// A finished candle at one of BarBuilder's intervals (typed bus channel)
+struct Bar {
+    Candle    candle;
+    long long interval_ms{0};
 };
 
 }
@@ -0,0 +1,186 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+Metrics:
+  Per-stage latency histograms for the trade -> order hot path.
+
+  Stages (all in nanoseconds, steady_clock):
+    Feed          live feeds: frame read off the socket -> trade handed to subscribers
+    Ingress       whole per-trade handling, from the feed callback until it returns
+    Dispatch      feed callback -> Engine's tick handler (queueing with --async-bus)
+    Strategy      on_price_tick + get_trade_action
+    BrokerAck     place_limit_order until the broker returns
+    TickToOrder   feed callback -> broker returned, for ticks that placed an order
+    PersistFlush  one CandleStore writer transaction
+
+  Call sites use the ENG_METRICS_* macros. Configure with
+  -DENG_ENABLE_METRICS=OFF to compile every one of them out; the classes
+  stay available so QueryMetrics can report that metrics are off.
+
+  Recording is lock-free (relaxed atomic adds), so any thread may record
+  while another takes a snapshot.
+*/
+
+#ifndef ENG_ENABLE_METRICS
+#define ENG_ENABLE_METRICS 1
+#endif
+
+namespace eng {
+
+/**
+ * LatencyHistogram
+ *
+ * HDR-style log-linear histogram: values below 2^kSubBits get one bucket
+ * each, and every power of two above that is split into 2^kSubBits equal
+ * buckets, so any recorded value is known to within ~3% across the whole
+ * 64-bit range with a fixed 15 KB of counters.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBits = 5;
+    static constexpr size_t kSubCount = size_t{1} << kSubBits;
+    static constexpr size_t kBuckets = (64 - kSubBits + 1) * kSubCount;
+
+    struct Summary {
+        uint64_t count{0};
+        uint64_t sum{0};
+        double mean{0.0};
+        uint64_t min{0};
+        uint64_t p50{0};
+        uint64_t p90{0};
+        uint64_t p99{0};
+        uint64_t p999{0};
+        uint64_t max{0};
+    };
+
+    void record(uint64_t value) {
+        counts_[bucket_for(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        uint64_t prev = max_.load(std::memory_order_relaxed);
+        while (value > prev && !max_.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {}
+        prev = min_.load(std::memory_order_relaxed);
+        while (value < prev && !min_.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    // Smallest bucket upper bound covering fraction q (0..1) of the values (clamped to max)
+    uint64_t percentile(double q) const;
+
+    Summary summary() const;
+
+    // Not atomic with respect to concurrent record() calls
+    void reset();
+
+    static size_t bucket_for(uint64_t value) {
+        if (value < kSubCount) return static_cast<size_t>(value);
+        const unsigned msb = 63u - static_cast<unsigned>(__builtin_clzll(value));
+        const unsigned shift = msb - kSubBits;
+        return ((shift + 1) << kSubBits) | ((value >> shift) & (kSubCount - 1));
+    }
+
+    // Largest value that lands in bucket i
+    static uint64_t bucket_upper(size_t i) {
+        if (i < kSubCount) return i;
+        const unsigned shift = static_cast<unsigned>(i >> kSubBits) - 1;
+        const uint64_t low = (kSubCount | (i & (kSubCount - 1))) << shift;
+        return low + ((uint64_t{1} << shift) - 1);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> counts_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_{UINT64_MAX};
+    std::atomic<uint64_t> max_{0};
+};
+
+enum class MetricStage : size_t {
+    Feed,
+    Ingress,
+    Dispatch,
+    Strategy,
+    BrokerAck,
+    TickToOrder,
+    PersistFlush,
+    Count
+};
+
+const char* metric_stage_name(MetricStage stage);
+
+class Metrics {
+public:
+    struct StageSummary {
+        std::string stage;
+        LatencyHistogram::Summary latency_ns;
+    };
+
+    // The process-wide registry
+    static Metrics& instance();
+
+    static constexpr bool enabled() { return ENG_ENABLE_METRICS != 0; }
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    LatencyHistogram& histogram(MetricStage stage) { return stages_[static_cast<size_t>(stage)]; }
+
+    void record(MetricStage stage, int64_t ns) {
+        histogram(stage).record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+    }
+
+    // Stages with at least one sample, in MetricStage order
+    std::vector<StageSummary> snapshot() const;
+
+    void reset();
+
+private:
+    Metrics() = default;
+
+    std::array<LatencyHistogram, static_cast<size_t>(MetricStage::Count)> stages_;
+};
+
+/**
+ * Records the time from construction to destruction under one stage.
+ */
+class ScopedStageTimer {
+public:
+    explicit ScopedStageTimer(MetricStage stage) : stage_(stage), start_(Metrics::now_ns()) {}
+    ~ScopedStageTimer() { Metrics::instance().record(stage_, Metrics::now_ns() - start_); }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    MetricStage stage_;
+    int64_t start_;
+};
+
+}  // namespace eng
+
+#define ENG_METRICS_CONCAT_INNER(a, b) a##b
+#define ENG_METRICS_CONCAT(a, b) ENG_METRICS_CONCAT_INNER(a, b)
+
+#if ENG_ENABLE_METRICS
+// Steady-clock stamp in ns (0 when metrics are compiled out)
+#define ENG_METRICS_NOW() ::eng::Metrics::now_ns()
+// Record ns under a stage
+#define ENG_METRICS_RECORD(stage, ns) ::eng::Metrics::instance().record(::eng::MetricStage::stage, (ns))
+// Time the rest of the enclosing scope under a stage
+#define ENG_METRICS_SCOPE(stage) \
+    ::eng::ScopedStageTimer ENG_METRICS_CONCAT(eng_metrics_timer_, __LINE__)(::eng::MetricStage::stage)
+#else
+#define ENG_METRICS_NOW() (int64_t{0})
+#define ENG_METRICS_RECORD(stage, ns) ((void)sizeof(ns))
+#define ENG_METRICS_SCOPE(stage) ((void)0)
+#endif
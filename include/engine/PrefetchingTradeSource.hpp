@@ -0,0 +1,154 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ITradeSource.hpp"
+
+namespace eng {
+
+/**
+ * PrefetchingTradeSource
+ *
+ * Runs another ITradeSource on a background thread so its decompression and
+ * parsing overlap with whatever consumes it. The worker fills a fixed pool
+ * of `depth` batches of `batch_trades` trades each; read() hands trades out
+ * of the oldest filled batch and returns drained batches to the worker.
+ *
+ * Trades are moved out by swapping slots with the caller's buffer, so both
+ * sides keep recycling the same TradePrint storage and nothing is copied or
+ * allocated per trade. Only one lock round-trip is taken per batch.
+ *
+ * An exception thrown by the inner source is rethrown from read() once the
+ * trades read before it have been delivered.
+ */
+class PrefetchingTradeSource : public ITradeSource {
+public:
+    explicit PrefetchingTradeSource(std::unique_ptr<ITradeSource> inner,
+                                    size_t batch_trades = 4096, size_t depth = 4)
+        : inner_(std::move(inner)), name_(inner_ ? inner_->name() : std::string()) {
+        if (!inner_) throw std::invalid_argument("PrefetchingTradeSource needs a source");
+        if (batch_trades == 0) batch_trades = 1;
+        if (depth < 2) depth = 2;  // One being drained, one being filled
+        batches_.resize(depth);
+        for (auto& b : batches_) {
+            b.trades.resize(batch_trades);
+            free_.push_back(&b);
+        }
+        worker_ = std::thread([this]() { fill_loop(); });
+    }
+
+    ~PrefetchingTradeSource() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (worker_.joinable()) worker_.join();
+    }
+
+    PrefetchingTradeSource(const PrefetchingTradeSource&) = delete;
+    PrefetchingTradeSource& operator=(const PrefetchingTradeSource&) = delete;
+
+    size_t read(TradePrint* out, size_t max_trades) override {
+        if (max_trades == 0) return 0;
+        if (!current_ && !next_batch()) return 0;
+
+        size_t n = std::min(max_trades, current_->count - pos_);
+        for (size_t i = 0; i < n; ++i) {
+            std::swap(out[i], current_->trades[pos_ + i]);
+        }
+        pos_ += n;
+
+        if (pos_ == current_->count) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                free_.push_back(current_);
+            }
+            cv_.notify_all();
+            current_ = nullptr;
+        }
+        return n;
+    }
+
+    std::string name() const override { return name_; }
+
+private:
+    struct Batch {
+        std::vector<TradePrint> trades;
+        size_t count{0};
+    };
+
+    std::unique_ptr<ITradeSource> inner_;
+    std::string name_;
+    std::vector<Batch> batches_;   // Sized once; Batch addresses are stable
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Batch*> free_;      // Ready for the worker to fill
+    std::deque<Batch*> filled_;    // Ready for read(), oldest first
+    bool done_{false};             // Worker hit end of stream (or an error)
+    bool stop_{false};
+    std::exception_ptr error_;
+    std::thread worker_;
+
+    // Consumer-side cursor (only touched by the reading thread)
+    Batch* current_{nullptr};
+    size_t pos_{0};
+
+    bool next_batch() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return !filled_.empty() || done_; });
+        if (filled_.empty()) {
+            if (error_) std::rethrow_exception(error_);
+            return false;
+        }
+        current_ = filled_.front();
+        filled_.pop_front();
+        pos_ = 0;
+        return true;
+    }
+
+    void fill_loop() {
+        try {
+            while (true) {
+                Batch* batch = nullptr;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this]() { return !free_.empty() || stop_; });
+                    if (stop_) break;
+                    batch = free_.front();
+                    free_.pop_front();
+                }
+
+                // The expensive part runs without the lock
+                batch->count = inner_->read(batch->trades.data(), batch->trades.size());
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (batch->count == 0) {
+                    free_.push_back(batch);
+                    break;
+                }
+                filled_.push_back(batch);
+                cv_.notify_all();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_ = true;
+        }
+        cv_.notify_all();
+    }
+};
+
+} // namespace eng
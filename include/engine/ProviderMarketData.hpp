@@ -1,6 +1,9 @@
 // include/adapters/ProviderMarketData.hpp
 #pragma once
 #include "engine/IMarketData.hpp"
+#include "engine/ITradeSource.hpp"
+#include "engine/TradeMerger.hpp"
+#include <atomic>
 #include <functional>
 #include <unordered_map>
 #include <memory>
@@ -18,6 +21,13 @@ republishes "canonical" market data events for strategies to use.
 
 The provider can subscribe to child feeds and re-publishes normalized data to the engine EventBus.
 It would do tasks like, say, taking "BTCUSD" from Kraken and outputting BTC (or whatever agreed upon token we're using).
+
+For replay, the provider can also pull from several recorded trade sources at once
+(attach_source) and merge them into one timestamp-ordered stream (replay_merged) that is
+delivered to the subscribe_trades callbacks, as if it came from a single feed.
+
+With a TickStore set, every trade is also recorded in memory so strategies can warm up
+from recent history (get_hist_candles/get_candles) instead of waiting for live ticks.
 */
 
 // include/adapters/ProviderMarketData.hpp
@@ -26,9 +36,34 @@ namespace eng {
 class ProviderMarketData {
 public:
 void attach(std::unique_ptr<eng::IMarketData> feed) {     // add a broker feed
+    if (tick_store_) feed->set_tick_store(tick_store_);
     feeds_.push_back(std::move(feed));
 }
 
+// Record every trade -- from attached feeds and from replay_merged -- into
+// one TickStore, and answer candle queries from it
+void set_tick_store(std::shared_ptr<TickStore> store) {
+    tick_store_ = std::move(store);
+    for (auto& f : feeds_) {
+      f->set_tick_store(tick_store_);
+    }
+}
+
+const std::shared_ptr<TickStore>& tick_store() const { return tick_store_; }
+
+// Last `limit` candles of an interval ("1m", "1h", ...) for warm-up
+std::vector<Candle> get_hist_candles(const std::string& symbol, const std::string& interval, int limit) const {
+    if (!tick_store_) return {};
+    return tick_store_->last_candles(symbol, TickStore::parse_interval(interval), limit);
+}
+
+// Candles of interval_ms from the bucket holding `since` (count = -1: all)
+std::vector<Candle> get_candles(const std::string& symbol, long long interval_ms,
+                                TimePoint since, int count = -1) const {
+    if (!tick_store_) return {};
+    return tick_store_->candles(symbol, interval_ms, since, count);
+}
+
 
 void subscribe_ticks(const std::vector<std::string>& syms,
                        std::function<void(const eng::Tick&)> on_tick) {
@@ -46,6 +81,38 @@ void subscribe_trades(const std::vector<std::string>& syms,
       f->subscribe_trades(syms, on_trade); // same callback works for all feeds
     }
 
+    // Kept for merged replay of attached sources
+    for (const auto& s : syms) {
+      trade_callbacks_[s] = on_trade;
+    }
+    cached_instrument_ = 0;
+    cached_callback_ = nullptr;
+}
+
+// Add a pull-style trade source for replay_merged(). Wrap sources that
+// decompress in a PrefetchingTradeSource (adapter::open_trade_source does).
+void attach_source(std::unique_ptr<eng::ITradeSource> source) {
+    merger_.add_source(std::move(source));
+}
+
+size_t source_count() const { return merger_.source_count(); }
+const TradeMerger& merger() const { return merger_; }
+
+// Replay every attached source as one globally timestamp-ordered stream and
+// deliver each trade to the subscribe_trades callback for its symbol (and to
+// on_trade, if given). Runs on the calling thread.
+// pace: 1.0 = real-time, 0 = unthrottled (see ReplayClock)
+// running: optional stop flag
+// skip: trades to pass over first (see TradeMerger::run)
+size_t replay_merged(std::function<void(const eng::TradePrint&)> on_trade = nullptr,
+                     double pace = 0.0,
+                     const std::atomic<bool>* running = nullptr,
+                     size_t skip = 0) {
+    return merger_.run([this, &on_trade](const eng::TradePrint& tp) {
+      if (tick_store_) tick_store_->append(tp);
+      if (auto* cb = trade_callback_for(tp)) (*cb)(tp);
+      if (on_trade) on_trade(tp);
+    }, pace, running, skip);
 }
 
 void subscribe_quotes(const std::vector<std::string>& syms,
@@ -75,6 +142,21 @@ void stop_all() {
 private:
   std::vector<std::unique_ptr<eng::IMarketData>> feeds_;
   // symbol map, best-bid/ask chooser, failover policy, etc.
+
+  TradeMerger merger_;
+  std::shared_ptr<TickStore> tick_store_;
+  std::unordered_map<std::string, std::function<void(const eng::TradePrint&)>> trade_callbacks_;
+  // Last instrument's callback, so steady single-symbol runs skip the map
+  InstrumentId cached_instrument_{0};
+  const std::function<void(const eng::TradePrint&)>* cached_callback_{nullptr};
+
+  const std::function<void(const eng::TradePrint&)>* trade_callback_for(const eng::TradePrint& tp) {
+    if (tp.instrument_id != 0 && tp.instrument_id == cached_instrument_) return cached_callback_;
+    auto it = trade_callbacks_.find(tp.symbol);
+    cached_instrument_ = tp.instrument_id;
+    cached_callback_ = (it != trade_callbacks_.end()) ? &it->second : nullptr;
+    return cached_callback_;
+  }
 };
 } // namespace eng 
 
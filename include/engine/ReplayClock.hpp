@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include "MarketDataTypes.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace eng {
+
+/**
+ * ReplayClock
+ *
+ * Paces a recorded event stream against the wall clock. The first event
+ * anchors replay time to "now"; every later event is released once
+ * (event_ts - first_ts) / pace of wall time has passed. pace = 1.0 is
+ * real-time, 10.0 is ten times faster, and pace <= 0 disables pacing
+ * entirely (max throughput, no clock reads).
+ *
+ * Waiting is a sleep/spin hybrid: the thread sleeps until it is within
+ * spin_window of the target and spins the rest, so releases land within
+ * microseconds without burning a core across quiet stretches. Events that
+ * share a timestamp (or are already overdue) return without sleeping, and a
+ * replay that falls behind catches up at full speed rather than drifting.
+ *
+ * Long sleeps are chunked so a replay can be stopped mid-gap.
+ */
+class ReplayClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t waits{0};        // Events that had to wait for the clock
+        uint64_t late{0};         // Events released more than 1ms after their target
+        int64_t max_lag_ns{0};    // Worst release lag behind target
+    };
+
+    explicit ReplayClock(double pace = 0.0,
+                         std::chrono::nanoseconds spin_window = std::chrono::microseconds(200))
+        : pace_(pace), spin_window_(spin_window) {}
+
+    bool paced() const { return pace_ > 0.0; }
+    double pace() const { return pace_; }
+    const Stats& stats() const { return stats_; }
+
+    // Forget the anchor; the next event starts a new timeline
+    void reset() {
+        anchored_ = false;
+        last_event_ns_ = 0;
+        stats_ = Stats{};
+    }
+
+    /**
+     * Block until event_ts is due.
+     * @param running Checked while waiting; returns false as soon as it drops
+     * @return false if the wait was cut short by `running`
+     */
+    bool wait_until(TimePoint event_ts, const std::atomic<bool>& running) {
+        if (!paced()) return true;
+
+        int64_t event_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            event_ts.time_since_epoch()).count();
+
+        if (!anchored_) {
+            anchored_ = true;
+            anchor_event_ns_ = event_ns;
+            anchor_wall_ = Clock::now();
+            last_event_ns_ = event_ns;
+            return true;
+        }
+
+        // Same instant as the previous event (or out of order): already due
+        if (event_ns <= last_event_ns_) return true;
+        last_event_ns_ = event_ns;
+
+        auto offset = std::chrono::nanoseconds(static_cast<int64_t>(
+            static_cast<double>(event_ns - anchor_event_ns_) / pace_));
+        Clock::time_point target = anchor_wall_ + std::chrono::duration_cast<Clock::duration>(offset);
+
+        Clock::time_point now = Clock::now();
+        if (now >= target) {
+            note_lag(now - target);
+            return true;
+        }
+
+        ++stats_.waits;
+        while (true) {
+            if (!running.load(std::memory_order_relaxed)) return false;
+            now = Clock::now();
+            auto remaining = target - now;
+            if (remaining <= Clock::duration::zero()) break;
+            if (remaining > spin_window_) {
+                auto nap = remaining - spin_window_;
+                if (nap > kMaxSleepChunk) nap = kMaxSleepChunk;
+                std::this_thread::sleep_for(nap);
+            } else {
+                cpu_relax();
+            }
+        }
+        note_lag(now - target);
+        return true;
+    }
+
+private:
+    static constexpr std::chrono::milliseconds kMaxSleepChunk{50};
+    static constexpr int64_t kLateThresholdNs = 1'000'000;
+
+    double pace_;
+    Clock::duration spin_window_;
+    bool anchored_{false};
+    int64_t anchor_event_ns_{0};
+    int64_t last_event_ns_{0};
+    Clock::time_point anchor_wall_{};
+    Stats stats_;
+
+    void note_lag(Clock::duration lag) {
+        int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(lag).count();
+        if (ns > kLateThresholdNs) ++stats_.late;
+        if (ns > stats_.max_lag_ns) stats_.max_lag_ns = ns;
+    }
+
+    static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+};
+
+}  // namespace eng
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "BoundedQueue.hpp"
+#include "BroadcastRing.hpp"
+#include "IBroker.hpp"
+#include "IStrategy.hpp"
+#include "MarketDataTypes.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace eng {
+
+/*
+StrategyFanOut:
+  Runs many strategies on one tick stream without putting them on the tick
+  path. Strategies are grouped onto worker threads, each optionally pinned
+  to a CPU. publish() copies a tick once into a BroadcastRing that every
+  worker reads in place, so the publisher's cost doesn't grow with the
+  number of strategies and a slow strategy only delays its own group.
+
+  Order intents (strategy, side, tick price and time) come back to a single
+  router thread through an MPSC queue. The router owns the broker: it feeds
+  it every tick (on_market_tick) and places intents as they arrive, so
+  brokers stay single-threaded as they are with one strategy. Fills, both
+  immediate and resting, are routed back to the strategy that placed the
+  order via Order::client_tag, and delivered on its worker before its next
+  batch of ticks.
+
+  Unlike Engine's single-strategy path this is asynchronous: a strategy
+  sees its fills some ticks late, and an order reaches the broker after
+  whatever ticks the router has already matched. Replays through it are
+  therefore not bit-for-bit repeatable; use set_strategy() for that.
+
+  Brokers that drop client_tag (plugin brokers: it has no field in the C
+  ABI) still receive every order, but their resting fills can't be
+  attributed and are logged and dropped.
+
+  The tick ring blocks the publisher when the slowest consumer is a full
+  ring behind, the same as a Backpressure::Block bus subscriber.
+*/
+class StrategyFanOut {
+public:
+    explicit StrategyFanOut(std::size_t ring_capacity = 1 << 16);
+    ~StrategyFanOut();
+
+    StrategyFanOut(const StrategyFanOut&) = delete;
+    StrategyFanOut& operator=(const StrategyFanOut&) = delete;
+
+    // New worker thread, pinned to `cpu` if it is >= 0; returns its index
+    std::size_t add_worker(int cpu = -1);
+
+    // Run `strat` on `worker` (an add_worker() index); returns its slot
+    std::size_t add_strategy(std::unique_ptr<IStrategy> strat, std::size_t worker);
+
+    // Pin the router (broker) thread
+    void set_router_cpu(int cpu) { router_cpu_ = cpu; }
+
+    std::size_t strategy_count() const { return strategies_.size(); }
+
+    // A strategy by slot; its worker owns it while ticks are flowing
+    IStrategy& strategy(std::size_t slot) { return *strategies_.at(slot); }
+    const IStrategy& strategy(std::size_t slot) const { return *strategies_.at(slot); }
+
+    // Spawn the workers and the router. Registration is closed afterwards.
+    void start(IBroker& broker, bool verbose);
+
+    // Called on the tick publisher's thread
+    void publish(const Tick& t);
+
+    // The broker's fill handler; runs on the router thread
+    void on_fill(const Order& fill);
+
+    // Block until every published tick, intent and fill has been handled.
+    // Only meaningful once the publisher has stopped.
+    void wait_idle() const;
+
+    // Drain and join all threads. Called by the destructor.
+    void stop();
+
+private:
+    struct Intent {
+        std::size_t slot{0};
+        Order::Side side{Order::Side::Buy};
+        std::string symbol;
+        InstrumentId instrument_id{0};
+        double price{0.0};
+        TimePoint ts{};
+        int64_t ingress_ns{0};
+    };
+
+    struct Worker {
+        int cpu{-1};
+        std::size_t consumer{0};                 // Ring cursor index
+        std::vector<std::size_t> slots;          // Strategies it runs
+        std::unique_ptr<BoundedQueue<Order>> fills;
+        std::atomic<std::uint64_t> fills_queued{0};
+        std::atomic<std::uint64_t> fills_done{0};
+        std::atomic<bool> exited{false};
+        std::vector<PriceData> batch;            // Scratch, reused across batches
+        std::thread thread;
+    };
+
+    static constexpr std::size_t kMaxBatch = 64;
+    static constexpr int SPIN_BEFORE_SLEEP = 256;
+
+    std::size_t ring_capacity_;
+    int router_cpu_{-1};
+    bool verbose_{false};
+    IBroker* broker_{nullptr};
+    std::vector<std::unique_ptr<IStrategy>> strategies_;
+    std::vector<std::size_t> worker_of_;         // By slot
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::unique_ptr<BroadcastRing<Tick>> ring_;
+    std::unique_ptr<BoundedQueue<Intent>> intents_;
+    std::atomic<std::uint64_t> intents_queued_{0};
+    std::atomic<std::uint64_t> intents_done_{0};
+    std::atomic<std::uint64_t> unattributed_fills_{0};
+    std::size_t router_consumer_{0};
+    std::thread router_;
+    std::atomic<bool> running_{false};          // Workers
+    std::atomic<bool> router_running_{false};
+
+    void run_worker(Worker& w);
+    void run_router();
+
+    // Worker side: decide on a span of ticks for every strategy of `w`
+    void decide(Worker& w, std::size_t n);
+    void push_intent(Worker& w, Intent&& intent);
+    std::size_t apply_fills(Worker& w);
+
+    // Router side
+    void place(Intent& intent);
+    void route_fill(const Order& fill, std::size_t slot);
+    std::size_t drain_intents();
+
+    static void pin_current_thread(int cpu, const char* what);
+    static void idle(int& spins);
+};
+
+} // namespace eng
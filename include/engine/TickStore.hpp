@@ -0,0 +1,177 @@
+#pragma once
+
+#include "engine/Checkpoint.hpp"
+#include "engine/InstrumentTable.hpp"
+#include "engine/MarketDataTypes.hpp"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+TickStore:
+  In-memory history of recent trades per instrument, for strategy warm-up
+  and historical queries that should not wait on SQLite.
+
+  Each instrument keeps an append-only list of fixed-size chunks. A chunk
+  stores its trades as parallel columns (timestamp, price, qty, side), so
+  building candles streams through a few dense arrays instead of striding
+  over whole TradePrints.
+
+  Range queries binary-search the chunks on their first timestamp, then the
+  chunk itself: O(log n + k) for k trades returned or folded. Timestamps
+  must not go backwards within an instrument (replay and live feeds don't);
+  a trade older than the previous one is stored at the previous timestamp
+  so the columns stay sorted.
+
+  Memory is bounded per instrument: once max_ticks_per_instrument is
+  reached the oldest chunk is evicted and recycled as the next one, so a
+  full store appends without allocating.
+
+  Thread-safe: one feed thread appends while any thread queries. Appends
+  take the exclusive lock, which is uncontended unless a query is running.
+*/
+
+namespace eng {
+
+struct TickStoreConfig {
+    size_t chunk_ticks{4096};                  // Trades per chunk (the eviction unit)
+    size_t max_ticks_per_instrument{1 << 22};  // Rounded down to whole chunks, at least one
+};
+
+class TickStore {
+public:
+    struct Stats {
+        size_t instruments{0};
+        size_t ticks{0};
+        size_t chunks{0};
+        uint64_t evicted_chunks{0};
+        size_t bytes{0};          // Column storage
+    };
+
+    explicit TickStore(TickStoreConfig config = {});
+
+    TickStore(const TickStore&) = delete;
+    TickStore& operator=(const TickStore&) = delete;
+
+    void append(const TradePrint& tp);
+
+    // Ticks carry a trade's qty and side when derived from one (see Tick)
+    void append(const Tick& tick);
+
+    // Trades held for a symbol
+    size_t size(const std::string& symbol) const;
+
+    // Timestamp of the newest trade for a symbol (epoch if none)
+    TimePoint last_time(const std::string& symbol) const;
+
+    /**
+     * Raw range scan: f(TimePoint ts, double price, double qty, TradeSide side)
+     * for every held trade with from <= ts < to, oldest first.
+     * Runs under the shared lock; f must not call back into the store.
+     * @return Number of trades visited
+     */
+    template <typename F>
+    size_t scan(const std::string& symbol, TimePoint from, TimePoint to, F&& f) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const Series* s = find(symbol);
+        if (!s) return 0;
+        const int64_t end = to.time_since_epoch().count();
+        const size_t pos = lower_bound(*s, from.time_since_epoch().count());
+        size_t visited = 0;
+        for (size_t ci = pos / chunk_ticks_, i = pos % chunk_ticks_; ci < s->chunks.size(); ++ci, i = 0) {
+            const Chunk& c = *s->chunks[ci];
+            for (; i < c.size; ++i, ++visited) {
+                if (c.ts[i] >= end) return visited;
+                f(TimePoint(TimePoint::duration(c.ts[i])), c.price[i], c.qty[i], static_cast<TradeSide>(c.side[i]));
+            }
+        }
+        return visited;
+    }
+
+    /**
+     * OHLCV candles of interval_ms built from the held trades, starting with
+     * the bucket that contains `since`. Buckets without trades are skipped
+     * (as BarBuilder does); the last candle may still be open.
+     * @param count Maximum number of candles (-1 = all)
+     */
+    std::vector<Candle> candles(const std::string& symbol, long long interval_ms,
+                                TimePoint since, int count = -1) const;
+
+    /**
+     * The last `limit` candles of interval_ms, ending with the bucket of the
+     * newest trade. Fewer if the store doesn't reach back that far.
+     */
+    std::vector<Candle> last_candles(const std::string& symbol, long long interval_ms, int limit) const;
+
+    Stats stats() const;
+
+    void clear();
+
+    /**
+     * Checkpoints: every held trade, per instrument, as raw columns. A
+     * resumed replay skips the trades before its position without appending
+     * them, so without this the store (and candles and warm-up built from
+     * it) would start at the resume point. load_state() appends to what the
+     * store already holds, within this store's own per-instrument bound.
+     */
+    void save_state(CheckpointWriter& out) const;
+    void load_state(CheckpointReader& in);
+
+    // "1s", "15s", "1m", "5m", "1h", "1d", ... in milliseconds (0 if unrecognised)
+    static long long parse_interval(const std::string& interval);
+
+private:
+    struct Chunk {
+        explicit Chunk(size_t capacity)
+            : ts(capacity), price(capacity), qty(capacity), side(capacity) {}
+
+        std::vector<int64_t> ts;          // TimePoint::duration ticks since epoch
+        std::vector<double> price;
+        std::vector<double> qty;
+        std::vector<uint8_t> side;        // TradeSide
+        size_t size{0};
+    };
+
+    struct Series {
+        std::string symbol;
+        InstrumentId id{0};
+        std::deque<std::unique_ptr<Chunk>> chunks;   // Oldest first; only the back one is partial
+        size_t ticks{0};
+        int64_t last_ts{0};
+    };
+
+    const size_t chunk_ticks_;
+    const size_t max_chunks_;
+
+    mutable std::shared_mutex mutex_;
+    InstrumentTable<Series*> slots_;                       // Append path: index by registry id
+    std::unordered_map<std::string, std::unique_ptr<Series>> series_;   // Owner; query path by symbol
+    uint64_t evicted_chunks_{0};
+
+    void append(InstrumentId id, const std::string& symbol, TimePoint ts,
+                double price, double qty, TradeSide side);
+    // Same, caller holds the exclusive lock
+    void append_locked(InstrumentId id, const std::string& symbol, int64_t ts,
+                       double price, double qty, TradeSide side);
+
+    const Series* find(const std::string& symbol) const {
+        auto it = series_.find(symbol);
+        return it != series_.end() ? it->second.get() : nullptr;
+    }
+
+    // First position whose timestamp is >= ts (s.ticks if none)
+    size_t lower_bound(const Series& s, int64_t ts) const;
+
+    // Candles from position pos onward; caller holds the lock
+    std::vector<Candle> build_candles(const Series& s, size_t pos, long long interval_ms, int count) const;
+
+    static void emit_candle(const Series& s, int64_t start, double open, double high, double low,
+                            double close, double volume, std::vector<Candle>& out);
+};
+
+}  // namespace eng
@@ -0,0 +1,141 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "ITradeSource.hpp"
+#include "ReplayClock.hpp"
+
+namespace eng {
+
+/**
+ * TradeMerger
+ *
+ * K-way merge of several timestamp-ordered ITradeSources into one globally
+ * ordered trade stream. Each source gets a read-ahead buffer of
+ * `read_ahead` trades; a binary min-heap over the buffer heads picks the
+ * next trade, so each emitted trade costs O(log K) comparisons of two
+ * integers.
+ *
+ * Ties on timestamp go to the source added first, and each source's own
+ * order is kept, so the output is deterministic for a given source order.
+ * A source that is itself out of order is merged as-is (only buffer heads
+ * are compared).
+ *
+ * Cheap sources (mmap'd archives) can be added directly; wrap sources that
+ * decompress in a PrefetchingTradeSource so the merge never waits on zlib.
+ */
+class TradeMerger {
+public:
+    using TradeCallback = std::function<void(const TradePrint&)>;
+
+    explicit TradeMerger(size_t read_ahead = 1024)
+        : read_ahead_(read_ahead == 0 ? 1 : read_ahead) {}
+
+    void add_source(std::unique_ptr<ITradeSource> source) {
+        if (!source) throw std::invalid_argument("TradeMerger: null source");
+        Cursor c;
+        c.source = std::move(source);
+        c.buffer.resize(read_ahead_);
+        cursors_.push_back(std::move(c));
+    }
+
+    size_t source_count() const { return cursors_.size(); }
+
+    // Trades emitted from source i by the last run()
+    size_t emitted_from(size_t i) const { return cursors_.at(i).emitted; }
+
+    const ReplayClock::Stats& last_clock_stats() const { return clock_stats_; }
+
+    /**
+     * Drain every source in timestamp order.
+     *
+     * @param emit Called once per trade, on the calling thread
+     * @param pace Replay speed by trade timestamp (see ReplayClock); <= 0 is unthrottled
+     * @param running Optional stop flag, checked between trades and while pacing
+     * @param skip Trades to pass over first (not paced or emitted), to resume
+     *             at a checkpoint's position; the merge order is deterministic
+     * @return Number of trades emitted, skipped ones included
+     */
+    size_t run(const TradeCallback& emit, double pace = 0.0,
+               const std::atomic<bool>* running = nullptr, size_t skip = 0) {
+        std::atomic<bool> always{true};
+        const std::atomic<bool>& keep_going = running ? *running : always;
+        ReplayClock clock(pace);
+
+        heap_.clear();
+        for (size_t i = 0; i < cursors_.size(); ++i) {
+            cursors_[i].emitted = 0;
+            if (refill(cursors_[i])) heap_.push_back(Head{head_ns(cursors_[i]), i});
+        }
+        std::make_heap(heap_.begin(), heap_.end(), later);
+
+        size_t total = 0;
+        while (!heap_.empty() && keep_going.load(std::memory_order_relaxed)) {
+            size_t idx = heap_.front().source;
+            Cursor& c = cursors_[idx];
+            const TradePrint& tp = c.buffer[c.pos];
+
+            if (total >= skip) {
+                if (!clock.wait_until(tp.ts, keep_going)) break;
+                emit(tp);
+                ++c.emitted;
+            }
+            ++total;
+
+            // Advance the winner and restore the heap in place
+            std::pop_heap(heap_.begin(), heap_.end(), later);
+            if (++c.pos < c.count || refill(c)) {
+                heap_.back().ts_ns = head_ns(c);
+                std::push_heap(heap_.begin(), heap_.end(), later);
+            } else {
+                heap_.pop_back();
+            }
+        }
+
+        clock_stats_ = clock.stats();
+        return total;
+    }
+
+private:
+    struct Cursor {
+        std::unique_ptr<ITradeSource> source;
+        std::vector<TradePrint> buffer;   // Read-ahead slots, reused across refills
+        size_t count{0};
+        size_t pos{0};
+        size_t emitted{0};
+    };
+
+    struct Head {
+        int64_t ts_ns;
+        size_t source;
+    };
+
+    // Heap comparator: std heaps are max-heaps, so "less" means "later"
+    static bool later(const Head& a, const Head& b) {
+        if (a.ts_ns != b.ts_ns) return a.ts_ns > b.ts_ns;
+        return a.source > b.source;
+    }
+
+    static int64_t head_ns(const Cursor& c) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            c.buffer[c.pos].ts.time_since_epoch()).count();
+    }
+
+    static bool refill(Cursor& c) {
+        c.pos = 0;
+        c.count = c.source->read(c.buffer.data(), c.buffer.size());
+        return c.count > 0;
+    }
+
+    size_t read_ahead_;
+    std::vector<Cursor> cursors_;
+    std::vector<Head> heap_;
+    ReplayClock::Stats clock_stats_;
+};
+
+} // namespace eng
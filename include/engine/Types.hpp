@@ -2,17 +2,31 @@
 
 #pragma once
 #include <string>
+#include <string_view>
 #include <any>
 #include <chrono>
+#include <cstdint>
 
 namespace eng {
 
 using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
+using InstrumentId = std::uint64_t;   // Same as MarketDataTypes.hpp; 0 = not registered
 
-// used by 
+// used by strategies (IStrategy::on_price_tick). symbol views the symbol of
+// the Tick it was built from, so handing a tick to a strategy doesn't copy
+// a string; it is valid for the call. Copy it to keep it.
 struct PriceData {
+    std::string_view symbol;
+    double      last{0.0};
+    InstrumentId instrument_id{0};
+};
+
+// A broker's answer to get_current_price(); owns its symbol, so it can
+// outlive the argument it was asked with
+struct PriceQuote {
     std::string symbol;
     double      last{0.0};
+    InstrumentId instrument_id{0};
 };
 
 enum class TradeAction {
@@ -53,7 +67,27 @@ struct Order {
     OrderStatus status{OrderStatus::NEW};       // Current order status
     std::string rejection_reason{};             // Populated if REJECTED
     TimePoint   timestamp{};                    // Order creation timestamp (event time, not wall-clock)
+    InstrumentId instrument_id{0};              // Registry id; brokers key positions by it when set
+    uint64_t    client_tag{0};                  // Caller's tag, copied onto fill reports (engine fan-out: strategy slot + 1)
+};
+
+// An order lifecycle change, published by brokers on the OrderEvent typed channel
+struct OrderEvent {
+    enum class Kind { Placed, Filled, Rejected, Canceled };
+    Kind  kind{Kind::Placed};
+    Order order;                                // Order record after the change
 };
 
+// String-topic name of an OrderEvent kind ("OrderPlaced", ...)
+inline const char* order_event_topic(OrderEvent::Kind kind) {
+    switch (kind) {
+        case OrderEvent::Kind::Placed: return "OrderPlaced";
+        case OrderEvent::Kind::Filled: return "OrderFilled";
+        case OrderEvent::Kind::Rejected: return "OrderRejected";
+        case OrderEvent::Kind::Canceled: return "OrderCanceled";
+    }
+    return "OrderUnknown";
+}
+
 
 } // namespace eng
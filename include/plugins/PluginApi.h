@@ -0,0 +1,134 @@
+#pragma once
+
+/*
+PluginApi:
+  The C ABI between the engine and strategy/broker plugins (shared objects
+  opened by PluginLoader). Only C types cross it, so a plugin built with a
+  different compiler or standard library still loads, and nothing about
+  eng::IStrategy's vtable layout is baked into the .so.
+
+  A plugin exports one function, eng_plugin_entry (use ENG_PLUGIN_EXPORT),
+  returning a static descriptor: the ABI version it was built against and
+  a function table for a strategy, a broker, or both. Instances are opaque
+  `void*` made by create() and released by destroy().
+
+  Strings and structs passed in are only valid for the duration of the call.
+
+  Batching: a strategy may provide on_price_ticks, which feeds a span of
+  ticks and stops after the first one that produces an action. The host
+  then pays one cross-library call per span instead of two per tick.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ENG_PLUGIN_ABI_VERSION 1
+
+#if defined(_WIN32)
+#define ENG_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define ENG_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+/* eng::TradeAction */
+enum {
+  ENG_ACTION_NONE = 0,
+  ENG_ACTION_BUY = 1,
+  ENG_ACTION_SELL = 2
+};
+
+/* eng::Order::Side */
+enum {
+  ENG_SIDE_BUY = 0,
+  ENG_SIDE_SELL = 1
+};
+
+/* eng::PriceData */
+typedef struct eng_price_tick {
+  const char* symbol;
+  double last;
+  uint64_t instrument_id;
+} eng_price_tick;
+
+/* eng::Tick, for brokers that simulate fills against the tape */
+typedef struct eng_market_tick {
+  const char* symbol;
+  double last;
+  uint64_t instrument_id;
+  double qty;
+  int32_t aggressor_side;         /* eng::TradeSide as an int */
+  int64_t ts_ns;                  /* system_clock nanoseconds since epoch */
+} eng_market_tick;
+
+/* eng::Order; status is eng::OrderStatus as an int */
+typedef struct eng_order {
+  uint64_t id;
+  const char* symbol;
+  double qty;
+  double filled_qty;
+  double fill_price;
+  int32_t side;
+  int32_t status;
+  int64_t timestamp_ns;           /* Event time, system_clock nanoseconds since epoch */
+  uint64_t instrument_id;
+  const char* rejection_reason;   /* Empty string if none */
+} eng_order;
+
+typedef struct eng_strategy_api {
+  /* NULL on failure (bad config, say) */
+  void* (*create)(const char* symbol, const char* config);
+  void (*destroy)(void* self);
+
+  void (*on_price_tick)(void* self, const eng_price_tick* tick);
+  int32_t (*get_trade_action)(void* self);
+  void (*on_order_fill)(void* self, const eng_order* order);
+
+  /* Optional (NULL: always 0) */
+  double (*get_net_position)(void* self);
+
+  /* Optional (NULL: on_price_tick + get_trade_action per tick). Feeds
+     ticks[0..n) in order, stopping after the first that yields an action;
+     returns how many were consumed and sets *action to the last one's. */
+  size_t (*on_price_ticks)(void* self, const eng_price_tick* ticks, size_t n, int32_t* action);
+} eng_strategy_api;
+
+/* Fills reported after place_*_order returned (resting orders) */
+typedef void (*eng_fill_callback)(void* ctx, const eng_order* fill);
+
+typedef struct eng_broker_api {
+  void* (*create)(const char* config);
+  void (*destroy)(void* self);
+
+  void (*place_order)(void* self, const eng_order* order);
+  /* Both return the quantity filled immediately. place_limit_order is
+     required; without place_market_order, market orders go to place_order
+     and report no immediate fill. */
+  double (*place_market_order)(void* self, const eng_order* order);
+  double (*place_limit_order)(void* self, const eng_order* order, double limit_price, int64_t event_time_ns);
+
+  double (*get_balance)(void* self);
+  double (*get_current_price)(void* self, const char* symbol);
+
+  /* Optional */
+  void (*set_fill_callback)(void* self, eng_fill_callback callback, void* ctx);
+  void (*on_market_tick)(void* self, const eng_market_tick* tick);
+} eng_broker_api;
+
+typedef struct eng_plugin_descriptor {
+  uint32_t abi_version;                 /* ENG_PLUGIN_ABI_VERSION */
+  const char* name;
+  const eng_strategy_api* strategy;     /* NULL if the plugin has none */
+  const eng_broker_api* broker;         /* NULL if the plugin has none */
+} eng_plugin_descriptor;
+
+/* The one exported symbol */
+typedef const eng_plugin_descriptor* (*eng_plugin_entry_fn)(void);
+#define ENG_PLUGIN_ENTRY_SYMBOL "eng_plugin_entry"
+
+#ifdef __cplusplus
+}
+#endif
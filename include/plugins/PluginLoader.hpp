@@ -1,9 +1,60 @@
 #pragma once
-#include <string>
+#include "engine/IBroker.hpp"
+#include "engine/IStrategy.hpp"
+#include "plugins/PluginApi.h"
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+
+/*
+PluginLoader:
+  Opens strategy and broker plugins (shared objects speaking the C ABI in
+  PluginApi.h) with dlopen and wraps their instances as eng::IStrategy /
+  eng::IBroker, so the engine, BacktestRunner and friends take them like
+  any built-in one.
+
+  Each instance keeps its library loaded; the library is closed when the
+  last instance made from it is destroyed. Loading the same path while it
+  is open reuses it. Once every instance is gone, loading the path again
+  opens the file afresh, so a rebuilt variant can be swapped in between
+  runs without relinking or restarting the process.
+
+  The plugin wrapper forwards on_price_ticks to the plugin's batch entry
+  when it has one: one call across the library boundary per span.
+
+  Errors (missing file, no entry point, ABI mismatch, create() refusing the
+  config) throw std::runtime_error. Thread-safe.
+*/
 
 class PluginLoader {
 public:
+    // A loaded library; shared by every instance made from it
+    struct Library;
+
+    // Instance of the plugin at `path`, configured by `config` (plugin-defined,
+    // e.g. "window=5,threshold=1.0"). IStrategy and IBroker are supported;
+    // strategies also get the symbol they trade.
     template<typename T>
-    std::unique_ptr<T> load(const std::string& path);
+    std::unique_ptr<T> load(const std::string& path, const std::string& config = "",
+                            const std::string& symbol = "");
+
+    // Process-wide instance, for callers that don't keep their own
+    static PluginLoader& instance();
+
+private:
+    std::mutex mutex_;
+    std::map<std::string, std::weak_ptr<Library>> libraries_;   // By path, while loaded
+
+    std::shared_ptr<Library> open(const std::string& path);
 };
+
+template<>
+std::unique_ptr<eng::IStrategy> PluginLoader::load<eng::IStrategy>(const std::string& path,
+                                                                   const std::string& config,
+                                                                   const std::string& symbol);
+
+template<>
+std::unique_ptr<eng::IBroker> PluginLoader::load<eng::IBroker>(const std::string& path,
+                                                               const std::string& config,
+                                                               const std::string& symbol);
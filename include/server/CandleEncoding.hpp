@@ -0,0 +1,196 @@
+#pragma once
+
+#include "engine/MarketDataTypes.hpp"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+CandleEncoding:
+  Compact wire formats for QueryCandlesResponse, selected per request with
+  data.encoding in QueryCandles ("json" is the default and unchanged).
+
+  "columnar": a normal JSON text frame whose data.columns holds parallel
+    arrays {ms, open, high, low, close, volume}. The symbol is sent once and the
+    per-candle ISO openTime strings are dropped.
+
+  "binary": a single binary frame, all fields little-endian:
+
+    offset  size  field
+    0       4     magic "CND1"
+    4       4     u32 header_len (offset of the first column, multiple of 8)
+    8       4     u32 count
+    12      4     u32 flags (bit 0: downsampled, bit 1: sparse)
+    16      8     i64 resolution_ms (bar width returned)
+    24      8     i64 requested_resolution_ms
+    32      2     u16 request_id_len
+    34      2     u16 symbol_len
+    36      4     reserved (0)
+    40      ...   request_id bytes, symbol bytes, zero padding to header_len
+    header_len    i64 ms[count], then f64 open/high/low/close/volume[count]
+
+  Columns start 8-byte aligned so the browser can view them in place with
+  BigInt64Array/Float64Array. Both encoders write straight from the candle
+  vector with no per-candle allocations.
+
+  Gap filling: buckets without trades go out as flat, zero-volume bars at
+  the previous close. They are generated while encoding (for_each_bar), never
+  stored, so a quiet market costs only the bytes sent. A "sparse" request
+  skips them and the client fills the gaps from resolutionMs instead.
+*/
+
+namespace server {
+
+enum class CandleEncoding { Json, Columnar, Binary };
+
+// Unknown or missing names fall back to plain JSON
+inline CandleEncoding parse_candle_encoding(const std::string& name) {
+  if (name == "columnar") return CandleEncoding::Columnar;
+  if (name == "binary") return CandleEncoding::Binary;
+  return CandleEncoding::Json;
+}
+
+namespace detail {
+
+inline long long candle_ms(const eng::Candle& c) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+      c.open_time.time_since_epoch()).count();
+}
+
+template <typename T>
+inline void put(std::string& buf, size_t& off, T value) {
+  std::memcpy(&buf[off], &value, sizeof(T));
+  off += sizeof(T);
+}
+
+}  // namespace detail
+
+/**
+ * Bars that will be sent for `bars`: with fill_gaps, one per bucket_ms
+ * bucket from the first bar to the last
+ */
+inline size_t bar_count(const std::vector<eng::Candle>& bars, long long bucket_ms, bool fill_gaps) {
+  if (!fill_gaps || bars.size() < 2 || bucket_ms <= 0) return bars.size();
+  size_t count = bars.size();
+  for (size_t i = 1; i < bars.size(); ++i) {
+    const long long gap = detail::candle_ms(bars[i]) - detail::candle_ms(bars[i - 1]);
+    if (gap > bucket_ms) count += static_cast<size_t>((gap - 1) / bucket_ms);
+  }
+  return count;
+}
+
+/**
+ * f(ms, open, high, low, close, volume) for each bar, oldest first. With
+ * fill_gaps, empty buckets between bars are passed as flat bars at the
+ * previous close without being materialized.
+ */
+template <typename F>
+inline void for_each_bar(const std::vector<eng::Candle>& bars, long long bucket_ms, bool fill_gaps, F&& f) {
+  long long prev_ms = 0;
+  for (size_t i = 0; i < bars.size(); ++i) {
+    const eng::Candle& c = bars[i];
+    const long long ms = detail::candle_ms(c);
+    if (fill_gaps && i > 0 && bucket_ms > 0) {
+      const double last_close = bars[i - 1].close;
+      for (long long gap_ms = prev_ms + bucket_ms; gap_ms < ms; gap_ms += bucket_ms) {
+        f(gap_ms, last_close, last_close, last_close, last_close, 0.0);
+      }
+    }
+    f(ms, c.open, c.high, c.low, c.close, c.volume);
+    prev_ms = ms;
+  }
+}
+
+/**
+ * Columns object for the "columnar" encoding: {ms:[], open:[], ...}, with
+ * gaps filled at bucket_ms if fill_gaps
+ */
+inline nlohmann::json encode_candles_columnar(const std::vector<eng::Candle>& candles,
+                                              long long bucket_ms = 0, bool fill_gaps = false) {
+  const size_t count = bar_count(candles, bucket_ms, fill_gaps);
+  std::vector<long long> ms;
+  std::vector<double> open, high, low, close, volume;
+  ms.reserve(count);
+  open.reserve(count);
+  high.reserve(count);
+  low.reserve(count);
+  close.reserve(count);
+  volume.reserve(count);
+
+  for_each_bar(candles, bucket_ms, fill_gaps,
+               [&](long long t, double o, double h, double l, double c, double v) {
+    ms.push_back(t);
+    open.push_back(o);
+    high.push_back(h);
+    low.push_back(l);
+    close.push_back(c);
+    volume.push_back(v);
+  });
+
+  nlohmann::json columns;
+  columns["ms"] = std::move(ms);
+  columns["open"] = std::move(open);
+  columns["high"] = std::move(high);
+  columns["low"] = std::move(low);
+  columns["close"] = std::move(close);
+  columns["volume"] = std::move(volume);
+  return columns;
+}
+
+/**
+ * Whole binary frame for the "binary" encoding (layout above). Gaps are
+ * filled at resolution_ms unless `sparse`.
+ * Assumes a little-endian host, like every target we build for.
+ */
+inline std::string encode_candles_binary(const std::string& request_id,
+                                         const std::string& symbol,
+                                         long long resolution_ms,
+                                         long long requested_resolution_ms,
+                                         bool downsampled,
+                                         const std::vector<eng::Candle>& candles,
+                                         bool sparse = false) {
+  if (request_id.size() > 0xFFFF || symbol.size() > 0xFFFF) {
+    throw std::runtime_error("requestId/symbol too long for a binary candle frame");
+  }
+  const size_t count = bar_count(candles, resolution_ms, !sparse);
+  const size_t fixed = 40;
+  const size_t header_len = (fixed + request_id.size() + symbol.size() + 7) & ~size_t(7);
+  const size_t total = header_len + count * (sizeof(int64_t) + 5 * sizeof(double));
+
+  std::string buf(total, '\0');
+  size_t off = 0;
+  std::memcpy(&buf[off], "CND1", 4);
+  off += 4;
+  detail::put<uint32_t>(buf, off, static_cast<uint32_t>(header_len));
+  detail::put<uint32_t>(buf, off, static_cast<uint32_t>(count));
+  detail::put<uint32_t>(buf, off, (downsampled ? 1u : 0u) | (sparse ? 2u : 0u));
+  detail::put<int64_t>(buf, off, resolution_ms);
+  detail::put<int64_t>(buf, off, requested_resolution_ms);
+  detail::put<uint16_t>(buf, off, static_cast<uint16_t>(request_id.size()));
+  detail::put<uint16_t>(buf, off, static_cast<uint16_t>(symbol.size()));
+  detail::put<uint32_t>(buf, off, 0u);
+  std::memcpy(&buf[off], request_id.data(), request_id.size());
+  off += request_id.size();
+  std::memcpy(&buf[off], symbol.data(), symbol.size());
+
+  // Column-major: every ms, then every open, ... written in one pass with
+  // a cursor per column
+  size_t col[6];
+  for (size_t k = 0; k < 6; ++k) col[k] = header_len + k * count * 8;
+  for_each_bar(candles, resolution_ms, !sparse,
+               [&](long long t, double o, double h, double l, double c, double v) {
+    detail::put<int64_t>(buf, col[0], t);
+    detail::put<double>(buf, col[1], o);
+    detail::put<double>(buf, col[2], h);
+    detail::put<double>(buf, col[3], l);
+    detail::put<double>(buf, col[4], c);
+    detail::put<double>(buf, col[5], v);
+  });
+  return buf;
+}
+
+}  // namespace server
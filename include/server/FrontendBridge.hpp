@@ -4,6 +4,8 @@
 #include "engine/MarketDataTypes.hpp"
 #include "engine/CandleStore.hpp"
 #include "engine/IBroker.hpp"
+#include "engine/TickStore.hpp"
+#include "server/QueryExecutor.hpp"
 #include <memory>
 #include <functional>
 #include <thread>
@@ -11,9 +13,11 @@
 #include <mutex>
 #include <atomic>
 #include <deque>
+#include <optional>
 #include <set>
 #include <string>
 #include <chrono>
+#include <unordered_map>
 #include <nlohmann/json.hpp>
 #include <websocketpp/config/asio_no_tls.hpp>
 #include <websocketpp/server.hpp>
@@ -22,6 +26,14 @@
 FrontendBridge:
   Subscribes to EventBus topics (ProviderTick, OrderFill, etc.) and broadcasts
   them as JSON via WebSocket to connected frontend clients.
+
+  Live candles: a SubscribeCandles request gets the recent bars as a
+  SubscribeCandlesResponse (CandleStore history, topped up from the
+  TickStore when one is set), then CandleDelta messages carrying only the
+  bars that changed: the ones closed since the last delta and the bar in
+  progress. Deltas are built from the tick stream and coalesced, at most
+  max_delta_rate_hz per subscription; a client that falls behind on the
+  socket gets fewer, larger deltas rather than a growing backlog.
 */
 
 namespace server {
@@ -41,9 +53,31 @@ public:
   // Stop the bridge
   void stop();
 
+  // Handle ticks on a dedicated bus worker thread. Must be called before start().
+  void set_async_dispatch(eng::EventBus::AsyncOptions opts) { async_dispatch_ = std::move(opts); }
+
+  // Broadcast BarBuilder's bars at these intervals as ChartCandle messages
+  // (none by default). Must be called before start().
+  void set_chart_intervals(std::vector<long long> intervals_ms) { chart_intervals_ = std::move(intervals_ms); }
+
+  // Top up candle subscription backfills (and seed their open bar) from the
+  // engine's in-memory trades. Must be called before start().
+  void set_tick_store(std::shared_ptr<const eng::TickStore> store) { tick_store_ = std::move(store); }
+
+  // Upper bound on CandleDelta messages per subscription per second (a
+  // client may ask for fewer). Must be called before start().
+  void set_max_delta_rate_hz(double hz) { max_delta_rate_hz_ = hz; }
+
   // Get recent ticks (thread-safe)
   std::vector<json> get_recent_ticks(size_t limit = 100) const;
 
+  // Broadcasts are skipped for a client whose unsent backlog exceeds this
+  // (a stalled browser tab shouldn't grow server memory without bound)
+  void set_max_client_buffered_bytes(size_t bytes) { max_client_buffered_bytes_ = bytes; }
+
+  // Broadcast messages skipped because a client was over its backlog limit
+  uint64_t dropped_broadcasts() const { return dropped_broadcasts_.load(std::memory_order_relaxed); }
+
   // Access to persistent candle store (shared with CandlePersister)
   std::shared_ptr<eng::CandleStore> get_candle_store() { return candle_store_; }
 
@@ -52,8 +86,10 @@ private:
   eng::IBroker& broker_;
   int port_;
   std::atomic<bool> running_{false};
+  std::optional<eng::EventBus::AsyncOptions> async_dispatch_;
+  std::vector<long long> chart_intervals_;
   mutable std::mutex ticks_mutex_;
-  std::deque<json> recent_ticks_;
+  std::deque<std::shared_ptr<const std::string>> recent_ticks_;  // Serialized broadcasts
   static constexpr size_t MAX_TICKS = 200;
   std::string current_run_id_;
   std::unique_ptr<std::thread> ws_thread_;
@@ -68,13 +104,61 @@ private:
   mutable std::mutex ws_mutex_;
   std::unique_ptr<WebSocketServerType> ws_server_;
   std::set<connection_ptr> ws_connections_;
+  // Immutable copy of ws_connections_ for the broadcast path, replaced on
+  // connect/disconnect so fan-out never holds ws_mutex_ while sending
+  std::shared_ptr<const std::vector<connection_ptr>> client_snapshot_{
+      std::make_shared<const std::vector<connection_ptr>>()};
+  size_t max_client_buffered_bytes_{4 * 1024 * 1024};
+  std::atomic<uint64_t> dropped_broadcasts_{0};
+
+  // One SubscribeCandles, keyed by client and requestId
+  struct CandleSubscription {
+    connection_ptr conn;
+    const void* client{nullptr};
+    std::string id;                       // The subscribing requestId
+    std::string symbol;
+    long long resolution_ms{0};
+    std::chrono::milliseconds min_interval{0};
+    eng::TimePoint seed_ts{};             // Ticks before this are already in the backfill
+    size_t seed_pending{0};               // Ticks at seed_ts still to come that are in it too
+    bool live{false};                     // Backfill sent; deltas may follow
+    bool has_bar{false};
+    eng::Candle bar;                      // Bar in progress
+    std::vector<eng::Candle> closed;      // Closed since the last delta
+    bool dirty{false};
+    bool resync{false};                   // Too many closed bars queued; client should resubscribe
+    std::chrono::steady_clock::time_point next_send{};
+  };
+  static constexpr long long DELTA_TIMER_MS = 20;
+  static constexpr size_t MAX_PENDING_CLOSED_BARS = 1000;
+
+  std::shared_ptr<const eng::TickStore> tick_store_;
+  double max_delta_rate_hz_{10.0};
+  std::mutex subs_mutex_;
+  std::unordered_map<std::string, std::vector<std::shared_ptr<CandleSubscription>>> subs_by_symbol_;
+  std::atomic<size_t> subscription_count_{0};
+  // Newest tick handed to update_candle_subscriptions per symbol and how
+  // many carried that timestamp (guarded by subs_mutex_), so a seed can tell
+  // which of the stored trades at its timestamp are still on their way
+  struct TickMark {
+    eng::TimePoint ts{};
+    size_t count{0};
+  };
+  std::unordered_map<std::string, TickMark> tick_marks_;
+
+  // Runs RPC queries off the io thread (declared last: its workers use the
+  // store and broker, so it must stop before they go away)
+  std::unique_ptr<QueryExecutor> query_executor_;
 
   // Convert Tick to JSON and broadcast to all connected clients
   void on_provider_tick(const eng::Tick& tick);
+  void on_chart_bar(const eng::Bar& bar);
   void on_order_placed(const eng::Order& order);
   void on_order_filled(const eng::Order& order);
   void on_order_rejected(const eng::Order& order);
   void broadcast_to_clients(const json& msg);
+  void fan_out(const std::string& payload);    // Runs on the io thread
+  void refresh_client_snapshot();              // Must hold ws_mutex_
   void emit_run_start();
   std::string generate_run_id() const;
   
@@ -86,14 +170,32 @@ private:
   
   // Handle incoming WebSocket messages (queries, commands)
   void handle_ws_message(websocketpp::connection_hdl hdl, const json& msg);
+
+  // Queue a response for one client on the io thread; dropped there if the
+  // request was cancelled or superseded in the meantime
+  void send_response(websocketpp::connection_hdl hdl, std::string payload,
+                     websocketpp::frame::opcode::value op = websocketpp::frame::opcode::text,
+                     const QueryExecutor::CancelToken& token = nullptr);
   
-  // RPC query handlers (send response to specific client)
-  void handle_query_candles(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id);
-  void handle_query_events(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id);
+  // RPC query handlers (run on query_executor_, send response to specific client)
+  void handle_query_candles(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id,
+                            const QueryExecutor::CancelToken& token);
+  void handle_query_events(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id,
+                           const QueryExecutor::CancelToken& token);
   void handle_query_balance(websocketpp::connection_hdl hdl, const std::string& request_id);
   void handle_query_positions(websocketpp::connection_hdl hdl, const std::string& request_id);
-  void handle_query_orders(websocketpp::connection_hdl hdl, const std::string& request_id);
+  void handle_query_orders(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id);
   void handle_query_default_viewport(websocketpp::connection_hdl hdl, const std::string& request_id);
+  void handle_query_metrics(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id);
+  void handle_subscribe_candles(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id,
+                                const QueryExecutor::CancelToken& token);
+
+  // Candle subscriptions (subs_mutex_ is taken inside)
+  bool remove_subscription(const void* client, const std::string& id);
+  void remove_client_subscriptions(const void* client);
+  void update_candle_subscriptions(const eng::Tick& tick);   // Feed side, per tick
+  void schedule_delta_timer();                               // Runs on the io thread
+  void flush_candle_deltas();                                // Runs on the io thread
 };
 
 
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+/*
+QueryExecutor:
+  Small worker pool that runs FrontendBridge RPC queries off the websocket io
+  thread, so one slow candle query doesn't stall other clients or live
+  broadcasts.
+
+  Every task is keyed by (client, requestId) and carries a cancel token:
+    - a new task with the same key supersedes the old one (the frontend
+      reuses requestIds for repeated viewport polls)
+    - cancel() / cancel_client() flag the token of pending and running tasks
+  Tasks cancelled before a worker picks them up are dropped without running;
+  running tasks are expected to poll the token (CandleStore checks it while
+  stepping its SQLite cursor) and the bridge drops their responses.
+*/
+
+namespace server {
+
+class QueryExecutor {
+public:
+  using CancelToken = std::shared_ptr<std::atomic<bool>>;
+  using Task = std::function<void(const CancelToken&)>;
+
+  struct Stats {
+    uint64_t submitted{0};
+    uint64_t completed{0};
+    uint64_t skipped{0};       // Cancelled before a worker started them
+    uint64_t superseded{0};    // Replaced by a newer task with the same key
+    size_t pending{0};
+  };
+
+  explicit QueryExecutor(size_t num_threads = 2);
+  ~QueryExecutor();
+
+  QueryExecutor(const QueryExecutor&) = delete;
+  QueryExecutor& operator=(const QueryExecutor&) = delete;
+
+  // Queue a task. An empty request_id is never superseded or cancellable by id.
+  CancelToken submit(const void* client, const std::string& request_id, Task task);
+
+  // Cancel one request; returns false if it wasn't pending or running
+  bool cancel(const void* client, const std::string& request_id);
+
+  // Cancel everything a client has queued or running (e.g. on disconnect)
+  void cancel_client(const void* client);
+
+  // Cancel pending work and join the workers
+  void stop();
+
+  Stats stats() const;
+
+private:
+  struct Key {
+    const void* client;
+    std::string request_id;
+
+    bool operator<(const Key& other) const {
+      return std::tie(client, request_id) < std::tie(other.client, other.request_id);
+    }
+  };
+
+  struct Job {
+    Key key;
+    CancelToken token;
+    Task task;
+  };
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Job> queue_;
+  std::map<Key, CancelToken> active_;   // Pending or running, by key
+  std::vector<std::thread> workers_;
+  bool stopping_{false};
+  Stats stats_;
+
+  void worker_loop();
+};
+
+}  // namespace server
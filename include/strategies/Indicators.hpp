@@ -0,0 +1,287 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+/*
+Indicators:
+  Header-only streaming indicator kernels for strategies. Every update is O(1)
+  (amortized O(1) for rolling min/max) and storage is a fixed-capacity ring
+  allocated once up front, so a 10,000-tick window costs the same per tick as
+  a 5-tick one.
+
+  Windowed indicators report over the values seen so far until the window
+  fills (count() < window()); check ready() if a full window is required.
+*/
+
+namespace strategy::indicators {
+
+// Fixed-capacity ring buffer; push() overwrites the oldest value when full
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity) : data_(capacity) {
+        if (capacity == 0) throw std::invalid_argument("RingBuffer capacity must be positive");
+    }
+
+    // Append a value; returns true and sets `evicted` if an old one fell out
+    bool push(const T& value, T& evicted) {
+        bool full = size_ == data_.size();
+        if (full) evicted = data_[head_];
+        data_[head_] = value;
+        head_ = (head_ + 1 == data_.size()) ? 0 : head_ + 1;
+        if (!full) ++size_;
+        return full;
+    }
+
+    // i = 0 is the oldest value
+    const T& operator[](size_t i) const {
+        size_t start = (size_ == data_.size()) ? head_ : 0;
+        size_t idx = start + i;
+        if (idx >= data_.size()) idx -= data_.size();
+        return data_[idx];
+    }
+
+    const T& newest() const { return data_[head_ == 0 ? data_.size() - 1 : head_ - 1]; }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return data_.size(); }
+    bool full() const { return size_ == data_.size(); }
+    void clear() { head_ = 0; size_ = 0; }
+
+private:
+    std::vector<T> data_;
+    size_t head_{0};   // Next slot to write
+    size_t size_{0};
+};
+
+// Sum over the last N values (Neumaier-compensated so add/subtract doesn't drift)
+class RollingSum {
+public:
+    explicit RollingSum(size_t window) : values_(window) {}
+
+    void update(double x) {
+        double evicted;
+        if (values_.push(x, evicted)) add(-evicted);
+        add(x);
+    }
+
+    double value() const { return sum_ + compensation_; }
+    size_t count() const { return values_.size(); }
+    size_t window() const { return values_.capacity(); }
+    bool ready() const { return values_.full(); }
+    const RingBuffer<double>& values() const { return values_; }
+
+    void reset() { values_.clear(); sum_ = 0.0; compensation_ = 0.0; }
+
+    // Exact internal state, for checkpoints: restore() from values() (oldest
+    // first), raw_sum() and compensation() carries on bit for bit
+    double raw_sum() const { return sum_; }
+    double compensation() const { return compensation_; }
+    void restore(const std::vector<double>& oldest_first, double raw_sum, double compensation) {
+        if (oldest_first.size() > window()) throw std::invalid_argument("RollingSum: more values than the window");
+        values_.clear();
+        double evicted;
+        for (double x : oldest_first) values_.push(x, evicted);
+        sum_ = raw_sum;
+        compensation_ = compensation;
+    }
+
+private:
+    RingBuffer<double> values_;
+    double sum_{0.0};
+    double compensation_{0.0};
+
+    void add(double x) {
+        double t = sum_ + x;
+        if (std::fabs(sum_) >= std::fabs(x)) compensation_ += (sum_ - t) + x;
+        else compensation_ += (x - t) + sum_;
+        sum_ = t;
+    }
+};
+
+// Simple moving average over the last N values
+class Sma {
+public:
+    explicit Sma(size_t window) : sum_(window) {}
+
+    double update(double x) { sum_.update(x); return value(); }
+    double value() const { return sum_.count() ? sum_.value() / static_cast<double>(sum_.count()) : 0.0; }
+    size_t count() const { return sum_.count(); }
+    size_t window() const { return sum_.window(); }
+    bool ready() const { return sum_.ready(); }
+    void reset() { sum_.reset(); }
+
+    // For checkpoints, see RollingSum::restore()
+    const RollingSum& rolling_sum() const { return sum_; }
+    RollingSum& rolling_sum() { return sum_; }
+
+private:
+    RollingSum sum_;
+};
+
+// Exponential moving average; seeded with the first value
+class Ema {
+public:
+    // Conventional period form: alpha = 2 / (period + 1)
+    explicit Ema(size_t period) : Ema(2.0 / (static_cast<double>(period) + 1.0), 0) {}
+
+    static Ema with_alpha(double alpha) { return Ema(alpha, 0); }
+
+    double update(double x) {
+        value_ = has_value_ ? value_ + alpha_ * (x - value_) : x;
+        has_value_ = true;
+        return value_;
+    }
+
+    double value() const { return value_; }
+    double alpha() const { return alpha_; }
+    bool ready() const { return has_value_; }
+    void reset() { value_ = 0.0; has_value_ = false; }
+
+private:
+    Ema(double alpha, int) : alpha_(alpha) {
+        if (!(alpha > 0.0 && alpha <= 1.0)) throw std::invalid_argument("EMA alpha must be in (0, 1]");
+    }
+
+    double alpha_;
+    double value_{0.0};
+    bool has_value_{false};
+};
+
+// Rolling min or max over the last N values via a monotonic deque.
+// Compare(a, b) true means a should be dropped when b arrives
+// (std::less_equal-like for max, greater_equal-like for min).
+template <typename Compare>
+class RollingExtremum {
+public:
+    explicit RollingExtremum(size_t window)
+        : window_(window), slots_(window) {
+        if (window == 0) throw std::invalid_argument("RollingExtremum window must be positive");
+    }
+
+    double update(double x) {
+        // Drop the candidate that aged out and any the new value dominates
+        if (size_ > 0 && front().seq + window_ <= seq_) pop_front();
+        while (size_ > 0 && Compare{}(back().value, x)) pop_back();
+        push_back(Entry{seq_, x});
+        ++seq_;
+        return value();
+    }
+
+    double value() const { return size_ ? front().value : std::numeric_limits<double>::quiet_NaN(); }
+    size_t count() const { return seq_ < window_ ? static_cast<size_t>(seq_) : window_; }
+    size_t window() const { return window_; }
+    bool ready() const { return seq_ >= window_; }
+    void reset() { head_ = 0; size_ = 0; seq_ = 0; }
+
+private:
+    struct Entry {
+        unsigned long long seq;
+        double value;
+    };
+
+    size_t window_;
+    std::vector<Entry> slots_;   // Ring storage for the deque (never exceeds window entries)
+    size_t head_{0};
+    size_t size_{0};
+    unsigned long long seq_{0};
+
+    Entry& front() { return slots_[head_]; }
+    const Entry& front() const { return slots_[head_]; }
+    Entry& back() { return slots_[(head_ + size_ - 1) % window_]; }
+    void push_back(const Entry& e) { slots_[(head_ + size_) % window_] = e; ++size_; }
+    void pop_back() { --size_; }
+    void pop_front() { head_ = (head_ + 1) % window_; --size_; }
+};
+
+struct DropIfNotGreater { bool operator()(double kept, double incoming) const { return kept <= incoming; } };
+struct DropIfNotLess    { bool operator()(double kept, double incoming) const { return kept >= incoming; } };
+
+using RollingMax = RollingExtremum<DropIfNotGreater>;
+using RollingMin = RollingExtremum<DropIfNotLess>;
+
+// Rolling mean/variance over the last N values (windowed Welford)
+class RollingVariance {
+public:
+    explicit RollingVariance(size_t window) : values_(window) {}
+
+    void update(double x) {
+        double evicted;
+        if (values_.push(x, evicted)) {
+            // Replace evicted with x at constant n
+            double n = static_cast<double>(values_.size());
+            double old_mean = mean_;
+            mean_ += (x - evicted) / n;
+            m2_ += (x - evicted) * (x - mean_ + evicted - old_mean);
+        } else {
+            double n = static_cast<double>(values_.size());
+            double delta = x - mean_;
+            mean_ += delta / n;
+            m2_ += delta * (x - mean_);
+        }
+        if (m2_ < 0.0) m2_ = 0.0;  // Rounding can push a flat window slightly negative
+    }
+
+    double mean() const { return mean_; }
+    // Population variance (divide by n); sample_variance() divides by n - 1
+    double variance() const { return values_.size() ? m2_ / static_cast<double>(values_.size()) : 0.0; }
+    double sample_variance() const { return values_.size() > 1 ? m2_ / static_cast<double>(values_.size() - 1) : 0.0; }
+    double stddev() const { return std::sqrt(variance()); }
+    size_t count() const { return values_.size(); }
+    size_t window() const { return values_.capacity(); }
+    bool ready() const { return values_.full(); }
+    void reset() { values_.clear(); mean_ = 0.0; m2_ = 0.0; }
+
+private:
+    RingBuffer<double> values_;
+    double mean_{0.0};
+    double m2_{0.0};
+};
+
+// Volume-weighted average price over the last N trades
+class RollingVwap {
+public:
+    explicit RollingVwap(size_t window) : notional_(window), volume_(window) {}
+
+    double update(double price, double qty) {
+        notional_.update(price * qty);
+        volume_.update(qty);
+        return value();
+    }
+
+    double value() const {
+        double v = volume_.value();
+        return v > 0.0 ? notional_.value() / v : std::numeric_limits<double>::quiet_NaN();
+    }
+    double volume() const { return volume_.value(); }
+    size_t count() const { return volume_.count(); }
+    bool ready() const { return volume_.ready(); }
+    void reset() { notional_.reset(); volume_.reset(); }
+
+private:
+    RollingSum notional_;
+    RollingSum volume_;
+};
+
+// Session VWAP since the last reset()
+class Vwap {
+public:
+    double update(double price, double qty) {
+        notional_ += price * qty;
+        volume_ += qty;
+        return value();
+    }
+
+    double value() const { return volume_ > 0.0 ? notional_ / volume_ : std::numeric_limits<double>::quiet_NaN(); }
+    double volume() const { return volume_; }
+    void reset() { notional_ = 0.0; volume_ = 0.0; }
+
+private:
+    double notional_{0.0};
+    double volume_{0.0};
+};
+
+}  // namespace strategy::indicators
@@ -1,32 +1,32 @@
 #pragma once
+#include "engine/Checkpoint.hpp"
+#include "engine/FixedPoint.hpp"
 #include "engine/IStrategy.hpp"
-#include <deque>
+#include "engine/Logger.hpp"
+#include "engine/TickStore.hpp"
+#include "strategies/Indicators.hpp"
 #include <string>
-#include <iostream>
 #include <iomanip>
 
 namespace strategy {
 
 // Simple moving-average based strategy. Keeps a rolling window of the last N prices
 // and computes the SMA. If price > SMA + threshold => Buy. If price < SMA - threshold => Sell.
+// The SMA is a running sum over a fixed ring (indicators::Sma), so every tick is O(1)
+// whatever the window.
 class MovingAverageStrategy : public eng::IStrategy {
 public:
     MovingAverageStrategy(std::string symbol, size_t window = 5, double threshold = 0.5, double qty = 0.01)
-      : symbol_(std::move(symbol)), window_(window), threshold_(threshold), qty_(qty) {}
+      : symbol_(std::move(symbol)), window_(window), threshold_(threshold), qty_(qty), sma_(window) {}
 
     
     // called by engine via callback function when any ProviderTick arrives on the bus
     void on_price_tick(const eng::PriceData& pd) override {
         // symbol filtering: return if we don't care about this symbol.
-        if (pd.symbol != symbol_) return;
-        prices_.push_back(pd.last);
-        if (prices_.size() > window_) prices_.pop_front();
+        if (!is_our_instrument(pd)) return;
 
-        if (prices_.size() < 1) { action_ = eng::TradeAction::None; return; }
-
-        double sum = 0.0;
-        for (double v : prices_) sum += v;
-        double sma = sum / static_cast<double>(prices_.size());
+        // Averages over what we have until the window fills
+        double sma = sma_.update(pd.last);
         last_sma_ = sma;
         last_price_ = pd.last;
 
@@ -35,40 +35,97 @@ public:
         else action_ = eng::TradeAction::None;
 
         // Print current holdings and SMA info each tick for visibility
-        double position = total_bought_qty_ - total_sold_qty_;
-        std::cout << std::fixed << std::setprecision(2);
-        std::cout << "[MovingAverage] Tick " << pd.symbol << " @ " << pd.last
-                  << " SMA=" << sma << " pos=" << position
-                  << " bought=" << total_bought_qty_ << " sold=" << total_sold_qty_ << "\n";
+        ENG_LOG_DEBUG(std::fixed << std::setprecision(2)
+                      << "[MovingAverage] Tick " << pd.symbol << " @ " << pd.last
+                      << " SMA=" << sma << " pos=" << (total_bought_qty_ - total_sold_qty_)
+                      << " bought=" << total_bought_qty_ << " sold=" << total_sold_qty_);
     }
 
     eng::TradeAction get_trade_action() override { return action_; }
 
+    // Seed the SMA from recorded trades in [since, until) so the first live
+    // tick already sees a full window. Sets no action.
+    void warm_up(const eng::TickStore& store, eng::TimePoint since, eng::TimePoint until) {
+        store.scan(symbol_, since, until, [this](eng::TimePoint, double px, double, eng::TradeSide) {
+            last_sma_ = sma_.update(px);
+            last_price_ = px;
+        });
+    }
+
     void on_order_fill(const eng::Order& order) override {
         // Update bought/sold totals on fill and reset the action
         if (order.side == eng::Order::Side::Buy) {
-            total_bought_qty_ += order.qty;
+            total_bought_qty_ += eng::Quantity(order.qty);
         } else {
-            total_sold_qty_ += order.qty;
+            total_sold_qty_ += eng::Quantity(order.qty);
         }
         action_ = eng::TradeAction::None;
     }
 
     double get_net_position() const override {
-        return total_bought_qty_ - total_sold_qty_;
+        return eng::to_double(total_bought_qty_ - total_sold_qty_);
+    }
+
+    bool save_state(eng::CheckpointWriter& out) const override {
+        out.put_string("MovingAverage");
+        out.put_string(symbol_);
+        out.put<uint64_t>(window_);
+        out.put<eng::InstrumentId>(instrument_id_);
+        const auto& sum = sma_.rolling_sum();
+        out.put<uint64_t>(sum.count());
+        for (size_t i = 0; i < sum.count(); ++i) out.put<double>(sum.values()[i]);
+        out.put<double>(sum.raw_sum());
+        out.put<double>(sum.compensation());
+        out.put<double>(last_price_);
+        out.put<double>(last_sma_);
+        out.put<int32_t>(static_cast<int32_t>(action_));
+        out.put<eng::Quantity>(total_bought_qty_);
+        out.put<eng::Quantity>(total_sold_qty_);
+        return true;
+    }
+
+    void load_state(eng::CheckpointReader& in) override {
+        if (in.get_string() != "MovingAverage") in.fail("not a MovingAverage checkpoint");
+        if (in.get_string() != symbol_) in.fail("MovingAverage checkpoint is for another symbol");
+        if (in.get<uint64_t>() != window_) in.fail("MovingAverage checkpoint has another window");
+        instrument_id_ = in.get<eng::InstrumentId>();
+        std::vector<double> values(in.get<uint64_t>());
+        for (double& v : values) v = in.get<double>();
+        const double raw_sum = in.get<double>();
+        const double compensation = in.get<double>();
+        sma_.rolling_sum().restore(values, raw_sum, compensation);
+        last_price_ = in.get<double>();
+        last_sma_ = in.get<double>();
+        action_ = static_cast<eng::TradeAction>(in.get<int32_t>());
+        total_bought_qty_ = in.get<eng::Quantity>();
+        total_sold_qty_ = in.get<eng::Quantity>();
+        if (!in.done()) in.fail("unexpected trailing data");
     }
 
 private:
+    // Match by registry id once we've seen our symbol carry one; only
+    // unregistered ticks (id 0) need the string compare.
+    bool is_our_instrument(const eng::PriceData& pd) {
+        if (pd.instrument_id != 0) {
+            if (instrument_id_ != 0) return pd.instrument_id == instrument_id_;
+            if (pd.symbol != symbol_) return false;
+            instrument_id_ = pd.instrument_id;
+            return true;
+        }
+        return pd.symbol == symbol_;
+    }
+
     std::string symbol_;
+    eng::InstrumentId instrument_id_{0};   // Bound from the first matching tick
     size_t window_;
     double threshold_;
     double qty_;
-    std::deque<double> prices_;
+    indicators::Sma sma_;
     double last_price_{0.0};
     double last_sma_{0.0};
     eng::TradeAction action_{eng::TradeAction::None};
-    double total_bought_qty_{0.0};
-    double total_sold_qty_{0.0};
+    eng::Quantity total_bought_qty_{};   // Exact in ENG_FIXED_POINT builds
+    eng::Quantity total_sold_qty_{};
 };
 
 } // namespace strategy
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+MovingAverageSweep:
+  In-process parameter sweep for MovingAverageStrategy. Instead of one
+  trading_engine process per configuration, each day's prices are loaded
+  once into a flat column and every configuration ("lane") is evaluated over
+  it in a single pass.
+
+  Lanes sharing a window share one running SMA; the per-tick decision and
+  fill bookkeeping for all of a window's thresholds then runs as a
+  branch-free loop over struct-of-arrays lane state, which the compiler
+  vectorizes. Work is split across threads by (day, window group).
+
+  The simulated fills mirror Engine + NullBroker for a single symbol: a Buy
+  fills at the tick price if the cash covers it (otherwise it's rejected), a
+  Sell closes the whole position if one is open (otherwise it's skipped).
+  Each day starts flat with the initial balance, like a fresh engine run.
+*/
+
+namespace strategy {
+
+struct MovingAverageParams {
+    size_t window{5};
+    double threshold{0.5};
+    double qty{0.01};   // Order size; the Engine currently always sends 0.01
+};
+
+struct SweepLaneResult {
+    double balance{0.0};      // Cash at end of day
+    double position{0.0};     // Open quantity at end of day
+    double equity{0.0};       // balance + position marked at the last price
+    uint32_t buys{0};
+    uint32_t sells{0};
+    uint32_t rejected_buys{0};   // Insufficient balance
+    uint32_t skipped_sells{0};   // Sell signal with no position open
+};
+
+class MovingAverageSweep {
+public:
+    struct Config {
+        double initial_balance{1'000'000.0};
+        size_t num_threads{0};   // 0 = hardware concurrency
+    };
+
+    // Loads day `index` (called concurrently from worker threads)
+    using DayLoader = std::function<std::vector<double>(size_t index)>;
+
+    explicit MovingAverageSweep(std::vector<MovingAverageParams> lanes);
+    MovingAverageSweep(std::vector<MovingAverageParams> lanes, Config config);
+
+    // Cartesian product of windows x thresholds, all with the same qty
+    static std::vector<MovingAverageParams> grid(const std::vector<size_t>& windows,
+                                                 const std::vector<double>& thresholds,
+                                                 double qty = 0.01);
+
+    const std::vector<MovingAverageParams>& lanes() const { return lanes_; }
+
+    // Evaluate every lane over every day; returns results[day][lane]
+    std::vector<std::vector<SweepLaneResult>> run(size_t num_days, const DayLoader& load) const;
+
+    // Evaluate every lane over one in-memory price column
+    std::vector<SweepLaneResult> run_day(const std::vector<double>& prices) const;
+
+private:
+    struct WindowGroup {
+        size_t window;
+        std::vector<size_t> lane_index;   // Into lanes_
+        std::vector<double> threshold;
+        std::vector<double> qty;
+    };
+
+    std::vector<MovingAverageParams> lanes_;
+    Config config_;
+    std::vector<WindowGroup> groups_;
+
+    void evaluate_group(const WindowGroup& group, const double* prices, size_t n,
+                        std::vector<SweepLaneResult>& out) const;
+};
+
+}  // namespace strategy
@@ -1,12 +1,93 @@
 #pragma once
-#include <string>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+WebSocketClient:
+  Small blocking RFC 6455 client over a plain (ws://) or TLS (wss://,
+  OpenSSL) socket, for exchange feeds. The caller's thread drives it:
+  connect(), then poll() in a loop.
+
+  Frames are parsed in place in the receive buffer and every complete
+  message is handed to the callback as a view into it, so a steady stream
+  of small messages costs no copies or allocations. Fragmented messages
+  (rare on exchange feeds) are reassembled in a buffer that is reused.
+
+  Pings are answered inside poll(); a close frame from the server is
+  echoed and ends the connection.
 
+  connect() throws std::runtime_error; afterwards a failure closes the
+  connection, poll()/send() return false and last_error() says why. One
+  thread uses an instance (callbacks run on it and may call send()/close()).
+*/
 class WebSocketClient {
 public:
-    // Connect to a WebSocket endpoint
-    void connect(const std::string& uri);
-    // Register a message callback
-    void on_message(std::function<void(const std::string&)> cb);
-    // TODO: add send(), close(), error handling, etc.
+    // `payload` points into the receive buffer; only valid during the call
+    using MessageHandler = std::function<void(std::string_view payload)>;
+
+    WebSocketClient();
+    ~WebSocketClient();
+
+    WebSocketClient(const WebSocketClient&) = delete;
+    WebSocketClient& operator=(const WebSocketClient&) = delete;
+
+    // Connect to a ws:// or wss:// endpoint and finish the opening handshake
+    // within timeout_ms. Drops any previous connection first.
+    void connect(const std::string& uri, int timeout_ms = 10000);
+
+    // Register a message callback (text and binary messages alike)
+    void on_message(MessageHandler cb) { on_message_ = std::move(cb); }
+
+    // Send one text message; false if the connection is gone
+    bool send(std::string_view text);
+
+    // Wait up to timeout_ms for data, then dispatch every complete message
+    // that has arrived. False once the connection is closed or failed.
+    bool poll(int timeout_ms);
+
+    // Send a close frame (best effort) and drop the connection
+    void close(uint16_t code = 1000);
+
+    bool is_open() const { return fd_ >= 0; }
+    const std::string& last_error() const { return error_; }
+
+private:
+    struct Tls;   // OpenSSL state, wss:// only
+
+    static constexpr size_t kInitialBuffer = 64 * 1024;
+    static constexpr size_t kMaxMessage = 16 * 1024 * 1024;
+
+    int fd_{-1};
+    std::unique_ptr<Tls> tls_;
+    MessageHandler on_message_;
+    std::vector<char> rx_;        // Receive buffer; [rx_begin_, rx_end_) is unparsed
+    size_t rx_begin_{0};
+    size_t rx_end_{0};
+    std::string fragments_;       // Message being reassembled
+    bool fragmented_{false};
+    std::vector<char> tx_;        // Outgoing frame scratch
+    std::string error_;
+
+    void open_socket(const std::string& host, const std::string& port, int timeout_ms);
+    void start_tls(const std::string& host, int timeout_ms);
+    void handshake(const std::string& host, const std::string& port, const std::string& path, int timeout_ms);
+
+    // > 0: bytes moved; 0: would block; < 0: closed or failed
+    long read_raw(char* buf, size_t n);
+    long write_raw(const char* buf, size_t n);
+    bool wait(bool for_write, int timeout_ms);
+    bool write_all(const char* data, size_t n);
+    // Read whatever is ready into rx_, dispatching the complete frames
+    // whenever it fills up; false on close/failure
+    bool fill();
+
+    bool send_frame(uint8_t opcode, const char* data, size_t n);
+    bool dispatch_frames();
+    void fail(std::string why);
+    void reset();
 };
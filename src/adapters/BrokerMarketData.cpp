@@ -1,6 +1,6 @@
 #include "adapters/BrokerMarketData.hpp"
 #include "engine/Types.hpp"  // for PriceData (your existing type)
-#include <iostream>
+#include "engine/Logger.hpp"
 #include <random>
 #include <cmath>
 
@@ -22,7 +22,7 @@ void BrokerMarketData::subscribe_ticks(const std::vector<std::string>& symbols,
     }
     // Store the handler so multiple subscribers receive ticks
     on_tick_handlers_.push_back(std::move(on_tick));
-    std::cout << "[BrokerMarketData] adapter subscribed (total handlers=" << on_tick_handlers_.size() << ")\n";
+    ENG_LOG_INFO("[BrokerMarketData] adapter subscribed (total handlers=" << on_tick_handlers_.size() << ")");
 }
 
 void BrokerMarketData::stop() {
@@ -36,7 +36,7 @@ void BrokerMarketData::stop() {
 // final 15 seconds ([-2.0, +1.0]) to bias price direction the other way.
 // Each second emission is rounded to the nearest cent.
 void BrokerMarketData::start(int seconds = 45) {
-    std::cout << "[BrokerMarketData] starting demo thread (" << seconds << "s)\n";
+    ENG_LOG_INFO("[BrokerMarketData] starting demo thread (" << seconds << "s)");
     if (running_.exchange(true)) return;
 
     th_ = std::thread([this, seconds] {
@@ -84,7 +84,8 @@ void BrokerMarketData::start(int seconds = 45) {
                 // emit a tick for each symbol to all handlers
                 for (const auto& s : syms) {
                     eng::Tick t{ s, px, now_tp };
-                    std::cout << "[BrokerMarketData thread] emitting tick " << s << " @ " << px << '\n';
+                    if (tick_store_) tick_store_->append(t);
+                    ENG_LOG_DEBUG("[BrokerMarketData thread] emitting tick " << s << " @ " << px);
                     for (auto &h : handlers) {
                         if (h) h(t);
                     }
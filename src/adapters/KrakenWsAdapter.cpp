@@ -0,0 +1,215 @@
+#include "adapters/KrakenWsAdapter.hpp"
+#include "engine/Logger.hpp"
+#include "engine/Metrics.hpp"
+#include "support/WebSocketClient.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+
+
+namespace adapter {
+
+KrakenWsAdapter::KrakenWsAdapter(Options opts, std::shared_ptr<eng::InstrumentRegistry> registry)
+    : opts_(std::move(opts)), registry_(registry), parser_(registry, false),
+      queue_(opts_.queue_capacity) {}
+
+void KrakenWsAdapter::subscribe_trades(const std::vector<std::string>& symbols,
+                                       std::function<void(const eng::TradePrint&)> on_trade) {
+    for (const auto& s : symbols) handlers_[s].trades.push_back(on_trade);
+}
+
+void KrakenWsAdapter::subscribe_ticks(const std::vector<std::string>& symbols,
+                                      std::function<void(const eng::Tick&)> on_tick) {
+    for (const auto& s : symbols) handlers_[s].ticks.push_back(on_tick);
+}
+
+void KrakenWsAdapter::start() {
+    if (running_.exchange(true)) return;
+    if (opts_.pairs.empty()) ENG_LOG_WARN("[KrakenWsAdapter] No pairs to subscribe to");
+    ingest_done_ = false;
+    dispatch_ = std::thread([this] { run_dispatch(); });
+    ingest_ = std::thread([this] { run_ingest(); });
+}
+
+void KrakenWsAdapter::stop() {
+    if (!running_.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_all();
+    }
+    if (ingest_.joinable()) ingest_.join();
+    if (dispatch_.joinable()) dispatch_.join();
+    const Stats s = stats();
+    ENG_LOG_INFO("[KrakenWsAdapter] Stopped: " << s.trades << " trades in " << s.frames << " frames, "
+                 << s.reconnects << " reconnects, " << s.malformed << " malformed");
+}
+
+KrakenWsAdapter::Stats KrakenWsAdapter::stats() const {
+    Stats s;
+    s.frames = frames_.load(std::memory_order_relaxed);
+    s.trades = trades_.load(std::memory_order_relaxed);
+    s.malformed = malformed_.load(std::memory_order_relaxed);
+    s.connects = connects_.load(std::memory_order_relaxed);
+    s.reconnects = reconnects_.load(std::memory_order_relaxed);
+    return s;
+}
+
+std::string KrakenWsAdapter::subscribe_message() const {
+    // No snapshot: after a reconnect it would replay trades already delivered
+    nlohmann::json msg = {
+        {"method", "subscribe"},
+        {"params", {{"channel", "trade"}, {"symbol", opts_.pairs}, {"snapshot", false}}},
+    };
+    return msg.dump();
+}
+
+void KrakenWsAdapter::run_ingest() {
+    WebSocketClient ws;
+    ws.on_message([this](std::string_view payload) { on_frame(payload); });
+    const std::string subscribe = subscribe_message();
+    int delay_ms = 500;
+
+    while (running_.load(std::memory_order_acquire)) {
+        try {
+            ws.connect(opts_.url, opts_.connect_timeout_ms);
+        } catch (const std::exception& e) {
+            ENG_LOG_WARN("[KrakenWsAdapter] " << e.what() << "; retrying in " << delay_ms << "ms");
+            if (!backoff(delay_ms)) break;
+            delay_ms = std::min(delay_ms * 2, opts_.max_backoff_ms);
+            continue;
+        }
+        if (connects_.fetch_add(1, std::memory_order_relaxed) > 0) {
+            reconnects_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!ws.send(subscribe)) {
+            ENG_LOG_WARN("[KrakenWsAdapter] Subscribe failed: " << ws.last_error());
+            if (!backoff(delay_ms)) break;
+            continue;
+        }
+        ENG_LOG_INFO("[KrakenWsAdapter] Connected to " << opts_.url << ", subscribed to " << opts_.pairs.size()
+                     << " pairs");
+
+        // Read until the connection fails, goes quiet, or we're stopped
+        auto last_frame = std::chrono::steady_clock::now();
+        uint64_t frames_seen = frames_.load(std::memory_order_relaxed);
+        while (running_.load(std::memory_order_acquire)) {
+            if (!ws.poll(100)) {
+                ENG_LOG_WARN("[KrakenWsAdapter] Connection lost: " << ws.last_error());
+                break;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            const uint64_t frames = frames_.load(std::memory_order_relaxed);
+            if (frames != frames_seen) {
+                frames_seen = frames;
+                last_frame = now;
+                delay_ms = 500;   // Healthy again
+            } else if (now - last_frame > std::chrono::milliseconds(opts_.stale_after_ms)) {
+                ENG_LOG_WARN("[KrakenWsAdapter] No data for " << opts_.stale_after_ms << "ms; reconnecting");
+                ws.close();
+                break;
+            }
+        }
+        if (running_.load(std::memory_order_acquire)) {
+            if (!backoff(delay_ms)) break;
+            delay_ms = std::min(delay_ms * 2, opts_.max_backoff_ms);
+        }
+    }
+    ws.close();
+    ingest_done_.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    wake_cv_.notify_all();
+}
+
+void KrakenWsAdapter::on_frame(std::string_view payload) {
+    const int64_t recv_ns = ENG_METRICS_NOW();
+    frames_.fetch_add(1, std::memory_order_relaxed);
+
+    const auto kind = parser_.parse_ws(payload, scratch_, [this, recv_ns](const eng::TradePrint& tp) {
+        enqueue(tp, recv_ns);
+    });
+    if (kind == KrakenTradeParser::WsMessage::Malformed) {
+        if (malformed_.fetch_add(1, std::memory_order_relaxed) == 0) {
+            ENG_LOG_WARN("[KrakenWsAdapter] Unreadable message: " << payload.substr(0, 256));
+        }
+    } else if (kind == KrakenTradeParser::WsMessage::Other &&
+               payload.find("\"success\":false") != std::string_view::npos) {
+        // Rejected subscription (unknown pair, say); rare, so log it whole
+        ENG_LOG_ERROR("[KrakenWsAdapter] " << payload);
+    }
+}
+
+void KrakenWsAdapter::enqueue(const eng::TradePrint& tp, int64_t recv_ns) {
+    pending_.tp = tp;            // Reuses pending_'s string capacity
+    pending_.recv_ns = recv_ns;
+    while (!queue_.try_push(pending_)) {
+        if (!running_.load(std::memory_order_acquire)) return;
+        std::this_thread::yield();
+    }
+    trades_.fetch_add(1, std::memory_order_relaxed);
+    if (sleeping_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_all();
+    }
+}
+
+void KrakenWsAdapter::run_dispatch() {
+    Item item;
+    int idle_spins = 0;
+    while (true) {
+        if (queue_.try_pop(item)) {
+            deliver(item);
+            idle_spins = 0;
+            continue;
+        }
+        if (ingest_done_.load(std::memory_order_acquire)) break;
+        if (opts_.busy_poll || ++idle_spins < SPIN_BEFORE_SLEEP) {
+            std::this_thread::yield();
+            continue;
+        }
+        // Park until the ingest thread wakes us; the timeout covers a wakeup
+        // racing with sleeping_ being set
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        sleeping_.store(true, std::memory_order_release);
+        if (queue_.size_approx() == 0 && !ingest_done_.load(std::memory_order_acquire)) {
+            wake_cv_.wait_for(lock, std::chrono::milliseconds(1));
+        }
+        sleeping_.store(false, std::memory_order_release);
+        idle_spins = 0;
+    }
+    // The ingest thread has exited: deliver what it queued
+    while (queue_.try_pop(item)) deliver(item);
+}
+
+void KrakenWsAdapter::deliver(const Item& item) {
+    const eng::TradePrint& tp = item.tp;
+    if (tp.instrument_id == 0 || tp.instrument_id != cached_id_) {
+        auto it = handlers_.find(tp.symbol);
+        cached_ = it != handlers_.end() ? &it->second : nullptr;
+        cached_id_ = tp.instrument_id;
+    }
+    // Recorded before it's emitted, so handlers can query it
+    if (tick_store_) tick_store_->append(tp);
+    if (item.recv_ns != 0) ENG_METRICS_RECORD(Feed, ENG_METRICS_NOW() - item.recv_ns);
+    if (!cached_) return;
+
+    for (const auto& h : cached_->trades) h(tp);
+    if (!cached_->ticks.empty()) {
+        tick_.symbol = tp.symbol;
+        tick_.last = tp.price;
+        tick_.ts = tp.ts;
+        tick_.instrument_id = tp.instrument_id;
+        tick_.qty = tp.qty;
+        tick_.side = tp.side;
+        tick_.ingress_ns = item.recv_ns;
+        for (const auto& h : cached_->ticks) h(tick_);
+    }
+}
+
+bool KrakenWsAdapter::backoff(int ms) {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_cv_.wait_for(lock, std::chrono::milliseconds(ms),
+                      [this] { return !running_.load(std::memory_order_acquire); });
+    return running_.load(std::memory_order_acquire);
+}
+
+}
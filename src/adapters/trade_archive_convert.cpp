@@ -0,0 +1,95 @@
+// trade_archive_convert.cpp
+//
+// One-time converter from cached Kraken JSONL.GZ days to the binary trade
+// archive format replayed by TradeArchiveReplayAdapter.
+//
+// Usage: trade_archive_convert <in.jsonl.gz> [out.trades]
+//        trade_archive_convert backtest/data/BTCUSD/*.jsonl.gz
+//
+// With a single input, the output path may be given explicitly. Otherwise
+// each input is written next to itself with ".jsonl.gz" replaced by ".trades".
+
+#include "adapters/GzipLineReader.hpp"
+#include "adapters/KrakenTradeParser.hpp"
+#include "adapters/TradeArchive.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string default_output_path(const std::string& input) {
+    const std::string suffix = ".jsonl.gz";
+    if (input.size() > suffix.size() &&
+        input.compare(input.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        return input.substr(0, input.size() - suffix.size()) + ".trades";
+    }
+    return input + ".trades";
+}
+
+bool is_archive_path(const std::string& path) {
+    const std::string suffix = ".trades";
+    return path.size() > suffix.size() &&
+           path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+size_t convert(const std::string& input, const std::string& output, size_t& skipped) {
+    auto registry = std::make_shared<eng::InstrumentRegistry>();
+    adapter::KrakenTradeParser parser(registry, false);
+    adapter::GzipLineReader reader(input, adapter::GzipLineReader::PREFETCH_CHUNK_SIZE,
+                                   adapter::GzipLineReader::Inflate::Background);
+    adapter::TradeArchiveWriter writer(output);
+
+    std::string_view line;
+    eng::TradePrint tp;
+    skipped = 0;
+
+    while (reader.next_line(line)) {
+        // Same fast-path/fallback split as KrakenFileReplayAdapter::replay()
+        if (parser.parse(line, tp) || parser.parse_json(line, tp)) {
+            writer.append(tp);
+        } else {
+            ++skipped;
+        }
+    }
+
+    writer.close();
+    return static_cast<size_t>(writer.record_count());
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <in.jsonl.gz> [out.trades]\n"
+                  << "       " << argv[0] << " <in1.jsonl.gz> <in2.jsonl.gz> ...\n";
+        return 1;
+    }
+
+    std::vector<std::pair<std::string, std::string>> jobs;
+    if (argc == 3 && is_archive_path(argv[2])) {
+        jobs.emplace_back(argv[1], argv[2]);
+    } else {
+        for (int i = 1; i < argc; ++i) {
+            jobs.emplace_back(argv[i], default_output_path(argv[i]));
+        }
+    }
+
+    int failures = 0;
+    for (const auto& [input, output] : jobs) {
+        try {
+            auto t0 = std::chrono::steady_clock::now();
+            size_t skipped = 0;
+            size_t count = convert(input, output, skipped);
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << "[trade_archive_convert] " << input << " -> " << output << ": "
+                      << count << " trades (" << skipped << " skipped) in " << secs << "s\n";
+        } catch (const std::exception& e) {
+            std::cerr << "[trade_archive_convert] ERROR converting " << input << ": " << e.what() << "\n";
+            ++failures;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+#include "backtest/BacktestRunner.hpp"
+#include "adapters/KrakenFileReplayAdapter.hpp"
+#include "adapters/TradeArchiveReplayAdapter.hpp"
+#include "brokers/NullBroker.hpp"
+#include "engine/Engine.hpp"
+#include "engine/InstrumentRegistry.hpp"
+#include "engine/ProviderMarketData.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace backtest {
+
+namespace {
+
+bool is_archive_path(const std::string& path) {
+    const std::string suffix = ".trades";
+    return path.size() > suffix.size() &&
+           path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+BacktestRunner::BacktestRunner(StrategyFactory factory)
+    : BacktestRunner(std::move(factory), Config{}) {}
+
+BacktestRunner::BacktestRunner(StrategyFactory factory, Config config)
+    : factory_(std::move(factory)), config_(config) {
+    if (!factory_) throw std::invalid_argument("BacktestRunner needs a strategy factory");
+}
+
+std::vector<PartitionResult> BacktestRunner::run(const std::vector<Partition>& partitions) const {
+    std::vector<PartitionResult> results(partitions.size());
+
+    size_t num_threads = config_.num_threads;
+    if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::min(num_threads, partitions.size());
+
+    // Workers pull the next partition index; run_partition never throws
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < partitions.size(); i = next++) {
+            results[i] = run_partition(partitions[i]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (size_t t = 0; t < num_threads; ++t) threads.emplace_back(worker);
+    for (auto& t : threads) t.join();
+
+    return results;
+}
+
+PartitionResult BacktestRunner::run_partition(const Partition& partition) const {
+    PartitionResult result;
+    result.partition = partition;
+    result.initial_balance = config_.initial_balance;
+    auto t0 = std::chrono::steady_clock::now();
+
+    try {
+        // Everything below is private to this partition
+        eng::Engine engine;
+        engine.set_verbose(false);
+        eng::EventBus& bus = engine.get_bus();
+
+        auto broker = std::make_unique<broker::NullBroker>(bus, config_.initial_balance);
+        broker->set_verbose(false);
+        if (config_.fill_sim) broker->enable_fill_simulation(config_.fill_config);
+        broker::NullBroker* broker_ptr = broker.get();
+
+        auto strat = factory_(partition);
+        if (!strat) throw std::runtime_error("strategy factory returned null");
+        eng::IStrategy* strat_ptr = strat.get();
+
+        auto registry = std::make_shared<eng::InstrumentRegistry>();
+        auto provider = std::make_unique<eng::ProviderMarketData>();
+        std::function<size_t()> replay;
+        if (is_archive_path(partition.data_file)) {
+            auto adapter = std::make_unique<adapter::TradeArchiveReplayAdapter>(registry);
+            adapter->start();
+            auto* adapter_ptr = adapter.get();
+            replay = [adapter_ptr, &partition]() { return adapter_ptr->replay(partition.data_file, 0.0, nullptr); };
+            provider->attach(std::move(adapter));
+        } else {
+            auto adapter = std::make_unique<adapter::KrakenFileReplayAdapter>(registry);
+            adapter->set_keep_metadata(false);
+            adapter->start();
+            auto* adapter_ptr = adapter.get();
+            replay = [adapter_ptr, &partition]() { return adapter_ptr->replay(partition.data_file, 0.0, nullptr); };
+            provider->attach(std::move(adapter));
+        }
+
+        // Same trade -> Tick path as main.cpp, plus mark-to-market tracking
+        // (the bus is synchronous, so the fill for this tick has landed by
+        // the time publish() returns)
+        double peak = config_.initial_balance;
+        double max_drawdown = 0.0;
+        provider->subscribe_trades({partition.symbol}, [&](const eng::TradePrint& tp) {
+            eng::Tick tick;
+            tick.symbol = tp.symbol;
+            tick.last = tp.price;
+            tick.ts = tp.ts;
+            tick.instrument_id = tp.instrument_id;
+            tick.qty = tp.qty;
+            tick.side = tp.side;
+            bus.publish(tick);
+
+            ++result.trades;
+            result.last_price = tp.price;
+            double equity = broker_ptr->get_balance() + strat_ptr->get_net_position() * tp.price;
+            if (equity > peak) {
+                peak = equity;
+            } else if (peak > 0.0) {
+                max_drawdown = std::min(max_drawdown, (equity - peak) / peak);
+            }
+        });
+
+        engine.set_broker(std::move(broker));
+        engine.set_market_data(std::move(provider));
+        engine.set_strategy(std::move(strat));
+        if (!engine.start()) throw std::runtime_error("engine failed to start");
+
+        replay();
+
+        result.final_balance = broker_ptr->get_balance();
+        result.position = strat_ptr->get_net_position();
+        result.equity = result.final_balance + result.position * result.last_price;
+        result.pnl = result.equity - result.initial_balance;
+        result.max_drawdown = max_drawdown;
+
+        std::vector<eng::Order> orders = broker_ptr->get_orders();
+        result.orders = orders.size();
+        for (const auto& o : orders) {
+            if (o.status == eng::OrderStatus::FILLED) ++result.filled;
+            else if (o.status == eng::OrderStatus::REJECTED) ++result.rejected;
+        }
+        if (config_.keep_orders) result.order_history = std::move(orders);
+
+        result.ok = true;
+    } catch (const std::exception& e) {
+        result.ok = false;
+        result.error = e.what();
+    }
+
+    result.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return result;
+}
+
+Summary BacktestRunner::summarize(const std::vector<PartitionResult>& results) {
+    Summary s;
+    s.partitions = results.size();
+    for (const auto& r : results) {
+        if (!r.ok) {
+            ++s.failed;
+            continue;
+        }
+        s.trades += r.trades;
+        s.orders += r.orders;
+        s.total_pnl += r.pnl;
+        s.worst_drawdown = std::min(s.worst_drawdown, r.max_drawdown);
+    }
+    return s;
+}
+
+}  // namespace backtest
@@ -0,0 +1,225 @@
+// backtest_runner.cpp
+//
+// Multi-day, multi-symbol MovingAverage backtest in a single process. Every
+// (symbol, day file) pair is an independent partition with its own engine,
+// broker and strategy; partitions run in parallel (see BacktestRunner).
+//
+// Usage: backtest_runner [--threads N] [--window 5] [--threshold 1.0] [--qty 0.01]
+//                        [--balance 1000000] [--keep-orders] [--output report.json]
+//                        [--fill-sim [--fill-latency-ms 0] [--fill-queue-ahead 0] [--fill-tif-s 0]
+//                                    [--fill-tick-size [<symbol>=]0.1]]
+//                        [--strategy-plugin <path.so> [--strategy-config <config>]]
+//                        --symbol XBTUSD <day files...> [--symbol ETHUSD <day files...>]
+//
+// --fill-tick-size sets the simulated book's price grid for every symbol, or for one
+// with <symbol>=<size> (repeatable); use the venue's price increment.
+//
+// --strategy-plugin runs a plugin strategy (see plugins/PluginApi.h) instead of
+// the built-in MovingAverage; --window/--threshold/--qty then don't apply.
+//
+// Day files are .trades archives or Kraken .jsonl.gz days; each partition is
+// labelled with its file name minus the extension (normally the date).
+
+#include "backtest/BacktestRunner.hpp"
+#include "plugins/PluginLoader.hpp"
+#include "strategies/MovingAverage.hpp"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string label_for(const std::string& path) {
+    std::string name = path.substr(path.find_last_of('/') + 1);
+    for (const std::string ext : {".jsonl.gz", ".trades"}) {
+        if (name.size() > ext.size() && name.compare(name.size() - ext.size(), ext.size(), ext) == 0) {
+            return name.substr(0, name.size() - ext.size());
+        }
+    }
+    return name;
+}
+
+nlohmann::json order_json(const eng::Order& order) {
+    nlohmann::json j;
+    j["orderId"] = order.id;
+    j["symbol"] = order.symbol;
+    j["qty"] = order.qty;
+    j["side"] = (order.side == eng::Order::Side::Buy) ? "Buy" : "Sell";
+    j["status"] = eng::order_status_to_string(order.status);
+    j["filledQty"] = order.filled_qty;
+    j["fillPrice"] = order.fill_price;
+    auto tp = std::chrono::system_clock::to_time_t(order.timestamp);
+    std::ostringstream ts_oss;
+    ts_oss << std::put_time(std::gmtime(&tp), "%Y-%m-%dT%H:%M:%SZ");
+    j["timestamp"] = ts_oss.str();
+    if (!order.rejection_reason.empty()) j["rejectionReason"] = order.rejection_reason;
+    return j;
+}
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [--threads N] [--window 5] [--threshold 1.0] [--qty 0.01]\n"
+              << "       [--balance 1000000] [--keep-orders] [--output report.json]\n"
+              << "       [--fill-sim [--fill-latency-ms 0] [--fill-queue-ahead 0] [--fill-tif-s 0]\n"
+              << "                   [--fill-tick-size [<symbol>=]0.1]]\n"
+              << "       [--strategy-plugin <path.so> [--strategy-config <config>]]\n"
+              << "       --symbol <symbol> <day files...> [--symbol <symbol> <day files...>]\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    backtest::BacktestRunner::Config config;
+    size_t window = 5;
+    double threshold = 1.0;
+    double qty = 0.01;
+    std::string output;
+    std::string symbol;
+    std::string plugin_path;
+    std::string plugin_config;
+    std::vector<backtest::Partition> partitions;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--symbol" && i + 1 < argc) symbol = argv[++i];
+            else if (arg == "--threads" && i + 1 < argc) config.num_threads = std::stoul(argv[++i]);
+            else if (arg == "--window" && i + 1 < argc) window = std::stoul(argv[++i]);
+            else if (arg == "--threshold" && i + 1 < argc) threshold = std::stod(argv[++i]);
+            else if (arg == "--qty" && i + 1 < argc) qty = std::stod(argv[++i]);
+            else if (arg == "--balance" && i + 1 < argc) config.initial_balance = std::stod(argv[++i]);
+            else if (arg == "--keep-orders") config.keep_orders = true;
+            else if (arg == "--fill-sim") config.fill_sim = true;
+            else if (arg == "--fill-latency-ms" && i + 1 < argc)
+                config.fill_config.latency = std::chrono::microseconds(static_cast<int64_t>(std::stod(argv[++i]) * 1000.0));
+            else if (arg == "--fill-queue-ahead" && i + 1 < argc) config.fill_config.queue_ahead = std::stod(argv[++i]);
+            else if (arg == "--fill-tif-s" && i + 1 < argc)
+                config.fill_config.time_in_force = std::chrono::milliseconds(static_cast<int64_t>(std::stod(argv[++i]) * 1000.0));
+            else if (arg == "--fill-tick-size" && i + 1 < argc) broker::parse_tick_size_flag(argv[++i], config.fill_config);
+            else if (arg == "--output" && i + 1 < argc) output = argv[++i];
+            else if (arg == "--strategy-plugin" && i + 1 < argc) plugin_path = argv[++i];
+            else if (arg == "--strategy-config" && i + 1 < argc) plugin_config = argv[++i];
+            else if (arg.rfind("--", 0) == 0) { usage(argv[0]); return 1; }
+            else if (symbol.empty()) { std::cerr << "[backtest_runner] ERROR: " << arg << " given before --symbol\n"; return 1; }
+            else partitions.push_back(backtest::Partition{symbol, arg, label_for(arg)});
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[backtest_runner] ERROR: bad argument: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (partitions.empty() || window == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    backtest::BacktestRunner::StrategyFactory factory;
+    if (!plugin_path.empty()) {
+        // Fail before any partition starts if the plugin doesn't load or
+        // rejects the config
+        try {
+            auto probe = PluginLoader::instance().load<eng::IStrategy>(plugin_path, plugin_config, symbol);
+        } catch (const std::exception& e) {
+            std::cerr << "[backtest_runner] ERROR: " << e.what() << "\n";
+            return 1;
+        }
+        factory = [plugin_path, plugin_config](const backtest::Partition& p) {
+            return PluginLoader::instance().load<eng::IStrategy>(plugin_path, plugin_config, p.symbol);
+        };
+    } else {
+        factory = [window, threshold, qty](const backtest::Partition& p) -> std::unique_ptr<eng::IStrategy> {
+            return std::make_unique<strategy::MovingAverageStrategy>(p.symbol, window, threshold, qty);
+        };
+    }
+    backtest::BacktestRunner runner(std::move(factory), config);
+
+    if (!plugin_path.empty()) {
+        std::cout << "[backtest_runner] " << partitions.size() << " partitions, plugin " << plugin_path
+                  << " config=\"" << plugin_config << "\"\n";
+    } else {
+        std::cout << "[backtest_runner] " << partitions.size() << " partitions, MovingAverage window="
+                  << window << " threshold=" << threshold << "\n";
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto results = runner.run(partitions);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    auto summary = backtest::BacktestRunner::summarize(results);
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto& r : results) {
+        if (!r.ok) {
+            std::cerr << "[backtest_runner] FAILED " << r.partition.symbol << " " << r.partition.label
+                      << ": " << r.error << "\n";
+            continue;
+        }
+        std::cout << "[backtest_runner] " << r.partition.symbol << " " << r.partition.label
+                  << ": trades=" << r.trades << " orders=" << r.orders << " pnl=" << r.pnl
+                  << " balance=" << r.final_balance << " max_dd=" << r.max_drawdown * 100.0 << "%"
+                  << " (" << r.elapsed_s << "s)\n";
+    }
+    std::cout << "[backtest_runner] Total: " << summary.trades << " trades, " << summary.orders
+              << " orders, pnl=" << summary.total_pnl << ", " << summary.failed << " failed, in "
+              << secs << "s\n";
+
+    if (!output.empty()) {
+        nlohmann::json report;
+        if (!plugin_path.empty()) {
+            report["strategy"] = {{"plugin", plugin_path}, {"config", plugin_config}};
+        } else {
+            report["strategy"] = {{"name", "MovingAverage"}, {"window", window}, {"threshold", threshold}, {"qty", qty}};
+        }
+        report["initial_balance"] = config.initial_balance;
+        report["fill_sim"] = config.fill_sim;
+        report["elapsed_s"] = secs;
+        report["summary"] = {
+            {"partitions", summary.partitions},
+            {"failed", summary.failed},
+            {"trades", summary.trades},
+            {"orders", summary.orders},
+            {"total_pnl", summary.total_pnl},
+            {"worst_drawdown", summary.worst_drawdown},
+        };
+        report["partitions"] = nlohmann::json::array();
+        for (const auto& r : results) {
+            nlohmann::json p = {
+                {"symbol", r.partition.symbol},
+                {"label", r.partition.label},
+                {"data_file", r.partition.data_file},
+                {"ok", r.ok},
+                {"trades", r.trades},
+                {"orders", r.orders},
+                {"filled", r.filled},
+                {"rejected", r.rejected},
+                {"final_balance", r.final_balance},
+                {"position", r.position},
+                {"last_price", r.last_price},
+                {"pnl", r.pnl},
+                {"pnl_pct", r.initial_balance > 0.0 ? r.pnl / r.initial_balance : 0.0},
+                {"max_drawdown", r.max_drawdown},
+                {"elapsed_s", r.elapsed_s},
+            };
+            if (!r.ok) p["error"] = r.error;
+            if (config.keep_orders) {
+                p["order_history"] = nlohmann::json::array();
+                for (const auto& o : r.order_history) p["order_history"].push_back(order_json(o));
+            }
+            report["partitions"].push_back(std::move(p));
+        }
+
+        std::ofstream out(output);
+        if (!out) {
+            std::cerr << "[backtest_runner] ERROR: cannot write " << output << "\n";
+            return 1;
+        }
+        out << report.dump(2) << "\n";
+        std::cout << "[backtest_runner] Report written to " << output << "\n";
+    }
+
+    return summary.failed == 0 ? 0 : 1;
+}
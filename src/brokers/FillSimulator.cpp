@@ -0,0 +1,339 @@
+#include "brokers/FillSimulator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace broker {
+
+namespace {
+
+constexpr double kQtyEps = 1e-12;
+constexpr int64_t kLevelSpan = 4096;   // Levels added per side when the array grows
+
+int64_t to_ns(eng::TimePoint ts) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(ts.time_since_epoch()).count();
+}
+
+}  // namespace
+
+FillSimulator::FillSimulator() : FillSimulator(Config{}) {}
+
+FillSimulator::FillSimulator(Config config) : config_(config) {
+    if (!(config_.tick_size > 0.0)) throw std::invalid_argument("FillSimulator: tick_size must be > 0");
+    for (const auto& [symbol, size] : config_.tick_sizes) {
+        if (!(size > 0.0)) throw std::invalid_argument("FillSimulator: tick size for " + symbol + " must be > 0");
+    }
+    if (config_.max_ticks_from_market <= 0) {
+        throw std::invalid_argument("FillSimulator: max_ticks_from_market must be > 0");
+    }
+    if (config_.queue_ahead < 0.0) config_.queue_ahead = 0.0;
+}
+
+int64_t FillSimulator::to_tick(const Book& book, double price) {
+    return std::llround(price / book.tick_size);
+}
+
+bool FillSimulator::in_band(const Book& book, double price) const {
+    // Checked in floating point, so a huge or non-finite price never reaches llround
+    double ticks = price / book.tick_size;
+    if (!std::isfinite(ticks)) return false;
+    if (book.market_tick == kNoLevel) return true;
+    return std::fabs(ticks - static_cast<double>(book.market_tick)) <=
+           static_cast<double>(config_.max_ticks_from_market);
+}
+
+uint32_t FillSimulator::book_for(eng::InstrumentId instrument_id, const std::string& symbol) {
+    auto& slot = book_index_.get(instrument_id, symbol);
+    if (slot.value == 0) {
+        books_.emplace_back();
+        auto it = config_.tick_sizes.find(symbol);
+        books_.back().tick_size = it != config_.tick_sizes.end() ? it->second : config_.tick_size;
+        slot.value = static_cast<uint32_t>(books_.size());
+    }
+    return slot.value - 1;
+}
+
+bool FillSimulator::accepts(eng::InstrumentId instrument_id, const std::string& symbol, double limit_price) {
+    return in_band(books_[book_for(instrument_id, symbol)], limit_price);
+}
+
+int32_t FillSimulator::alloc_node() {
+    int32_t idx;
+    if (free_head_ != kNil) {
+        idx = free_head_;
+        free_head_ = nodes_[idx].next;
+    } else {
+        idx = static_cast<int32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    ++live_;
+    return idx;
+}
+
+void FillSimulator::release_node(int32_t idx) {
+    Node& n = nodes_[idx];
+    ++n.gen;
+    n.state = State::Free;
+    n.prev = kNil;
+    n.next = free_head_;
+    free_head_ = idx;
+    --live_;
+}
+
+FillSimulator::Level& FillSimulator::level_at(BookSide& side, int64_t tick) {
+    if (side.levels.empty()) {
+        side.base = tick - kLevelSpan / 2;
+        side.levels.resize(kLevelSpan);
+    } else if (tick < side.base) {
+        int64_t grow = (side.base - tick) + kLevelSpan / 2;
+        side.levels.insert(side.levels.begin(), static_cast<size_t>(grow), Level{});
+        side.base -= grow;
+    } else if (tick - side.base >= static_cast<int64_t>(side.levels.size())) {
+        side.levels.resize(static_cast<size_t>(tick - side.base + kLevelSpan / 2));
+    }
+    return side.levels[static_cast<size_t>(tick - side.base)];
+}
+
+void FillSimulator::push_back(BookSide& side, std::vector<Node>& nodes, int32_t idx) {
+    Node& n = nodes[idx];
+    Level& lv = level_at(side, n.tick);
+    n.prev = lv.tail;
+    n.next = kNil;
+    if (lv.tail != kNil) nodes[lv.tail].next = idx;
+    else lv.head = idx;
+    lv.tail = idx;
+
+    bool is_bid = n.side == Side::Buy;
+    if (side.best == kNoLevel || (is_bid ? n.tick > side.best : n.tick < side.best)) {
+        side.best = n.tick;
+    }
+    ++side.orders;
+}
+
+void FillSimulator::unlink(BookSide& side, std::vector<Node>& nodes, int32_t idx, bool is_bid) {
+    Node& n = nodes[idx];
+    Level& lv = side.levels[static_cast<size_t>(n.tick - side.base)];
+    if (n.prev != kNil) nodes[n.prev].next = n.next;
+    else lv.head = n.next;
+    if (n.next != kNil) nodes[n.next].prev = n.prev;
+    else lv.tail = n.prev;
+    n.prev = n.next = kNil;
+    --side.orders;
+
+    if (lv.head != kNil || n.tick != side.best) return;
+
+    // Best level emptied: walk away from the touch to the next live level
+    if (side.orders == 0) {
+        side.best = kNoLevel;
+        return;
+    }
+    const int64_t lo = side.base;
+    const int64_t hi = side.base + static_cast<int64_t>(side.levels.size()) - 1;
+    int64_t t = n.tick;
+    while (true) {
+        t += is_bid ? -1 : 1;
+        if (t < lo || t > hi) {
+            side.best = kNoLevel;  // Unreachable while orders > 0
+            return;
+        }
+        if (side.levels[static_cast<size_t>(t - side.base)].head != kNil) {
+            side.best = t;
+            return;
+        }
+    }
+}
+
+void FillSimulator::emit(const Node& node, double qty, double price, bool taker, bool expired,
+                         eng::TimePoint ts, std::vector<Execution>& out) const {
+    Execution e;
+    e.order_id = node.order_id;
+    e.tag = node.tag;
+    e.side = node.side;
+    e.limit_price = node.limit;
+    e.qty = qty;
+    e.price = price;
+    e.remaining = node.remaining;
+    e.taker = taker;
+    e.expired = expired;
+    e.ts = ts;
+    out.push_back(e);
+}
+
+bool FillSimulator::submit(uint64_t order_id, uint64_t tag, eng::InstrumentId instrument_id,
+                           const std::string& symbol, Side side, double limit_price, double qty,
+                           eng::TimePoint ts) {
+    uint32_t book = book_for(instrument_id, symbol);
+    Book& b = books_[book];
+    if (!in_band(b, limit_price)) return false;
+    if (!(qty > kQtyEps)) return true;   // Nothing to rest
+
+    const int64_t tick = to_tick(b, limit_price);
+    if (b.market_tick == kNoLevel) b.market_tick = tick;
+    int32_t idx = alloc_node();
+    Node& n = nodes_[idx];
+    n.order_id = order_id;
+    n.tag = tag;
+    n.side = side;
+    n.limit = limit_price;
+    n.remaining = qty;
+    n.ahead = config_.queue_ahead;
+    n.tick = tick;
+    n.book = book;
+    n.state = State::Pending;
+
+    int64_t ts_ns = to_ns(ts);
+    n.active_ns = ts_ns + config_.latency.count();
+    n.expire_ns = config_.time_in_force.count() > 0 ? ts_ns + config_.time_in_force.count() : 0;
+
+    b.pending.push_back(Ref{n.active_ns, idx, n.gen});
+    if (n.expire_ns != 0) b.expiries.push_back(Ref{n.expire_ns, idx, n.gen});
+    return true;
+}
+
+void FillSimulator::on_trade(eng::InstrumentId instrument_id, const std::string& symbol,
+                             double price, double qty, eng::TradeSide aggressor, eng::TimePoint ts,
+                             std::vector<Execution>& out) {
+    // Every traded instrument gets a book, so the band follows the market
+    // from its first trade
+    Book& book = books_[book_for(instrument_id, symbol)];
+    int64_t trade_tick = to_tick(book, price);
+    book.market_tick = trade_tick;
+    if (book.pending.empty() && book.bids.orders == 0 && book.asks.orders == 0) return;
+
+    int64_t ts_ns = to_ns(ts);
+
+    expire(book, ts_ns, ts, out);
+    activate(book, trade_tick, price, ts_ns, ts, out);
+    // A sell-initiated trade hits bids, a buy-initiated one lifts asks
+    match_side(book.bids, true, trade_tick, qty, aggressor != eng::TradeSide::Buy, ts, out);
+    match_side(book.asks, false, trade_tick, qty, aggressor != eng::TradeSide::Sell, ts, out);
+}
+
+void FillSimulator::activate(Book& book, int64_t trade_tick, double price, int64_t ts_ns,
+                             eng::TimePoint ts, std::vector<Execution>& out) {
+    while (!book.pending.empty() && book.pending.front().ns <= ts_ns) {
+        Ref ref = book.pending.front();
+        book.pending.pop_front();
+        Node& n = nodes_[ref.node];
+        if (n.gen != ref.gen || n.state != State::Pending) continue;  // Canceled or expired
+
+        bool is_bid = n.side == Side::Buy;
+        bool crosses = is_bid ? n.tick > trade_tick : n.tick < trade_tick;
+        if (crosses) {
+            double fill = n.remaining;
+            n.remaining = 0.0;
+            emit(n, fill, price, true, false, ts, out);
+            release_node(ref.node);
+            continue;
+        }
+        n.state = State::Resting;
+        push_back(is_bid ? book.bids : book.asks, nodes_, ref.node);
+    }
+}
+
+void FillSimulator::match_side(BookSide& side, bool is_bid, int64_t trade_tick, double qty,
+                               bool queue_eligible, eng::TimePoint ts, std::vector<Execution>& out) {
+    while (side.best != kNoLevel && (is_bid ? side.best >= trade_tick : side.best <= trade_tick)) {
+        int64_t tick = side.best;
+        Level& lv = side.levels[static_cast<size_t>(tick - side.base)];
+
+        if (tick != trade_tick) {
+            // Traded through: everything at this level would have filled first
+            while (lv.head != kNil) {
+                int32_t idx = lv.head;
+                Node& n = nodes_[idx];
+                double fill = n.remaining;
+                n.remaining = 0.0;
+                emit(n, fill, n.limit, false, false, ts, out);
+                unlink(side, nodes_, idx, is_bid);
+                release_node(idx);
+            }
+            continue;  // unlink moved best to the next level
+        }
+
+        if (!queue_eligible) break;
+
+        // Traded at our price: work down the FIFO
+        double left = qty;
+        int32_t cursor = lv.head;
+        while (cursor != kNil && left > kQtyEps) {
+            Node& n = nodes_[cursor];
+            int32_t next = n.next;
+
+            double eaten = std::min(left, n.ahead);
+            n.ahead -= eaten;
+            left -= eaten;
+            if (left <= kQtyEps) break;
+
+            double fill = std::min(left, n.remaining);
+            left -= fill;
+            n.remaining -= fill;
+            if (n.remaining <= kQtyEps) n.remaining = 0.0;
+            emit(n, fill, n.limit, false, false, ts, out);
+            if (n.remaining == 0.0) {
+                unlink(side, nodes_, cursor, is_bid);
+                release_node(cursor);
+            }
+            cursor = next;
+        }
+        break;
+    }
+}
+
+void FillSimulator::expire(Book& book, int64_t ts_ns, eng::TimePoint ts, std::vector<Execution>& out) {
+    while (!book.expiries.empty() && book.expiries.front().ns <= ts_ns) {
+        Ref ref = book.expiries.front();
+        book.expiries.pop_front();
+        Node& n = nodes_[ref.node];
+        if (n.gen != ref.gen || n.state == State::Free) continue;  // Already done
+
+        if (n.state == State::Resting) {
+            unlink(n.side == Side::Buy ? book.bids : book.asks, nodes_, ref.node, n.side == Side::Buy);
+        }
+        emit(n, 0.0, 0.0, false, true, ts, out);
+        release_node(ref.node);
+    }
+}
+
+bool FillSimulator::cancel(uint64_t order_id, Execution* out) {
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        Node& n = nodes_[i];
+        if (n.state == State::Free || n.order_id != order_id) continue;
+
+        int32_t idx = static_cast<int32_t>(i);
+        if (n.state == State::Resting) {
+            Book& book = books_[n.book];
+            unlink(n.side == Side::Buy ? book.bids : book.asks, nodes_, idx, n.side == Side::Buy);
+        }
+        if (out) {
+            *out = Execution{};
+            out->order_id = n.order_id;
+            out->tag = n.tag;
+            out->side = n.side;
+            out->limit_price = n.limit;
+            out->remaining = n.remaining;
+        }
+        release_node(idx);
+        return true;
+    }
+    return false;
+}
+
+void parse_tick_size_flag(const std::string& value, FillSimulator::Config& config) {
+    const auto eq = value.find('=');
+    const std::string size_text = eq == std::string::npos ? value : value.substr(eq + 1);
+    size_t used = 0;
+    double size = 0.0;
+    try {
+        size = std::stod(size_text, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != size_text.size() || !(size > 0.0) || eq == 0) {
+        throw std::invalid_argument("bad tick size '" + value + "' (expected <size> or <symbol>=<size>)");
+    }
+    if (eq == std::string::npos) config.tick_size = size;
+    else config.tick_sizes[value.substr(0, eq)] = size;
+}
+
+}  // namespace broker
@@ -1,19 +1,21 @@
 #include "brokers/NullBroker.hpp"
+#include "engine/Checkpoint.hpp"
 #include "engine/Types.hpp"
 #include "engine/EventBus.hpp"
+#include "engine/Logger.hpp"
+#include <algorithm>
 #include <unordered_map>
 #include <vector>
 #include <chrono>
 #include <iomanip>
-#include <sstream>
 
 namespace broker {
 
 NullBroker::NullBroker(double initial_balance)
-    : balance_(initial_balance) {}
+    : balance_(eng::Money(initial_balance)) {}
 
 NullBroker::NullBroker(eng::EventBus& bus, double initial_balance)
-    : bus_(&bus), balance_(initial_balance) {}
+    : bus_(&bus), balance_(eng::Money(initial_balance)) {}
 
 NullBroker::~NullBroker() = default;
 
@@ -21,13 +23,44 @@ uint64_t NullBroker::generate_order_id() {
     return next_order_id_++;
 }
 
+std::atomic<eng::Quantity>& NullBroker::position_for(const eng::Order& order) {
+    auto& slot = position_index_.get(order.instrument_id, order.symbol);
+    if (slot.value == 0) {
+        const std::string& symbol = order.symbol;
+        slot.value = positions_.append([&symbol](PositionSlot& p) { p.symbol = symbol; }) + 1;
+    }
+    return positions_[slot.value - 1].qty;
+}
+
+void NullBroker::publish(eng::OrderEvent::Kind kind, const eng::Order& order) {
+    if (!bus_) return;
+    // Typed channel: handlers get a reference, nothing is allocated
+    bus_->publish(eng::OrderEvent{kind, order});
+
+    // The std::any copy allocates, so only build it for string-topic subscribers
+    const char* topic = eng::order_event_topic(kind);
+    if (!bus_->has_subscribers(topic)) return;
+    eng::Event ev;
+    ev.type = topic;
+    ev.data = std::make_any<eng::Order>(order);
+    bus_->publish(ev);
+}
+
+size_t NullBroker::record(const eng::Order& order) {
+    return journal_.append(order);
+}
+
+size_t NullBroker::record(const eng::Order& order, eng::OrderEvent::Kind event) {
+    publish(event, order);
+    return journal_.append(order);
+}
+
 void NullBroker::place_order(const eng::Order& order) {
     // default place_order will behave like a market order for now
     place_market_order(order);
 }
 
 double NullBroker::place_market_order(const eng::Order& order) {
-    std::lock_guard<std::mutex> lk(mutex_);
     auto pd = get_current_price(order.symbol);
     double fill_price = pd.last;
     double filled = 0.0;
@@ -39,99 +72,89 @@ double NullBroker::place_market_order(const eng::Order& order) {
 
     if (order.side == eng::Order::Side::Buy) {
         // Buy logic: check balance first
-        double value = fill_price * order.qty;
-        if (balance_ < value) {
-            std::ostringstream ss;
-            ss << std::fixed << std::setprecision(2);
-            ss << "NullBroker: Insufficient balance for buy. Need " << value 
-               << " but have " << balance_ << " for " << order.qty << " " << order.symbol;
-            std::cout << ss.str() << '\n';
-            
+        eng::Money value = eng::notional(eng::Price(fill_price), eng::Quantity(order.qty));
+        eng::Money balance = balance_.load(std::memory_order_relaxed);
+        if (balance < value) {
+            if (verbose_) {
+                ENG_LOG_DEBUG(std::fixed << std::setprecision(2) << "NullBroker: Insufficient balance for buy. Need " << value
+                              << " but have " << balance << " for " << order.qty << " " << order.symbol);
+            }
+
             // Track rejected order
             exec_order.status = eng::OrderStatus::REJECTED;
             exec_order.rejection_reason = "Insufficient balance";
-            orders_.push_back(exec_order);
-            
+            record(exec_order);
+
             return 0.0;  // Order rejected
         }
-        balance_ -= value;
-        positions_[order.symbol] += order.qty;
+        add_balance(-value);
+        add_qty(position_for(order), eng::Quantity(order.qty));
         filled = order.qty;
-        
+
         // Track filled order
         exec_order.status = eng::OrderStatus::FILLED;
         exec_order.filled_qty = filled;
         exec_order.fill_price = fill_price;
-        orders_.push_back(exec_order);
-        
-        std::ostringstream ss;
-        ss << std::fixed << std::setprecision(2);
-        ss << "NullBroker: Bought " << order.qty << " of " << order.symbol
-           << " @ " << fill_price << " -> balance=" << balance_;
-        std::cout << ss.str() << '\n';
+        record(exec_order);
+
+        if (verbose_) {
+            ENG_LOG_DEBUG(std::fixed << std::setprecision(2) << "NullBroker: Bought " << order.qty << " of " << order.symbol
+                          << " @ " << fill_price << " -> balance=" << get_balance());
+        }
     } else {
         // Sell logic: sell entire position at market price
-        double position = positions_[order.symbol];
-        if (position <= 0.0) {
-            std::cout << "NullBroker: No position to sell for " << order.symbol << "\n";
-            
+        std::atomic<eng::Quantity>& position_slot = position_for(order);
+        eng::Quantity position = position_slot.load(std::memory_order_relaxed);
+        if (position <= eng::Quantity{}) {
+            if (verbose_) ENG_LOG_DEBUG("NullBroker: No position to sell for " << order.symbol);
+
             // Track rejected order
             exec_order.status = eng::OrderStatus::REJECTED;
             exec_order.rejection_reason = "No position to sell";
-            orders_.push_back(exec_order);
-            
+            record(exec_order);
+
             return 0.0;
         }
-        double value = fill_price * position;
-        balance_ += value;
-        positions_[order.symbol] = 0.0;
-        filled = position;
-        
+        add_balance(eng::notional(eng::Price(fill_price), position));
+        position_slot.store(eng::Quantity{}, std::memory_order_relaxed);
+        filled = eng::to_double(position);
+
         // Track filled order
         exec_order.status = eng::OrderStatus::FILLED;
         exec_order.filled_qty = filled;
         exec_order.fill_price = fill_price;
-        orders_.push_back(exec_order);
-        
-        std::ostringstream ss;
-        ss << std::fixed << std::setprecision(2);
-        ss << "NullBroker: Sold " << position << " of " << order.symbol
-           << " @ " << fill_price << " -> balance=" << balance_;
-        std::cout << ss.str() << '\n';
+        record(exec_order);
+
+        if (verbose_) {
+            ENG_LOG_DEBUG(std::fixed << std::setprecision(2) << "NullBroker: Sold " << position << " of " << order.symbol
+                          << " @ " << fill_price << " -> balance=" << get_balance());
+        }
     }
 
     return filled;
 }
 
 double NullBroker::place_limit_order(const eng::Order& order, double limit_price, eng::TimePoint event_time) {
-    std::lock_guard<std::mutex> lk(mutex_);
-    
     // Assign order ID
     eng::Order exec_order = order;
     exec_order.id = generate_order_id();
     exec_order.status = eng::OrderStatus::WORKING;
-    
+
     // Use event_time if provided, otherwise fall back to current time
     if (event_time == eng::TimePoint()) {
         exec_order.timestamp = std::chrono::system_clock::now();
     } else {
         exec_order.timestamp = event_time;
     }
-    
-    // Convert timestamp to ISO8601 for logging
-    auto tp = std::chrono::system_clock::to_time_t(exec_order.timestamp);
-    std::ostringstream ts_oss;
-    ts_oss << std::put_time(std::gmtime(&tp), "%Y-%m-%dT%H:%M:%SZ");
-    std::string timestamp = ts_oss.str();
-    
+
     // Publish OrderPlaced event
-    if (bus_) {
-        eng::Event ev;
-        ev.type = "OrderPlaced";
-        ev.data = std::make_any<eng::Order>(exec_order);
-        bus_->publish(ev);
+    publish(eng::OrderEvent::Kind::Placed, exec_order);
+
+    // Simulated book: rest the order; the tape fills it later
+    if (sim_) {
+        return place_simulated_limit(exec_order, limit_price);
     }
-    
+
     // Now try to execute
     double market = limit_price;
     bool execute = false;
@@ -147,124 +170,245 @@ double NullBroker::place_limit_order(const eng::Order& order, double limit_price
     if (execute) {
         if (order.side == eng::Order::Side::Buy) {
             // Buy logic: check balance first
-            double value = market * order.qty;
-            std::cout << "[NullBroker] Limit buy check: need=" << value << " balance=" << balance_ << "\n";
-            if (balance_ < value) {
-                std::ostringstream ss;
-                ss << std::fixed << std::setprecision(2);
-                ss << "[NullBroker] REJECTED limit buy: Need " << value 
-                   << " but have " << balance_ << " for " << order.qty << " " << order.symbol;
-                std::cout << ss.str() << '\n';
-                
-                // Publish OrderRejected event
+            eng::Money value = eng::notional(eng::Price(market), eng::Quantity(order.qty));
+            eng::Money balance = balance_.load(std::memory_order_relaxed);
+            if (verbose_) ENG_LOG_TRACE("[NullBroker] Limit buy check: need=" << value << " balance=" << balance);
+            if (balance < value) {
+                if (verbose_) {
+                    ENG_LOG_DEBUG(std::fixed << std::setprecision(2) << "[NullBroker] REJECTED limit buy: Need " << value
+                                  << " but have " << balance << " for " << order.qty << " " << order.symbol);
+                }
+
+                // Publish OrderRejected event and track the rejected order
+                exec_order.status = eng::OrderStatus::REJECTED;
+                exec_order.rejection_reason = "Insufficient balance";
                 if (bus_) {
-                    std::cout << "[NullBroker] Publishing OrderRejected event\n";
-                    exec_order.status = eng::OrderStatus::REJECTED;
-                    exec_order.rejection_reason = "Insufficient balance";
-                    eng::Event ev;
-                    ev.type = "OrderRejected";
-                    ev.data = std::make_any<eng::Order>(exec_order);
-                    bus_->publish(ev);
+                    if (verbose_) ENG_LOG_TRACE("[NullBroker] Publishing OrderRejected event");
                 } else {
-                    std::cerr << "[NullBroker] WARNING: bus_ is null, cannot publish OrderRejected!\n";
+                    ENG_LOG_WARN("[NullBroker] WARNING: bus_ is null, cannot publish OrderRejected!");
                 }
-                
-                // Track rejected order
-                orders_.push_back(exec_order);
+                record(exec_order, eng::OrderEvent::Kind::Rejected);
                 return 0.0;  // Order rejected
             }
-            balance_ -= value;
-            positions_[order.symbol] += order.qty;
+            add_balance(-value);
+            add_qty(position_for(order), eng::Quantity(order.qty));
             filled = order.qty;
-            
+
             // Update order with fill info
             exec_order.status = eng::OrderStatus::FILLED;
             exec_order.filled_qty = filled;
             exec_order.fill_price = market;
-            
-            std::ostringstream ss;
-            ss << std::fixed << std::setprecision(2);
-            ss << "NullBroker: Limit executed for " << order.symbol << " @ " << market
-               << " (limit=" << limit_price << ") -> balance=" << balance_;
-            std::cout << ss.str() << '\n';
-            
-            // Publish OrderFilled event
-            if (bus_) {
-                eng::Event ev;
-                ev.type = "OrderFilled";
-                ev.data = std::make_any<eng::Order>(exec_order);
-                bus_->publish(ev);
+
+            if (verbose_) {
+                ENG_LOG_DEBUG(std::fixed << std::setprecision(2) << "NullBroker: Limit executed for " << order.symbol << " @ " << market
+                              << " (limit=" << limit_price << ") -> balance=" << get_balance());
             }
-            
-            // Track filled order
-            orders_.push_back(exec_order);
+
+            // Publish OrderFilled event and track the filled order
+            record(exec_order, eng::OrderEvent::Kind::Filled);
         } else {
             // Sell logic: sell entire position at limit price
-            double position = positions_[order.symbol];
-            if (position <= 0.0) {
-                std::cout << "NullBroker: No position to sell for " << order.symbol << "\n";
-                
-                // Publish OrderRejected event
-                if (bus_) {
-                    exec_order.status = eng::OrderStatus::REJECTED;
-                    exec_order.rejection_reason = "No position to sell";
-                    eng::Event ev;
-                    ev.type = "OrderRejected";
-                    ev.data = std::make_any<eng::Order>(exec_order);
-                    bus_->publish(ev);
-                }
-                
-                // Track rejected order
-                orders_.push_back(exec_order);
+            std::atomic<eng::Quantity>& position_slot = position_for(order);
+            eng::Quantity position = position_slot.load(std::memory_order_relaxed);
+            if (position <= eng::Quantity{}) {
+                if (verbose_) ENG_LOG_DEBUG("NullBroker: No position to sell for " << order.symbol);
+
+                // Publish OrderRejected event and track the rejected order
+                exec_order.status = eng::OrderStatus::REJECTED;
+                exec_order.rejection_reason = "No position to sell";
+                record(exec_order, eng::OrderEvent::Kind::Rejected);
                 return 0.0;
             }
-            double value = market * position;
-            balance_ += value;
-            positions_[order.symbol] = 0.0;
-            filled = position;
-            
+            add_balance(eng::notional(eng::Price(market), position));
+            position_slot.store(eng::Quantity{}, std::memory_order_relaxed);
+            filled = eng::to_double(position);
+
             // Update order with fill info
             exec_order.status = eng::OrderStatus::FILLED;
             exec_order.filled_qty = filled;
             exec_order.fill_price = market;
-            
-            std::ostringstream ss;
-            ss << std::fixed << std::setprecision(2);
-            ss << "NullBroker: Limit executed for " << order.symbol << " @ " << market
-               << " (limit=" << limit_price << "), sold " << position
-               << " -> balance=" << balance_;
-            std::cout << ss.str() << '\n';
-            
-            // Publish OrderFilled event
-            if (bus_) {
-                eng::Event ev;
-                ev.type = "OrderFilled";
-                ev.data = std::make_any<eng::Order>(exec_order);
-                bus_->publish(ev);
+
+            if (verbose_) {
+                ENG_LOG_DEBUG(std::fixed << std::setprecision(2) << "NullBroker: Limit executed for " << order.symbol << " @ " << market
+                              << " (limit=" << limit_price << "), sold " << position
+                              << " -> balance=" << get_balance());
             }
-            
-            // Track filled order
-            orders_.push_back(exec_order);
+
+            // Publish OrderFilled event and track the filled order
+            record(exec_order, eng::OrderEvent::Kind::Filled);
         }
     } else {
-        std::ostringstream ss;
-        ss << std::fixed << std::setprecision(2);
-        ss << "NullBroker: Limit order for " << order.symbol << " @ " << limit_price
-           << " not executed (market=" << market << ")";
-        std::cout << ss.str() << '\n';
+        if (verbose_) {
+            ENG_LOG_DEBUG(std::fixed << std::setprecision(2) << "NullBroker: Limit order for " << order.symbol << " @ " << limit_price
+                          << " not executed (market=" << market << ")");
+        }
     }
 
     return filled;
 }
 
+void NullBroker::enable_fill_simulation(const FillSimulator::Config& config) {
+    sim_ = std::make_unique<FillSimulator>(config);
+}
+
+void NullBroker::set_fill_handler(FillHandler handler) {
+    fill_handler_ = std::move(handler);
+}
+
+double NullBroker::place_simulated_limit(eng::Order& exec_order, double limit_price) {
+    const char* reject = nullptr;
+    if (!sim_->accepts(exec_order.instrument_id, exec_order.symbol, limit_price)) {
+        reject = "Limit price too far from market";
+    } else if (exec_order.side == eng::Order::Side::Buy) {
+        eng::Money need = eng::notional(eng::Price(limit_price), eng::Quantity(exec_order.qty));
+        if (balance_.load(std::memory_order_relaxed) - reserved_cash_ < need) {
+            reject = "Insufficient balance";
+        } else {
+            reserved_cash_ += need;
+        }
+    } else {
+        eng::Quantity& held = reserved_qty_.get(exec_order.instrument_id, exec_order.symbol).value;
+        eng::Quantity position = position_for(exec_order).load(std::memory_order_relaxed);
+        eng::Quantity qty = std::min(eng::Quantity(exec_order.qty), position - held);
+        if (qty <= eng::Quantity(1e-12)) {
+            reject = "No position to sell";
+        } else {
+            exec_order.qty = eng::to_double(qty);
+            held += qty;
+        }
+    }
+
+    if (reject) {
+        exec_order.status = eng::OrderStatus::REJECTED;
+        exec_order.rejection_reason = reject;
+        if (verbose_) {
+            ENG_LOG_DEBUG("[NullBroker] REJECTED simulated limit " << exec_order.id << ": " << reject);
+        }
+        record(exec_order, eng::OrderEvent::Kind::Rejected);
+        return 0.0;
+    }
+
+    size_t tag = record(exec_order);  // Journal index of this order
+    sim_->submit(exec_order.id, tag, exec_order.instrument_id, exec_order.symbol, exec_order.side,
+                 limit_price, exec_order.qty, exec_order.timestamp);
+    open_orders_.store(sim_->open_orders(), std::memory_order_relaxed);
+
+    if (verbose_) {
+        ENG_LOG_DEBUG(std::fixed << std::setprecision(2) << "NullBroker: Limit order " << exec_order.id << " resting for " << exec_order.symbol
+                      << " @ " << limit_price);
+    }
+    return 0.0;  // Fills arrive through on_market_tick
+}
+
+void NullBroker::on_market_tick(const eng::Tick& tick) {
+    if (!sim_) return;
+    last_tick_ts_ = tick.ts;
+    executions_.clear();
+    sim_->on_trade(tick.instrument_id, tick.symbol, tick.last, tick.qty, tick.side, tick.ts,
+                   executions_);
+    if (executions_.empty()) return;
+
+    for (const auto& e : executions_) {
+        apply_execution(e);
+    }
+    open_orders_.store(sim_->open_orders(), std::memory_order_relaxed);
+    publish_notices();
+}
+
+bool NullBroker::cancel_order(uint64_t order_id) {
+    if (!sim_) return false;
+    FillSimulator::Execution e;
+    if (!sim_->cancel(order_id, &e)) return false;
+    e.expired = true;
+    e.ts = last_tick_ts_;
+    apply_execution(e);
+    open_orders_.store(sim_->open_orders(), std::memory_order_relaxed);
+    publish_notices();
+    return true;
+}
+
+void NullBroker::apply_execution(const FillSimulator::Execution& e) {
+    const eng::Order& header = journal_.header(e.tag);
+    OrderJournal::FillState state = journal_.fill_state(e.tag);
+    bool is_buy = e.side == eng::Order::Side::Buy;
+    bool is_fill = !e.expired;
+
+    if (e.expired) {
+        // Release whatever was still held for the unfilled part
+        if (is_buy) {
+            reserved_cash_ -= eng::notional(eng::Price(e.limit_price), eng::Quantity(e.remaining));
+        } else {
+            reserved_qty_.get(header.instrument_id, header.symbol).value -= eng::Quantity(e.remaining);
+        }
+        state.status = eng::OrderStatus::CANCELED;
+        if (verbose_) {
+            ENG_LOG_DEBUG("NullBroker: Order " << header.id << " canceled with " << e.remaining
+                          << " unfilled");
+        }
+    } else {
+        const eng::Quantity qty(e.qty);
+        const eng::Money notional = eng::notional(eng::Price(e.price), qty);
+        if (is_buy) {
+            reserved_cash_ -= eng::notional(eng::Price(e.limit_price), qty);
+            add_balance(-notional);
+            add_qty(position_for(header), qty);
+        } else {
+            reserved_qty_.get(header.instrument_id, header.symbol).value -= qty;
+            add_balance(notional);
+            add_qty(position_for(header), -qty);
+        }
+
+        double prev_filled = state.filled_qty;
+        state.filled_qty += e.qty;
+        state.fill_price = (state.fill_price * prev_filled + eng::to_double(notional)) / state.filled_qty;
+        state.status = e.remaining > 0.0 ? eng::OrderStatus::PARTIALLY_FILLED : eng::OrderStatus::FILLED;
+
+        if (verbose_) {
+            ENG_LOG_DEBUG(std::fixed << std::setprecision(2) << "NullBroker: Simulated " << (e.taker ? "taker" : "maker") << " fill "
+                          << (is_buy ? "buy " : "sell ") << e.qty << " " << header.symbol << " @ " << e.price
+                          << (e.remaining > 0.0 ? " (partial)" : "") << " -> balance=" << get_balance());
+        }
+    }
+    journal_.update(e.tag, state);
+
+    if (bus_ || (is_fill && fill_handler_)) {
+        Notice n{is_fill ? eng::OrderEvent::Kind::Filled : eng::OrderEvent::Kind::Canceled,
+                 journal_.get(e.tag), eng::Order{}, is_fill};
+        n.order.timestamp = e.ts;
+        if (is_fill) {
+            n.fill = n.order;
+            n.fill.qty = e.qty;
+            n.fill.fill_price = e.price;
+        }
+        notices_.push_back(std::move(n));
+    }
+
+    // Nothing open: drop rounding residue from the reservations
+    if (sim_->open_orders() == 0) {
+        reserved_cash_ = eng::Money{};
+        reserved_qty_.for_each([](auto& slot) { slot.value = eng::Quantity{}; });
+    }
+}
+
+void NullBroker::publish_notices() {
+    // Handlers may place orders (and queue notices) of their own
+    std::vector<Notice> batch;
+    batch.swap(notices_);
+    for (const auto& n : batch) {
+        publish(n.kind, n.order);
+        if (n.is_fill && fill_handler_) fill_handler_(n.fill);
+    }
+    batch.clear();
+    if (notices_.empty()) notices_.swap(batch);  // Keep the capacity
+}
+
 double NullBroker::get_balance() {
-    std::lock_guard<std::mutex> lk(mutex_);
-    return balance_;
+    return eng::to_double(balance_.load(std::memory_order_relaxed));
 }
 
-eng::PriceData NullBroker::get_current_price(const std::string& symbol) {
+eng::PriceQuote NullBroker::get_current_price(const std::string& symbol) {
     // Simple deterministic price model for testing; could be extended to random or fed prices
-    eng::PriceData pd;
+    eng::PriceQuote pd;
     pd.symbol = symbol;
     pd.last = 100.0; // fixed price for now
     return pd;
@@ -278,19 +422,100 @@ eng::PriceData NullBroker::get_current_price(const std::string& symbol) {
 void NullBroker::subscribe_to_ticks(const std::string& symbol,
                                     std::function<void(const eng::PriceData&)> cb) {
     // For the null broker we don't produce live ticks; acknowledge subscription
-    std::cout << "NullBroker: subscription registered for " << symbol << '\n';
+    ENG_LOG_INFO("NullBroker: subscription registered for " << symbol);
     (void)cb;
 }
 //*/
 
 std::unordered_map<std::string, double> NullBroker::get_positions() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return positions_;
+    std::unordered_map<std::string, double> out;
+    size_t n = positions_.size();
+    for (size_t i = 0; i < n; ++i) {
+        const PositionSlot& p = positions_[i];
+        out[p.symbol] += eng::to_double(p.qty.load(std::memory_order_relaxed));
+    }
+    return out;
 }
 
 std::vector<eng::Order> NullBroker::get_orders() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return orders_;
+    return journal_.snapshot();
+}
+
+std::vector<eng::Order> NullBroker::get_orders_since(uint64_t after_id, size_t limit) const {
+    return journal_.since(after_id, limit);
+}
+
+static void put_order(eng::CheckpointWriter& out, const eng::Order& o) {
+    out.put<uint64_t>(o.id);
+    out.put_string(o.symbol);
+    out.put<double>(o.qty);
+    out.put<double>(o.filled_qty);
+    out.put<double>(o.fill_price);
+    out.put<uint8_t>(static_cast<uint8_t>(o.side));
+    out.put<uint8_t>(static_cast<uint8_t>(o.status));
+    out.put_string(o.rejection_reason);
+    out.put_time(o.timestamp);
+    out.put<eng::InstrumentId>(o.instrument_id);
+    out.put<uint64_t>(o.client_tag);
+}
+
+static eng::Order get_order(eng::CheckpointReader& in) {
+    eng::Order o;
+    o.id = in.get<uint64_t>();
+    o.symbol = in.get_string();
+    o.qty = in.get<double>();
+    o.filled_qty = in.get<double>();
+    o.fill_price = in.get<double>();
+    o.side = static_cast<eng::Order::Side>(in.get<uint8_t>());
+    o.status = static_cast<eng::OrderStatus>(in.get<uint8_t>());
+    o.rejection_reason = in.get_string();
+    o.timestamp = in.get_time();
+    o.instrument_id = in.get<eng::InstrumentId>();
+    o.client_tag = in.get<uint64_t>();
+    return o;
+}
+
+bool NullBroker::save_state(eng::CheckpointWriter& out) const {
+    if (sim_) return false;
+    out.put_string("NullBroker");
+    out.put<eng::Money>(balance_.load(std::memory_order_relaxed));
+    out.put<uint64_t>(next_order_id_);
+
+    uint64_t positions = 0;
+    position_index_.for_each([&positions](const auto& slot) { if (slot.value != 0) ++positions; });
+    out.put<uint64_t>(positions);
+    position_index_.for_each([this, &out](const auto& slot) {
+        if (slot.value == 0) return;
+        out.put_string(slot.symbol);
+        out.put<eng::InstrumentId>(slot.id);
+        out.put<eng::Quantity>(positions_[slot.value - 1].qty.load(std::memory_order_relaxed));
+    });
+
+    const size_t orders = journal_.size();
+    out.put<uint64_t>(orders);
+    for (size_t i = 0; i < orders; ++i) put_order(out, journal_.get(i));
+    return true;
+}
+
+void NullBroker::load_state(eng::CheckpointReader& in) {
+    if (in.get_string() != "NullBroker") in.fail("not a NullBroker checkpoint");
+    if (sim_) in.fail("NullBroker checkpoints can't be restored with fill simulation");
+    if (journal_.size() != 0 || next_order_id_ != 1) in.fail("NullBroker has already traded");
+
+    balance_.store(in.get<eng::Money>(), std::memory_order_relaxed);
+    next_order_id_ = in.get<uint64_t>();
+
+    const auto positions = in.get<uint64_t>();
+    for (uint64_t i = 0; i < positions; ++i) {
+        eng::Order key;
+        key.symbol = in.get_string();
+        key.instrument_id = in.get<eng::InstrumentId>();
+        position_for(key).store(in.get<eng::Quantity>(), std::memory_order_relaxed);
+    }
+
+    const auto orders = in.get<uint64_t>();
+    for (uint64_t i = 0; i < orders; ++i) journal_.append(get_order(in));
+    if (!in.done()) in.fail("unexpected trailing data");
 }
 
 } // namespace broker
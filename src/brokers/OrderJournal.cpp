@@ -0,0 +1,69 @@
+#include "brokers/OrderJournal.hpp"
+#include <algorithm>
+
+namespace broker {
+
+size_t OrderJournal::append(const eng::Order& order) {
+    return entries_.append([&order](Entry& e) {
+        e.order = order;
+        e.status.store(order.status, std::memory_order_relaxed);
+        e.filled_qty.store(order.filled_qty, std::memory_order_relaxed);
+        e.fill_price.store(order.fill_price, std::memory_order_relaxed);
+    });
+}
+
+void OrderJournal::update(size_t index, const FillState& state) {
+    Entry& e = entries_[index];
+    uint32_t seq = e.seq.load(std::memory_order_relaxed);
+    e.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    e.status.store(state.status, std::memory_order_relaxed);
+    e.filled_qty.store(state.filled_qty, std::memory_order_relaxed);
+    e.fill_price.store(state.fill_price, std::memory_order_relaxed);
+    e.seq.store(seq + 2, std::memory_order_release);
+}
+
+OrderJournal::FillState OrderJournal::fill_state(size_t index) const {
+    const Entry& e = entries_[index];
+    FillState s;
+    while (true) {
+        uint32_t before = e.seq.load(std::memory_order_acquire);
+        if (before & 1u) continue;  // Update in flight (a few stores long)
+        s.status = e.status.load(std::memory_order_relaxed);
+        s.filled_qty = e.filled_qty.load(std::memory_order_relaxed);
+        s.fill_price = e.fill_price.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.seq.load(std::memory_order_relaxed) == before) return s;
+    }
+}
+
+eng::Order OrderJournal::get(size_t index) const {
+    eng::Order order = entries_[index].order;
+    FillState s = fill_state(index);
+    order.status = s.status;
+    order.filled_qty = s.filled_qty;
+    order.fill_price = s.fill_price;
+    return order;
+}
+
+std::vector<eng::Order> OrderJournal::since(uint64_t after_id, size_t limit) const {
+    const size_t n = entries_.size();
+
+    // First entry with id > after_id
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (entries_[mid].order.id <= after_id) lo = mid + 1;
+        else hi = mid;
+    }
+
+    size_t count = n - lo;
+    if (limit != 0) count = std::min(count, limit);
+
+    std::vector<eng::Order> out;
+    out.reserve(count);
+    for (size_t i = lo; i < lo + count; ++i) out.push_back(get(i));
+    return out;
+}
+
+}  // namespace broker
@@ -0,0 +1,192 @@
+#include "engine/CandleCache.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+namespace eng {
+
+long long CandleCache::to_ms(const Candle& c) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+      c.open_time.time_since_epoch()).count();
+}
+
+size_t CandleCache::segment_bytes(const Segment& seg) {
+  return sizeof(Segment) +
+         seg.candles.capacity() * sizeof(Candle) +
+         seg.times.capacity() * sizeof(long long);
+}
+
+bool CandleCache::lookup(const std::string& symbol, long long resolution_ms,
+                         long long start_ms, long long end_ms, std::vector<Candle>& out) {
+  auto sit = series_.find(Key{symbol, resolution_ms});
+  if (sit == series_.end() || sit->second.segments.empty()) {
+    stats_.misses++;
+    return false;
+  }
+  auto& segments = sit->second.segments;
+
+  // Last segment starting at or before start_ms
+  auto it = segments.upper_bound(start_ms);
+  if (it == segments.begin()) {
+    stats_.misses++;
+    return false;
+  }
+  --it;
+  Segment& seg = it->second;
+  if (seg.end_ms < end_ms) {
+    stats_.misses++;
+    return false;
+  }
+
+  auto lo = std::lower_bound(seg.times.begin(), seg.times.end(), start_ms);
+  auto hi = std::upper_bound(lo, seg.times.end(), end_ms);
+  out.assign(seg.candles.begin() + (lo - seg.times.begin()),
+             seg.candles.begin() + (hi - seg.times.begin()));
+
+  touch(seg);
+  stats_.hits++;
+  return true;
+}
+
+uint64_t CandleCache::generation(const std::string& symbol, long long resolution_ms) {
+  return series_[Key{symbol, resolution_ms}].generation;
+}
+
+void CandleCache::insert(const std::string& symbol, long long resolution_ms,
+                         long long start_ms, long long end_ms,
+                         std::vector<Candle> candles, uint64_t generation) {
+  if (end_ms < start_ms) return;
+  Series& series = series_[Key{symbol, resolution_ms}];
+  // Committed to since this was read, or it may be missing a batch in flight
+  if (series.generation != generation || series.committing > 0) return;
+
+  Segment merged;
+  merged.start_ms = start_ms;
+  merged.end_ms = end_ms;
+  merged.candles = std::move(candles);
+
+  // Absorb overlapping/adjacent segments. Inside [start_ms, end_ms] the new
+  // result wins; outside it the old segments' candles are kept.
+  auto& segments = series.segments;
+  auto it = segments.upper_bound(start_ms);
+  if (it != segments.begin() && std::prev(it)->second.end_ms + 1 >= start_ms) --it;
+
+  std::vector<Candle> before, after;
+  while (it != segments.end() && it->second.start_ms <= end_ms + 1) {
+    Segment& old = it->second;
+    for (size_t i = 0; i < old.candles.size(); ++i) {
+      if (old.times[i] < start_ms) before.push_back(old.candles[i]);
+      else if (old.times[i] > end_ms) after.push_back(old.candles[i]);
+    }
+    merged.start_ms = std::min(merged.start_ms, old.start_ms);
+    merged.end_ms = std::max(merged.end_ms, old.end_ms);
+    auto next = std::next(it);
+    erase_segment(series, it);
+    it = next;
+  }
+  if (!before.empty() || !after.empty()) {
+    before.reserve(before.size() + merged.candles.size() + after.size());
+    before.insert(before.end(), merged.candles.begin(), merged.candles.end());
+    before.insert(before.end(), after.begin(), after.end());
+    merged.candles = std::move(before);
+  }
+
+  merged.times.reserve(merged.candles.size());
+  for (const auto& c : merged.candles) merged.times.push_back(to_ms(c));
+
+  auto [pos, inserted] = segments.emplace(merged.start_ms, std::move(merged));
+  (void)inserted;
+  Segment& seg = pos->second;
+  lru_.push_front(LruEntry{&series, seg.start_ms});
+  seg.lru = lru_.begin();
+  seg.bytes = 0;
+  account(seg);
+  stats_.segments++;
+
+  // A segment bigger than the whole budget isn't worth keeping
+  if (seg.bytes > budget_bytes_) {
+    erase_segment(series, pos);
+    return;
+  }
+  evict_to_budget(&seg);
+}
+
+void CandleCache::begin_commit(const std::string& symbol, long long resolution_ms) {
+  Series& series = series_[Key{symbol, resolution_ms}];
+  series.generation++;
+  series.committing++;
+}
+
+void CandleCache::end_commit(const std::string& symbol, long long resolution_ms,
+                             const Candle& candle, bool committed) {
+  Series& series = series_[Key{symbol, resolution_ms}];
+  series.generation++;
+  series.committing--;
+  if (!committed) {
+    drop(series);
+    return;
+  }
+
+  const long long t = to_ms(candle);
+  auto it = series.segments.upper_bound(t);
+  if (it == series.segments.begin()) return;
+  --it;
+  Segment& seg = it->second;
+  if (seg.end_ms < t) return;
+
+  auto pos = std::lower_bound(seg.times.begin(), seg.times.end(), t);
+  size_t idx = static_cast<size_t>(pos - seg.times.begin());
+  if (pos != seg.times.end() && *pos == t) {
+    seg.candles[idx] = candle;
+  } else {
+    seg.times.insert(pos, t);
+    seg.candles.insert(seg.candles.begin() + idx, candle);
+    account(seg);
+    evict_to_budget(&seg);
+  }
+}
+
+void CandleCache::clear() {
+  // Series stay, so a batch in flight still closes its bracket
+  for (auto& [key, series] : series_) {
+    drop(series);
+    series.generation++;   // Reads started before the clear must not land
+  }
+}
+
+void CandleCache::touch(Segment& seg) {
+  lru_.splice(lru_.begin(), lru_, seg.lru);
+}
+
+void CandleCache::account(Segment& seg) {
+  size_t now = segment_bytes(seg);
+  stats_.bytes = stats_.bytes - seg.bytes + now;
+  seg.bytes = now;
+}
+
+void CandleCache::erase_segment(Series& series, std::map<long long, Segment>::iterator it) {
+  stats_.bytes -= it->second.bytes;
+  stats_.segments--;
+  lru_.erase(it->second.lru);
+  series.segments.erase(it);
+}
+
+void CandleCache::drop(Series& series) {
+  while (!series.segments.empty()) erase_segment(series, series.segments.begin());
+}
+
+void CandleCache::evict_to_budget(const Segment* keep) {
+  while (stats_.bytes > budget_bytes_ && !lru_.empty()) {
+    LruEntry victim = lru_.back();
+    auto it = victim.series->segments.find(victim.start_ms);
+    if (it == victim.series->segments.end()) {
+      lru_.pop_back();  // Shouldn't happen; drop the stale entry
+      continue;
+    }
+    if (&it->second == keep) break;
+    erase_segment(*victim.series, it);
+    stats_.evictions++;
+  }
+}
+
+} // namespace eng
@@ -1,62 +1,319 @@
 #include "engine/CandleStore.hpp"
-#include <iostream>
+#include "engine/Logger.hpp"
+#include "engine/Metrics.hpp"
 #include <sstream>
 #include <chrono>
 #include <iomanip>
 #include <stdexcept>
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
 
 namespace eng {
 
+namespace fs = std::filesystem;
+
+namespace {
+
+// "2024-01-01" for a UTC day start
+std::string day_name(long long day_ms) {
+  std::time_t t = static_cast<std::time_t>(day_ms / 1000);
+  std::tm tm{};
+  gmtime_r(&t, &tm);
+  char buf[16];
+  std::strftime(buf, sizeof(buf), "%Y-%m-%d", &tm);
+  return buf;
+}
+
+// Inverse of day_name; false if the name isn't a date
+bool parse_day_name(const std::string& name, long long& day_ms) {
+  std::tm tm{};
+  if (name.size() != 10 || !strptime(name.c_str(), "%Y-%m-%d", &tm)) return false;
+  day_ms = static_cast<long long>(timegm(&tm)) * 1000;
+  return true;
+}
+
+// Source names become directory names: keep them to [A-Za-z0-9_-]
+std::string source_dir_name(const std::string& source) {
+  std::string out;
+  for (char c : source) {
+    out += (std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_') ? c : '_';
+  }
+  return out.empty() ? "_" : out;
+}
+
+// Empty strings are stored as NULL
+void bind_text_or_null(sqlite3_stmt* stmt, int idx, const std::string& value) {
+  if (value.empty()) {
+    sqlite3_bind_null(stmt, idx);
+  } else {
+    sqlite3_bind_text(stmt, idx, value.c_str(), -1, SQLITE_STATIC);
+  }
+}
+
+}  // namespace
+
+// ---- Partitions ----
+
+struct CandleStore::Partition {
+  PartitionKey key;
+  std::string path;
+  size_t max_readers{1};
+
+  // Writer connection: used by the writer thread only (and by clear_all
+  // while the writer is idle)
+  sqlite3* writer_db{nullptr};
+  sqlite3_stmt* insert_candle{nullptr};
+  sqlite3_stmt* insert_event{nullptr};
+
+  // Read-only connections, opened on demand up to max_readers
+  std::mutex pool_mutex;
+  std::condition_variable pool_cv;
+  std::vector<sqlite3*> idle_readers;
+  size_t open_readers{0};
+
+  ~Partition() {
+    close_writer();
+    for (sqlite3* db : idle_readers) sqlite3_close(db);
+  }
+
+  // Open the writer connection (creating the file and schema) if needed
+  void open_writer() {
+    if (writer_db) return;
+    if (sqlite3_open(path.c_str(), &writer_db) != SQLITE_OK) {
+      std::string msg = "Failed to open database " + path + ": " + sqlite3_errmsg(writer_db);
+      close_writer();
+      throw std::runtime_error(msg);
+    }
+    try {
+      db_ensure_schema(writer_db);
+    } catch (...) {
+      close_writer();
+      throw;
+    }
+
+    // Re-persisting a bucket (e.g. a re-run over the same day) overwrites it
+    const char* candle_sql = R"SQL(
+      INSERT OR REPLACE INTO candles(symbol, resolution_ms, open_time_ms, source, open, high, low, close, volume, trade_count)
+      VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+    )SQL";
+    const char* event_sql = R"SQL(
+      INSERT INTO events(event_type, timestamp_ms, symbol, source, order_id, side, qty, price, status, extra)
+      VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+    )SQL";
+
+    if (sqlite3_prepare_v2(writer_db, candle_sql, -1, &insert_candle, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(writer_db, event_sql, -1, &insert_event, nullptr) != SQLITE_OK) {
+      std::string msg = std::string("Failed to prepare statement: ") + sqlite3_errmsg(writer_db);
+      close_writer();
+      throw std::runtime_error(msg);
+    }
+  }
+
+  void close_writer() {
+    if (insert_candle) { sqlite3_finalize(insert_candle); insert_candle = nullptr; }
+    if (insert_event) { sqlite3_finalize(insert_event); insert_event = nullptr; }
+    if (writer_db) { sqlite3_close(writer_db); writer_db = nullptr; }
+  }
+
+  sqlite3* acquire_reader() {
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    while (idle_readers.empty()) {
+      if (open_readers < max_readers) {
+        ++open_readers;
+        lock.unlock();
+        sqlite3* db = nullptr;
+        if (sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+          std::string msg = "Failed to open read connection to " + path + ": " + sqlite3_errmsg(db);
+          sqlite3_close(db);
+          std::lock_guard<std::mutex> relock(pool_mutex);
+          --open_readers;
+          throw std::runtime_error(msg);
+        }
+        sqlite3_busy_timeout(db, 5000);
+        return db;
+      }
+      pool_cv.wait(lock);
+    }
+    sqlite3* db = idle_readers.back();
+    idle_readers.pop_back();
+    return db;
+  }
+
+  void release_reader(sqlite3* db) {
+    {
+      std::lock_guard<std::mutex> lock(pool_mutex);
+      idle_readers.push_back(db);
+    }
+    pool_cv.notify_one();
+  }
+};
+
+// A pooled read-only connection, returned on destruction
+class CandleStore::ReadLease {
+public:
+  explicit ReadLease(Partition& partition) : partition_(partition), db_(partition.acquire_reader()) {}
+  ~ReadLease() { partition_.release_reader(db_); }
+
+  ReadLease(const ReadLease&) = delete;
+  ReadLease& operator=(const ReadLease&) = delete;
+
+  sqlite3* db() const { return db_; }
+
+private:
+  Partition& partition_;
+  sqlite3* db_;
+};
+
+CandleStore::PartitionKey CandleStore::partition_key(long long timestamp_ms, const std::string& source) const {
+  if (!config_.partition_by_day) return PartitionKey{};
+  const long long day = timestamp_ms >= 0 ? (timestamp_ms / kDayMs) * kDayMs
+                                          : ((timestamp_ms - kDayMs + 1) / kDayMs) * kDayMs;
+  return PartitionKey{day, source_dir_name(source)};
+}
+
+std::shared_ptr<CandleStore::Partition> CandleStore::make_partition(const PartitionKey& key) const {
+  auto partition = std::make_shared<Partition>();
+  partition->key = key;
+  partition->path = key.day_ms < 0
+      ? config_.db_path
+      : (fs::path(partition_root()) / key.source / (day_name(key.day_ms) + ".db")).string();
+  partition->max_readers = std::max<size_t>(config_.read_connections, 1);
+  return partition;
+}
+
+std::shared_ptr<CandleStore::Partition> CandleStore::writer_partition(const PartitionKey& key) {
+  {
+    std::lock_guard<std::mutex> lock(partitions_mutex_);
+    auto it = partitions_.find(key);
+    if (it != partitions_.end()) {
+      it->second->open_writer();
+      return it->second;
+    }
+  }
+
+  // New day: create the file and schema before readers can see it
+  auto partition = make_partition(key);
+  fs::create_directories(fs::path(partition->path).parent_path());
+  partition->open_writer();
+  ENG_LOG_INFO("[CandleStore] Opened partition: " << partition->path);
+
+  std::lock_guard<std::mutex> lock(partitions_mutex_);
+  partitions_[key] = partition;
+  return partition;
+}
+
+void CandleStore::discover_partitions() {
+  std::error_code ec;
+  const fs::path root(partition_root());
+  if (!fs::is_directory(root, ec)) return;
+
+  size_t found = 0;
+  std::lock_guard<std::mutex> lock(partitions_mutex_);
+  for (const auto& source_dir : fs::directory_iterator(root, ec)) {
+    if (!source_dir.is_directory()) continue;
+    for (const auto& file : fs::directory_iterator(source_dir.path(), ec)) {
+      long long day_ms = 0;
+      if (file.path().extension() != ".db" || !parse_day_name(file.path().stem().string(), day_ms)) continue;
+      PartitionKey key{day_ms, source_dir.path().filename().string()};
+      partitions_[key] = make_partition(key);
+      ++found;
+    }
+  }
+  ENG_LOG_INFO("[CandleStore] Found " << found << " partitions under " << root.string());
+}
+
+std::vector<std::shared_ptr<CandleStore::Partition>> CandleStore::partitions_for(long long start_ms,
+                                                                             long long end_ms) const {
+  std::vector<std::shared_ptr<Partition>> out;
+  std::lock_guard<std::mutex> lock(partitions_mutex_);
+  for (const auto& [key, partition] : partitions_) {
+    if (key.day_ms >= 0 && (key.day_ms + kDayMs <= start_ms || key.day_ms > end_ms)) continue;
+    out.push_back(partition);
+  }
+  return out;
+}
+
+// ---- CandleStore ----
+
 CandleStore::CandleStore(const CandleStoreConfig& config)
-    : config_(config) {
-  int rc = sqlite3_open(config_.db_path.c_str(), &db_);
-  if (rc != SQLITE_OK) {
-    std::string msg = "Failed to open database: " + std::string(sqlite3_errmsg(db_));
-    if (db_) sqlite3_close(db_);
-    throw std::runtime_error(msg);
+    : config_(config), candle_cache_(config.candle_cache_bytes), event_cache_(config.max_cached_events) {
+  if (config_.partition_by_day) {
+    discover_partitions();
+  } else {
+    // The single file is opened (and its schema checked) up front
+    auto partition = make_partition(PartitionKey{});
+    partition->open_writer();
+    partitions_[PartitionKey{}] = std::move(partition);
+    ENG_LOG_INFO("[CandleStore] Opened database: " << config_.db_path);
   }
-  
-  std::cout << "[CandleStore] Opened database: " << config_.db_path << "\n";
-  ensure_schema();
+
+  writer_thread_ = std::thread([this]() { writer_loop(); });
 }
 
 CandleStore::~CandleStore() {
   try {
     flush_all();
   } catch (const std::exception& e) {
-    std::cerr << "[CandleStore] Error flushing on shutdown: " << e.what() << "\n";
+    ENG_LOG_ERROR("[CandleStore] Error flushing on shutdown: " << e.what());
   }
-  
-  if (db_) {
-    sqlite3_close(db_);
-    std::cout << "[CandleStore] Closed database\n";
+
+  {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    stop_writer_ = true;
+  }
+  writer_cv_.notify_one();
+  if (writer_thread_.joinable()) writer_thread_.join();
+
+  {
+    std::lock_guard<std::mutex> lock(partitions_mutex_);
+    partitions_.clear();   // Connections close with the last reference
   }
+  ENG_LOG_INFO("[CandleStore] Closed database");
 }
 
 void CandleStore::ensure_schema() {
-  std::lock_guard<std::mutex> lock(db_mutex_);
-  db_ensure_schema();
+  // Only the writer thread touches writer connections; a short-lived one
+  // per file is enough for this
+  for (const auto& partition : partitions_for(0, INT64_MAX)) {
+    sqlite3* db = nullptr;
+    if (sqlite3_open(partition->path.c_str(), &db) != SQLITE_OK) {
+      std::string msg = "Failed to open database " + partition->path + ": " + sqlite3_errmsg(db);
+      sqlite3_close(db);
+      throw std::runtime_error(msg);
+    }
+    try {
+      db_ensure_schema(db);
+    } catch (...) {
+      sqlite3_close(db);
+      throw;
+    }
+    sqlite3_close(db);
+  }
 }
 
-void CandleStore::db_ensure_schema() {
+void CandleStore::db_ensure_schema(sqlite3* db) {
   // Performance pragmas
-  exec_sql("PRAGMA journal_mode=WAL;");
-  exec_sql("PRAGMA synchronous=NORMAL;");
-  exec_sql("PRAGMA foreign_keys=ON;");
-  exec_sql("PRAGMA cache_size=50000;");
-  exec_sql("PRAGMA temp_store=MEMORY;");
-  exec_sql("PRAGMA busy_timeout=5000;");
+  exec_sql(db, "PRAGMA journal_mode=WAL;");
+  exec_sql(db, "PRAGMA synchronous=NORMAL;");
+  exec_sql(db, "PRAGMA foreign_keys=ON;");
+  exec_sql(db, "PRAGMA cache_size=50000;");
+  exec_sql(db, "PRAGMA temp_store=MEMORY;");
+  exec_sql(db, "PRAGMA busy_timeout=5000;");
 
   // Schema version tracking
-  exec_sql("CREATE TABLE IF NOT EXISTS schema_version(version INTEGER NOT NULL);");
+  exec_sql(db, "CREATE TABLE IF NOT EXISTS schema_version(version INTEGER NOT NULL);");
 
-  int v = query_int("SELECT version FROM schema_version LIMIT 1;", 0);
+  int v = query_int(db, "SELECT version FROM schema_version LIMIT 1;", 0);
 
-  exec_sql("BEGIN;");
+  exec_sql(db, "BEGIN;");
   try {
     if (v < 1) {
       // Candles table: OHLCV data at various resolutions
-      exec_sql(R"SQL(
+      exec_sql(db, R"SQL(
         CREATE TABLE IF NOT EXISTS candles(
           symbol TEXT NOT NULL,
           resolution_ms INTEGER NOT NULL,
@@ -74,19 +331,19 @@ void CandleStore::db_ensure_schema() {
       )SQL");
 
       // Fast queries by symbol, resolution, and time range
-      exec_sql(R"SQL(
+      exec_sql(db, R"SQL(
         CREATE INDEX IF NOT EXISTS idx_candles_query 
         ON candles(symbol, resolution_ms, open_time_ms);
       )SQL");
 
       // Track which data is live vs backtest
-      exec_sql(R"SQL(
+      exec_sql(db, R"SQL(
         CREATE INDEX IF NOT EXISTS idx_candles_by_source 
         ON candles(source, open_time_ms);
       )SQL");
 
       // Events table: flexible JSON storage for OrderPlaced, OrderFilled, etc.
-      exec_sql(R"SQL(
+      exec_sql(db, R"SQL(
         CREATE TABLE IF NOT EXISTS events(
           event_id INTEGER PRIMARY KEY AUTOINCREMENT,
           event_type TEXT NOT NULL,
@@ -99,25 +356,25 @@ void CandleStore::db_ensure_schema() {
       )SQL");
 
       // Fast queries by symbol and time range
-      exec_sql(R"SQL(
+      exec_sql(db, R"SQL(
         CREATE INDEX IF NOT EXISTS idx_events_query 
         ON events(symbol, timestamp_ms);
       )SQL");
 
       // Filter by event type
-      exec_sql(R"SQL(
+      exec_sql(db, R"SQL(
         CREATE INDEX IF NOT EXISTS idx_events_by_type 
         ON events(event_type, symbol);
       )SQL");
 
       // Track ingestion time for debugging/cleanup
-      exec_sql(R"SQL(
+      exec_sql(db, R"SQL(
         CREATE INDEX IF NOT EXISTS idx_events_ingestion 
         ON events(ingestion_time);
       )SQL");
 
       // Sources reference table
-      exec_sql(R"SQL(
+      exec_sql(db, R"SQL(
         CREATE TABLE IF NOT EXISTS sources(
           source_id TEXT PRIMARY KEY,
           description TEXT,
@@ -126,124 +383,551 @@ void CandleStore::db_ensure_schema() {
       )SQL");
 
       // Seed default sources
-      exec_sql("INSERT OR IGNORE INTO sources(source_id, description) VALUES('live', 'Real-time live trading');");
-      exec_sql("INSERT OR IGNORE INTO sources(source_id, description) VALUES('backtest', 'Historical backtest data');");
+      exec_sql(db, "INSERT OR IGNORE INTO sources(source_id, description) VALUES('live', 'Real-time live trading');");
+      exec_sql(db, "INSERT OR IGNORE INTO sources(source_id, description) VALUES('backtest', 'Historical backtest data');");
 
-      exec_sql("DELETE FROM schema_version;");
-      exec_sql("INSERT INTO schema_version(version) VALUES (1);");
+      exec_sql(db, "DELETE FROM schema_version;");
+      exec_sql(db, "INSERT INTO schema_version(version) VALUES (1);");
       v = 1;
       
-      std::cout << "[CandleStore] Schema initialized (v1)\n";
+      ENG_LOG_INFO("[CandleStore] Schema initialized (v1)");
     }
 
-    exec_sql("COMMIT;");
+    if (v < 2) {
+      // v2: rollup tiers. Databases written before them only have the base
+      // resolution, so build the tiers from it once.
+      db_rebuild_rollups(db);
+
+      exec_sql(db, "DELETE FROM schema_version;");
+      exec_sql(db, "INSERT INTO schema_version(version) VALUES (2);");
+      v = 2;
+
+      ENG_LOG_INFO("[CandleStore] Schema migrated to v2 (rollup tiers)");
+    }
+
+    if (v < 3) {
+      // v3: typed event columns. The order fields move out of the JSON
+      // payload; whatever else it held stays in `extra`, including the
+      // order qty of a fill (filledQty takes the column, as in add_event).
+      // A payload that isn't valid JSON is kept whole, under extra.data.
+      exec_sql(db, R"SQL(
+        CREATE TABLE events_v3(
+          event_id INTEGER PRIMARY KEY AUTOINCREMENT,
+          event_type TEXT NOT NULL,
+          timestamp_ms INTEGER NOT NULL,
+          symbol TEXT NOT NULL,
+          source TEXT NOT NULL,
+          order_id INTEGER,
+          side TEXT,
+          qty REAL,
+          price REAL,
+          status TEXT,
+          extra TEXT,
+          ingestion_time DATETIME DEFAULT CURRENT_TIMESTAMP
+        );
+      )SQL");
+      exec_sql(db, R"SQL(
+        INSERT INTO events_v3(event_id, event_type, timestamp_ms, symbol, source,
+                              order_id, side, qty, price, status, extra, ingestion_time)
+        SELECT event_id, event_type, timestamp_ms, symbol, source,
+               json_extract(data, '$.orderId'),
+               json_extract(data, '$.side'),
+               COALESCE(json_extract(data, '$.filledQty'), json_extract(data, '$.qty')),
+               json_extract(data, '$.fillPrice'),
+               json_extract(data, '$.status'),
+               NULLIF(json_remove(data, '$.orderId', '$.symbol', '$.side',
+                                  CASE WHEN json_extract(data, '$.filledQty') IS NULL
+                                       THEN '$.qty' ELSE '$.filledQty' END,
+                                  '$.fillPrice', '$.status'), '{}'),
+               ingestion_time
+        FROM events WHERE json_valid(data);
+      )SQL");
+      const int invalid = query_int(db, "SELECT COUNT(*) FROM events WHERE NOT json_valid(data);", 0);
+      if (invalid > 0) {
+        exec_sql(db, R"SQL(
+          INSERT INTO events_v3(event_id, event_type, timestamp_ms, symbol, source, extra, ingestion_time)
+          SELECT event_id, event_type, timestamp_ms, symbol, source, json_object('data', data), ingestion_time
+          FROM events WHERE NOT json_valid(data);
+        )SQL");
+        ENG_LOG_WARN("[CandleStore] " << invalid << " events had a payload that isn't valid JSON; "
+                     "kept as text in extra.data");
+      }
+      exec_sql(db, "DROP TABLE events;");
+      exec_sql(db, "ALTER TABLE events_v3 RENAME TO events;");
+      exec_sql(db, "CREATE INDEX IF NOT EXISTS idx_events_query ON events(symbol, timestamp_ms);");
+      exec_sql(db, "CREATE INDEX IF NOT EXISTS idx_events_by_type ON events(event_type, symbol);");
+      exec_sql(db, "CREATE INDEX IF NOT EXISTS idx_events_ingestion ON events(ingestion_time);");
+
+      exec_sql(db, "DELETE FROM schema_version;");
+      exec_sql(db, "INSERT INTO schema_version(version) VALUES (3);");
+      v = 3;
+
+      ENG_LOG_INFO("[CandleStore] Schema migrated to v3 (typed events)");
+    }
+
+    exec_sql(db, "COMMIT;");
   } catch (const std::exception& e) {
-    exec_sql("ROLLBACK;");
+    exec_sql(db, "ROLLBACK;");
     throw;
   }
 }
 
+void CandleStore::db_rebuild_rollups(sqlite3* db) {
+  // Each tier is aggregated straight from the base candles: first open, max
+  // high, min low, last close, summed volume per bucket
+  const char* sql = R"SQL(
+    INSERT OR REPLACE INTO candles(symbol, resolution_ms, open_time_ms, source, open, high, low, close, volume, trade_count)
+    SELECT g.symbol, ?1, g.bucket, g.source,
+      (SELECT f.open FROM candles f
+        WHERE f.symbol = g.symbol AND f.resolution_ms = ?2 AND f.source = g.source AND f.open_time_ms = g.first_ms),
+      g.high, g.low,
+      (SELECT l.close FROM candles l
+        WHERE l.symbol = g.symbol AND l.resolution_ms = ?2 AND l.source = g.source AND l.open_time_ms = g.last_ms),
+      g.volume, g.trade_count
+    FROM (
+      SELECT symbol, source, (open_time_ms / ?1) * ?1 AS bucket,
+             MIN(open_time_ms) AS first_ms, MAX(open_time_ms) AS last_ms,
+             MAX(high) AS high, MIN(low) AS low, SUM(volume) AS volume,
+             SUM(COALESCE(trade_count, 0)) AS trade_count
+      FROM candles
+      WHERE resolution_ms = ?2
+      GROUP BY symbol, source, bucket
+    ) g;
+  )SQL";
+
+  sqlite3_stmt* stmt = nullptr;
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    throw std::runtime_error(std::string("Failed to prepare rollup rebuild: ") + sqlite3_errmsg(db));
+  }
+
+  for (long long tier_ms : kRollupTiersMs) {
+    sqlite3_bind_int64(stmt, 1, tier_ms);
+    sqlite3_bind_int64(stmt, 2, kBaseResolutionMs);
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE) {
+      std::string msg = std::string("Failed to rebuild rollups: ") + sqlite3_errmsg(db);
+      sqlite3_finalize(stmt);
+      throw std::runtime_error(msg);
+    }
+  }
+  sqlite3_finalize(stmt);
+}
+
 void CandleStore::add_candle(const std::string& symbol, long long resolution_ms,
                              const Candle& candle, const std::string& source) {
+  bool wake = false;
   {
     std::lock_guard<std::mutex> lock(buffer_mutex_);
     // append a copy of a candle to the write_buffer.
-    candles_write_buffer_.push_back({symbol, candle});
-    // why do we track separate resolutions?
-    candles_resolution_buffer_.push_back({resolution_ms, symbol});
+    candles_write_buffer_.push_back({symbol, resolution_ms, source, candle});
+    ++enqueued_seq_;
+    if (config_.maintain_rollups && resolution_ms == kBaseResolutionMs) {
+      fold_into_rollups(symbol, source, candle);
+    }
+    wake = candles_write_buffer_.size() >= config_.candle_buffer_size;
+  }
+
+  if (wake) {
+    writer_cv_.notify_one();
   }
+}
 
-  if (candles_write_buffer_.size() >= config_.candle_buffer_size) {
-    flush_candles();
+long long CandleStore::rollup_resolution_for(long long resolution_ms) {
+  for (size_t i = kNumRollupTiers; i-- > 0;) {
+    if (resolution_ms >= kRollupTiersMs[i] && resolution_ms % kRollupTiersMs[i] == 0) {
+      return kRollupTiersMs[i];
+    }
   }
+  return kBaseResolutionMs;
+}
+
+void CandleStore::fold_into_rollups(const std::string& symbol, const std::string& source,
+                                    const Candle& candle) {
+  const long long t = std::chrono::duration_cast<std::chrono::milliseconds>(
+      candle.open_time.time_since_epoch()).count();
+
+  auto it = rollups_.find(RollupKey{symbol, source});
+  if (it == rollups_.end()) {
+    it = rollups_.emplace(RollupKey{symbol, source}, RollupState{}).first;
+  }
+  RollupState& state = it->second;
+
+  // The first tier has already written out the bucket this candle belongs
+  // in; the coarser tiers see base candles only through it
+  if (t < state[0].bucket_ms) {
+    const uint64_t late = ++writer_stats_.late_rollup_candles;
+    if (late % 1000 == 1) {
+      ENG_LOG_WARN("[CandleStore] " << symbol << " candle at " << t << "ms arrived after its "
+                   << kRollupTiersMs[0] << "ms bucket closed; left out of the rollups ("
+                   << late << " so far)");
+    }
+    return;
+  }
+
+  RollupPart part{t, candle.open, candle.high, candle.low, candle.close, candle.volume};
+  for (size_t i = 0; i < kNumRollupTiers; ++i) {
+    const long long tier_ms = kRollupTiersMs[i];
+    const long long bucket_ms = (part.open_ms / tier_ms) * tier_ms;
+    RollupBucket& acc = state[i];
+
+    if (bucket_ms > acc.bucket_ms) {
+      // Bucket rolled over: make sure the finished one gets written
+      if (acc.dirty) {
+        candles_write_buffer_.push_back({symbol, tier_ms, source, acc.candle});
+      }
+      acc.parts.clear();
+      if (acc.bucket_ms < 0) {
+        // First bucket since startup: an earlier run may have stored part
+        // of it. Nothing of this run is committed for the key yet.
+        db_query_rollup_parts(it->first, i == 0 ? kBaseResolutionMs : kRollupTiersMs[i - 1],
+                              bucket_ms, bucket_ms + tier_ms - 1, acc.parts);
+      }
+      acc.bucket_ms = bucket_ms;
+      acc.candle = candle;
+      acc.candle.open_time = TimePoint(std::chrono::milliseconds(bucket_ms));
+    }
+
+    // Replace the part if it was folded in before, else insert it in order
+    auto pos = std::lower_bound(acc.parts.begin(), acc.parts.end(), part.open_ms,
+        [](const RollupPart& p, long long ms) { return p.open_ms < ms; });
+    if (pos != acc.parts.end() && pos->open_ms == part.open_ms) *pos = part;
+    else acc.parts.insert(pos, part);
+
+    acc.candle.open = acc.parts.front().open;
+    acc.candle.close = acc.parts.back().close;
+    acc.candle.high = acc.parts.front().high;
+    acc.candle.low = acc.parts.front().low;
+    acc.candle.volume = 0.0;
+    for (const RollupPart& p : acc.parts) {
+      acc.candle.high = std::max(acc.candle.high, p.high);
+      acc.candle.low = std::min(acc.candle.low, p.low);
+      acc.candle.volume += p.volume;
+    }
+    acc.dirty = true;
+
+    // This bucket, as it stands, is the next tier's part
+    part = RollupPart{bucket_ms, acc.candle.open, acc.candle.high, acc.candle.low,
+                      acc.candle.close, acc.candle.volume};
+  }
+}
+
+void CandleStore::take_dirty_rollups(std::vector<PendingCandle>& out) {
+  // One row per open bucket per batch, however many base candles it absorbed
+  for (auto& [key, state] : rollups_) {
+    for (size_t i = 0; i < kNumRollupTiers; ++i) {
+      RollupBucket& acc = state[i];
+      if (!acc.dirty) continue;
+      out.push_back({key.symbol, kRollupTiersMs[i], key.source, acc.candle});
+      acc.dirty = false;
+    }
+  }
+}
+
+void CandleStore::db_query_rollup_parts(const RollupKey& key, long long resolution_ms,
+                                        long long start_ms, long long end_ms,
+                                        std::vector<RollupPart>& out) {
+  // A bucket lies within one day, so one source's rows come from one file,
+  // already in order
+  const char* sql = R"SQL(
+    SELECT open_time_ms, open, high, low, close, volume
+    FROM candles
+    WHERE symbol = ? AND resolution_ms = ? AND source = ? AND open_time_ms BETWEEN ? AND ?
+    ORDER BY open_time_ms ASC;
+  )SQL";
+
+  for (const auto& partition : partitions_for(start_ms, end_ms)) {
+    ReadLease lease(*partition);
+    sqlite3* db = lease.db();
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+      // A file whose schema isn't there yet has nothing to read
+      if (config_.partition_by_day) continue;
+      throw std::runtime_error(std::string("Failed to prepare query: ") + sqlite3_errmsg(db));
+    }
+    sqlite3_bind_text(stmt, 1, key.symbol.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 2, resolution_ms);
+    sqlite3_bind_text(stmt, 3, key.source.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 4, start_ms);
+    sqlite3_bind_int64(stmt, 5, end_ms);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      out.push_back(RollupPart{sqlite3_column_int64(stmt, 0), sqlite3_column_double(stmt, 1),
+                               sqlite3_column_double(stmt, 2), sqlite3_column_double(stmt, 3),
+                               sqlite3_column_double(stmt, 4), sqlite3_column_double(stmt, 5)});
+    }
+    sqlite3_finalize(stmt);
+  }
+}
+
+void CandleStore::save_state(CheckpointWriter& out) const {
+  std::lock_guard<std::mutex> lock(buffer_mutex_);
+  out.put<uint32_t>(kRollupCheckpointLayout);
+  out.put<uint64_t>(kNumRollupTiers);
+  out.put<uint64_t>(rollups_.size());
+  for (const auto& [key, state] : rollups_) {
+    out.put_string(key.symbol);
+    out.put_string(key.source);
+    for (const RollupBucket& acc : state) {
+      out.put<long long>(acc.bucket_ms);
+      out.put<uint64_t>(acc.parts.size());
+      for (const RollupPart& part : acc.parts) out.put<RollupPart>(part);
+      out.put<uint8_t>(acc.dirty);
+      out.put_time(acc.candle.open_time);
+      out.put<double>(acc.candle.open);
+      out.put<double>(acc.candle.high);
+      out.put<double>(acc.candle.low);
+      out.put<double>(acc.candle.close);
+      out.put<double>(acc.candle.volume);
+      out.put<InstrumentId>(acc.candle.instrument_id);
+    }
+  }
+}
+
+void CandleStore::load_state(CheckpointReader& in) {
+  if (in.get<uint32_t>() != kRollupCheckpointLayout) in.fail("CandleStore checkpoint has another rollup layout");
+  if (in.get<uint64_t>() != kNumRollupTiers) in.fail("CandleStore checkpoint has other rollup tiers");
+  std::lock_guard<std::mutex> lock(buffer_mutex_);
+  const auto keys = in.get<uint64_t>();
+  for (uint64_t i = 0; i < keys; ++i) {
+    RollupKey key;
+    key.symbol = in.get_string();
+    key.source = in.get_string();
+    RollupState& state = rollups_[key];
+    for (RollupBucket& acc : state) {
+      acc.bucket_ms = in.get<long long>();
+      const auto parts = in.get<uint64_t>();
+      if (parts > static_cast<uint64_t>(kRollupTiersMs[0] / kBaseResolutionMs)) {
+        in.fail("rollup bucket with " + std::to_string(parts) + " parts");
+      }
+      acc.parts.clear();
+      for (uint64_t p = 0; p < parts; ++p) acc.parts.push_back(in.get<RollupPart>());
+      acc.dirty = in.get<uint8_t>() != 0;
+      acc.candle.symbol = key.symbol;
+      acc.candle.open_time = in.get_time();
+      acc.candle.open = in.get<double>();
+      acc.candle.high = in.get<double>();
+      acc.candle.low = in.get<double>();
+      acc.candle.close = in.get<double>();
+      acc.candle.volume = in.get<double>();
+      acc.candle.instrument_id = in.get<InstrumentId>();
+    }
+  }
+  if (!in.done()) in.fail("unexpected trailing data");
 }
 
 void CandleStore::add_event(const std::string& event_type, long long timestamp_ms,
                             const std::string& symbol, const std::string& source,
                             const json& data) {
+  StoredEvent event;
+  event.event_type = event_type;
+  event.timestamp_ms = timestamp_ms;
+  event.symbol = symbol;
+  event.source = source;
+  if (data.is_object()) {
+    json extra = data;
+    auto take = [&extra](const char* key) {
+      json value;
+      auto it = extra.find(key);
+      if (it != extra.end()) {
+        value = std::move(*it);
+        extra.erase(it);
+      }
+      return value;
+    };
+    json order_id = take("orderId"), side = take("side"), qty = take("qty"),
+         filled_qty = take("filledQty"), price = take("fillPrice"), status = take("status");
+    take("symbol");
+
+    if (order_id.is_number()) event.order_id = order_id.get<long long>();
+    if (side.is_string()) event.side = side.get<std::string>();
+    // A fill's qty is what was filled; the order qty then stays in extra
+    if (filled_qty.is_number()) {
+      event.qty = filled_qty.get<double>();
+      if (!qty.is_null()) extra["qty"] = std::move(qty);
+    } else if (qty.is_number()) {
+      event.qty = qty.get<double>();
+    }
+    if (price.is_number()) event.price = price.get<double>();
+    if (status.is_string()) event.status = status.get<std::string>();
+    if (!extra.empty()) event.extra = std::move(extra);
+  } else if (!data.is_null()) {
+    event.extra["data"] = data;
+  }
+  add_event(std::move(event));
+}
+
+void CandleStore::add_event(StoredEvent event) {
+  bool wake = false;
   {
     std::lock_guard<std::mutex> lock(buffer_mutex_);
-    events_write_buffer_.push_back({event_type, timestamp_ms, symbol, source, data});
+    events_write_buffer_.push_back(std::move(event));
+    ++enqueued_seq_;
+    wake = events_write_buffer_.size() >= config_.event_buffer_size;
   }
 
-  if (events_write_buffer_.size() >= config_.event_buffer_size) {
-    flush_events();
+  if (wake) {
+    writer_cv_.notify_one();
   }
 }
 
 void CandleStore::flush_all() {
-  flush_candles();
-  flush_events();
+  std::unique_lock<std::mutex> lock(buffer_mutex_);
+  const uint64_t target = enqueued_seq_;
+  if (committed_seq_ >= target) return;
+  flush_requested_ = true;
+  writer_cv_.notify_one();
+  committed_cv_.wait(lock, [this, target]() { return committed_seq_ >= target || stop_writer_; });
 }
 
 void CandleStore::flush_candles() {
-  std::vector<std::pair<std::string, Candle>> to_flush;
-  std::vector<std::pair<long long, std::string>> resolutions;
-  {
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    to_flush = std::move(candles_write_buffer_);
-    resolutions = std::move(candles_resolution_buffer_);
-    candles_write_buffer_.clear();
-    candles_resolution_buffer_.clear();
-  }
+  flush_all();
+}
 
-  if (to_flush.empty()) return;
+void CandleStore::flush_events() {
+  flush_all();
+}
 
-  {
-    std::lock_guard<std::mutex> lock(db_mutex_);
-    db_batch_insert_candles(to_flush, resolutions);
-  }
+CandleStoreWriterStats CandleStore::writer_stats() const {
+  std::lock_guard<std::mutex> lock(buffer_mutex_);
+  return writer_stats_;
+}
 
-  std::cout << "[CandleStore] Flushed " << to_flush.size() << " candles to DB\n";
+CandleCache::Stats CandleStore::candle_cache_stats() {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  return candle_cache_.stats();
 }
 
-void CandleStore::flush_events() {
-  std::vector<StoredEvent> to_flush;
-  {
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    to_flush = std::move(events_write_buffer_);
-    events_write_buffer_.clear();
-  }
+EventCache::Stats CandleStore::event_cache_stats() {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  return event_cache_.stats();
+}
 
-  if (to_flush.empty()) return;
+void CandleStore::writer_loop() {
+  std::vector<PendingCandle> candles;
+  std::vector<StoredEvent> events;
+  const auto interval = std::chrono::milliseconds(config_.flush_interval_ms);
+
+  std::unique_lock<std::mutex> lock(buffer_mutex_);
+  while (true) {
+    writer_cv_.wait_for(lock, interval, [this]() {
+      return stop_writer_ || flush_requested_ ||
+             candles_write_buffer_.size() >= config_.candle_buffer_size ||
+             events_write_buffer_.size() >= config_.event_buffer_size;
+    });
+    flush_requested_ = false;
+
+    if (candles_write_buffer_.empty() && events_write_buffer_.empty()) {
+      if (stop_writer_) break;
+      continue;
+    }
 
-  {
-    std::lock_guard<std::mutex> lock(db_mutex_);
-    db_batch_insert_events(to_flush);
+    // Take everything pending; producers keep appending to fresh buffers
+    candles.swap(candles_write_buffer_);
+    events.swap(events_write_buffer_);
+    take_dirty_rollups(candles);
+    const uint64_t taken_seq = enqueued_seq_;
+    writer_busy_ = true;
+    lock.unlock();
+
+    // The caches only ever see committed rows, rollup rows included
+    {
+      std::lock_guard<std::mutex> cache_lock(cache_mutex_);
+      for (const auto& c : candles) candle_cache_.begin_commit(c.symbol, c.resolution_ms);
+      if (!events.empty()) event_cache_.begin_commit(events);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    bool ok = true;
+    try {
+      write_batch(candles, events);
+    } catch (const std::exception& e) {
+      ok = false;
+      ENG_LOG_ERROR("[CandleStore] Writer failed to commit " << candles.size() << " candles, "
+                    << events.size() << " events: " << e.what());
+    }
+
+    {
+      std::lock_guard<std::mutex> cache_lock(cache_mutex_);
+      for (const auto& c : candles) candle_cache_.end_commit(c.symbol, c.resolution_ms, c.candle, ok);
+      if (!events.empty()) event_cache_.end_commit(events, ok);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - t0;
+    double secs = std::chrono::duration<double>(elapsed).count();
+    const size_t rows = candles.size() + events.size();
+    ENG_METRICS_RECORD(PersistFlush, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+    lock.lock();
+    if (ok) {
+      writer_stats_.candles_written += candles.size();
+      writer_stats_.events_written += events.size();
+      writer_stats_.batches++;
+      writer_busy_seconds_ += secs;
+      writer_stats_.last_batch_rows_per_sec = secs > 0.0 ? rows / secs : 0.0;
+      uint64_t total = writer_stats_.candles_written + writer_stats_.events_written;
+      writer_stats_.avg_rows_per_sec = writer_busy_seconds_ > 0.0 ? total / writer_busy_seconds_ : 0.0;
+
+      ENG_LOG_DEBUG("[CandleStore] Committed " << candles.size() << " candles, " << events.size()
+                    << " events in " << std::fixed << std::setprecision(1) << secs * 1000.0 << "ms ("
+                    << std::setprecision(0) << writer_stats_.last_batch_rows_per_sec << " rows/s)");
+    } else {
+      writer_stats_.failed_batches++;
+    }
+    committed_seq_ = taken_seq;
+    writer_busy_ = false;
+    candles.clear();
+    events.clear();
+    committed_cv_.notify_all();
   }
 
-  std::cout << "[CandleStore] Flushed " << to_flush.size() << " events to DB\n";
+  committed_cv_.notify_all();
 }
 
-void CandleStore::db_batch_insert_candles(
-    const std::vector<std::pair<std::string, Candle>>& batch,
-    const std::vector<std::pair<long long, std::string>>& resolutions) {
-  if (batch.empty()) return;
-
-  sqlite3_stmt* stmt = nullptr;
-  const char* sql = R"SQL(
-    INSERT INTO candles(symbol, resolution_ms, open_time_ms, source, open, high, low, close, volume, trade_count)
-    VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
-  )SQL";
+void CandleStore::write_batch(const std::vector<PendingCandle>& candles,
+                              const std::vector<StoredEvent>& events) {
+  // Group rows by the file they belong in; unpartitioned, that's one file
+  struct Rows {
+    std::vector<const PendingCandle*> candles;
+    std::vector<const StoredEvent*> events;
+  };
+  std::map<PartitionKey, Rows> by_partition;
+  for (const auto& pending : candles) {
+    auto open_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        pending.candle.open_time.time_since_epoch()).count();
+    by_partition[partition_key(open_time_ms, pending.source)].candles.push_back(&pending);
+  }
+  for (const auto& event : events) {
+    by_partition[partition_key(event.timestamp_ms, event.source)].events.push_back(&event);
+  }
 
-  int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-  if (rc != SQLITE_OK) {
-    throw std::runtime_error(std::string("Failed to prepare statement: ") + sqlite3_errmsg(db_));
+  // One transaction per file. A failing file is rolled back; the others
+  // still commit, and the batch is reported as failed.
+  std::string errors;
+  for (const auto& [key, rows] : by_partition) {
+    try {
+      write_partition(*writer_partition(key), rows.candles, rows.events);
+    } catch (const std::exception& e) {
+      if (!errors.empty()) errors += "; ";
+      errors += e.what();
+    }
   }
+  if (!errors.empty()) throw std::runtime_error(errors);
+}
 
-  exec_sql("BEGIN TRANSACTION;");
+void CandleStore::write_partition(Partition& partition, const std::vector<const PendingCandle*>& candles,
+                                  const std::vector<const StoredEvent*>& events) {
+  sqlite3* db = partition.writer_db;
+  exec_sql(db, "BEGIN TRANSACTION;");
   try {
-    for (size_t i = 0; i < batch.size(); ++i) {
-      const auto& [symbol, candle] = batch[i];
-      const auto& [resolution_ms, _] = resolutions[i];
-      
+    for (const PendingCandle* pending : candles) {
+      const Candle& candle = pending->candle;
       auto open_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
           candle.open_time.time_since_epoch()).count();
 
-      sqlite3_bind_text(stmt, 1, symbol.c_str(), -1, SQLITE_STATIC);
-      sqlite3_bind_int64(stmt, 2, resolution_ms);
+      sqlite3_stmt* stmt = partition.insert_candle;
+      sqlite3_bind_text(stmt, 1, pending->symbol.c_str(), -1, SQLITE_STATIC);
+      sqlite3_bind_int64(stmt, 2, pending->resolution_ms);
       sqlite3_bind_int64(stmt, 3, open_time_ms);
-      sqlite3_bind_text(stmt, 4, "backtest", -1, SQLITE_STATIC);  // Source
+      sqlite3_bind_text(stmt, 4, pending->source.c_str(), -1, SQLITE_STATIC);
       sqlite3_bind_double(stmt, 5, candle.open);
       sqlite3_bind_double(stmt, 6, candle.high);
       sqlite3_bind_double(stmt, 7, candle.low);
@@ -251,104 +935,176 @@ void CandleStore::db_batch_insert_candles(
       sqlite3_bind_double(stmt, 9, candle.volume);
       sqlite3_bind_int(stmt, 10, 0);  // trade_count (optional)
 
-      rc = sqlite3_step(stmt);
+      int rc = sqlite3_step(stmt);
+      sqlite3_reset(stmt);
       if (rc != SQLITE_DONE) {
-        throw std::runtime_error(std::string("Failed to insert candle: ") + sqlite3_errmsg(db_));
+        throw std::runtime_error(std::string("Failed to insert candle: ") + sqlite3_errmsg(db));
       }
+    }
+
+    std::string extra_str;
+    for (const StoredEvent* event : events) {
+      sqlite3_stmt* stmt = partition.insert_event;
+      sqlite3_bind_text(stmt, 1, event->event_type.c_str(), -1, SQLITE_STATIC);
+      sqlite3_bind_int64(stmt, 2, event->timestamp_ms);
+      sqlite3_bind_text(stmt, 3, event->symbol.c_str(), -1, SQLITE_STATIC);
+      sqlite3_bind_text(stmt, 4, event->source.c_str(), -1, SQLITE_STATIC);
+      sqlite3_bind_int64(stmt, 5, event->order_id);
+      bind_text_or_null(stmt, 6, event->side);
+      sqlite3_bind_double(stmt, 7, event->qty);
+      sqlite3_bind_double(stmt, 8, event->price);
+      bind_text_or_null(stmt, 9, event->status);
+
+      if (event->extra.is_null()) {
+        sqlite3_bind_null(stmt, 10);
+      } else {
+        extra_str = event->extra.dump();
+        sqlite3_bind_text(stmt, 10, extra_str.c_str(), -1, SQLITE_STATIC);
+      }
+
+      int rc = sqlite3_step(stmt);
       sqlite3_reset(stmt);
+      if (rc != SQLITE_DONE) {
+        throw std::runtime_error(std::string("Failed to insert event: ") + sqlite3_errmsg(db));
+      }
     }
-    exec_sql("COMMIT;");
+    exec_sql(db, "COMMIT;");
   } catch (const std::exception& e) {
-    exec_sql("ROLLBACK;");
-    sqlite3_finalize(stmt);
+    try { exec_sql(db, "ROLLBACK;"); } catch (...) {}
     throw;
   }
-  sqlite3_finalize(stmt);
 }
 
-void CandleStore::db_batch_insert_events(const std::vector<StoredEvent>& batch) {
-  if (batch.empty()) return;
+std::vector<Candle> CandleStore::query_candles(const std::string& symbol,
+                                                long long resolution_ms,
+                                                long long start_ms, long long end_ms) {
+  // Check cache first: any cached segment covering the whole range answers it
+  uint64_t generation = 0;
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    std::vector<Candle> cached;
+    if (candle_cache_.lookup(symbol, resolution_ms, start_ms, end_ms, cached)) {
+      return cached;  // Cache hit!
+    }
+    generation = candle_cache_.generation(symbol, resolution_ms);
+  }
 
-  sqlite3_stmt* stmt = nullptr;
-  const char* sql = R"SQL(
-    INSERT INTO events(event_type, timestamp_ms, symbol, source, data)
-    VALUES(?, ?, ?, ?, ?);
-  )SQL";
+  // Cache miss: query database
+  std::vector<Candle> result;
+  db_query_candles(symbol, resolution_ms, start_ms, end_ms, result);
 
-  int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-  if (rc != SQLITE_OK) {
-    throw std::runtime_error(std::string("Failed to prepare statement: ") + sqlite3_errmsg(db_));
+  // Cache the range (merged with neighbouring cached ranges)
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    candle_cache_.insert(symbol, resolution_ms, start_ms, end_ms, result, generation);
   }
 
-  exec_sql("BEGIN TRANSACTION;");
-  try {
-    for (const auto& event : batch) {
-      sqlite3_bind_text(stmt, 1, event.event_type.c_str(), -1, SQLITE_STATIC);
-      sqlite3_bind_int64(stmt, 2, event.timestamp_ms);
-      sqlite3_bind_text(stmt, 3, event.symbol.c_str(), -1, SQLITE_STATIC);
-      sqlite3_bind_text(stmt, 4, event.source.c_str(), -1, SQLITE_STATIC);
-      
-      std::string data_str = event.data.dump();
-      sqlite3_bind_text(stmt, 5, data_str.c_str(), -1, SQLITE_TRANSIENT);
+  return result;
+}
 
-      rc = sqlite3_step(stmt);
-      if (rc != SQLITE_DONE) {
-        throw std::runtime_error(std::string("Failed to insert event: ") + sqlite3_errmsg(db_));
-      }
-      sqlite3_reset(stmt);
+long long CandleStore::downsample_bucket_for(long long resolution_ms,
+                                            long long start_ms, long long end_ms,
+                                            size_t max_points) {
+  if (max_points == 0 || end_ms < start_ms) return resolution_ms;
+  const long long span = end_ms - start_ms + 1;
+  const long long points = static_cast<long long>(max_points);
+  const long long needed = (span + points - 1) / points;
+  if (needed <= resolution_ms) return resolution_ms;
+
+  // Widen to a multiple of the coarsest tier that fits, so the bars are built
+  // from as few stored rows as possible; otherwise to a multiple of resolution
+  for (size_t i = kNumRollupTiers; i-- > 0;) {
+    const long long tier_ms = kRollupTiersMs[i];
+    if (needed >= tier_ms && tier_ms % resolution_ms == 0) {
+      return ((needed + tier_ms - 1) / tier_ms) * tier_ms;
     }
-    exec_sql("COMMIT;");
-  } catch (const std::exception& e) {
-    exec_sql("ROLLBACK;");
-    sqlite3_finalize(stmt);
-    throw;
   }
-  sqlite3_finalize(stmt);
+  return ((needed + resolution_ms - 1) / resolution_ms) * resolution_ms;
 }
 
-std::vector<Candle> CandleStore::query_candles(const std::string& symbol,
-                                                long long resolution_ms,
-                                                long long start_ms, long long end_ms) {
-  CandleCacheKey key{symbol, resolution_ms};
-
-  // Check cache first
+DownsampledCandles CandleStore::query_candles_downsampled(const std::string& symbol,
+                                                          long long resolution_ms,
+                                                          long long start_ms, long long end_ms,
+                                                          size_t max_points,
+                                                          const std::atomic<bool>* cancel) {
+  DownsampledCandles out;
+  out.bucket_ms = downsample_bucket_for(resolution_ms, start_ms, end_ms, max_points);
+  out.downsampled = out.bucket_ms != resolution_ms;
+  out.source_resolution_ms = rollup_resolution_for(out.bucket_ms);
+  if (end_ms < start_ms) return out;
+
+  const long long bucket_ms = out.bucket_ms;
+  const long long tier_ms = out.source_resolution_ms;
+  if (max_points > 0) out.candles.reserve(std::min<size_t>(max_points, 1 << 16));
+
+  // Fold one stored row into the current bar, opening a new bar when the row
+  // falls in a later bucket
+  long long current_bucket = -1;
+  auto feed = [&](long long t, double open, double high, double low, double close, double volume) {
+    ++out.rows_scanned;
+    const long long b = (t / bucket_ms) * bucket_ms;
+    if (b != current_bucket) {
+      Candle bar;
+      bar.symbol = symbol;
+      bar.open_time = TimePoint(std::chrono::milliseconds(b));
+      bar.open = open;
+      bar.high = high;
+      bar.low = low;
+      bar.close = close;
+      bar.volume = volume;
+      out.candles.push_back(std::move(bar));
+      current_bucket = b;
+      return;
+    }
+    Candle& bar = out.candles.back();
+    bar.high = std::max(bar.high, high);
+    bar.low = std::min(bar.low, low);
+    bar.close = close;
+    bar.volume += volume;
+  };
+
+  // Cached range: stream from memory
+  uint64_t generation = 0;
   {
     std::lock_guard<std::mutex> lock(cache_mutex_);
-    if (candles_cache_.count(key)) {
-      auto& cached = candles_cache_[key];
-      // Filter by time range
-      std::vector<Candle> result;
-      for (const auto& candle : cached) {
-        auto candle_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            candle.open_time.time_since_epoch()).count();
-        if (candle_ms >= start_ms && candle_ms <= end_ms) {
-          result.push_back(candle);
-        }
+    std::vector<Candle> cached;
+    if (candle_cache_.lookup(symbol, tier_ms, start_ms, end_ms, cached)) {
+      for (const auto& c : cached) {
+        auto t = std::chrono::duration_cast<std::chrono::milliseconds>(
+            c.open_time.time_since_epoch()).count();
+        feed(t, c.open, c.high, c.low, c.close, c.volume);
       }
-      if (!result.empty()) return result;  // Cache hit!
+      return out;
     }
+    generation = candle_cache_.generation(symbol, tier_ms);
   }
 
-  // Cache miss: query database
-  auto result = [this, &symbol, resolution_ms, start_ms, end_ms]() {
-    std::lock_guard<std::mutex> lock(db_mutex_);
-    return db_query_candles(symbol, resolution_ms, start_ms, end_ms);
-  }();
+  // Cache miss: read the stored rows (kept to cache the range) and fold them
+  std::vector<Candle> rows;
+  if (!db_query_candles(symbol, tier_ms, start_ms, end_ms, rows, cancel)) {
+    out.cancelled = true;
+  }
+  for (const auto& c : rows) {
+    auto t = std::chrono::duration_cast<std::chrono::milliseconds>(
+        c.open_time.time_since_epoch()).count();
+    feed(t, c.open, c.high, c.low, c.close, c.volume);
+  }
+  if (out.cancelled) return out;  // Partial scan: don't cache it
 
-  // Cache the full result for this resolution
   {
     std::lock_guard<std::mutex> lock(cache_mutex_);
-    candles_cache_[key] = result;
-    evict_old_candle_cache();
+    candle_cache_.insert(symbol, tier_ms, start_ms, end_ms, std::move(rows), generation);
   }
 
-  return result;
+  return out;
 }
 
-std::vector<Candle> CandleStore::db_query_candles(const std::string& symbol,
-                                                   long long resolution_ms,
-                                                   long long start_ms, long long end_ms) {
-  sqlite3_stmt* stmt = nullptr;
+bool CandleStore::db_query_candles(const std::string& symbol,
+                                   long long resolution_ms,
+                                   long long start_ms, long long end_ms,
+                                   std::vector<Candle>& out,
+                                   const std::atomic<bool>* cancel) {
+  auto is_cancelled = [cancel]() { return cancel && cancel->load(std::memory_order_relaxed); };
   const char* sql = R"SQL(
     SELECT open_time_ms, open, high, low, close, volume, trade_count
     FROM candles
@@ -356,91 +1112,100 @@ std::vector<Candle> CandleStore::db_query_candles(const std::string& symbol,
     ORDER BY open_time_ms ASC;
   )SQL";
 
-  int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-  if (rc != SQLITE_OK) {
-    throw std::runtime_error(std::string("Failed to prepare query: ") + sqlite3_errmsg(db_));
-  }
-
-  sqlite3_bind_text(stmt, 1, symbol.c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_int64(stmt, 2, resolution_ms);
-  sqlite3_bind_int64(stmt, 3, start_ms);
-  sqlite3_bind_int64(stmt, 4, end_ms);
+  // Days are disjoint and visited in order, so rows arrive sorted unless two
+  // sources share a day
+  long long last_day = LLONG_MIN;
+  bool need_sort = false;
+  size_t rows_read = 0;
+  for (const auto& partition : partitions_for(start_ms, end_ms)) {
+    if (is_cancelled()) return false;
+
+    const size_t before = out.size();
+    ReadLease lease(*partition);
+    sqlite3* db = lease.db();
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+      // A file whose schema isn't there yet has nothing to read
+      if (config_.partition_by_day) continue;
+      throw std::runtime_error(std::string("Failed to prepare query: ") + sqlite3_errmsg(db));
+    }
+    sqlite3_bind_text(stmt, 1, symbol.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 2, resolution_ms);
+    sqlite3_bind_int64(stmt, 3, start_ms);
+    sqlite3_bind_int64(stmt, 4, end_ms);
+
+    bool stopped = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      if ((++rows_read & 1023) == 0 && is_cancelled()) {
+        stopped = true;
+        break;
+      }
+      Candle candle;
+      candle.symbol = symbol;
+      candle.open_time = TimePoint(std::chrono::milliseconds(sqlite3_column_int64(stmt, 0)));
+      candle.open = sqlite3_column_double(stmt, 1);
+      candle.high = sqlite3_column_double(stmt, 2);
+      candle.low = sqlite3_column_double(stmt, 3);
+      candle.close = sqlite3_column_double(stmt, 4);
+      candle.volume = sqlite3_column_double(stmt, 5);
+      out.push_back(std::move(candle));
+    }
+    sqlite3_finalize(stmt);
+    if (stopped) return false;
 
-  std::vector<Candle> result;
-  while (sqlite3_step(stmt) == SQLITE_ROW) {
-    long long open_time_ms = sqlite3_column_int64(stmt, 0);
-    double open = sqlite3_column_double(stmt, 1);
-    double high = sqlite3_column_double(stmt, 2);
-    double low = sqlite3_column_double(stmt, 3);
-    double close = sqlite3_column_double(stmt, 4);
-    double volume = sqlite3_column_double(stmt, 5);
-    int trade_count = sqlite3_column_int(stmt, 6);
-
-    Candle candle;
-    candle.symbol = symbol;
-    candle.open_time = std::chrono::time_point<std::chrono::system_clock>(
-        std::chrono::milliseconds(open_time_ms));
-    candle.open = open;
-    candle.high = high;
-    candle.low = low;
-    candle.close = close;
-    candle.volume = volume;
-
-    result.push_back(candle);
+    if (out.size() > before) {
+      need_sort |= partition->key.day_ms == last_day;
+      last_day = partition->key.day_ms;
+    }
   }
 
-  sqlite3_finalize(stmt);
-  return result;
+  if (need_sort) {
+    std::stable_sort(out.begin(), out.end(),
+                     [](const Candle& a, const Candle& b) { return a.open_time < b.open_time; });
+  }
+  return true;
 }
 
 std::vector<StoredEvent> CandleStore::query_events(const std::string& symbol,
                                                     long long start_ms, long long end_ms,
                                                     const std::vector<std::string>& event_types) {
-  EventCacheKey key{symbol, start_ms, end_ms};
-
-  // Check cache first
+  // Check cache first; on a miss, only the part it doesn't cover is read
+  std::vector<std::pair<long long, long long>> missing;
+  uint64_t generation = 0;
   {
     std::lock_guard<std::mutex> lock(cache_mutex_);
-    if (events_cache_.count(key)) {
-      auto& cached = events_cache_[key];
-      if (event_types.empty()) {
-        return cached;  // Cache hit!
-      }
-      // Filter by event types
-      std::vector<StoredEvent> result;
-      for (const auto& event : cached) {
-        for (const auto& type : event_types) {
-          if (event.event_type == type) {
-            result.push_back(event);
-            break;
-          }
-        }
-      }
-      if (!result.empty()) return result;  // Cache hit!
+    std::vector<StoredEvent> cached;
+    if (event_cache_.lookup(symbol, start_ms, end_ms, event_types, cached)) {
+      return cached;  // Cache hit!
     }
+    missing = event_cache_.missing(symbol, start_ms, end_ms);
+    generation = event_cache_.generation(symbol);
   }
 
-  // Cache miss: query database
-  auto result = [this, &symbol, start_ms, end_ms, &event_types]() {
-    std::lock_guard<std::mutex> lock(db_mutex_);
-    return db_query_events(symbol, start_ms, end_ms, event_types);
-  }();
+  // The cache holds every type, so fetch them all and filter on the way out
+  std::vector<std::pair<std::pair<long long, long long>, std::vector<StoredEvent>>> fetched;
+  for (const auto& [a, b] : missing) {
+    fetched.push_back({{a, b}, db_query_events(symbol, a, b, {})});
+  }
 
-  // Cache the result
   {
     std::lock_guard<std::mutex> lock(cache_mutex_);
-    events_cache_[key] = result;
-    evict_old_event_cache();
+    event_cache_.insert(symbol, std::move(fetched), generation);
+    std::vector<StoredEvent> result;
+    if (event_cache_.lookup(symbol, start_ms, end_ms, event_types, result)) {
+      return result;
+    }
   }
 
-  return result;
+  // Not cached (a write raced the fetch, or the range is over budget)
+  return db_query_events(symbol, start_ms, end_ms, event_types);
 }
 
 std::vector<StoredEvent> CandleStore::db_query_events(const std::string& symbol,
                                                      long long start_ms, long long end_ms,
                                                      const std::vector<std::string>& event_types) {
   std::string sql = R"SQL(
-    SELECT event_type, timestamp_ms, symbol, source, data
+    SELECT event_type, timestamp_ms, symbol, source, order_id, side, qty, price, status, extra
     FROM events
     WHERE symbol = ? AND timestamp_ms BETWEEN ? AND ?
   )SQL";
@@ -457,76 +1222,116 @@ std::vector<StoredEvent> CandleStore::db_query_events(const std::string& symbol,
 
   sql += " ORDER BY timestamp_ms ASC;";
 
-  sqlite3_stmt* stmt = nullptr;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
-  if (rc != SQLITE_OK) {
-    throw std::runtime_error(std::string("Failed to prepare query: ") + sqlite3_errmsg(db_));
-  }
-
-  int bind_idx = 1;
-  sqlite3_bind_text(stmt, bind_idx++, symbol.c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_int64(stmt, bind_idx++, start_ms);
-  sqlite3_bind_int64(stmt, bind_idx++, end_ms);
-
-  for (const auto& type : event_types) {
-    sqlite3_bind_text(stmt, bind_idx++, type.c_str(), -1, SQLITE_STATIC);
-  }
-
+  // Same ordering rule as db_query_candles
   std::vector<StoredEvent> result;
-  while (sqlite3_step(stmt) == SQLITE_ROW) {
-    const char* event_type_str = (const char*)sqlite3_column_text(stmt, 0);
-    long long timestamp_ms = sqlite3_column_int64(stmt, 1);
-    const char* symbol_str = (const char*)sqlite3_column_text(stmt, 2);
-    const char* source_str = (const char*)sqlite3_column_text(stmt, 3);
-    const char* data_str = (const char*)sqlite3_column_text(stmt, 4);
+  long long last_day = LLONG_MIN;
+  bool need_sort = false;
+  for (const auto& partition : partitions_for(start_ms, end_ms)) {
+    const size_t before = result.size();
+    ReadLease lease(*partition);
+    sqlite3* db = lease.db();
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+      if (config_.partition_by_day) continue;
+      throw std::runtime_error(std::string("Failed to prepare query: ") + sqlite3_errmsg(db));
+    }
 
-    StoredEvent event;
-    event.event_type = event_type_str ? event_type_str : "";
-    event.timestamp_ms = timestamp_ms;
-    event.symbol = symbol_str ? symbol_str : "";
-    event.source = source_str ? source_str : "";
-    event.data = json::parse(data_str ? data_str : "{}");
+    int bind_idx = 1;
+    sqlite3_bind_text(stmt, bind_idx++, symbol.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, bind_idx++, start_ms);
+    sqlite3_bind_int64(stmt, bind_idx++, end_ms);
 
-    result.push_back(event);
-  }
+    for (const auto& type : event_types) {
+      sqlite3_bind_text(stmt, bind_idx++, type.c_str(), -1, SQLITE_STATIC);
+    }
 
-  sqlite3_finalize(stmt);
-  return result;
-}
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      const char* event_type_str = (const char*)sqlite3_column_text(stmt, 0);
+      long long timestamp_ms = sqlite3_column_int64(stmt, 1);
+      const char* symbol_str = (const char*)sqlite3_column_text(stmt, 2);
+      const char* source_str = (const char*)sqlite3_column_text(stmt, 3);
+      const char* side_str = (const char*)sqlite3_column_text(stmt, 5);
+      const char* status_str = (const char*)sqlite3_column_text(stmt, 8);
+
+      StoredEvent event;
+      event.event_type = event_type_str ? event_type_str : "";
+      event.timestamp_ms = timestamp_ms;
+      event.symbol = symbol_str ? symbol_str : "";
+      event.source = source_str ? source_str : "";
+      event.order_id = sqlite3_column_int64(stmt, 4);
+      event.side = side_str ? side_str : "";
+      event.qty = sqlite3_column_double(stmt, 6);
+      event.price = sqlite3_column_double(stmt, 7);
+      event.status = status_str ? status_str : "";
+      if (sqlite3_column_type(stmt, 9) != SQLITE_NULL) {
+        // Only events with fields beyond the typed ones pay for a parse
+        event.extra = json::parse((const char*)sqlite3_column_text(stmt, 9), nullptr, false);
+        if (event.extra.is_discarded()) event.extra = nullptr;
+      }
 
-void CandleStore::evict_old_candle_cache() {
-  if (candles_cache_.size() > config_.max_candle_cache_entries) {
-    candles_cache_.erase(candles_cache_.begin());
+      result.push_back(std::move(event));
+    }
+    sqlite3_finalize(stmt);
+
+    if (result.size() > before) {
+      need_sort |= partition->key.day_ms == last_day;
+      last_day = partition->key.day_ms;
+    }
   }
-}
 
-void CandleStore::evict_old_event_cache() {
-  if (events_cache_.size() > config_.max_event_cache_entries) {
-    events_cache_.erase(events_cache_.begin());
+  if (need_sort) {
+    std::stable_sort(result.begin(), result.end(), [](const StoredEvent& a, const StoredEvent& b) {
+      return a.timestamp_ms < b.timestamp_ms;
+    });
   }
+  return result;
 }
 
 void CandleStore::clear_all() {
   {
     std::lock_guard<std::mutex> lock(cache_mutex_);
-    candles_cache_.clear();
-    events_cache_.clear();
+    candle_cache_.clear();
+    event_cache_.clear();
   }
 
   {
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    // Drop anything not yet taken by the writer, and let an in-flight batch
+    // finish so it can't land after the DELETE
+    std::unique_lock<std::mutex> lock(buffer_mutex_);
     candles_write_buffer_.clear();
     events_write_buffer_.clear();
-    candles_resolution_buffer_.clear();
-  }
+    rollups_.clear();
+    committed_cv_.wait(lock, [this]() { return !writer_busy_; });
+    committed_seq_ = enqueued_seq_;
+
+    // The writer can't start another batch while we hold buffer_mutex_, so
+    // its connections are ours until we return
+    if (config_.partition_by_day) {
+      // Drop every partition; a query still running keeps its files open
+      // (unlinked) until it finishes
+      std::map<PartitionKey, std::shared_ptr<Partition>> dropped;
+      {
+        std::lock_guard<std::mutex> plock(partitions_mutex_);
+        dropped.swap(partitions_);
+      }
+      for (auto& [key, partition] : dropped) partition->close_writer();
+      std::error_code ec;
+      const auto removed = fs::remove_all(partition_root(), ec);
+      if (ec) {
+        ENG_LOG_ERROR("[CandleStore] Failed to remove " << partition_root() << ": " << ec.message());
+      }
+      ENG_LOG_INFO("[CandleStore] Cleared all data (" << dropped.size() << " partitions, "
+                   << (ec ? 0 : removed) << " files removed)");
+      return;
+    }
 
-  {
-    std::lock_guard<std::mutex> lock(db_mutex_);
-    exec_sql("DELETE FROM candles;");
-    exec_sql("DELETE FROM events;");
+    auto partition = partitions_for(0, INT64_MAX).front();
+    exec_sql(partition->writer_db, "DELETE FROM candles;");
+    exec_sql(partition->writer_db, "DELETE FROM events;");
   }
 
-  std::cout << "[CandleStore] Cleared all data\n";
+  ENG_LOG_INFO("[CandleStore] Cleared all data");
 }
 
 json CandleStore::get_run_meta(const std::string& symbol) const {
@@ -537,13 +1342,23 @@ json CandleStore::get_run_meta(const std::string& symbol) const {
 }
 
 std::vector<json> CandleStore::list_runs(int limit) const {
-  // Not yet implemented; would return list of recent runs
-  return std::vector<json>();
+  std::vector<json> runs;
+  std::lock_guard<std::mutex> lock(partitions_mutex_);
+  for (auto it = partitions_.rbegin(); it != partitions_.rend() && static_cast<int>(runs.size()) < limit; ++it) {
+    json run;
+    if (it->first.day_ms >= 0) {
+      run["source"] = it->first.source;
+      run["day"] = day_name(it->first.day_ms);
+    }
+    run["path"] = it->second->path;
+    runs.push_back(std::move(run));
+  }
+  return runs;
 }
 
-void CandleStore::exec_sql(const std::string& sql) {
+void CandleStore::exec_sql(sqlite3* db, const std::string& sql) {
   char* err_msg = nullptr;
-  int rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &err_msg);
+  int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &err_msg);
   if (rc != SQLITE_OK) {
     std::string error = err_msg ? err_msg : "Unknown error";
     if (err_msg) sqlite3_free(err_msg);
@@ -551,9 +1366,9 @@ void CandleStore::exec_sql(const std::string& sql) {
   }
 }
 
-int CandleStore::query_int(const std::string& sql, int default_value) {
+int CandleStore::query_int(sqlite3* db, const std::string& sql, int default_value) {
   sqlite3_stmt* stmt = nullptr;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
   if (rc != SQLITE_OK) {
     return default_value;
   }
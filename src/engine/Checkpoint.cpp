@@ -0,0 +1,104 @@
+// Checkpoint.cpp
+
+#include "engine/Checkpoint.hpp"
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace eng {
+
+namespace {
+
+std::uint64_t fnv1a(const std::string& data) {
+    std::uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+template <typename T>
+void append(std::string& out, const T& v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+}  // namespace
+
+size_t Checkpoint::size() const {
+    size_t n = 0;
+    for (const auto& [name, w] : sections_) n += w.bytes().size();
+    return n;
+}
+
+void Checkpoint::save(const std::string& path) const {
+    std::string out;
+    out.reserve(size() + 64);
+    out.append(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    append(out, CHECKPOINT_VERSION);
+    append(out, CHECKPOINT_FLAGS);
+    append(out, static_cast<std::uint32_t>(sections_.size()));
+    for (const auto& [name, w] : sections_) {
+        append(out, static_cast<std::uint16_t>(name.size()));
+        out += name;
+        append(out, static_cast<std::uint64_t>(w.bytes().size()));
+        out += w.bytes();
+    }
+    append(out, fnv1a(out));
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f) throw std::runtime_error("Checkpoint: cannot write " + tmp);
+        f.write(out.data(), static_cast<std::streamsize>(out.size()));
+        f.flush();
+        if (!f) throw std::runtime_error("Checkpoint: write failed for " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Checkpoint: cannot rename " + tmp + " to " + path + ": " + std::strerror(errno));
+    }
+}
+
+Checkpoint Checkpoint::load(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) throw std::runtime_error("Checkpoint: cannot open " + path);
+    const std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    constexpr size_t header = sizeof(CHECKPOINT_MAGIC) + 3 * sizeof(std::uint32_t);
+    if (data.size() < header + sizeof(std::uint64_t) ||
+        std::memcmp(data.data(), CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0) {
+        throw std::runtime_error("Checkpoint: " + path + " is not a checkpoint");
+    }
+    const std::string body = data.substr(0, data.size() - sizeof(std::uint64_t));
+    std::uint64_t checksum;
+    std::memcpy(&checksum, data.data() + body.size(), sizeof(checksum));
+    if (checksum != fnv1a(body)) throw std::runtime_error("Checkpoint: " + path + " is corrupt (checksum)");
+
+    CheckpointReader in("header", std::string_view(body).substr(sizeof(CHECKPOINT_MAGIC)));
+    const auto version = in.get<std::uint32_t>();
+    if (version != CHECKPOINT_VERSION) {
+        throw std::runtime_error("Checkpoint: " + path + " has version " + std::to_string(version) +
+                                 ", expected " + std::to_string(CHECKPOINT_VERSION));
+    }
+    const auto flags = in.get<std::uint32_t>();
+    if ((flags & CHECKPOINT_FIXED_POINT) != (CHECKPOINT_FLAGS & CHECKPOINT_FIXED_POINT)) {
+        throw std::runtime_error("Checkpoint: " + path + " was written by a " +
+                                 ((flags & CHECKPOINT_FIXED_POINT) ? "fixed-point" : "floating-point") +
+                                 " build (ENG_FIXED_POINT); this one is " +
+                                 (ENG_FIXED_POINT ? "fixed-point" : "floating-point"));
+    }
+    Checkpoint cp;
+    const auto count = in.get<std::uint32_t>();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const auto name_len = in.get<std::uint16_t>();
+        const std::string name(in.get_bytes(name_len));
+        const auto len = in.get<std::uint64_t>();
+        cp.sections_[name].bytes_ = std::string(in.get_bytes(len));
+    }
+    if (!in.done()) throw std::runtime_error("Checkpoint: " + path + " has trailing data");
+    return cp;
+}
+
+}  // namespace eng
@@ -3,11 +3,15 @@
  */
 
 #include "engine/Engine.hpp"
+#include "engine/FixedPoint.hpp"
 #include "engine/Types.hpp"
 #include "engine/MarketDataTypes.hpp"
 #include "engine/ProviderMarketData.hpp"
-#include <iostream>
+#include "engine/Logger.hpp"
+#include "engine/Metrics.hpp"
 #include <memory>
+#include <stdexcept>
+#include <string>
 
 using namespace eng;
 
@@ -21,83 +25,195 @@ void Engine::set_broker(std::unique_ptr<IBroker> brkr) {
     broker_ = std::move(brkr);
 }
 
+std::size_t Engine::add_strategy_worker(int cpu) {
+    if (!fan_out_) fan_out_ = std::make_unique<StrategyFanOut>();
+    return fan_out_->add_worker(cpu);
+}
+
+std::size_t Engine::add_strategy(std::unique_ptr<IStrategy> strat, std::size_t worker) {
+    if (!fan_out_) fan_out_ = std::make_unique<StrategyFanOut>();
+    return fan_out_->add_strategy(std::move(strat), worker);
+}
+
+void Engine::set_broker_cpu(int cpu) {
+    if (!fan_out_) fan_out_ = std::make_unique<StrategyFanOut>();
+    fan_out_->set_router_cpu(cpu);
+}
+
+std::size_t Engine::strategy_count() const {
+    if (fan_out_ && fan_out_->strategy_count() > 0) return fan_out_->strategy_count();
+    return strategy_ ? 1 : 0;
+}
+
+IStrategy& Engine::strategy_at(std::size_t i) const {
+    if (fan_out_ && fan_out_->strategy_count() > 0) return fan_out_->strategy(i);
+    return *strategy_;
+}
+
+bool Engine::save_state(Checkpoint& cp) const {
+    if (!broker_ || !broker_->save_state(cp.section("broker"))) return false;
+    for (std::size_t i = 0; i < strategy_count(); ++i) {
+        if (!strategy_at(i).save_state(cp.section("strategy." + std::to_string(i)))) return false;
+    }
+    return true;
+}
+
+void Engine::load_state(const Checkpoint& cp) {
+    if (started_) throw std::runtime_error("Engine: load_state() after start()");
+    if (broker_) {
+        auto in = cp.reader("broker");
+        broker_->load_state(in);
+    }
+    const std::size_t n = strategy_count();
+    if (cp.has("strategy." + std::to_string(n))) {
+        throw std::runtime_error("Engine: checkpoint has more than " + std::to_string(n) + " strategies");
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        auto in = cp.reader("strategy." + std::to_string(i));
+        strategy_at(i).load_state(in);
+    }
+}
+
 void Engine::set_market_data(std::unique_ptr<ProviderMarketData> md) {
     market_data_ = std::move(md);
 
     // Tell provider what symbols to listen for, and wire its callback to publish on the bus
     market_data_->subscribe_ticks({ "BTCUSD" }, [this](const Tick& t){
-        Event ev{ "ProviderTick", t };
-        bus_.publish(ev);
+        bus_.publish(t);
     });
 
 }
 
-void Engine::run() {
+bool Engine::start() {
+    if (started_) return true;
 
-    if (!strategy_ || !broker_ || !market_data_) {
-        std::cerr << "[Engine] Missing strategy, broker, or market data stream.\n";
-        return;
+    const bool fan_out = fan_out_ && fan_out_->strategy_count() > 0;
+    if ((!strategy_ && !fan_out) || !broker_ || !market_data_) {
+        ENG_LOG_ERROR("[Engine] Missing strategy, broker, or market data stream.");
+        return false;
+    }
+    if (strategy_ && fan_out) {
+        ENG_LOG_ERROR("[Engine] set_strategy() and add_strategy() can't be combined.");
+        return false;
     }
 
-    // Demo: subscribe to a single tick and let the strategy react
-    const std::string symbol = "BTCUSD";
-
-    // Subscribe to ProviderTick events on the bus and forward to the strategy.
-    bus_.subscribe("ProviderTick", [this](const Event& ev){
-        try {
-            auto t = std::any_cast<Tick>(ev.data);
-            if (strategy_) {
-                strategy_->on_price_tick({t.symbol, t.last});
-                auto act = strategy_->get_trade_action();
-                if (act == TradeAction::Buy) {
+    if (fan_out) {
+        // The broker is driven from the fan-out's broker thread only
+        broker_->set_fill_handler([this](const Order& fill) {
+            if (verbose_) {
+                ENG_LOG_DEBUG("[Engine] Fill " << (fill.side == Order::Side::Buy ? "BUY " : "SELL ")
+                              << fill.qty << " " << fill.symbol << " @ " << fill.fill_price);
+            }
+            fan_out_->on_fill(fill);
+        });
+        fan_out_->start(*broker_, verbose_);
+
+        bus_.subscribe<Tick>([this](const Tick& t){
+            if (t.ingress_ns != 0) ENG_METRICS_RECORD(Dispatch, ENG_METRICS_NOW() - t.ingress_ns);
+            fan_out_->publish(t);
+        }, async_dispatch_);
+
+        started_ = true;
+        return true;
+    }
+
+    // Fills that land after place_*_order returned (resting orders)
+    broker_->set_fill_handler([this](const Order& fill) {
+        if (verbose_) {
+            ENG_LOG_DEBUG("[Engine] Fill " << (fill.side == Order::Side::Buy ? "BUY " : "SELL ")
+                          << fill.qty << " " << fill.symbol << " @ " << fill.fill_price);
+        }
+        if (strategy_) strategy_->on_order_fill(fill);
+    });
+
+    // Subscribe to provider ticks on the bus and forward to the strategy.
+    bus_.subscribe<Tick>([this](const Tick& t){
+        if (t.ingress_ns != 0) ENG_METRICS_RECORD(Dispatch, ENG_METRICS_NOW() - t.ingress_ns);
+
+        // Let a simulating broker match resting orders on this trade first,
+        // on this thread, so fills and ticks reach the strategy in order
+        if (broker_) broker_->on_market_tick(t);
+        if (strategy_) {
+            const int64_t decide_start = ENG_METRICS_NOW();
+            const PriceData pd{t.symbol, t.last, t.instrument_id};
+            TradeAction act = TradeAction::None;
+            strategy_->on_price_ticks(&pd, 1, act);
+            ENG_METRICS_RECORD(Strategy, ENG_METRICS_NOW() - decide_start);
+
+            // Time one order through the broker, and the whole tick -> order path
+            auto place = [&t](IBroker& broker, const Order& o) {
+                const int64_t submit = ENG_METRICS_NOW();
+                double filled = broker.place_limit_order(o, t.last, t.ts);
+                const int64_t acked = ENG_METRICS_NOW();
+                ENG_METRICS_RECORD(BrokerAck, acked - submit);
+                if (t.ingress_ns != 0) ENG_METRICS_RECORD(TickToOrder, acked - t.ingress_ns);
+                return filled;
+            };
+            if (act == TradeAction::Buy) {
+                Order o;
+                o.symbol = t.symbol;
+                o.instrument_id = t.instrument_id;
+                o.qty = 0.01;
+                o.side = Order::Side::Buy;
+                if (broker_) {
+                    // place a limit buy at the most recent price and obtain filled qty
+                    double filled = place(*broker_, o);
+                    if (verbose_) {
+                        ENG_LOG_DEBUG("[Engine] Placed LIMIT BUY " << o.qty << " " << o.symbol
+                                      << " @ " << t.last << " (filled=" << filled << ")");
+                    }
+                    if (filled > 0.0 && strategy_) {
+                        Order filled_o = o;
+                        filled_o.qty = filled;
+                        strategy_->on_order_fill(filled_o);
+                    }
+                }
+            } else if (act == TradeAction::Sell) {
+                // Check if we have a position to sell before attempting
+                // This prevents rejected orders and works with long/short/futures/options
+                double netPos = strategy_->get_net_position();
+                if (netPos > kFlatPosition) {  // Tolerance only needed for double positions
                     Order o;
                     o.symbol = t.symbol;
+                    o.instrument_id = t.instrument_id;
                     o.qty = 0.01;
-                    o.side = Order::Side::Buy;
+                    o.side = Order::Side::Sell;
                     if (broker_) {
-                        // place a limit buy at the most recent price and obtain filled qty
-                        double filled = broker_->place_limit_order(o, t.last, t.ts);
-                        std::cout << "[Engine] Placed LIMIT BUY " << o.qty << " " << o.symbol
-                                  << " @ " << t.last << " (filled=" << filled << ")\n";
+                        // place a limit sell at the most recent price and obtain filled qty
+                        double filled = place(*broker_, o);
+                        if (verbose_) {
+                            ENG_LOG_DEBUG("[Engine] Placed LIMIT SELL " << o.qty << " " << o.symbol
+                                          << " @ " << t.last << " (filled=" << filled << ")");
+                        }
                         if (filled > 0.0 && strategy_) {
                             Order filled_o = o;
                             filled_o.qty = filled;
                             strategy_->on_order_fill(filled_o);
                         }
                     }
-                } else if (act == TradeAction::Sell) {
-                    // Check if we have a position to sell before attempting
-                    // This prevents rejected orders and works with long/short/futures/options
-                    double netPos = strategy_->get_net_position();
-                    if (netPos > 0.001) {  // Small tolerance for floating point errors
-                        Order o;
-                        o.symbol = t.symbol;
-                        o.qty = 0.01;
-                        o.side = Order::Side::Sell;
-                        if (broker_) {
-                            // place a limit sell at the most recent price and obtain filled qty
-                            double filled = broker_->place_limit_order(o, t.last, t.ts);
-                            std::cout << "[Engine] Placed LIMIT SELL " << o.qty << " " << o.symbol
-                                      << " @ " << t.last << " (filled=" << filled << ")\n";
-                            if (filled > 0.0 && strategy_) {
-                                Order filled_o = o;
-                                filled_o.qty = filled;
-                                strategy_->on_order_fill(filled_o);
-                            }
-                        }
-                    } else {
-                        std::cout << "[Engine] Skipping SELL: no position to sell (net pos=" << netPos << ")\n";
-                    }
-                } else {
-                    std::cout << "[Engine] Strategy: No action." << std::endl;
+                } else if (verbose_) {
+                    ENG_LOG_DEBUG("[Engine] Skipping SELL: no position to sell (net pos=" << netPos << ")");
                 }
+            } else if (verbose_) {
+                ENG_LOG_TRACE("[Engine] Strategy: No action.");
             }
-        } catch (const std::bad_any_cast& e) {
-            std::cerr << "[Engine] bad_any_cast when handling ProviderTick\n";
         }
-    });
+    }, async_dispatch_);
+
+    started_ = true;
+    return true;
+}
 
-    std::cout << "[Engine] Backtest/demo running. Press Ctrl+C to exit.\n";
+void Engine::wait_idle() {
+    bus_.wait_idle();
+    if (fan_out_) fan_out_->wait_idle();
+}
+
+void Engine::run() {
+
+    if (!start()) return;
+
+    ENG_LOG_INFO("[Engine] Backtest/demo running. Press Ctrl+C to exit.");
     
     // Wait for shutdown signal
     while (!shutdown_requested_) {
@@ -105,9 +221,6 @@ void Engine::run() {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     
-    std::cout << "[Engine] Shutdown requested - stopping run.\n";
-    std::cout << "[Engine] Run complete.\n";
+    ENG_LOG_INFO("[Engine] Shutdown requested - stopping run.");
+    ENG_LOG_INFO("[Engine] Run complete.");
 }
-
-
-
@@ -1,40 +1,89 @@
 // EventBus.cpp
 
 #include "engine/EventBus.hpp"
-//#ifdef ENG_DEBUG
-    #include <iostream>
-//#endif
+#include "engine/Logger.hpp"
 
 namespace eng {
 
 EventBus::HandlerId EventBus::subscribe(const std::string& topic, Handler handler) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     const HandlerId id = next_id_++;
-    handlers_[topic].emplace_back(id, std::move(handler));
+    auto& slot = handlers_[topic];
+    auto list = slot ? std::make_shared<HandlerList>(*slot) : std::make_shared<HandlerList>();
+    list->emplace_back(id, std::move(handler));
+    slot = std::move(list);
     return id;
 }
 
 
 bool EventBus::unsubscribe(const std::string& topic, HandlerId id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     auto it = handlers_.find(topic);
-    if (it == handlers_.end()) return false;
-    auto& vec = it->second;
-    for (auto vit = vec.begin(); vit != vec.end(); ++vit) {
-        if (vit->first == id) { vec.erase(vit); return true; }
+    if (it == handlers_.end() || !it->second) return false;
+    auto list = std::make_shared<HandlerList>(*it->second);
+    for (auto vit = list->begin(); vit != list->end(); ++vit) {
+        if (vit->first == id) {
+            list->erase(vit);
+            it->second = std::move(list);
+            return true;
+        }
     }
     return false;
 }
 
 void EventBus::publish(const Event& ev) const {
+    ENG_LOG_TRACE("[debug] [bus publish] " << ev.type);
 
-    #ifdef ENG_DEBUG
-        std::cout << "[debug] [bus publish] " << ev.type << " " << "\n";
-    #endif
-
-    auto it = handlers_.find(ev.type);
-    if (it == handlers_.end()) return;
-    for (auto& pair : it->second) {
+    std::shared_ptr<const HandlerList> snapshot;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = handlers_.find(ev.type);
+        if (it == handlers_.end()) return;
+        snapshot = it->second;
+    }
+    for (auto& pair : *snapshot) {
         pair.second(ev); // invoke handler
     }
 }
 
-}
\ No newline at end of file
+bool EventBus::has_subscribers(const std::string& topic) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = handlers_.find(topic);
+    return it != handlers_.end() && it->second && !it->second->empty();
+}
+
+void EventBus::wait_idle() const {
+    std::vector<AsyncWorkerBase*> workers;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (auto& w : workers_) workers.push_back(w.get());
+    }
+    for (auto* w : workers) {
+        while (!w->idle()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+void EventBus::stop_async() {
+    std::vector<AsyncWorkerBase*> workers;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (auto& w : workers_) workers.push_back(w.get());
+    }
+    // Workers stay allocated (stopped) until the bus is destroyed, since the
+    // channel handlers that feed them still point at them.
+    for (auto* w : workers) {
+        w->stop();
+    }
+}
+
+std::vector<EventBus::QueueStats> EventBus::queue_stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<QueueStats> out;
+    out.reserve(workers_.size());
+    for (auto& w : workers_) out.push_back(w->stats());
+    return out;
+}
+
+}
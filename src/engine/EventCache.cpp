@@ -0,0 +1,159 @@
+#include "engine/EventCache.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace eng {
+
+namespace {
+
+bool matches(const StoredEvent& event, const std::vector<std::string>& event_types) {
+  if (event_types.empty()) return true;
+  return std::find(event_types.begin(), event_types.end(), event.event_type) != event_types.end();
+}
+
+// Overlapping or directly adjacent, so the union is one contiguous range
+bool touches(long long start_ms, long long end_ms, long long other_start, long long other_end) {
+  return start_ms <= other_end + 1 && end_ms + 1 >= other_start;
+}
+
+}  // namespace
+
+bool EventCache::lookup(const std::string& symbol, long long start_ms, long long end_ms,
+                        const std::vector<std::string>& event_types, std::vector<StoredEvent>& out) {
+  auto it = series_.find(symbol);
+  if (it == series_.end() || !it->second.cached) return false;
+  Series& s = it->second;
+  const Range& r = s.range;
+  if (start_ms < r.start_ms || end_ms > r.end_ms) return false;
+
+  auto first = std::lower_bound(r.events.begin(), r.events.end(), start_ms,
+      [](const StoredEvent& e, long long ms) { return e.timestamp_ms < ms; });
+  for (auto e = first; e != r.events.end() && e->timestamp_ms <= end_ms; ++e) {
+    if (matches(*e, event_types)) out.push_back(*e);
+  }
+  touch(s, symbol);
+  stats_.hits++;
+  return true;
+}
+
+std::vector<std::pair<long long, long long>> EventCache::missing(const std::string& symbol,
+                                                                 long long start_ms, long long end_ms) {
+  auto it = series_.find(symbol);
+  if (it == series_.end() || !it->second.cached ||
+      !touches(start_ms, end_ms, it->second.range.start_ms, it->second.range.end_ms)) {
+    stats_.misses++;
+    return {{start_ms, end_ms}};
+  }
+
+  const Range& r = it->second.range;
+  std::vector<std::pair<long long, long long>> out;
+  if (start_ms < r.start_ms) out.emplace_back(start_ms, r.start_ms - 1);
+  if (end_ms > r.end_ms) out.emplace_back(r.end_ms + 1, end_ms);
+  stats_.partial_hits++;
+  return out;
+}
+
+uint64_t EventCache::generation(const std::string& symbol) {
+  return series_[symbol].generation;
+}
+
+void EventCache::insert(const std::string& symbol,
+                        std::vector<std::pair<std::pair<long long, long long>, std::vector<StoredEvent>>> fetched,
+                        uint64_t generation) {
+  Series& s = series_[symbol];
+  // Rows committed meanwhile may or may not be in it
+  if (s.generation != generation || s.committing > 0) return;
+
+  for (auto& [range, events] : fetched) {
+    const auto [start_ms, end_ms] = range;
+    Range& r = s.range;
+    if (!s.cached || !touches(start_ms, end_ms, r.start_ms, r.end_ms)) {
+      // Nothing to extend: this range replaces the cached one
+      drop(s);
+      r.start_ms = start_ms;
+      r.end_ms = end_ms;
+      r.events = std::move(events);
+      lru_.push_front(symbol);
+      r.lru = lru_.begin();
+      s.cached = true;
+      stats_.events += r.events.size();
+      continue;
+    }
+
+    // Keep only what falls outside the cached range; it is all before or
+    // after it, so the result stays sorted
+    std::vector<StoredEvent> merged;
+    merged.reserve(r.events.size() + events.size());
+    auto before_end = std::lower_bound(events.begin(), events.end(), r.start_ms,
+        [](const StoredEvent& e, long long ms) { return e.timestamp_ms < ms; });
+    auto after_begin = std::upper_bound(events.begin(), events.end(), r.end_ms,
+        [](long long ms, const StoredEvent& e) { return ms < e.timestamp_ms; });
+    merged.insert(merged.end(), std::make_move_iterator(events.begin()), std::make_move_iterator(before_end));
+    merged.insert(merged.end(), std::make_move_iterator(r.events.begin()), std::make_move_iterator(r.events.end()));
+    merged.insert(merged.end(), std::make_move_iterator(after_begin), std::make_move_iterator(events.end()));
+
+    stats_.events += merged.size() - r.events.size();
+    r.events = std::move(merged);
+    r.start_ms = std::min(r.start_ms, start_ms);
+    r.end_ms = std::max(r.end_ms, end_ms);
+    touch(s, symbol);
+  }
+  evict();
+}
+
+void EventCache::begin_commit(const std::vector<StoredEvent>& events) {
+  for (const auto& event : events) {
+    Series& s = series_[event.symbol];
+    s.generation++;
+    s.committing++;
+  }
+}
+
+void EventCache::end_commit(const std::vector<StoredEvent>& events, bool committed) {
+  for (const auto& event : events) {
+    Series& s = series_[event.symbol];
+    s.generation++;
+    s.committing--;
+    if (!committed) {
+      drop(s);
+      continue;
+    }
+    Range& r = s.range;
+    if (!s.cached || event.timestamp_ms < r.start_ms || event.timestamp_ms > r.end_ms) continue;
+    auto pos = std::upper_bound(r.events.begin(), r.events.end(), event.timestamp_ms,
+        [](long long ms, const StoredEvent& e) { return ms < e.timestamp_ms; });
+    r.events.insert(pos, event);
+    stats_.events++;
+  }
+  evict();
+}
+
+void EventCache::clear() {
+  for (auto& [symbol, s] : series_) {
+    drop(s);
+    s.generation++;   // Fetches started before the clear must not land
+  }
+}
+
+void EventCache::touch(Series& s, const std::string& symbol) {
+  lru_.erase(s.range.lru);
+  lru_.push_front(symbol);
+  s.range.lru = lru_.begin();
+}
+
+void EventCache::drop(Series& s) {
+  if (!s.cached) return;
+  stats_.events -= s.range.events.size();
+  lru_.erase(s.range.lru);
+  s.range = Range{};
+  s.cached = false;
+}
+
+void EventCache::evict() {
+  while (stats_.events > max_events_ && !lru_.empty()) {
+    drop(series_[lru_.back()]);
+    stats_.evictions++;
+  }
+}
+
+}  // namespace eng
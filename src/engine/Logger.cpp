@@ -0,0 +1,141 @@
+#include "engine/Logger.hpp"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace eng {
+
+LogLevel parse_log_level(const std::string& name) {
+    if (name == "trace") return LogLevel::Trace;
+    if (name == "debug") return LogLevel::Debug;
+    if (name == "info") return LogLevel::Info;
+    if (name == "warn") return LogLevel::Warn;
+    if (name == "error") return LogLevel::Error;
+    if (name == "off") return LogLevel::Off;
+    throw std::invalid_argument("unknown log level: " + name);
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() {
+    thread_ = std::thread([this] { run(); });
+}
+
+Logger::~Logger() {
+    running_.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+    if (thread_.joinable()) thread_.join();
+}
+
+void Logger::write(const LogRecord& record) {
+    if (!queue_.try_push(record)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    enqueued_.fetch_add(1, std::memory_order_release);
+
+    if (sleeping_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+}
+
+void Logger::flush() {
+    const uint64_t target = enqueued_.load(std::memory_order_acquire);
+    while (written_.load(std::memory_order_acquire) < target) {
+        std::this_thread::yield();
+    }
+    std::cout.flush();
+}
+
+Logger::Stats Logger::stats() const {
+    Stats s;
+    s.written = written_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void Logger::run() {
+    LogRecord record;
+    uint64_t reported_drops = 0;
+    int idle_spins = 0;
+
+    auto emit = [this](const LogRecord& r) {
+        std::ostream& out = (r.level >= LogLevel::Warn) ? std::cerr : std::cout;
+        out.write(r.text.data(), static_cast<std::streamsize>(r.text.size()));
+        out.put('\n');
+        written_.fetch_add(1, std::memory_order_release);
+    };
+
+    while (true) {
+        if (queue_.try_pop(record)) {
+            emit(record);
+            idle_spins = 0;
+            continue;
+        }
+
+        // Caught up: push the batch to the terminal and report any drops
+        std::cout.flush();
+        uint64_t drops = dropped_.load(std::memory_order_relaxed);
+        if (drops != reported_drops) {
+            std::cerr << "[Logger] dropped " << (drops - reported_drops) << " lines (ring full)\n";
+            reported_drops = drops;
+        }
+
+        if (!running_.load(std::memory_order_acquire)) break;
+        if (++idle_spins < SPIN_BEFORE_SLEEP) {
+            std::this_thread::yield();
+            continue;
+        }
+        // Park until a producer wakes us; the timeout covers a wakeup
+        // racing with sleeping_ being set.
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        sleeping_.store(true, std::memory_order_release);
+        if (queue_.size_approx() == 0 && running_.load(std::memory_order_acquire)) {
+            wake_cv_.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        sleeping_.store(false, std::memory_order_release);
+        idle_spins = 0;
+    }
+
+    // Drain whatever was queued before shutdown
+    while (queue_.try_pop(record)) emit(record);
+    std::cout.flush();
+}
+
+// ---- LogLine ----
+
+LogLine::LogLine(LogLevel level)
+    : buffer_(thread_buffer()), stream_(&buffer_) {
+    buffer_.record.level = level;
+    buffer_.record.text.clear();
+}
+
+LogLine::~LogLine() {
+    Logger::instance().write(buffer_.record);
+}
+
+LogLine::Buffer& LogLine::thread_buffer() {
+    thread_local Buffer buffer;
+    return buffer;
+}
+
+LogLine::Buffer::int_type LogLine::Buffer::overflow(int_type ch) {
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        record.text.push_back(traits_type::to_char_type(ch));
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize LogLine::Buffer::xsputn(const char* s, std::streamsize n) {
+    record.text.append(s, static_cast<size_t>(n));
+    return n;
+}
+
+}  // namespace eng
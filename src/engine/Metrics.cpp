@@ -0,0 +1,77 @@
+#include "engine/Metrics.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace eng {
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    if (rank == 0) rank = 1;
+
+    const uint64_t max = max_.load(std::memory_order_relaxed);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(bucket_upper(i), max);
+    }
+    return max;  // Counts raced ahead of count_; the top is the best answer
+}
+
+LatencyHistogram::Summary LatencyHistogram::summary() const {
+    Summary s;
+    s.count = count();
+    if (s.count == 0) return s;
+    s.sum = sum_.load(std::memory_order_relaxed);
+    s.mean = static_cast<double>(s.sum) / static_cast<double>(s.count);
+    s.min = min_.load(std::memory_order_relaxed);
+    s.max = max_.load(std::memory_order_relaxed);
+    s.p50 = percentile(0.50);
+    s.p90 = percentile(0.90);
+    s.p99 = percentile(0.99);
+    s.p999 = percentile(0.999);
+    return s;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(UINT64_MAX, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+const char* metric_stage_name(MetricStage stage) {
+    switch (stage) {
+        case MetricStage::Feed: return "feed";
+        case MetricStage::Ingress: return "ingress";
+        case MetricStage::Dispatch: return "dispatch";
+        case MetricStage::Strategy: return "strategy";
+        case MetricStage::BrokerAck: return "broker_ack";
+        case MetricStage::TickToOrder: return "tick_to_order";
+        case MetricStage::PersistFlush: return "persist_flush";
+        case MetricStage::Count: break;
+    }
+    return "unknown";
+}
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+std::vector<Metrics::StageSummary> Metrics::snapshot() const {
+    std::vector<StageSummary> out;
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        if (stages_[i].count() == 0) continue;
+        out.push_back({metric_stage_name(static_cast<MetricStage>(i)), stages_[i].summary()});
+    }
+    return out;
+}
+
+void Metrics::reset() {
+    for (auto& h : stages_) h.reset();
+}
+
+}  // namespace eng
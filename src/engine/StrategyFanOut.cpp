@@ -0,0 +1,304 @@
+// StrategyFanOut.cpp
+
+#include "engine/StrategyFanOut.hpp"
+#include "engine/FixedPoint.hpp"
+#include "engine/Logger.hpp"
+#include "engine/Metrics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace eng {
+
+StrategyFanOut::StrategyFanOut(std::size_t ring_capacity) : ring_capacity_(ring_capacity) {}
+
+StrategyFanOut::~StrategyFanOut() { stop(); }
+
+std::size_t StrategyFanOut::add_worker(int cpu) {
+    if (ring_) throw std::runtime_error("StrategyFanOut: add_worker() after start()");
+    auto w = std::make_unique<Worker>();
+    w->cpu = cpu;
+    w->fills = std::make_unique<BoundedQueue<Order>>(1 << 12);
+    w->batch.resize(kMaxBatch);
+    workers_.push_back(std::move(w));
+    return workers_.size() - 1;
+}
+
+std::size_t StrategyFanOut::add_strategy(std::unique_ptr<IStrategy> strat, std::size_t worker) {
+    if (ring_) throw std::runtime_error("StrategyFanOut: add_strategy() after start()");
+    if (!strat) throw std::runtime_error("StrategyFanOut: null strategy");
+    if (worker >= workers_.size()) {
+        throw std::runtime_error("StrategyFanOut: no worker " + std::to_string(worker));
+    }
+    strategies_.push_back(std::move(strat));
+    worker_of_.push_back(worker);
+    workers_[worker]->slots.push_back(strategies_.size() - 1);
+    return strategies_.size() - 1;
+}
+
+void StrategyFanOut::start(IBroker& broker, bool verbose) {
+    if (ring_) return;
+    broker_ = &broker;
+    verbose_ = verbose;
+
+    // Every worker with a strategy, plus the router, reads each tick
+    std::size_t consumers = 0;
+    for (auto& w : workers_) {
+        if (!w->slots.empty()) w->consumer = consumers++;
+    }
+    router_consumer_ = consumers++;
+    ring_ = std::make_unique<BroadcastRing<Tick>>(ring_capacity_, consumers);
+    intents_ = std::make_unique<BoundedQueue<Intent>>(1 << 14);
+
+    running_.store(true, std::memory_order_release);
+    router_running_.store(true, std::memory_order_release);
+    for (auto& w : workers_) {
+        if (w->slots.empty()) continue;
+        Worker* worker = w.get();
+        w->thread = std::thread([this, worker] { run_worker(*worker); });
+    }
+    router_ = std::thread([this] { run_router(); });
+
+    ENG_LOG_INFO("[Engine] Fan-out: " << strategies_.size() << " strategies on " << workers_.size()
+                 << " workers, tick ring " << ring_->capacity());
+}
+
+void StrategyFanOut::publish(const Tick& t) {
+    if (!ring_ || !running_.load(std::memory_order_acquire)) return;
+    while (!ring_->try_push(t)) {
+        if (!running_.load(std::memory_order_acquire)) return;
+        std::this_thread::yield();
+    }
+}
+
+void StrategyFanOut::on_fill(const Order& fill) {
+    if (fill.client_tag == 0 || fill.client_tag > strategies_.size()) {
+        if (unattributed_fills_.fetch_add(1, std::memory_order_relaxed) == 0) {
+            ENG_LOG_WARN("[Engine] Fan-out: dropping fill for order " << fill.id
+                         << " with no strategy tag (broker doesn't carry client_tag)");
+        }
+        return;
+    }
+    route_fill(fill, static_cast<std::size_t>(fill.client_tag - 1));
+}
+
+void StrategyFanOut::wait_idle() const {
+    if (!ring_) return;
+    auto settled = [this] {
+        // In pipeline order: a released tick has queued its intents, a placed
+        // intent has queued its fills
+        if (ring_->size_approx() != 0) return false;
+        if (intents_done_.load(std::memory_order_acquire) != intents_queued_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        for (const auto& w : workers_) {
+            if (w->fills_done.load(std::memory_order_acquire) != w->fills_queued.load(std::memory_order_acquire)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    while (!settled()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+void StrategyFanOut::stop() {
+    if (!running_.exchange(false)) return;
+    // Workers drain the ring before exiting; the router then places what they queued
+    for (auto& w : workers_) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+    router_running_.store(false, std::memory_order_release);
+    if (router_.joinable()) router_.join();
+    const auto dropped = unattributed_fills_.load(std::memory_order_relaxed);
+    if (dropped > 0) ENG_LOG_WARN("[Engine] Fan-out: " << dropped << " fills could not be attributed");
+}
+
+void StrategyFanOut::run_worker(Worker& w) {
+    pin_current_thread(w.cpu, "strategy worker");
+    int spins = 0;
+    while (true) {
+        std::size_t work = apply_fills(w);
+        const std::size_t n = std::min(ring_->available(w.consumer), kMaxBatch);
+        if (n > 0) {
+            decide(w, n);
+            ring_->release(w.consumer, n);
+            work += n;
+        }
+        if (work > 0) {
+            spins = 0;
+            continue;
+        }
+        if (!running_.load(std::memory_order_acquire)) break;
+        idle(spins);
+    }
+    apply_fills(w);
+    w.exited.store(true, std::memory_order_release);
+}
+
+void StrategyFanOut::decide(Worker& w, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        const Tick& t = ring_->peek(w.consumer, i);
+        PriceData& pd = w.batch[i];
+        pd.symbol = t.symbol;   // Views the ring slot, which outlives this batch
+        pd.last = t.last;
+        pd.instrument_id = t.instrument_id;
+    }
+
+    for (std::size_t slot : w.slots) {
+        IStrategy& strat = *strategies_[slot];
+        std::size_t done = 0;
+        while (done < n) {
+            const int64_t decide_start = ENG_METRICS_NOW();
+            TradeAction act = TradeAction::None;
+            const std::size_t consumed = strat.on_price_ticks(w.batch.data() + done, n - done, act);
+            ENG_METRICS_RECORD(Strategy, ENG_METRICS_NOW() - decide_start);
+            if (consumed == 0) break;
+            done += consumed;
+            if (act == TradeAction::None) continue;
+
+            // Same sell gate as the single-strategy path, on the strategy's own thread
+            if (act == TradeAction::Sell && strat.get_net_position() <= kFlatPosition) {
+                if (verbose_) {
+                    ENG_LOG_DEBUG("[Engine] Strategy " << slot << ": skipping SELL, no position to sell");
+                }
+                continue;
+            }
+
+            const Tick& t = ring_->peek(w.consumer, done - 1);
+            Intent intent;
+            intent.slot = slot;
+            intent.side = act == TradeAction::Buy ? Order::Side::Buy : Order::Side::Sell;
+            intent.symbol = t.symbol;
+            intent.instrument_id = t.instrument_id;
+            intent.price = t.last;
+            intent.ts = t.ts;
+            intent.ingress_ns = t.ingress_ns;
+            push_intent(w, std::move(intent));
+        }
+    }
+}
+
+void StrategyFanOut::push_intent(Worker& w, Intent&& intent) {
+    intents_queued_.fetch_add(1, std::memory_order_release);
+    while (!intents_->try_push(std::move(intent))) {
+        // The router may be waiting on our fill queue; keep it moving
+        apply_fills(w);
+        std::this_thread::yield();
+    }
+}
+
+std::size_t StrategyFanOut::apply_fills(Worker& w) {
+    std::size_t n = 0;
+    Order fill;
+    while (w.fills->try_pop(fill)) {
+        strategies_[fill.client_tag - 1]->on_order_fill(fill);
+        w.fills_done.fetch_add(1, std::memory_order_release);
+        ++n;
+    }
+    return n;
+}
+
+void StrategyFanOut::run_router() {
+    pin_current_thread(router_cpu_, "router");
+    int spins = 0;
+    while (true) {
+        std::size_t work = drain_intents();
+
+        // Let a simulating broker match resting orders on the tape
+        const std::size_t n = std::min(ring_->available(router_consumer_), kMaxBatch);
+        for (std::size_t i = 0; i < n; ++i) {
+            broker_->on_market_tick(ring_->peek(router_consumer_, i));
+        }
+        if (n > 0) ring_->release(router_consumer_, n);
+        work += n;
+
+        if (work > 0) {
+            spins = 0;
+            continue;
+        }
+        // Cleared once the workers have exited, so nothing more can arrive
+        if (!router_running_.load(std::memory_order_acquire)) break;
+        idle(spins);
+    }
+}
+
+std::size_t StrategyFanOut::drain_intents() {
+    std::size_t n = 0;
+    Intent intent;
+    while (n < kMaxBatch && intents_->try_pop(intent)) {
+        place(intent);
+        intents_done_.fetch_add(1, std::memory_order_release);
+        ++n;
+    }
+    return n;
+}
+
+void StrategyFanOut::place(Intent& intent) {
+    Order o;
+    o.symbol = intent.symbol;
+    o.instrument_id = intent.instrument_id;
+    o.qty = 0.01;
+    o.side = intent.side;
+    o.client_tag = intent.slot + 1;
+
+    const int64_t submit = ENG_METRICS_NOW();
+    const double filled = broker_->place_limit_order(o, intent.price, intent.ts);
+    const int64_t acked = ENG_METRICS_NOW();
+    ENG_METRICS_RECORD(BrokerAck, acked - submit);
+    if (intent.ingress_ns != 0) ENG_METRICS_RECORD(TickToOrder, acked - intent.ingress_ns);
+
+    if (verbose_) {
+        ENG_LOG_DEBUG("[Engine] Strategy " << intent.slot << ": placed LIMIT "
+                      << (o.side == Order::Side::Buy ? "BUY " : "SELL ") << o.qty << " " << o.symbol
+                      << " @ " << intent.price << " (filled=" << filled << ")");
+    }
+    if (filled > 0.0) {
+        Order filled_o = o;
+        filled_o.qty = filled;
+        route_fill(filled_o, intent.slot);
+    }
+}
+
+void StrategyFanOut::route_fill(const Order& fill, std::size_t slot) {
+    Worker& w = *workers_[worker_of_[slot]];
+    w.fills_queued.fetch_add(1, std::memory_order_release);
+    Order tagged = fill;
+    tagged.client_tag = slot + 1;
+    while (!w.fills->try_push(std::move(tagged))) {
+        // A worker blocked on the intent queue drains its fills, so this clears;
+        // once it has exited nobody will, and the fill is moot
+        if (w.exited.load(std::memory_order_acquire)) return;
+        std::this_thread::yield();
+    }
+}
+
+void StrategyFanOut::pin_current_thread(int cpu, const char* what) {
+    if (cpu < 0) return;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        ENG_LOG_WARN("[Engine] Fan-out: could not pin " << what << " to CPU " << cpu << " (error " << rc << ")");
+    }
+#else
+    ENG_LOG_WARN("[Engine] Fan-out: CPU pinning is not supported on this platform; " << what << " runs unpinned");
+#endif
+}
+
+void StrategyFanOut::idle(int& spins) {
+    if (++spins < SPIN_BEFORE_SLEEP) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+} // namespace eng
@@ -0,0 +1,270 @@
+#include "engine/TickStore.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <utility>
+
+namespace eng {
+
+namespace {
+
+using Native = TimePoint::duration;
+
+int64_t to_native(long long ms) {
+    return std::chrono::duration_cast<Native>(std::chrono::milliseconds(ms)).count();
+}
+
+long long to_ms(int64_t native) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Native(native)).count();
+}
+
+// Start of the interval bucket holding a timestamp, in native ticks
+int64_t bucket_start(int64_t native, long long interval_ms) {
+    const long long ms = to_ms(native);
+    return to_native((ms / interval_ms) * interval_ms);
+}
+
+}  // namespace
+
+void TickStore::emit_candle(const Series& s, int64_t start, double open, double high, double low,
+                            double close, double volume, std::vector<Candle>& out) {
+    Candle c;
+    c.symbol = s.symbol;
+    c.open_time = TimePoint(Native(start));
+    c.open = open;
+    c.high = high;
+    c.low = low;
+    c.close = close;
+    c.volume = volume;
+    c.instrument_id = s.id;
+    out.push_back(std::move(c));
+}
+
+TickStore::TickStore(TickStoreConfig config)
+    : chunk_ticks_(std::max<size_t>(config.chunk_ticks, 1)),
+      max_chunks_(std::max<size_t>(config.max_ticks_per_instrument / std::max<size_t>(config.chunk_ticks, 1), 1)) {}
+
+void TickStore::append(const TradePrint& tp) {
+    append(tp.instrument_id, tp.symbol, tp.ts, tp.price, tp.qty, tp.side);
+}
+
+void TickStore::append(const Tick& tick) {
+    append(tick.instrument_id, tick.symbol, tick.ts, tick.last, tick.qty, tick.side);
+}
+
+void TickStore::append(InstrumentId id, const std::string& symbol, TimePoint ts,
+                       double price, double qty, TradeSide side) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    append_locked(id, symbol, ts.time_since_epoch().count(), price, qty, side);
+}
+
+void TickStore::append_locked(InstrumentId id, const std::string& symbol, int64_t ts,
+                              double price, double qty, TradeSide side) {
+    auto& slot = slots_.get(id, symbol);
+    if (!slot.value) {
+        // A symbol seen first without an id (or vice versa) shares one series
+        auto& owned = series_[symbol];
+        if (!owned) {
+            owned = std::make_unique<Series>();
+            owned->symbol = symbol;
+            owned->id = id;
+        }
+        slot.value = owned.get();
+    }
+    Series& s = *slot.value;
+
+    if (s.chunks.empty() || s.chunks.back()->size == chunk_ticks_) {
+        std::unique_ptr<Chunk> chunk;
+        if (s.chunks.size() >= max_chunks_) {
+            // Full: the oldest chunk becomes the newest
+            chunk = std::move(s.chunks.front());
+            s.chunks.pop_front();
+            s.ticks -= chunk->size;
+            ++evicted_chunks_;
+        } else {
+            chunk = std::make_unique<Chunk>(chunk_ticks_);
+        }
+        chunk->size = 0;
+        s.chunks.push_back(std::move(chunk));
+    }
+
+    // Keep the column sorted even if the feed steps back in time
+    const int64_t t = std::max<int64_t>(ts, s.last_ts);
+    Chunk& c = *s.chunks.back();
+    const size_t i = c.size++;
+    c.ts[i] = t;
+    c.price[i] = price;
+    c.qty[i] = qty;
+    c.side[i] = static_cast<uint8_t>(side);
+    s.last_ts = t;
+    ++s.ticks;
+}
+
+size_t TickStore::size(const std::string& symbol) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Series* s = find(symbol);
+    return s ? s->ticks : 0;
+}
+
+TimePoint TickStore::last_time(const std::string& symbol) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Series* s = find(symbol);
+    return (s && s->ticks) ? TimePoint(Native(s->last_ts)) : TimePoint{};
+}
+
+size_t TickStore::lower_bound(const Series& s, int64_t ts) const {
+    // Last chunk whose first trade is at or before ts, then search inside it
+    auto it = std::upper_bound(s.chunks.begin(), s.chunks.end(), ts,
+        [](int64_t t, const std::unique_ptr<Chunk>& c) { return t < c->ts[0]; });
+    if (it == s.chunks.begin()) return 0;
+    --it;
+    const Chunk& c = **it;
+    const size_t base = static_cast<size_t>(it - s.chunks.begin()) * chunk_ticks_;
+    const auto first = c.ts.begin();
+    return base + static_cast<size_t>(std::lower_bound(first, first + c.size, ts) - first);
+}
+
+std::vector<Candle> TickStore::build_candles(const Series& s, size_t pos, long long interval_ms, int count) const {
+    std::vector<Candle> out;
+    if (interval_ms <= 0 || count == 0) return out;
+
+    const int64_t width = to_native(interval_ms);
+    int64_t start = 0;
+    int64_t bucket_end = 0;
+    // The open bar lives in locals (kept in registers) and is written out
+    // when the bucket changes
+    double open = 0.0, high = 0.0, low = 0.0, close = 0.0, volume = 0.0;
+    bool open_bar = false;
+
+    // Chunk by chunk, so the inner loop walks plain columns
+    for (size_t ci = pos / chunk_ticks_, i = pos % chunk_ticks_; ci < s.chunks.size(); ++ci, i = 0) {
+        const Chunk& c = *s.chunks[ci];
+        for (; i < c.size; ++i) {
+            const int64_t t = c.ts[i];
+            const double px = c.price[i];
+
+            if (t >= bucket_end || !open_bar) {
+                // Trade in a new bucket: stop once the requested candles are done
+                if (open_bar) emit_candle(s, start, open, high, low, close, volume, out);
+                if (count > 0 && out.size() == static_cast<size_t>(count)) return out;
+                start = bucket_start(t, interval_ms);
+                bucket_end = start + width;
+                open = high = low = close = px;
+                volume = c.qty[i];
+                open_bar = true;
+                continue;
+            }
+            high = std::max(high, px);
+            low = std::min(low, px);
+            close = px;
+            volume += c.qty[i];
+        }
+    }
+    if (open_bar) emit_candle(s, start, open, high, low, close, volume, out);
+    return out;
+}
+
+std::vector<Candle> TickStore::candles(const std::string& symbol, long long interval_ms,
+                                       TimePoint since, int count) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Series* s = find(symbol);
+    if (!s || interval_ms <= 0) return {};
+    // Include the whole bucket `since` falls in
+    const int64_t from = bucket_start(since.time_since_epoch().count(), interval_ms);
+    return build_candles(*s, lower_bound(*s, from), interval_ms, count);
+}
+
+std::vector<Candle> TickStore::last_candles(const std::string& symbol, long long interval_ms, int limit) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Series* s = find(symbol);
+    if (!s || interval_ms <= 0 || limit <= 0) return {};
+
+    // Hop back one occupied bucket at a time: the trade just before a
+    // bucket's first trade names the previous bucket
+    size_t pos = s->ticks;
+    for (int buckets = 0; buckets < limit && pos > 0; ++buckets) {
+        const size_t p = pos - 1;
+        const int64_t t = s->chunks[p / chunk_ticks_]->ts[p % chunk_ticks_];
+        pos = lower_bound(*s, bucket_start(t, interval_ms));
+    }
+    return build_candles(*s, pos, interval_ms, limit);
+}
+
+TickStore::Stats TickStore::stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    Stats out;
+    out.instruments = series_.size();
+    out.evicted_chunks = evicted_chunks_;
+    for (const auto& [symbol, s] : series_) {
+        out.ticks += s->ticks;
+        out.chunks += s->chunks.size();
+    }
+    const size_t per_chunk = chunk_ticks_ * (sizeof(int64_t) + 2 * sizeof(double) + sizeof(uint8_t));
+    out.bytes = out.chunks * per_chunk;
+    return out;
+}
+
+void TickStore::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    slots_.clear();
+    series_.clear();
+}
+
+void TickStore::save_state(CheckpointWriter& out) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    out.put<uint64_t>(series_.size());
+    for (const auto& [symbol, s] : series_) {
+        out.put_string(symbol);
+        out.put<InstrumentId>(s->id);
+        out.put<uint64_t>(s->ticks);
+        // Column by column, so each reads back as one block
+        for (const auto& c : s->chunks) out.put_bytes(c->ts.data(), c->size * sizeof(int64_t));
+        for (const auto& c : s->chunks) out.put_bytes(c->price.data(), c->size * sizeof(double));
+        for (const auto& c : s->chunks) out.put_bytes(c->qty.data(), c->size * sizeof(double));
+        for (const auto& c : s->chunks) out.put_bytes(c->side.data(), c->size * sizeof(uint8_t));
+    }
+}
+
+void TickStore::load_state(CheckpointReader& in) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const auto count = in.get<uint64_t>();
+    for (uint64_t k = 0; k < count; ++k) {
+        const std::string symbol = in.get_string();
+        const auto id = in.get<InstrumentId>();
+        const auto n = in.get<uint64_t>();
+        if (n > SIZE_MAX / sizeof(int64_t)) in.fail("bad tick count for " + symbol);
+        // Views into the section; unaligned, so values are copied out
+        const char* ts = in.get_bytes(n * sizeof(int64_t)).data();
+        const char* price = in.get_bytes(n * sizeof(double)).data();
+        const char* qty = in.get_bytes(n * sizeof(double)).data();
+        const char* side = in.get_bytes(n * sizeof(uint8_t)).data();
+        for (uint64_t i = 0; i < n; ++i) {
+            int64_t t;
+            double p, q;
+            std::memcpy(&t, ts + i * sizeof(int64_t), sizeof(t));
+            std::memcpy(&p, price + i * sizeof(double), sizeof(p));
+            std::memcpy(&q, qty + i * sizeof(double), sizeof(q));
+            append_locked(id, symbol, t, p, q, static_cast<TradeSide>(side[i]));
+        }
+    }
+    if (!in.done()) in.fail("unexpected trailing data");
+}
+
+long long TickStore::parse_interval(const std::string& interval) {
+    if (interval.size() < 2) return 0;
+    long long n = 0;
+    size_t i = 0;
+    for (; i < interval.size() && std::isdigit(static_cast<unsigned char>(interval[i])); ++i) {
+        n = n * 10 + (interval[i] - '0');
+    }
+    if (i == 0 || i + 1 != interval.size() || n <= 0) return 0;
+    switch (interval[i]) {
+        case 's': return n * 1000;
+        case 'm': return n * 60 * 1000;
+        case 'h': return n * 60 * 60 * 1000;
+        case 'd': return n * 24 * 60 * 60 * 1000;
+        default:  return 0;
+    }
+}
+
+}  // namespace eng
@@ -1,11 +1,21 @@
 #include "adapters/BrokerMarketData.hpp"
 #include "adapters/KrakenFileReplayAdapter.hpp"
+#include "adapters/KrakenWsAdapter.hpp"
+#include "adapters/TradeArchiveReplayAdapter.hpp"
+#include "adapters/TradeFileSources.hpp"
 #include "brokers/NullBroker.hpp"
 #include "engine/Engine.hpp"
 #include "engine/InstrumentRegistry.hpp"
 #include "engine/ProviderMarketData.hpp"
+#include "engine/BarBuilder.hpp"
+#include "engine/Checkpoint.hpp"
 #include "engine/CandlePersister.hpp"
+#include "engine/AllocationCounter.hpp"
+#include "engine/Logger.hpp"
+#include "engine/Metrics.hpp"
+#include "engine/TickStore.hpp"
 #include "strategies/MovingAverage.hpp"
+#include "plugins/PluginLoader.hpp"
 #include "server/FrontendBridge.hpp"
 #include <memory>
 #include <vector>
@@ -15,13 +25,89 @@
 #include <csignal>
 #include <atomic>
 #include <string>
+#include <functional>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <algorithm>
+#include <sys/resource.h>
 
 static std::atomic<bool> shutdown_requested(false);
+static std::atomic<bool> replay_running(true);  // Stop flag for merged replay
 static eng::Engine* g_engine = nullptr;
 
+static void print_pacing(double pace, const eng::ReplayClock::Stats& stats) {
+  if (pace <= 0.0) return;
+  ENG_LOG_INFO("[Main] Replay pacing: waits=" << stats.waits << " late(>1ms)=" << stats.late
+               << " max_lag_us=" << stats.max_lag_ns / 1000);
+}
+
+// Events seen on the bus during a --bench run
+struct BenchCounters {
+  std::atomic<uint64_t> trades{0};
+  std::atomic<uint64_t> ticks{0};
+  std::atomic<uint64_t> bars{0};
+  std::atomic<uint64_t> order_events{0};
+
+  uint64_t total() const { return trades + ticks + bars + order_events; }
+};
+
+static double stage_seconds(const std::vector<eng::Metrics::StageSummary>& stages, const char* name) {
+  for (const auto& m : stages) {
+    if (m.stage == name) return static_cast<double>(m.latency_ns.sum) / 1e9;
+  }
+  return 0.0;
+}
+
+// Headless summary of one --bench replay
+static void print_bench_report(size_t trades, const BenchCounters& events, uint64_t allocations,
+                               double replay_s, double drain_s, double flush_s, bool async_bus) {
+  const double total_s = replay_s + drain_s + flush_s;
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+
+  std::cout << std::fixed << std::setprecision(0);
+  std::cout << "[Bench] trades=" << trades << " in " << std::setprecision(3) << total_s << "s\n";
+  std::cout << std::setprecision(0)
+            << "[Bench] trades/sec=" << (total_s > 0.0 ? trades / total_s : 0.0)
+            << " events/sec=" << (total_s > 0.0 ? events.total() / total_s : 0.0)
+            << " (trades=" << events.trades << " ticks=" << events.ticks << " bars=" << events.bars
+            << " order_events=" << events.order_events << ")\n";
+  std::cout << "[Bench] peak_rss=" << usage.ru_maxrss / 1024 << "MB"   // ru_maxrss is KB on Linux
+            << " allocations=" << allocations << " (" << std::setprecision(2)
+            << (trades ? static_cast<double>(allocations) / trades : 0.0) << "/trade)\n";
+
+  // Phases from the hot-path histograms: the replay loop alternates between
+  // reading/decoding the next trade and handling it inline (ingress), which
+  // splits into strategy, broker and bus dispatch (bars, fill matching).
+  // The candle writer's commits overlap the replay on their own thread.
+  std::cout << std::setprecision(3);
+  if (!eng::Metrics::enabled()) {
+    std::cout << "[Bench] phases: replay=" << replay_s << "s drain=" << drain_s << "s flush=" << flush_s
+              << "s (built with ENG_ENABLE_METRICS=OFF; no per-phase split)\n";
+    return;
+  }
+  const auto stages = eng::Metrics::instance().snapshot();
+  const double ingress = stage_seconds(stages, "ingress");
+  const double strategy = stage_seconds(stages, "strategy");
+  const double broker = stage_seconds(stages, "broker_ack");
+  std::cout << "[Bench] phases: decode=" << std::max(0.0, replay_s - ingress) << "s";
+  if (async_bus) {
+    // Handlers run on bus workers; ingress only covers enqueueing
+    std::cout << " enqueue=" << ingress << "s strategy=" << strategy << "s broker=" << broker
+              << "s (on workers) drain=" << drain_s << "s";
+  } else {
+    std::cout << " dispatch=" << std::max(0.0, ingress - strategy - broker) << "s strategy=" << strategy
+              << "s broker=" << broker << "s";
+  }
+  std::cout << " persist=" << stage_seconds(stages, "persist_flush") << "s (writer thread) final_flush="
+            << flush_s << "s\n";
+}
+
 void signal_handler(int sig) {
   std::cout << "\n[Main] Shutdown signal received. Cleaning up...\n";
   shutdown_requested = true;
+  replay_running = false;
   if (g_engine) {
     g_engine->request_shutdown();
   }
@@ -34,22 +120,143 @@ int main(int argc, char* argv[]) {
 #endif
 
   // Parse command-line arguments
-  // Usage: trading_engine --data-file <path> [--symbol <symbol>]
-  std::string data_file;
+  // Usage: trading_engine --data-file <path> | --kraken-live <pair> [--symbol <symbol>] [--async-bus]
+  //                       [--pace <x>] [--start-delay <seconds>] [--fill-sim ...]
+  //                       [--chart-interval <ms>...] [--candle-delta-hz <hz>] [--log-level <level>]
+  //                       [--strategy-plugin <path.so> [--strategy-config <config>]]
+  //                       [--strategy-cpus <cpu,cpu,...> [--broker-cpu <cpu>]]
+  //                       [--checkpoint <path> [--checkpoint-every <trades>]] [--resume <path>]
+  // <path> is a Kraken .jsonl.gz day or a binary .trades archive (see trade_archive_convert).
+  // Repeat --data-file to replay several files merged into one timestamp-ordered stream.
+  // --kraken-live trades Kraken's live trade feed for one pair instead (e.g. BTC/USD, traded
+  //   as BTCUSD) until Ctrl+C; --pace doesn't apply and --bench isn't supported
+  // --async-bus runs the strategy, bar builder and frontend on their own bus worker threads
+  // --pace replays by trade timestamp: 1 = real-time, 10 = 10x, 0 = as fast as possible (default)
+  // --start-delay waits before replay so the frontend can connect (default 5s)
+  // --fill-sim rests limit orders in a simulated book filled by the tape instead of filling
+  //   them instantly; --fill-latency-ms, --fill-queue-ahead and --fill-tif-s tune it.
+  //   --fill-tick-size sets the book's price grid, for every symbol (<size>, default 0.1) or
+  //   one (<symbol>=<size>, repeatable); use the venue's price increment
+  // --chart-interval streams live bars of that width to the frontend (repeatable, e.g. 60000)
+  // --candle-delta-hz caps CandleDelta messages per SubscribeCandles subscription per second (default 10)
+  // --log-level trace|debug|info|warn|error|off (levels below the build's ENG_LOG_LEVEL are compiled out)
+  // --strategy-plugin trades a plugin strategy (see plugins/PluginApi.h) instead of the built-in
+  //   MovingAverage, configured by --strategy-config (e.g. plugins/moving_average_plugin.so, "window=5")
+  // --strategy-cpus runs one instance of the strategy per listed CPU, each on a worker thread pinned
+  //   there (-1: unpinned), fed by a broadcast ring; orders go through one broker thread, pinned by
+  //   --broker-cpu. Asynchronous, so replays aren't repeatable run to run (see StrategyFanOut.hpp)
+  // --checkpoint writes broker, strategy, bar and instrument state plus the replay position to
+  //   <path> every --checkpoint-every trades (default 1000000) and when the replay ends
+  // --resume restores a checkpoint before replaying: the same data files carry on after its
+  //   position, other files (the next day, say) are replayed whole on top of its state.
+  //   Only .trades archives jump straight to the position; a .jsonl.gz file still inflates
+  //   and parses every trade before it (gzip can't seek), so convert days you resume often.
+  //   Not with --fill-sim (resting orders aren't saved), --kraken-live or --bench
+  // --bench replays headless (no websocket bridge, no start delay, unthrottled) into bench.db,
+  //   prints throughput, peak RSS, allocations per trade and time by phase, then exits
+  std::vector<std::string> data_files;
   std::string symbol = "BTCUSD";
+  bool async_bus = false;
+  double pace = 0.0;
+  double start_delay_s = 5.0;
+  bool fill_sim = false;
+  broker::FillSimulator::Config fill_config;
+  std::vector<long long> chart_intervals;
+  double candle_delta_hz = 10.0;
+  bool bench = false;
+  std::string plugin_path;
+  std::string plugin_config;
+  std::vector<int> strategy_cpus;
+  int broker_cpu = -1;
+  std::string live_pair;
+  std::string checkpoint_path;
+  size_t checkpoint_every = 1'000'000;
+  std::string resume_path;
 
   for (int i = 1; i < argc; ++i) {
     std::string arg = argv[i];
     if (arg == "--data-file" && i + 1 < argc) {
-      data_file = argv[++i];
+      data_files.push_back(argv[++i]);
     } else if (arg == "--symbol" && i + 1 < argc) {
       symbol = argv[++i];
+    } else if (arg == "--async-bus") {
+      async_bus = true;
+    } else if (arg == "--pace" && i + 1 < argc) {
+      pace = std::stod(argv[++i]);
+    } else if (arg == "--start-delay" && i + 1 < argc) {
+      start_delay_s = std::stod(argv[++i]);
+    } else if (arg == "--fill-sim") {
+      fill_sim = true;
+    } else if (arg == "--fill-latency-ms" && i + 1 < argc) {
+      fill_config.latency = std::chrono::microseconds(static_cast<int64_t>(std::stod(argv[++i]) * 1000.0));
+    } else if (arg == "--fill-queue-ahead" && i + 1 < argc) {
+      fill_config.queue_ahead = std::stod(argv[++i]);
+    } else if (arg == "--fill-tif-s" && i + 1 < argc) {
+      fill_config.time_in_force = std::chrono::milliseconds(static_cast<int64_t>(std::stod(argv[++i]) * 1000.0));
+    } else if (arg == "--fill-tick-size" && i + 1 < argc) {
+      broker::parse_tick_size_flag(argv[++i], fill_config);
+    } else if (arg == "--chart-interval" && i + 1 < argc) {
+      chart_intervals.push_back(std::stoll(argv[++i]));
+    } else if (arg == "--candle-delta-hz" && i + 1 < argc) {
+      candle_delta_hz = std::stod(argv[++i]);
+    } else if (arg == "--log-level" && i + 1 < argc) {
+      eng::Logger::instance().set_level(eng::parse_log_level(argv[++i]));
+    } else if (arg == "--bench") {
+      bench = true;
+    } else if (arg == "--strategy-plugin" && i + 1 < argc) {
+      plugin_path = argv[++i];
+    } else if (arg == "--strategy-config" && i + 1 < argc) {
+      plugin_config = argv[++i];
+    } else if (arg == "--strategy-cpus" && i + 1 < argc) {
+      std::stringstream cpus(argv[++i]);
+      std::string cpu;
+      while (std::getline(cpus, cpu, ',')) {
+        if (!cpu.empty()) strategy_cpus.push_back(std::stoi(cpu));
+      }
+    } else if (arg == "--broker-cpu" && i + 1 < argc) {
+      broker_cpu = std::stoi(argv[++i]);
+    } else if (arg == "--kraken-live" && i + 1 < argc) {
+      live_pair = argv[++i];
+    } else if (arg == "--checkpoint" && i + 1 < argc) {
+      checkpoint_path = argv[++i];
+    } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+      checkpoint_every = std::stoull(argv[++i]);
+    } else if (arg == "--resume" && i + 1 < argc) {
+      resume_path = argv[++i];
+    }
+  }
+
+  const bool live = !live_pair.empty();
+  if (live) {
+    // The adapter delivers Kraken's "BTC/USD" as "BTCUSD"
+    symbol = live_pair;
+    symbol.erase(std::remove(symbol.begin(), symbol.end(), '/'), symbol.end());
+    if (!data_files.empty()) {
+      std::cerr << "[Main] ERROR: --kraken-live and --data-file are exclusive\n";
+      return 1;
+    }
+    if (bench) {
+      std::cerr << "[Main] ERROR: --bench replays recorded data; it can't run with --kraken-live\n";
+      return 1;
     }
   }
 
-  if (data_file.empty()) {
-    std::cerr << "[Main] ERROR: --data-file is required\n";
-    std::cerr << "Usage: " << argv[0] << " --data-file <path> [--symbol <symbol>]\n";
+  if ((!checkpoint_path.empty() || !resume_path.empty()) && (fill_sim || live || bench)) {
+    std::cerr << "[Main] ERROR: --checkpoint/--resume can't be combined with --fill-sim, --kraken-live or --bench\n";
+    return 1;
+  }
+  if (checkpoint_every == 0) checkpoint_every = 1'000'000;
+
+  if (data_files.empty() && !live) {
+    std::cerr << "[Main] ERROR: --data-file or --kraken-live is required\n";
+    std::cerr << "Usage: " << argv[0] << " --data-file <path> [--data-file <path>...] | --kraken-live <pair>"
+              << " [--symbol <symbol>] [--async-bus]"
+              << " [--pace <x>] [--start-delay <seconds>] [--fill-sim [--fill-latency-ms <ms>]"
+              << " [--fill-queue-ahead <qty>] [--fill-tif-s <seconds>] [--fill-tick-size [<symbol>=]<size>]]"
+              << " [--chart-interval <ms>...] [--candle-delta-hz <hz>]"
+              << " [--log-level <level>] [--bench] [--strategy-plugin <path.so> [--strategy-config <config>]]"
+              << " [--strategy-cpus <cpu,cpu,...> [--broker-cpu <cpu>]]"
+              << " [--checkpoint <path> [--checkpoint-every <trades>]] [--resume <path>]\n";
     return 1;
   }
 
@@ -59,57 +266,202 @@ int main(int argc, char* argv[]) {
 
   // 1. set up an exchange broker to facilitate orders
   auto broker = std::make_unique<broker::NullBroker>(engine->get_bus());
+  if (bench) {
+    // Nothing per order on the output; the report is the result
+    engine->set_verbose(false);
+    broker->set_verbose(false);
+    pace = 0.0;
+  }
+  if (fill_sim) {
+    broker->enable_fill_simulation(fill_config);
+    ENG_LOG_INFO("[Main] Simulated fills: latency=" << fill_config.latency.count() / 1000 << "us"
+                 << " queue_ahead=" << fill_config.queue_ahead);
+  }
 
   // 2. Set up market-data adapter with recorded trade data
   auto registry = std::make_shared<eng::InstrumentRegistry>();
+
+  // Restore instruments first, so every later registration (replay sources
+  // start prefetching as they're attached) gets the ids the checkpoint uses
+  std::optional<eng::Checkpoint> resume;
+  if (!resume_path.empty()) {
+    try {
+      resume = eng::Checkpoint::load(resume_path);
+      auto in = resume->reader("registry");
+      registry->load_state(in);
+    } catch (const std::exception& e) {
+      std::cerr << "[Main] ERROR: " << e.what() << "\n";
+      return 1;
+    }
+  }
   
-  auto kraken_adapter = std::make_unique<adapter::KrakenFileReplayAdapter>(registry);
-  kraken_adapter->start();
-  auto kraken_adapter_ptr = kraken_adapter.get();  // Keep raw pointer before moving
-  
-  std::cout << "[Main] Using data file: " << data_file << "\n";
+  // Binary trade archives replay straight out of an mmap; anything else is
+  // treated as Kraken JSONL.GZ
+  const std::string data_file = live ? "kraken:" + live_pair : data_files.front();
+  const bool merged = data_files.size() > 1;
+  const std::string archive_ext = ".trades";
+  bool use_archive = !live && data_file.size() > archive_ext.size() &&
+      data_file.compare(data_file.size() - archive_ext.size(), archive_ext.size(), archive_ext) == 0;
+
+  // Replay entry point for whichever adapter we pick (called on the replay thread):
+  // (path, pace, trades to skip, per-trade hook) -> position reached, skipped trades included
+  using TradeHook = std::function<void(const eng::TradePrint&)>;
+  std::function<size_t(const std::string&, double, size_t, const TradeHook&)> replay_fn;
+  adapter::KrakenWsAdapter* live_feed = nullptr;  // Stopped before the components it feeds
 
   // 3. provider (aggregator) that attaches feeds
   auto provider = std::make_unique<eng::ProviderMarketData>();
-  provider->attach(std::move(kraken_adapter));
+
+  if (live) {
+    adapter::KrakenWsAdapter::Options opts;
+    opts.pairs = {live_pair};
+    auto live_adapter = std::make_unique<adapter::KrakenWsAdapter>(opts, registry);
+    auto live_adapter_ptr = live_adapter.get();
+    live_feed = live_adapter_ptr;
+    // "Replays" the feed until Ctrl+C
+    replay_fn = [live_adapter_ptr](const std::string&, double, size_t, const TradeHook&) {
+      live_adapter_ptr->start();
+      while (replay_running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      }
+      live_adapter_ptr->stop();
+      return static_cast<size_t>(live_adapter_ptr->stats().trades);
+    };
+    provider->attach(std::move(live_adapter));
+  } else if (merged) {
+    // Several files: the provider k-way merges them by trade timestamp;
+    // gzip files inflate on their own prefetch threads
+    for (const auto& path : data_files) {
+      provider->attach_source(adapter::open_trade_source(path, registry));
+    }
+    auto provider_ptr = provider.get();  // Owned by the engine from step 6 on
+    replay_fn = [provider_ptr](const std::string&, double pace, size_t skip, const TradeHook& hook) {
+      size_t n = provider_ptr->replay_merged(hook, pace, &replay_running, skip);
+      print_pacing(pace, provider_ptr->merger().last_clock_stats());
+      return n;
+    };
+  } else if (use_archive) {
+    auto archive_adapter = std::make_unique<adapter::TradeArchiveReplayAdapter>(registry);
+    archive_adapter->start();
+    auto archive_adapter_ptr = archive_adapter.get();  // Keep raw pointer before moving
+    replay_fn = [archive_adapter_ptr](const std::string& path, double pace, size_t skip, const TradeHook& hook) {
+      size_t n = archive_adapter_ptr->replay(path, pace, hook, skip);
+      print_pacing(pace, archive_adapter_ptr->last_replay_clock_stats());
+      return n;
+    };
+    provider->attach(std::move(archive_adapter));
+  } else {
+    auto kraken_adapter = std::make_unique<adapter::KrakenFileReplayAdapter>(registry);
+    kraken_adapter->set_keep_metadata(false);  // Nothing downstream reads kraken_misc
+    kraken_adapter->start();
+    auto kraken_adapter_ptr = kraken_adapter.get();  // Keep raw pointer before moving
+    replay_fn = [kraken_adapter_ptr](const std::string& path, double pace, size_t skip, const TradeHook& hook) {
+      size_t n = kraken_adapter_ptr->replay(path, pace, hook, skip);  // hook only for checkpoints; trades go to subscriptions
+      print_pacing(pace, kraken_adapter_ptr->last_replay_clock_stats());
+      return n;
+    };
+    provider->attach(std::move(kraken_adapter));
+  }
+
+  // Every replayed trade is also kept in memory for candle/warm-up queries
+  auto tick_store = std::make_shared<eng::TickStore>();
+  provider->set_tick_store(tick_store);
+
+  if (merged) {
+    std::string paths;
+    for (const auto& path : data_files) paths += " " + path;
+    ENG_LOG_INFO("[Main] Merging " << data_files.size() << " data files:" << paths);
+  } else if (live) {
+    ENG_LOG_INFO("[Main] Trading Kraken's live " << live_pair << " feed as " << symbol);
+  } else {
+    ENG_LOG_INFO("[Main] Using data file: " << data_file
+                 << (use_archive ? " (trade archive)" : ""));
+  }
 
   // Subscribe to trades and publish to event bus
-  // This connects the adapter to ChartAggregator and Strategy
+  // This connects the adapter to BarBuilder and Strategy
   eng::EventBus& bus = engine->get_bus();
+  // Both go over typed channels: subscribers get a const ref, nothing is copied
   provider->subscribe_trades({symbol}, [symbol, &bus](const eng::TradePrint &tp) {
-    // Publish TradePrint for ChartAggregator to consume
-    eng::Event trade_ev{"TradePrint", tp};
-    bus.publish(trade_ev);
+    const int64_t ingress = ENG_METRICS_NOW();
+    // Publish TradePrint for BarBuilder to consume
+    bus.publish(tp);
     
     // Convert TradePrint to Tick event for the strategy
     eng::Tick tick{
         .symbol = tp.symbol,
         .last = tp.price,
-        .ts = tp.ts
+        .ts = tp.ts,
+        .instrument_id = tp.instrument_id,
+        .qty = tp.qty,
+        .side = tp.side,
+        .ingress_ns = ingress
     };
-    eng::Event ev{"ProviderTick", tick};
-    bus.publish(ev);
+    bus.publish(tick);
+    ENG_METRICS_RECORD(Ingress, ENG_METRICS_NOW() - ingress);
   });
 
   // 4. set strategies
-  // Moving-average strategy: 5-sample SMA, threshold 1.0, qty 0.01
-  auto strat =
-      std::make_unique<strategy::MovingAverageStrategy>(symbol, 5, 1.0, 0.01);
+  // Moving-average strategy: 5-sample SMA, threshold 1.0, qty 0.01, unless a plugin is given
+  // (one per --strategy-cpus entry)
+  std::vector<std::unique_ptr<eng::IStrategy>> strats;
+  for (size_t n = 0; n < std::max<size_t>(1, strategy_cpus.size()); ++n) {
+    if (!plugin_path.empty()) {
+      try {
+        strats.push_back(PluginLoader::instance().load<eng::IStrategy>(plugin_path, plugin_config, symbol));
+      } catch (const std::exception& e) {
+        std::cerr << "[Main] ERROR: " << e.what() << "\n";
+        return 1;
+      }
+    } else {
+      strats.push_back(std::make_unique<strategy::MovingAverageStrategy>(symbol, 5, 1.0, 0.01));
+    }
+  }
 
   // 5. Create the frontend bridge for WebSocket and RPC queries
-  // Handles QueryCandles, QueryOrders, etc. via WebSocket on port 8080
-  auto bridge = std::make_unique<server::FrontendBridge>(engine->get_bus(), *broker, 8080);
-  bridge->start();
+  // Handles QueryCandles, QueryOrders, etc. via WebSocket on port 8080.
+  // --bench runs headless: no bridge, candles go to a store of its own
+  std::unique_ptr<server::FrontendBridge> bridge;
+  std::shared_ptr<eng::CandleStore> candle_store;
+  if (bench) {
+    eng::CandleStoreConfig store_config;
+    store_config.db_path = "bench.db";
+    store_config.partition_by_day = true;   // As the bridge's store; clear_all() unlinks the files
+    candle_store = std::make_shared<eng::CandleStore>(store_config);
+    candle_store->clear_all();   // Same starting point every run
+  } else {
+    bridge = std::make_unique<server::FrontendBridge>(engine->get_bus(), *broker, 8080);
+    if (async_bus) {
+      // Websocket fan-out may lag; never let it hold up the replay
+      bridge->set_async_dispatch({"FrontendBridge", 1 << 14, eng::EventBus::Backpressure::DropOldest});
+    }
+    bridge->set_chart_intervals(chart_intervals);
+    bridge->set_tick_store(tick_store);
+    bridge->set_max_delta_rate_hz(candle_delta_hz);
+    bridge->start();
+    candle_store = bridge->get_candle_store();
+  }
 
-  // 5b. Create the candle persister for real-time write path
-  // Subscribes to TradePrint events, buckets into 1s candles, writes to database
+  // 5b. One bar builder feeds both the persister and the chart stream:
+  // every interval is updated in a single pass per trade
   // TODO: Make component selection configurable via runtime configuration
+  std::vector<long long> bar_intervals = chart_intervals;
+  bar_intervals.push_back(eng::CandleStore::kBaseResolutionMs);
+  auto bars = std::make_unique<eng::BarBuilder>(engine->get_bus(), bar_intervals);
+  if (async_bus) {
+    // Lossless: every trade must reach the database
+    bars->set_async_dispatch({"BarBuilder", 1 << 16, eng::EventBus::Backpressure::Block});
+  }
+
+  // 5c. Create the candle persister for real-time write path
+  // Writes the builder's 1s bars to the database
   auto persister = std::make_unique<eng::CandlePersister>(
       engine->get_bus(), 
-      bridge->get_candle_store(),  // Share the same CandleStore instance
-      1000  // 1 second resolution
+      candle_store,  // Shared with the bridge's queries
+      eng::CandleStore::kBaseResolutionMs
   );
   persister->start();
+  bars->start();
 
   // Set up signal handlers for clean shutdown
   std::signal(SIGINT, signal_handler);
@@ -118,28 +470,186 @@ int main(int argc, char* argv[]) {
   // 6. engine: wire it all together
   engine->set_broker(std::move(broker));
   engine->set_market_data(std::move(provider));
-  engine->set_strategy(std::move(strat));
+  if (strategy_cpus.empty()) {
+    engine->set_strategy(std::move(strats.front()));
+  } else {
+    for (size_t n = 0; n < strats.size(); ++n) {
+      engine->add_strategy(std::move(strats[n]), engine->add_strategy_worker(strategy_cpus[n]));
+    }
+    engine->set_broker_cpu(broker_cpu);
+  }
+  if (async_bus) {
+    engine->set_async_dispatch({"Strategy", 1 << 16, eng::EventBus::Backpressure::Block});
+  }
+
+  // --resume: the rest of the checkpoint. Replaying the same data files picks
+  // up after its position; other files are replayed whole on top of its state
+  size_t resume_at = 0;
+  if (resume) {
+    const auto t0 = std::chrono::steady_clock::now();
+    try {
+      engine->load_state(*resume);
+      auto bars_in = resume->reader("bars");
+      bars->load_state(bars_in);
+      auto candles_in = resume->reader("candles");
+      candle_store->load_state(candles_in);
+      if (resume->has("ticks")) {   // Older checkpoints didn't keep the tick history
+        auto ticks_in = resume->reader("ticks");
+        tick_store->load_state(ticks_in);
+      }
+      auto replay_in = resume->reader("replay");
+      std::vector<std::string> sources(replay_in.get<uint64_t>());
+      for (auto& path : sources) path = replay_in.get_string();
+      const auto position = replay_in.get<uint64_t>();
+      if (sources == data_files) resume_at = position;
+    } catch (const std::exception& e) {
+      std::cerr << "[Main] ERROR: " << e.what() << "\n";
+      return 1;
+    }
+    const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    if (resume_at > 0) {
+      ENG_LOG_INFO("[Main] Resumed from " << resume_path << " at trade " << resume_at << " (" << ms << "ms)");
+    } else {
+      ENG_LOG_INFO("[Main] Resumed state from " << resume_path << " (" << ms << "ms); it was taken on"
+                   << " other data, so these files replay from their first trade");
+    }
+  }
+
+  if (bench) {
+    // Replay on this thread, unthrottled, and time it end to end
+    if (!engine->start()) return 1;
+    auto& bus = engine->get_bus();
+    BenchCounters events;
+    bus.subscribe<eng::TradePrint>([&events](const eng::TradePrint&) {
+      events.trades.fetch_add(1, std::memory_order_relaxed);
+    });
+    bus.subscribe<eng::Tick>([&events](const eng::Tick&) {
+      events.ticks.fetch_add(1, std::memory_order_relaxed);
+    });
+    bus.subscribe<eng::Bar>([&events](const eng::Bar&) {
+      events.bars.fetch_add(1, std::memory_order_relaxed);
+    });
+    bus.subscribe<eng::OrderEvent>([&events](const eng::OrderEvent&) {
+      events.order_events.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    ENG_LOG_INFO("[Main] Bench: replaying " << (merged ? std::string("merged sources") : data_file));
+    eng::Metrics::instance().reset();
+    const uint64_t allocs_before = eng::allocation_count();
+    const auto t0 = std::chrono::steady_clock::now();
+    size_t trades_replayed = replay_fn(data_file, 0.0, 0, nullptr);
+    const auto t1 = std::chrono::steady_clock::now();
+    engine->wait_idle();
+    const auto t2 = std::chrono::steady_clock::now();
+    bars->flush();
+    persister->flush_pending_data();
+    const auto t3 = std::chrono::steady_clock::now();
+    const uint64_t allocations = eng::allocation_count() - allocs_before;
+
+    auto secs = [](auto a, auto b) { return std::chrono::duration<double>(b - a).count(); };
+    print_bench_report(trades_replayed, events, allocations,
+                       secs(t0, t1), secs(t1, t2), secs(t2, t3), async_bus);
+
+    bus.stop_async();
+    bars->stop();
+    persister->stop();
+    eng::Logger::instance().flush();
+    return 0;
+  }
+
+  // Wire the strategy to the bus before the first trade can be published;
+  // with no start delay (or a fast resume) replay would otherwise race run()
+  if (!engine->start()) return 1;
 
   // Spawn replay thread to run while engine is executing
-  std::cout << "[Main] Starting replay...\n";
+  ENG_LOG_INFO("[Main] Starting replay...");
   auto engine_ptr = engine.get();
-  auto adapter_ptr = kraken_adapter_ptr;
+  auto bars_ptr = bars.get();
   auto persister_ptr = persister.get();
-  std::thread replay_thread([engine_ptr, adapter_ptr, persister_ptr, &data_file]() {
-    std::this_thread::sleep_for(std::chrono::seconds(5));  // Wait for frontend WebSocket connection
-    std::cout << "[Main] Replaying trades from: " << data_file << "\n";
-    size_t trades_replayed = adapter_ptr->replay(
-        data_file,
-        1.0,  // pace: 1.0 = real-time (not used in backtest, instant replay)
-        nullptr  // on_trade callback (optional, use subscriptions instead)
-    );
-    std::cout << "[Main] Replayed " << trades_replayed << " trades.\n";
+
+  // Checkpoints are taken on the replay thread between trades, once the engine
+  // has caught up, so every trade handed out so far is fully applied. They're
+  // written before the end-of-replay flush, which would close the open bars.
+  auto write_checkpoint = [engine_ptr, bars_ptr, persister_ptr, candle_store, tick_store, registry,
+                           checkpoint_path, data_files](size_t position) {
+    const auto t0 = std::chrono::steady_clock::now();
+    engine_ptr->wait_idle();
+    eng::Checkpoint cp;
+    if (!engine_ptr->save_state(cp)) {
+      ENG_LOG_ERROR("[Main] The strategy or broker can't be checkpointed; not writing checkpoints");
+      return false;
+    }
+    registry->save_state(cp.section("registry"));
+    bars_ptr->save_state(cp.section("bars"));
+    tick_store->save_state(cp.section("ticks"));
+    auto& replay = cp.section("replay");
+    replay.put<uint64_t>(data_files.size());
+    for (const auto& path : data_files) replay.put_string(path);
+    replay.put<uint64_t>(position);
+    // Bars finished before this point must be stored before anything resumes past it
+    persister_ptr->flush_pending_data();
+    candle_store->save_state(cp.section("candles"));
+    try {
+      cp.save(checkpoint_path);
+    } catch (const std::exception& e) {
+      ENG_LOG_ERROR("[Main] " << e.what());   // Try again at the next one
+      return true;
+    }
+    const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    ENG_LOG_INFO("[Main] Checkpoint at trade " << position << ": " << cp.size() / 1024 << "KB in " << ms << "ms");
+    return true;
+  };
+  const bool checkpointing = !checkpoint_path.empty();
+
+  std::thread replay_thread([engine_ptr, replay_fn, bars_ptr, persister_ptr, tick_store, &data_file, merged, pace, start_delay_s,
+                             write_checkpoint, checkpointing, checkpoint_every, resume_at]() {
+    // Give the frontend a chance to connect before the first trade
+    if (start_delay_s > 0.0) {
+      std::this_thread::sleep_for(std::chrono::duration<double>(start_delay_s));
+    }
+    const std::string& from = merged ? std::string("merged sources") : data_file;
+    if (pace > 0.0) {
+      ENG_LOG_INFO("[Main] Replaying trades from: " << from << " at " << pace << "x");
+    } else {
+      ENG_LOG_INFO("[Main] Replaying trades from: " << from);
+    }
+    bool checkpoints = checkpointing;
+    size_t position = resume_at;
+    TradeHook hook;
+    if (checkpoints) {
+      hook = [&](const eng::TradePrint&) {
+        if (++position % checkpoint_every == 0 && checkpoints) checkpoints = write_checkpoint(position);
+      };
+    }
+    size_t trades_replayed = replay_fn(data_file, pace, resume_at, hook);
+    ENG_LOG_INFO("[Main] Replayed " << trades_replayed - std::min(trades_replayed, resume_at) << " trades."
+                 << (resume_at > 0 ? " (resumed after trade " + std::to_string(resume_at) + ")" : std::string()));
+    // Interrupted: main's shutdown flushes the candles; don't race it
+    if (shutdown_requested) return;
+    if (checkpoints && trades_replayed % checkpoint_every != 0) write_checkpoint(trades_replayed);
+    const auto ticks = tick_store->stats();
+    ENG_LOG_INFO("[Main] Tick store: " << ticks.ticks << " trades in " << ticks.chunks << " chunks ("
+                 << ticks.bytes / (1024 * 1024) << "MB, " << ticks.evicted_chunks << " evicted)");
+
+    // With --async-bus / --strategy-cpus, let the subscriber queues drain before flushing
+    engine_ptr->wait_idle();
+    for (const auto& q : engine_ptr->get_bus().queue_stats()) {
+      ENG_LOG_INFO("[Main] Bus queue " << q.name << ": processed=" << q.processed
+                   << " dropped=" << q.dropped << " max_depth=" << q.max_depth
+                   << "/" << q.capacity);
+    }
     
     // Flush all pending candles to database after replay completes
     // This ensures deterministic behavior: all replay data is persisted before queries begin
-    std::cout << "[Main] Replay complete. Flushing all pending candles to database...\n";
+    ENG_LOG_INFO("[Main] Replay complete. Flushing all pending candles to database...");
+    bars_ptr->flush();
     persister_ptr->flush_pending_data();
-    std::cout << "[Main] All candles flushed. Engine staying open - press Ctrl+C to exit.\n";
+    for (const auto& m : eng::Metrics::instance().snapshot()) {
+      ENG_LOG_INFO("[Main] Latency " << m.stage << ": n=" << m.latency_ns.count
+                   << " p50=" << m.latency_ns.p50 << "ns p99=" << m.latency_ns.p99
+                   << "ns p99.9=" << m.latency_ns.p999 << "ns max=" << m.latency_ns.max << "ns");
+    }
+    ENG_LOG_INFO("[Main] All candles flushed. Engine staying open - press Ctrl+C to exit.");
   });
   replay_thread.detach();
 
@@ -147,16 +657,22 @@ int main(int argc, char* argv[]) {
   engine->run();
 
   // 7. Engine completed; stop components in reverse order and shut down cleanly
-  std::cout << "\n[Main] Engine run complete. Stopping components...\n";
+  ENG_LOG_INFO("\n[Main] Engine run complete. Stopping components...");
+  if (live_feed) live_feed->stop();
   
-  // Stop candle persister to flush final pending candles
+  // Join bus workers first so no handler runs while components shut down
+  engine->get_bus().stop_async();
+
+  // Stop the bar builder, then the persister, to flush final pending candles
+  bars->stop();
   persister->stop();
-  std::cout << "[Main] Candle persister stopped.\n";
+  ENG_LOG_INFO("[Main] Candle persister stopped.");
   
   // Stop WebSocket bridge
   bridge->stop();
-  std::cout << "[Main] WebSocket server stopped.\n";
+  ENG_LOG_INFO("[Main] WebSocket server stopped.");
   
-  std::cout << "[Main] Cleanup complete. Exiting.\n";
+  ENG_LOG_INFO("[Main] Cleanup complete. Exiting.");
+  eng::Logger::instance().flush();
   return 0;
 }
@@ -0,0 +1,122 @@
+// MovingAveragePlugin.cpp
+//
+// MovingAverageStrategy's rule as a loadable plugin, and the reference for
+// writing one: C ABI only (plugins/PluginApi.h), no engine library linked.
+//
+//   trading_engine --strategy-plugin plugins/moving_average_plugin.so
+//                  --strategy-config window=20,threshold=2.5 ...
+//
+// Config keys: window (default 5), threshold (default 1.0).
+
+#include "plugins/PluginApi.h"
+#include "strategies/Indicators.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+namespace {
+
+struct MovingAverage {
+    std::string symbol;
+    uint64_t instrument_id{0};
+    double threshold{1.0};
+    strategy::indicators::Sma sma;
+    int32_t action{ENG_ACTION_NONE};
+    double bought{0.0};
+    double sold{0.0};
+
+    MovingAverage(const char* sym, size_t window, double thr) : symbol(sym), threshold(thr), sma(window) {}
+
+    // Same id-then-string matching as MovingAverageStrategy
+    bool ours(const eng_price_tick& t) {
+        if (t.instrument_id != 0) {
+            if (instrument_id != 0) return t.instrument_id == instrument_id;
+            if (symbol != t.symbol) return false;
+            instrument_id = t.instrument_id;
+            return true;
+        }
+        return symbol == t.symbol;
+    }
+
+    void tick(const eng_price_tick& t) {
+        if (!ours(t)) return;
+        const double avg = sma.update(t.last);
+        if (t.last > avg + threshold) action = ENG_ACTION_BUY;
+        else if (t.last < avg - threshold) action = ENG_ACTION_SELL;
+        else action = ENG_ACTION_NONE;
+    }
+};
+
+// "window=5,threshold=1.0"; false on an unknown key or bad number
+bool parse_config(const char* config, size_t& window, double& threshold) {
+    std::string s = config ? config : "";
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) comma = s.size();
+        const std::string item = s.substr(pos, comma - pos);
+        pos = comma + 1;
+        if (item.empty()) continue;
+
+        const size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        const std::string key = item.substr(0, eq);
+        const char* value = item.c_str() + eq + 1;
+        char* end = nullptr;
+        if (key == "window") window = std::strtoul(value, &end, 10);
+        else if (key == "threshold") threshold = std::strtod(value, &end);
+        else return false;
+        if (end == value || *end != '\0') return false;
+    }
+    return window > 0;
+}
+
+void* create(const char* symbol, const char* config) {
+    size_t window = 5;
+    double threshold = 1.0;
+    if (!parse_config(config, window, threshold)) return nullptr;
+    return new (std::nothrow) MovingAverage(symbol ? symbol : "", window, threshold);
+}
+
+void destroy(void* self) { delete static_cast<MovingAverage*>(self); }
+
+void on_price_tick(void* self, const eng_price_tick* tick) { static_cast<MovingAverage*>(self)->tick(*tick); }
+
+int32_t get_trade_action(void* self) { return static_cast<MovingAverage*>(self)->action; }
+
+void on_order_fill(void* self, const eng_order* order) {
+    auto* s = static_cast<MovingAverage*>(self);
+    (order->side == ENG_SIDE_BUY ? s->bought : s->sold) += order->qty;
+    s->action = ENG_ACTION_NONE;
+}
+
+double get_net_position(void* self) {
+    auto* s = static_cast<MovingAverage*>(self);
+    return s->bought - s->sold;
+}
+
+size_t on_price_ticks(void* self, const eng_price_tick* ticks, size_t n, int32_t* action) {
+    auto* s = static_cast<MovingAverage*>(self);
+    *action = ENG_ACTION_NONE;
+    for (size_t i = 0; i < n; ++i) {
+        s->tick(ticks[i]);
+        if (s->action != ENG_ACTION_NONE) {
+            *action = s->action;
+            return i + 1;
+        }
+    }
+    return n;
+}
+
+const eng_strategy_api kStrategy = {
+    create, destroy, on_price_tick, get_trade_action, on_order_fill, get_net_position, on_price_ticks,
+};
+
+const eng_plugin_descriptor kDescriptor = {ENG_PLUGIN_ABI_VERSION, "MovingAverage", &kStrategy, nullptr};
+
+}  // namespace
+
+extern "C" ENG_PLUGIN_EXPORT const eng_plugin_descriptor* eng_plugin_entry(void) {
+    return &kDescriptor;
+}
@@ -1,5 +1,244 @@
 // PluginLoader.cpp
 
 #include "plugins/PluginLoader.hpp"
+#include "engine/Logger.hpp"
+#include <dlfcn.h>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
 
-// TODO: implement
+struct PluginLoader::Library {
+    std::string path;
+    void* handle{nullptr};
+    const eng_plugin_descriptor* descriptor{nullptr};
+
+    ~Library() {
+        if (handle) dlclose(handle);
+    }
+};
+
+namespace {
+
+int64_t to_ns(eng::TimePoint tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+eng::TimePoint from_ns(int64_t ns) {
+    return eng::TimePoint(std::chrono::duration_cast<eng::TimePoint::duration>(std::chrono::nanoseconds(ns)));
+}
+
+// Points into `order`; valid while it is
+eng_order to_c(const eng::Order& order) {
+    eng_order out{};
+    out.id = order.id;
+    out.symbol = order.symbol.c_str();
+    out.qty = order.qty;
+    out.filled_qty = order.filled_qty;
+    out.fill_price = order.fill_price;
+    out.side = order.side == eng::Order::Side::Buy ? ENG_SIDE_BUY : ENG_SIDE_SELL;
+    out.status = static_cast<int32_t>(order.status);
+    out.timestamp_ns = to_ns(order.timestamp);
+    out.instrument_id = order.instrument_id;
+    out.rejection_reason = order.rejection_reason.c_str();
+    return out;
+}
+
+eng::Order from_c(const eng_order& order) {
+    eng::Order out;
+    out.id = order.id;
+    out.symbol = order.symbol ? order.symbol : "";
+    out.qty = order.qty;
+    out.filled_qty = order.filled_qty;
+    out.fill_price = order.fill_price;
+    out.side = order.side == ENG_SIDE_SELL ? eng::Order::Side::Sell : eng::Order::Side::Buy;
+    out.status = static_cast<eng::OrderStatus>(order.status);
+    out.rejection_reason = order.rejection_reason ? order.rejection_reason : "";
+    out.timestamp = from_ns(order.timestamp_ns);
+    out.instrument_id = order.instrument_id;
+    return out;
+}
+
+eng::TradeAction to_action(int32_t action) {
+    switch (action) {
+        case ENG_ACTION_BUY: return eng::TradeAction::Buy;
+        case ENG_ACTION_SELL: return eng::TradeAction::Sell;
+        default: return eng::TradeAction::None;
+    }
+}
+
+class PluginStrategy : public eng::IStrategy {
+public:
+    PluginStrategy(std::shared_ptr<PluginLoader::Library> library, const eng_strategy_api* api, void* self)
+      : library_(std::move(library)), api_(api), self_(self) {}
+
+    ~PluginStrategy() override { api_->destroy(self_); }
+
+    void on_price_tick(const eng::PriceData& pd) override {
+        // pd.symbol views a Tick's std::string, so it is NUL-terminated
+        const eng_price_tick tick{pd.symbol.data(), pd.last, pd.instrument_id};
+        api_->on_price_tick(self_, &tick);
+    }
+
+    eng::TradeAction get_trade_action() override { return to_action(api_->get_trade_action(self_)); }
+
+    void on_order_fill(const eng::Order& order) override {
+        const eng_order fill = to_c(order);
+        api_->on_order_fill(self_, &fill);
+    }
+
+    double get_net_position() const override {
+        return api_->get_net_position ? api_->get_net_position(self_) : 0.0;
+    }
+
+    size_t on_price_ticks(const eng::PriceData* ticks, size_t n, eng::TradeAction& action) override {
+        if (!api_->on_price_ticks) return IStrategy::on_price_ticks(ticks, n, action);
+
+        // The span crosses in one call; the scratch buffer is reused
+        batch_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            batch_[i] = eng_price_tick{ticks[i].symbol.data(), ticks[i].last, ticks[i].instrument_id};
+        }
+        int32_t raw = ENG_ACTION_NONE;
+        const size_t consumed = api_->on_price_ticks(self_, batch_.data(), n, &raw);
+        action = to_action(raw);
+        return consumed;
+    }
+
+private:
+    std::shared_ptr<PluginLoader::Library> library_;   // Outlives self_
+    const eng_strategy_api* api_;
+    void* self_;
+    std::vector<eng_price_tick> batch_;
+};
+
+class PluginBroker : public eng::IBroker {
+public:
+    PluginBroker(std::shared_ptr<PluginLoader::Library> library, const eng_broker_api* api, void* self)
+      : library_(std::move(library)), api_(api), self_(self) {}
+
+    ~PluginBroker() override { api_->destroy(self_); }
+
+    void place_order(const eng::Order& order) override {
+        const eng_order o = to_c(order);
+        api_->place_order(self_, &o);
+    }
+
+    double place_market_order(const eng::Order& order) override {
+        const eng_order o = to_c(order);
+        if (api_->place_market_order) return api_->place_market_order(self_, &o);
+        // Only place_order exported: it takes the order, fills come back
+        // through the fill callback
+        api_->place_order(self_, &o);
+        return 0.0;
+    }
+
+    double place_limit_order(const eng::Order& order, double limit_price, eng::TimePoint event_time) override {
+        const eng_order o = to_c(order);
+        return api_->place_limit_order(self_, &o, limit_price, to_ns(event_time));   // Required by load()
+    }
+
+    void set_fill_handler(FillHandler handler) override {
+        fill_handler_ = std::move(handler);
+        if (api_->set_fill_callback) api_->set_fill_callback(self_, &PluginBroker::on_fill, this);
+    }
+
+    void on_market_tick(const eng::Tick& tick) override {
+        if (!api_->on_market_tick) return;
+        const eng_market_tick t{tick.symbol.c_str(), tick.last, tick.instrument_id, tick.qty,
+                                static_cast<int32_t>(tick.side), to_ns(tick.ts)};
+        api_->on_market_tick(self_, &t);
+    }
+
+    double get_balance() override { return api_->get_balance(self_); }
+
+    eng::PriceQuote get_current_price(const std::string& symbol) override {
+        return eng::PriceQuote{symbol, api_->get_current_price(self_, symbol.c_str()), 0};
+    }
+
+private:
+    std::shared_ptr<PluginLoader::Library> library_;
+    const eng_broker_api* api_;
+    void* self_;
+    FillHandler fill_handler_;
+
+    static void on_fill(void* ctx, const eng_order* fill) {
+        auto* broker = static_cast<PluginBroker*>(ctx);
+        if (broker->fill_handler_ && fill) broker->fill_handler_(from_c(*fill));
+    }
+};
+
+}  // namespace
+
+PluginLoader& PluginLoader::instance() {
+    static PluginLoader loader;
+    return loader;
+}
+
+std::shared_ptr<PluginLoader::Library> PluginLoader::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto open = libraries_[path].lock()) return open;
+
+    auto library = std::make_shared<Library>();
+    library->path = path;
+    // Local: two variants of one plugin must not resolve each other's symbols
+    library->handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!library->handle) {
+        const char* err = dlerror();
+        throw std::runtime_error("Failed to load plugin " + path + ": " + (err ? err : "unknown error"));
+    }
+
+    auto entry = reinterpret_cast<eng_plugin_entry_fn>(dlsym(library->handle, ENG_PLUGIN_ENTRY_SYMBOL));
+    if (!entry) {
+        throw std::runtime_error("Plugin " + path + " has no " ENG_PLUGIN_ENTRY_SYMBOL " entry point");
+    }
+    library->descriptor = entry();
+    if (!library->descriptor || library->descriptor->abi_version != ENG_PLUGIN_ABI_VERSION) {
+        throw std::runtime_error("Plugin " + path + " was built for plugin ABI v" +
+                                 std::to_string(library->descriptor ? library->descriptor->abi_version : 0) +
+                                 ", this engine speaks v" + std::to_string(ENG_PLUGIN_ABI_VERSION));
+    }
+
+    ENG_LOG_INFO("[PluginLoader] Loaded " << (library->descriptor->name ? library->descriptor->name : "plugin")
+                 << " from " << path);
+    libraries_[path] = library;
+    return library;
+}
+
+template<>
+std::unique_ptr<eng::IStrategy> PluginLoader::load<eng::IStrategy>(const std::string& path,
+                                                                   const std::string& config,
+                                                                   const std::string& symbol) {
+    auto library = open(path);
+    const eng_strategy_api* api = library->descriptor->strategy;
+    if (!api || !api->create || !api->destroy || !api->on_price_tick || !api->get_trade_action ||
+        !api->on_order_fill) {
+        throw std::runtime_error("Plugin " + path + " provides no strategy");
+    }
+    void* self = api->create(symbol.c_str(), config.c_str());
+    if (!self) {
+        throw std::runtime_error("Plugin " + path + " rejected strategy config \"" + config + "\"");
+    }
+    return std::make_unique<PluginStrategy>(std::move(library), api, self);
+}
+
+template<>
+std::unique_ptr<eng::IBroker> PluginLoader::load<eng::IBroker>(const std::string& path,
+                                                               const std::string& config,
+                                                               const std::string& /*symbol*/) {
+    auto library = open(path);
+    const eng_broker_api* api = library->descriptor->broker;
+    if (!api || !api->create || !api->destroy || !api->place_order || !api->get_balance ||
+        !api->get_current_price) {
+        throw std::runtime_error("Plugin " + path + " provides no broker");
+    }
+    // The engine trades through limit orders, and eng_order has no price to
+    // send one through place_order with
+    if (!api->place_limit_order) {
+        throw std::runtime_error("Plugin " + path + " broker has no place_limit_order");
+    }
+    void* self = api->create(config.c_str());
+    if (!self) {
+        throw std::runtime_error("Plugin " + path + " rejected broker config \"" + config + "\"");
+    }
+    return std::make_unique<PluginBroker>(std::move(library), api, self);
+}
@@ -1,25 +1,108 @@
 #include "server/FrontendBridge.hpp"
-#include <iostream>
+#include "server/CandleEncoding.hpp"
+#include "engine/Logger.hpp"
+#include "engine/Metrics.hpp"
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
 
 namespace server {
 
+namespace {
+
+long long to_ms(eng::TimePoint tp) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+}
+
+// A bar in the 'json' response encoding
+json bar_to_json(const std::string& symbol, long long ms, double open, double high,
+                 double low, double close, double volume) {
+  json candle_json;
+  candle_json["symbol"] = symbol;
+  candle_json["open"] = open;
+  candle_json["high"] = high;
+  candle_json["low"] = low;
+  candle_json["close"] = close;
+  candle_json["volume"] = volume;
+
+  // Timestamps
+  std::time_t tp = static_cast<std::time_t>(ms / 1000);
+  std::ostringstream oss;
+  oss << std::put_time(std::gmtime(&tp), "%Y-%m-%dT%H:%M:%SZ");
+  candle_json["openTime"] = oss.str();
+  candle_json["ms"] = ms;
+  return candle_json;
+}
+
+json candle_to_json(const eng::Candle& candle) {
+  return bar_to_json(candle.symbol, to_ms(candle.open_time), candle.open, candle.high,
+                     candle.low, candle.close, candle.volume);
+}
+
+// 'json' encoding of bars, gaps filled on the fly unless sparse
+json bars_to_json(const std::vector<eng::Candle>& bars, const std::string& symbol,
+                  long long bucket_ms, bool sparse) {
+  json out = json::array();
+  for_each_bar(bars, bucket_ms, !sparse,
+               [&](long long ms, double o, double h, double l, double c, double v) {
+    out.push_back(bar_to_json(symbol, ms, o, h, l, c, v));
+  });
+  return out;
+}
+
+// The stored form of an order event (typed columns, no JSON)
+eng::StoredEvent order_event(const char* event_type, const eng::Order& order) {
+  eng::StoredEvent event;
+  event.event_type = event_type;
+  event.timestamp_ms = to_ms(order.timestamp);
+  event.symbol = order.symbol;
+  event.source = "backtest";
+  event.order_id = order.id;
+  event.side = (order.side == eng::Order::Side::Buy) ? "Buy" : "Sell";
+  return event;
+}
+
+// The `data` object QueryEvents has always returned, rebuilt from the columns
+json event_data_json(const eng::StoredEvent& event) {
+  json data;
+  data["orderId"] = event.order_id;
+  data["symbol"] = event.symbol;
+  if (event.event_type == "OrderFilled") {
+    data["filledQty"] = event.qty;
+    data["fillPrice"] = event.price;
+  } else {
+    data["qty"] = event.qty;
+  }
+  if (!event.side.empty()) data["side"] = event.side;
+  if (!event.status.empty()) data["status"] = event.status;
+  if (event.extra.is_object()) data.update(event.extra);
+  return data;
+}
+
+}  // namespace
+
 FrontendBridge::FrontendBridge(eng::EventBus& bus, eng::IBroker& broker, int port)
     : bus_(bus), broker_(broker), port_(port) {
   // Initialize persistent candle store (shared with CandlePersister)
   eng::CandleStoreConfig config;
   config.db_path = "backtest.db";
-  config.candle_buffer_size = 100;  // Smaller buffer for frequent flushes (live-ready)
-  config.event_buffer_size = 100;   // Match candle buffer size
+  // One file per source and day under backtest.db.d/, so a query over an
+  // earlier day doesn't share a file with the run being written
+  config.partition_by_day = true;
+  // Default batch sizes; the store's writer also commits every flush_interval_ms,
+  // which keeps the frontend's view fresh without small transactions
   candle_store_ = std::make_shared<eng::CandleStore>(config);
+
+  query_executor_ = std::make_unique<QueryExecutor>(2);
 }
 
 FrontendBridge::~FrontendBridge() {
+  query_executor_->stop();
+
   // Flush any remaining candles before shutdown
   if (candle_store_) {
-    std::cout << "[FrontendBridge] Destructor: flushing remaining candles\n";
+    ENG_LOG_INFO("[FrontendBridge] Destructor: flushing remaining candles");
     candle_store_->flush_all();
   }
   stop();
@@ -31,46 +114,27 @@ void FrontendBridge::start() {
   // Generate a unique run ID for this session
   current_run_id_ = generate_run_id();
   
-  // Subscribe to ProviderTick events on the bus
-  bus_.subscribe("ProviderTick", [this](const eng::Event& ev) {
-    try {
-      auto tick = std::any_cast<eng::Tick>(ev.data);
-      on_provider_tick(tick);
-    } catch (const std::bad_any_cast&) {
-      std::cerr << "[FrontendBridge] Failed to cast ProviderTick event\n";
-    }
-  });
-
-  // NOTE: ChartCandle persistence is now handled by CandlePersister component
-  // FrontendBridge focuses on query handling and WebSocket communication
-
-  // Subscribe to OrderPlaced events
-  bus_.subscribe("OrderPlaced", [this](const eng::Event& ev) {
-    try {
-      auto order = std::any_cast<eng::Order>(ev.data);
-      on_order_placed(order);
-    } catch (const std::bad_any_cast&) {
-      std::cerr << "[FrontendBridge] Failed to cast OrderPlaced event\n";
-    }
-  });
-
-  // Subscribe to OrderFilled events
-  bus_.subscribe("OrderFilled", [this](const eng::Event& ev) {
-    try {
-      auto order = std::any_cast<eng::Order>(ev.data);
-      on_order_filled(order);
-    } catch (const std::bad_any_cast&) {
-      std::cerr << "[FrontendBridge] Failed to cast OrderFilled event\n";
-    }
-  });
+  // Subscribe to provider ticks on the bus
+  bus_.subscribe<eng::Tick>([this](const eng::Tick& tick) {
+    on_provider_tick(tick);
+  }, async_dispatch_);
+
+  // Live chart bars come from BarBuilder; persistence is CandlePersister's job
+  if (!chart_intervals_.empty()) {
+    bus_.subscribe<eng::Bar>([this](const eng::Bar& bar) {
+      if (std::find(chart_intervals_.begin(), chart_intervals_.end(), bar.interval_ms) != chart_intervals_.end()) {
+        on_chart_bar(bar);
+      }
+    }, async_dispatch_);
+  }
 
-  // Subscribe to OrderRejected events
-  bus_.subscribe("OrderRejected", [this](const eng::Event& ev) {
-    try {
-      auto order = std::any_cast<eng::Order>(ev.data);
-      on_order_rejected(order);
-    } catch (const std::bad_any_cast&) {
-      std::cerr << "[FrontendBridge] Failed to cast OrderRejected event\n";
+  // Order lifecycle from the broker (typed channel: no std::any copy per order)
+  bus_.subscribe<eng::OrderEvent>([this](const eng::OrderEvent& ev) {
+    switch (ev.kind) {
+      case eng::OrderEvent::Kind::Placed: on_order_placed(ev.order); break;
+      case eng::OrderEvent::Kind::Filled: on_order_filled(ev.order); break;
+      case eng::OrderEvent::Kind::Rejected: on_order_rejected(ev.order); break;
+      case eng::OrderEvent::Kind::Canceled: break;   // Not streamed to the frontend yet
     }
   });
 
@@ -79,8 +143,8 @@ void FrontendBridge::start() {
     run_ws_server();
   });
 
-  std::cout << "[FrontendBridge] WebSocket server starting on port " << port_ << "\n";
-  std::cout << "[FrontendBridge] Run ID: " << current_run_id_ << "\n";
+  ENG_LOG_INFO("[FrontendBridge] WebSocket server starting on port " << port_);
+  ENG_LOG_INFO("[FrontendBridge] Run ID: " << current_run_id_);
   
   // Give the WebSocket server a moment to start
   std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -91,6 +155,9 @@ void FrontendBridge::start() {
 
 void FrontendBridge::stop() {
   if (!running_.exchange(false)) return;
+
+  // Drop queued queries and wait for running ones before the server goes away
+  query_executor_->stop();
   
   // Stop the WebSocket server
   {
@@ -100,9 +167,10 @@ void FrontendBridge::stop() {
         ws_server_->stop_listening();
         ws_server_->stop();  // Explicitly stop the ASIO service
       } catch (const std::exception& e) {
-        std::cerr << "[FrontendBridge] Error stopping server: " << e.what() << "\n";
+        ENG_LOG_ERROR("[FrontendBridge] Error stopping server: " << e.what());
       }
       ws_connections_.clear();
+      refresh_client_snapshot();
     }
   }
   
@@ -111,7 +179,7 @@ void FrontendBridge::stop() {
     ws_thread_->join();
   }
   
-  std::cout << "[FrontendBridge] Server stopped\n";
+  ENG_LOG_INFO("[FrontendBridge] Server stopped");
 }
 
 std::vector<json> FrontendBridge::get_recent_ticks(size_t limit) const {
@@ -120,14 +188,17 @@ std::vector<json> FrontendBridge::get_recent_ticks(size_t limit) const {
   size_t count = std::min(limit, recent_ticks_.size());
   auto it = recent_ticks_.rbegin();
   for (size_t i = 0; i < count && it != recent_ticks_.rend(); ++i, ++it) {
-    result.insert(result.begin(), *it);
+    result.insert(result.begin(), json::parse(**it));
   }
   return result;
 }
 
 void FrontendBridge::on_provider_tick(const eng::Tick& tick) {
+  // Live candle subscriptions are built from ticks; sent as coalesced deltas
+  update_candle_subscriptions(tick);
+
   // DISABLED: ProviderTick events are no longer sent to frontend.
-  // The frontend receives only ChartCandle events from the ChartAggregator.
+  // The frontend receives only ChartCandle events built by BarBuilder.
   // This prevents the frontend from being flooded with thousands of individual ticks
   // and reduces network bandwidth by ~1000x in backtest mode.
   //
@@ -144,33 +215,76 @@ void FrontendBridge::on_provider_tick(const eng::Tick& tick) {
   // broadcast_to_clients(msg);
 }
 
+void FrontendBridge::on_chart_bar(const eng::Bar& bar) {
+  const eng::Candle& c = bar.candle;
+  json msg;
+  msg["type"] = "ChartCandle";
+  msg["data"]["symbol"] = c.symbol;
+  msg["data"]["open"] = c.open;
+  msg["data"]["high"] = c.high;
+  msg["data"]["low"] = c.low;
+  msg["data"]["close"] = c.close;
+  msg["data"]["volume"] = c.volume;
+  msg["data"]["resolutionMs"] = bar.interval_ms;
+
+  auto [open_time_iso, ms] = timepoint_to_iso_and_ms(c.open_time);
+  msg["data"]["open_time"] = open_time_iso;
+  msg["data"]["ms"] = ms;
+  broadcast_to_clients(msg);
+}
+
 void FrontendBridge::broadcast_to_clients(const json& msg) {
+  // Serialize once; the recent-message buffer and every client share it
+  auto payload = std::make_shared<const std::string>(msg.dump());
+
   // Store tick in memory queue
   {
     std::lock_guard<std::mutex> lock(ticks_mutex_);
-    recent_ticks_.push_back(msg);
+    recent_ticks_.push_back(payload);
     if (recent_ticks_.size() > MAX_TICKS) {
       recent_ticks_.pop_front();
     }
   }
 
-  // Broadcast to all connected WebSocket clients
+  // Hand the send to the io thread. Posting is O(1) regardless of client
+  // count; ws_mutex_ only keeps ws_server_ alive while we post.
   {
     std::lock_guard<std::mutex> lock(ws_mutex_);
     if (ws_server_) {
-      std::string payload = msg.dump();
-      for (auto& conn : ws_connections_) {
-        try {
-          ws_server_->send(conn, payload, websocketpp::frame::opcode::text);
-        } catch (const std::exception& e) {
-          std::cerr << "[FrontendBridge] Failed to send to client: " << e.what() << "\n";
-        }
+      ws_server_->get_io_service().post([this, payload]() { fan_out(*payload); });
+    }
+  }
+
+  ENG_LOG_TRACE("[WS] " << *payload);
+}
+
+void FrontendBridge::fan_out(const std::string& payload) {
+  std::shared_ptr<const std::vector<connection_ptr>> clients;
+  {
+    std::lock_guard<std::mutex> lock(ws_mutex_);
+    clients = client_snapshot_;
+  }
+
+  for (const auto& conn : *clients) {
+    // Slow client: skip rather than queue without bound
+    if (conn->get_buffered_amount() > max_client_buffered_bytes_) {
+      uint64_t dropped = dropped_broadcasts_.fetch_add(1, std::memory_order_relaxed) + 1;
+      if (dropped % 1000 == 1) {
+        ENG_LOG_WARN("[FrontendBridge] Client send backlog over " << max_client_buffered_bytes_
+                     << " bytes; " << dropped << " broadcasts dropped so far");
       }
+      continue;
+    }
+    auto ec = conn->send(payload.data(), payload.size(), websocketpp::frame::opcode::text);
+    if (ec) {
+      ENG_LOG_ERROR("[FrontendBridge] Failed to send to client: " << ec.message());
     }
   }
+}
 
-  // Log to stdout for debugging
-  std::cout << "[WS] " << msg.dump() << "\n";
+void FrontendBridge::refresh_client_snapshot() {
+  client_snapshot_ = std::make_shared<const std::vector<connection_ptr>>(
+      ws_connections_.begin(), ws_connections_.end());
 }
 
 // Helper: convert TimePoint to both ISO8601 string and millisecond epoch
@@ -204,7 +318,7 @@ void FrontendBridge::emit_run_start() {
 
   // Flush any buffered candles from the previous run
   if (candle_store_) {
-    std::cout << "[FrontendBridge] Flushing candle store for new run\n";
+    ENG_LOG_INFO("[FrontendBridge] Flushing candle store for new run");
     candle_store_->flush_all();
   }
 
@@ -221,7 +335,7 @@ void FrontendBridge::emit_run_start() {
   // Include the starting balance from the broker
   double starting_balance = broker_.get_balance();
   run_start["data"]["startingBalance"] = starting_balance;
-  std::cout << "[FrontendBridge] Emitting RunStart with starting balance: " << starting_balance << "\n";
+  ENG_LOG_INFO("[FrontendBridge] Emitting RunStart with starting balance: " << starting_balance);
   
   broadcast_to_clients(run_start);
 }
@@ -242,7 +356,8 @@ void FrontendBridge::run_ws_server() {
       std::lock_guard<std::mutex> lock(ws_mutex_);
       auto conn = ws_server_->get_con_from_hdl(hdl);
       ws_connections_.insert(conn);
-      std::cout << "[FrontendBridge] Client connected. Total clients: " << ws_connections_.size() << "\n";
+      refresh_client_snapshot();
+      ENG_LOG_INFO("[FrontendBridge] Client connected. Total clients: " << ws_connections_.size());
       
       // Send current run ID so client knows which run it's in
       json run_start;
@@ -258,13 +373,17 @@ void FrontendBridge::run_ws_server() {
       try {
         ws_server_->send(hdl, run_start.dump(), websocketpp::frame::opcode::text);
       } catch (const std::exception& e) {
-        std::cerr << "[FrontendBridge] Failed to send RunStart on connection: " << e.what() << "\n";
+        ENG_LOG_ERROR("[FrontendBridge] Failed to send RunStart on connection: " << e.what());
       }
       // Don't send historical ticks - only forward new ticks from this point on
     });
 
     // Handle client disconnect
     server->set_close_handler([this](websocketpp::connection_hdl hdl) {
+      // Nobody is left to read this client's results
+      query_executor_->cancel_client(hdl.lock().get());
+      remove_client_subscriptions(hdl.lock().get());
+
       std::lock_guard<std::mutex> lock(ws_mutex_);
       auto it = ws_connections_.begin();
       while (it != ws_connections_.end()) {
@@ -274,18 +393,19 @@ void FrontendBridge::run_ws_server() {
           ++it;
         }
       }
-      std::cout << "[FrontendBridge] Client disconnected. Total clients: " << ws_connections_.size() << "\n";
+      refresh_client_snapshot();
+      ENG_LOG_INFO("[FrontendBridge] Client disconnected. Total clients: " << ws_connections_.size());
     });
 
     // Handle incoming messages (e.g., "clear" command, queries)
     server->set_message_handler([this](websocketpp::connection_hdl hdl, WebSocketServerType::message_ptr msg) {
-      std::cout << "[FrontendBridge set_message_handler] Received message from client: " << msg->get_payload() << "\n";
+      ENG_LOG_DEBUG("[FrontendBridge set_message_handler] Received message from client: " << msg->get_payload());
       try {
         std::string payload = msg->get_payload();
         json command = json::parse(payload);
         
         if (command.contains("command") && command["command"] == "clear") {
-          std::cout << "[FrontendBridge] Clear command received from client\n";
+          ENG_LOG_INFO("[FrontendBridge] Clear command received from client");
           // Generate a new run ID and emit RunStart to signal chart clear
           current_run_id_ = generate_run_id();
           emit_run_start();
@@ -293,16 +413,18 @@ void FrontendBridge::run_ws_server() {
           // Route all Query messages to handler dispatcher
           std::string cmd_type = command["type"].get<std::string>();
           if (cmd_type == "QueryCandles" || cmd_type == "QueryEvents" || cmd_type == "QueryBalance" || 
-              cmd_type == "QueryPositions" || cmd_type == "QueryOrders" || cmd_type == "QueryDefaultViewport") {
+              cmd_type == "QueryPositions" || cmd_type == "QueryOrders" || cmd_type == "QueryDefaultViewport" ||
+              cmd_type == "QueryMetrics" || cmd_type == "CancelQuery" ||
+              cmd_type == "SubscribeCandles" || cmd_type == "UnsubscribeCandles") {
             handle_ws_message(hdl, command);
           } else {
-            std::cerr << "[FrontendBridge] Unknown command type received from client: " << cmd_type << "\n";
+            ENG_LOG_WARN("[FrontendBridge] Unknown command type received from client: " << cmd_type);
           }
         } else {
-          std::cerr << "[FrontendBridge] Malformed command received: missing 'command' and 'type' fields\n";
+          ENG_LOG_WARN("[FrontendBridge] Malformed command received: missing 'command' and 'type' fields");
         }
       } catch (const std::exception& e) {
-        std::cerr << "[FrontendBridge] Failed to parse incoming message: " << e.what() << "\n";
+        ENG_LOG_ERROR("[FrontendBridge] Failed to parse incoming message: " << e.what());
       }
     });
 
@@ -316,7 +438,10 @@ void FrontendBridge::run_ws_server() {
       ws_server_ = std::move(server);
     }
 
-    std::cout << "[FrontendBridge] WebSocket listening on ws://localhost:" << port_ << "\n";
+    ENG_LOG_INFO("[FrontendBridge] WebSocket listening on ws://localhost:" << port_);
+
+    // Candle subscription deltas go out from a timer on the io thread
+    schedule_delta_timer();
 
     // Run the server (blocks until stop_listening() is called)
     ws_server_->run();
@@ -326,27 +451,21 @@ void FrontendBridge::run_ws_server() {
       std::lock_guard<std::mutex> lock(ws_mutex_);
       ws_server_ = nullptr;
       ws_connections_.clear();
+      refresh_client_snapshot();
     }
 
   } catch (const std::exception& e) {
-    std::cerr << "[FrontendBridge] WebSocket server error: " << e.what() << "\n";
+    ENG_LOG_ERROR("[FrontendBridge] WebSocket server error: " << e.what());
   }
 }
 
 void FrontendBridge::on_order_placed(const eng::Order& order) {
   // Store in persistent database
   if (candle_store_) {
-    json event_data;
-    event_data["orderId"] = order.id;
-    event_data["symbol"] = order.symbol;
-    event_data["qty"] = order.qty;
-    event_data["side"] = (order.side == eng::Order::Side::Buy) ? "Buy" : "Sell";
-    event_data["status"] = eng::order_status_to_string(order.status);
-    
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        order.timestamp.time_since_epoch()).count();
-    
-    candle_store_->add_event("OrderPlaced", ms, order.symbol, "backtest", event_data);
+    auto event = order_event("OrderPlaced", order);
+    event.qty = order.qty;
+    event.status = eng::order_status_to_string(order.status);
+    candle_store_->add_event(std::move(event));
   }
 
   json msg;
@@ -368,21 +487,13 @@ void FrontendBridge::on_order_placed(const eng::Order& order) {
 void FrontendBridge::on_order_filled(const eng::Order& order) {
   // Store in persistent database
   if (candle_store_) {
-    json event_data;
-    event_data["orderId"] = order.id;
-    event_data["symbol"] = order.symbol;
-    event_data["filledQty"] = order.filled_qty;
-    event_data["fillPrice"] = order.fill_price;
-    event_data["side"] = (order.side == eng::Order::Side::Buy) ? "Buy" : "Sell";
-    event_data["status"] = eng::order_status_to_string(order.status);
-    
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        order.timestamp.time_since_epoch()).count();
-    
-    candle_store_->add_event("OrderFilled", ms, order.symbol, "backtest", event_data);
-    
-    // Flush immediately on order fills so frontend sees trades
-    candle_store_->flush_all();
+    auto event = order_event("OrderFilled", order);
+    event.qty = order.filled_qty;
+    event.price = order.fill_price;
+    event.status = eng::order_status_to_string(order.status);
+    // No explicit flush: this runs inside the broker's fill on the strategy
+    // path, and the store's writer commits within flush_interval_ms anyway
+    candle_store_->add_event(std::move(event));
   }
 
   json msg;
@@ -405,17 +516,10 @@ void FrontendBridge::on_order_filled(const eng::Order& order) {
 void FrontendBridge::on_order_rejected(const eng::Order& order) {
   // Store in persistent database
   if (candle_store_) {
-    json event_data;
-    event_data["orderId"] = order.id;
-    event_data["symbol"] = order.symbol;
-    event_data["qty"] = order.qty;
-    event_data["side"] = (order.side == eng::Order::Side::Buy) ? "Buy" : "Sell";
-    event_data["reason"] = order.rejection_reason;
-    
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        order.timestamp.time_since_epoch()).count();
-    
-    candle_store_->add_event("OrderRejected", ms, order.symbol, "backtest", event_data);
+    auto event = order_event("OrderRejected", order);
+    event.qty = order.qty;
+    event.extra["reason"] = order.rejection_reason;
+    candle_store_->add_event(std::move(event));
   }
 
   json msg;
@@ -439,30 +543,75 @@ void FrontendBridge::handle_ws_message(websocketpp::connection_hdl hdl, const js
     std::string request_id = msg.contains("requestId") ? msg["requestId"].get<std::string>() : "";
     std::string msg_type = msg["type"].get<std::string>();
 
-    std::cout << "[FrontendBridge] Received WebSocket message: type=" << msg_type << " requestId=" << request_id << "\n";
-
-    if (msg_type == "QueryCandles") {
-      handle_query_candles(hdl, msg, request_id);
-    } else if (msg_type == "QueryEvents") {
-      handle_query_events(hdl, msg, request_id);
-    } else if (msg_type == "QueryBalance") {
-      handle_query_balance(hdl, request_id);
-    } else if (msg_type == "QueryPositions") {
-      handle_query_positions(hdl, request_id);
-    } else if (msg_type == "QueryOrders") {
-      handle_query_orders(hdl, request_id);
-    } else if (msg_type == "QueryDefaultViewport") {
-      handle_query_default_viewport(hdl, request_id);
-    } else {
-      std::cerr << "[FrontendBridge] Unknown message type: " << msg_type << "\n";
+    ENG_LOG_DEBUG("[FrontendBridge] Received WebSocket message: type=" << msg_type << " requestId=" << request_id);
+
+    const void* client = hdl.lock().get();
+
+    // Cancellation is handled right here on the io thread
+    if (msg_type == "CancelQuery") {
+      bool found = query_executor_->cancel(client, request_id);
+      ENG_LOG_DEBUG("[FrontendBridge] CancelQuery " << request_id << (found ? "" : " (not running)"));
+      return;
     }
+    if (msg_type == "UnsubscribeCandles") {
+      // Drops a backfill still in flight as well
+      query_executor_->cancel(client, request_id);
+      bool found = remove_subscription(client, request_id);
+      ENG_LOG_DEBUG("[FrontendBridge] UnsubscribeCandles " << request_id << (found ? "" : " (not subscribed)"));
+      return;
+    }
+
+    // Everything else runs on the query pool. Reusing a requestId that is
+    // still pending or running supersedes the older request.
+    query_executor_->submit(client, request_id,
+        [this, hdl, msg, request_id, msg_type](const QueryExecutor::CancelToken& token) {
+      if (msg_type == "QueryCandles") {
+        handle_query_candles(hdl, msg, request_id, token);
+      } else if (msg_type == "QueryEvents") {
+        handle_query_events(hdl, msg, request_id, token);
+      } else if (msg_type == "QueryBalance") {
+        handle_query_balance(hdl, request_id);
+      } else if (msg_type == "QueryPositions") {
+        handle_query_positions(hdl, request_id);
+      } else if (msg_type == "QueryOrders") {
+        handle_query_orders(hdl, msg, request_id);
+      } else if (msg_type == "QueryDefaultViewport") {
+        handle_query_default_viewport(hdl, request_id);
+      } else if (msg_type == "QueryMetrics") {
+        handle_query_metrics(hdl, msg, request_id);
+      } else if (msg_type == "SubscribeCandles") {
+        handle_subscribe_candles(hdl, msg, request_id, token);
+      } else {
+        ENG_LOG_WARN("[FrontendBridge] Unknown message type: " << msg_type);
+      }
+    });
   } catch (const std::exception& e) {
-    std::cerr << "[FrontendBridge] Error handling WS message: " << e.what() << "\n";
+    ENG_LOG_ERROR("[FrontendBridge] Error handling WS message: " << e.what());
     // Could send error response here
   }
 }
 
-void FrontendBridge::handle_query_candles(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id) {
+void FrontendBridge::send_response(websocketpp::connection_hdl hdl, std::string payload,
+                                   websocketpp::frame::opcode::value op,
+                                   const QueryExecutor::CancelToken& token) {
+  auto shared = std::make_shared<const std::string>(std::move(payload));
+  std::lock_guard<std::mutex> lock(ws_mutex_);
+  if (!ws_server_) return;
+
+  // ws_server_ outlives every handler it runs, so the raw pointer is safe there
+  WebSocketServerType* server = ws_server_.get();
+  server->get_io_service().post([server, hdl, shared, op, token]() {
+    if (token && token->load()) return;  // Superseded while waiting to be sent
+    websocketpp::lib::error_code ec;
+    server->send(hdl, *shared, op, ec);
+    if (ec) {
+      ENG_LOG_ERROR("[FrontendBridge] Failed to send response: " << ec.message());
+    }
+  });
+}
+
+void FrontendBridge::handle_query_candles(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id,
+                                          const QueryExecutor::CancelToken& token) {
   json response;
   response["type"] = "QueryCandlesResponse";
   response["requestId"] = request_id;
@@ -475,11 +624,22 @@ void FrontendBridge::handle_query_candles(websocketpp::connection_hdl hdl, const
     long long end_ms = query["data"]["endMs"].get<long long>();
     
     // Debug: print incoming query
-    std::cout << "[FrontendBridge] QueryCandles received: " << symbol << " @ " << resolution_ms
-              << "ms [" << start_ms << "-" << end_ms << "]\n";
+    ENG_LOG_DEBUG("[FrontendBridge] QueryCandles received: " << symbol << " @ " << resolution_ms
+                  << "ms [" << start_ms << "-" << end_ms << "]");
     
-    size_t limit = 10000;  // Default limit
-    if (query["data"].contains("limit")) {
+    // Optional compact wire format (see CandleEncoding.hpp)
+    CandleEncoding encoding = CandleEncoding::Json;
+    if (query["data"].contains("encoding")) {
+      encoding = parse_candle_encoding(query["data"]["encoding"].get<std::string>());
+    }
+
+    // Sparse: only buckets with trades; the client fills the gaps
+    const bool sparse = query["data"].value("sparse", false);
+
+    size_t limit = 10000;  // Default max bars
+    if (query["data"].contains("maxPoints")) {
+      limit = query["data"]["maxPoints"].get<size_t>();
+    } else if (query["data"].contains("limit")) {
       limit = query["data"]["limit"].get<size_t>();
     }
 
@@ -487,6 +647,9 @@ void FrontendBridge::handle_query_candles(websocketpp::connection_hdl hdl, const
     if (symbol.empty()) {
       throw std::runtime_error("Symbol is required");
     }
+    if (limit == 0) {
+      throw std::runtime_error("maxPoints must be positive");
+    }
     if (resolution_ms <= 0) {
       throw std::runtime_error("Resolution must be positive");
     }
@@ -494,154 +657,66 @@ void FrontendBridge::handle_query_candles(websocketpp::connection_hdl hdl, const
       throw std::runtime_error("startMs must be less than endMs");
     }
 
-    // ALWAYS query database at 1-second resolution (raw candles)
-    auto raw_candles = candle_store_->query_candles(symbol, 1000, start_ms, end_ms);
-    
-    std::cout << "[FrontendBridge] QueryCandles: Retrieved " << raw_candles.size() 
-              << " raw 1s candles from database\n";
-
-    // Fill gaps in the candle data with forward-filled empty candles
-    std::vector<eng::Candle> filled_candles = raw_candles;
-    if (!filled_candles.empty()) {
-      std::vector<eng::Candle> result_with_gaps;
-      double last_close = filled_candles.front().open;  // Start with first candle's open price
-      
-      for (size_t i = 0; i < filled_candles.size(); ++i) {
-        const auto& current = filled_candles[i];
-        auto current_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            current.open_time.time_since_epoch()).count();
-        
-        // Fill gaps from previous candle (or start_ms for first candle)
-        long long prev_ms = (i == 0) ? current_ms - 1000 : 
-            std::chrono::duration_cast<std::chrono::milliseconds>(
-                filled_candles[i-1].open_time.time_since_epoch()).count();
-        
-        // Create gap-filling candles
-        for (long long gap_ms = prev_ms + 1000; gap_ms < current_ms; gap_ms += 1000) {
-          eng::Candle gap_candle;
-          gap_candle.symbol = symbol;
-          gap_candle.open = last_close;
-          gap_candle.high = last_close;
-          gap_candle.low = last_close;
-          gap_candle.close = last_close;
-          gap_candle.volume = 0.0;
-          gap_candle.open_time = std::chrono::system_clock::time_point(
-              std::chrono::milliseconds(gap_ms));
-          result_with_gaps.push_back(gap_candle);
-        }
-        
-        result_with_gaps.push_back(current);
-        last_close = current.close;  // Update last close for next gap
-      }
-      
-      filled_candles = result_with_gaps;
-      std::cout << "[FrontendBridge] QueryCandles: After gap-filling: " << filled_candles.size() 
-                << " total 1s candles (including " << (filled_candles.size() - raw_candles.size()) 
-                << " gap-fill candles)\n";
-    }
-
-    // Aggregate raw candles to requested resolution
-    std::vector<eng::Candle> aggregated_candles;
-    
-    if (resolution_ms == 1000) {
-      // No aggregation needed, use gap-filled candles as-is
-      aggregated_candles = filled_candles;
-    } else {
-      // Aggregate candles by time buckets
-      std::map<long long, std::vector<eng::Candle>> buckets;
-      
-      for (const auto& candle : filled_candles) {
-        auto candle_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            candle.open_time.time_since_epoch()).count();
-        
-        // Floor timestamp to resolution boundary
-        long long bucket_ms = (candle_ms / resolution_ms) * resolution_ms;
-        buckets[bucket_ms].push_back(candle);
-      }
-      
-      // Build aggregated candles from buckets
-      for (const auto& [bucket_ms, bucket_candles] : buckets) {
-        if (bucket_candles.empty()) continue;
-        
-        eng::Candle agg_candle;
-        agg_candle.symbol = symbol;
-        agg_candle.open = bucket_candles.front().open;
-        agg_candle.close = bucket_candles.back().close;
-        agg_candle.high = bucket_candles.front().high;
-        agg_candle.low = bucket_candles.front().low;
-        agg_candle.volume = 0.0;
-        
-        // Calculate high, low, volume
-        for (const auto& c : bucket_candles) {
-          if (c.high > agg_candle.high) agg_candle.high = c.high;
-          if (c.low < agg_candle.low) agg_candle.low = c.low;
-          agg_candle.volume += c.volume;
-        }
-        
-        // Set timestamp to bucket start
-        agg_candle.open_time = std::chrono::system_clock::time_point(
-            std::chrono::milliseconds(bucket_ms));
-        
-        aggregated_candles.push_back(agg_candle);
-      }
-      
-      // Sort by time (should already be sorted, but ensure it)
-      std::sort(aggregated_candles.begin(), aggregated_candles.end(),
-                [](const eng::Candle& a, const eng::Candle& b) {
-                  return a.open_time < b.open_time;
-                });
+    // Let the store pick the bar width: the requested resolution, widened
+    // just enough to keep the bar count within the limit. Bars are built in
+    // one pass over the coarsest stored rollup tier that divides that width,
+    // so wide viewports cost what they return and the newest bars are kept.
+    auto result = candle_store_->query_candles_downsampled(symbol, resolution_ms, start_ms, end_ms, limit, token.get());
+    if (result.cancelled || token->load()) {
+      ENG_LOG_DEBUG("[FrontendBridge] QueryCandles " << request_id << " cancelled after "
+                    << result.rows_scanned << " rows");
+      return;
     }
+    const long long bucket_ms = result.bucket_ms;
     
-    std::cout << "[FrontendBridge] QueryCandles: Aggregated to " << aggregated_candles.size() << " candles\n";
+    ENG_LOG_DEBUG("[FrontendBridge] QueryCandles: Built " << result.candles.size() << " "
+                  << bucket_ms << "ms bars from " << result.rows_scanned << " "
+                  << result.source_resolution_ms << "ms candles");
 
-    // Check if results exceed limit
+    // Gaps between bars are filled with flat bars by the encoders as they
+    // write, not stored here
+    const auto& bars = result.candles;
+    const size_t bar_total = bar_count(bars, bucket_ms, !sparse);
+
+    ENG_LOG_DEBUG("[FrontendBridge] QueryCandles: " << bar_total << " bars "
+                  << (sparse ? "(sparse)" : "after gap-filling")
+                  << (result.downsampled ? " (downsampled)" : ""));
+
+    // Bars are widened instead of dropped, so nothing is cut off
     bool is_truncated = false;
-    if (aggregated_candles.size() > limit) {
-      is_truncated = true;
-      aggregated_candles.erase(aggregated_candles.begin() + limit, aggregated_candles.end());
+
+    // Binary frames carry their own header; nothing else to build
+    if (encoding == CandleEncoding::Binary) {
+      std::string frame = encode_candles_binary(request_id, symbol, bucket_ms, resolution_ms,
+                                                result.downsampled, bars, sparse);
+      ENG_LOG_DEBUG("[FrontendBridge] QueryCandlesResponse sent (binary): " << bar_total
+                    << " candles, " << frame.size() << " bytes");
+      send_response(hdl, std::move(frame), websocketpp::frame::opcode::binary, token);
+      return;
     }
 
     // Build response
     response["data"]["symbol"] = symbol;
-    response["data"]["resolutionMs"] = resolution_ms;
-    response["data"]["candles"] = json::array();
-    response["data"]["count"] = aggregated_candles.size();
+    response["data"]["resolutionMs"] = bucket_ms;
+    response["data"]["requestedResolutionMs"] = resolution_ms;
+    response["data"]["downsampled"] = result.downsampled;
+    response["data"]["count"] = bar_total;
     response["data"]["isTruncated"] = is_truncated;
+    if (sparse) response["data"]["sparse"] = true;
 
-    for (const auto& candle : aggregated_candles) {
-      json candle_json;
-      candle_json["symbol"] = candle.symbol;
-      candle_json["open"] = candle.open;
-      candle_json["high"] = candle.high;
-      candle_json["low"] = candle.low;
-      candle_json["close"] = candle.close;
-      candle_json["volume"] = candle.volume;
-      
-      // Timestamps
-      auto tp = std::chrono::system_clock::to_time_t(candle.open_time);
-      std::ostringstream oss;
-      oss << std::put_time(std::gmtime(&tp), "%Y-%m-%dT%H:%M:%SZ");
-      candle_json["openTime"] = oss.str();
-      
-      auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-          candle.open_time.time_since_epoch()).count();
-      candle_json["ms"] = ms;
-
-      response["data"]["candles"].push_back(candle_json);
+    if (encoding == CandleEncoding::Columnar) {
+      response["data"]["encoding"] = "columnar";
+      response["data"]["columns"] = encode_candles_columnar(bars, bucket_ms, !sparse);
+    } else {
+      response["data"]["candles"] = bars_to_json(bars, symbol, bucket_ms, sparse);
     }
 
     // Send response to THIS client only
     {
-      std::lock_guard<std::mutex> lock(ws_mutex_);
-      if (ws_server_) {
-        try {
-          ws_server_->send(hdl, response.dump(), websocketpp::frame::opcode::text);
-          std::cout << "[FrontendBridge] QueryCandlesResponse sent: " << aggregated_candles.size()
-                    << " candles (truncated: " << is_truncated << ")\n";
-        } catch (const std::exception& e) {
-          std::cerr << "[FrontendBridge] Failed to send candles response: " << e.what() << "\n";
-        }
-      }
+      std::string payload = response.dump();
+      ENG_LOG_DEBUG("[FrontendBridge] QueryCandlesResponse sent: " << bar_total
+                    << " candles, " << payload.size() << " bytes (truncated: " << is_truncated << ")");
+      send_response(hdl, std::move(payload), websocketpp::frame::opcode::text, token);
     }
 
   } catch (const std::exception& e) {
@@ -650,22 +725,14 @@ void FrontendBridge::handle_query_candles(websocketpp::connection_hdl hdl, const
     response["data"]["errorCode"] = "QUERY_ERROR";
     response["data"]["errorMessage"] = e.what();
 
-    {
-      std::lock_guard<std::mutex> lock(ws_mutex_);
-      if (ws_server_) {
-        try {
-          ws_server_->send(hdl, response.dump(), websocketpp::frame::opcode::text);
-        } catch (const std::exception& e) {
-          std::cerr << "[FrontendBridge] Failed to send error response: " << e.what() << "\n";
-        }
-      }
-    }
+    send_response(hdl, response.dump(), websocketpp::frame::opcode::text, token);
 
-    std::cerr << "[FrontendBridge] QueryCandles error: " << e.what() << "\n";
+    ENG_LOG_ERROR("[FrontendBridge] QueryCandles error: " << e.what());
   }
 }
 
-void FrontendBridge::handle_query_events(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id) {
+void FrontendBridge::handle_query_events(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id,
+                                         const QueryExecutor::CancelToken& token) {
   json response;
   response["type"] = "QueryEventsResponse";
   response["requestId"] = request_id;
@@ -718,25 +785,16 @@ void FrontendBridge::handle_query_events(websocketpp::connection_hdl hdl, const
       event_json["timestampMs"] = event.timestamp_ms;
       event_json["symbol"] = event.symbol;
       event_json["source"] = event.source;
-      event_json["data"] = event.data;
+      event_json["data"] = event_data_json(event);
 
       response["data"]["events"].push_back(event_json);
     }
 
     // Send response to THIS client only
-    {
-      std::lock_guard<std::mutex> lock(ws_mutex_);
-      if (ws_server_) {
-        try {
-          ws_server_->send(hdl, response.dump(), websocketpp::frame::opcode::text);
-        } catch (const std::exception& e) {
-          std::cerr << "[FrontendBridge] Failed to send events response: " << e.what() << "\n";
-        }
-      }
-    }
+    send_response(hdl, response.dump(), websocketpp::frame::opcode::text, token);
 
-    std::cout << "[FrontendBridge] QueryEvents: " << symbol << " [" << start_ms << "-" << end_ms
-              << "], returned " << events.size() << " events (truncated: " << is_truncated << ")\n";
+    ENG_LOG_DEBUG("[FrontendBridge] QueryEvents: " << symbol << " [" << start_ms << "-" << end_ms
+                  << "], returned " << events.size() << " events (truncated: " << is_truncated << ")");
 
   } catch (const std::exception& e) {
     // Send error response
@@ -744,18 +802,9 @@ void FrontendBridge::handle_query_events(websocketpp::connection_hdl hdl, const
     response["data"]["errorCode"] = "QUERY_ERROR";
     response["data"]["errorMessage"] = e.what();
 
-    {
-      std::lock_guard<std::mutex> lock(ws_mutex_);
-      if (ws_server_) {
-        try {
-          ws_server_->send(hdl, response.dump(), websocketpp::frame::opcode::text);
-        } catch (const std::exception& e) {
-          std::cerr << "[FrontendBridge] Failed to send error response: " << e.what() << "\n";
-        }
-      }
-    }
+    send_response(hdl, response.dump(), websocketpp::frame::opcode::text, token);
 
-    std::cerr << "[FrontendBridge] QueryEvents error: " << e.what() << "\n";
+    ENG_LOG_ERROR("[FrontendBridge] QueryEvents error: " << e.what());
   }
 }
 
@@ -768,11 +817,11 @@ void FrontendBridge::handle_query_balance(websocketpp::connection_hdl hdl, const
     response["requestId"] = request_id;
     response["data"]["balance"] = balance;
     
-    std::cout << "[FrontendBridge] QueryBalance response sent: balance=" << balance << "\n";
+    ENG_LOG_DEBUG("[FrontendBridge] QueryBalance response sent: balance=" << balance);
     
-    ws_server_->send(hdl, response.dump(), websocketpp::frame::opcode::text);
+    send_response(hdl, response.dump());
   } catch (const std::exception& e) {
-    std::cerr << "[FrontendBridge] QueryBalance error: " << e.what() << "\n";
+    ENG_LOG_ERROR("[FrontendBridge] QueryBalance error: " << e.what());
     
     try {
       json error_response;
@@ -780,9 +829,9 @@ void FrontendBridge::handle_query_balance(websocketpp::connection_hdl hdl, const
       error_response["requestId"] = request_id;
       error_response["error"] = e.what();
       
-      ws_server_->send(hdl, error_response.dump(), websocketpp::frame::opcode::text);
+      send_response(hdl, error_response.dump());
     } catch (const std::exception& e2) {
-      std::cerr << "[FrontendBridge] Failed to send error response: " << e2.what() << "\n";
+      ENG_LOG_ERROR("[FrontendBridge] Failed to send error response: " << e2.what());
     }
   }
 }
@@ -805,11 +854,11 @@ void FrontendBridge::handle_query_positions(websocketpp::connection_hdl hdl, con
       }
     }
     
-    std::cout << "[FrontendBridge] QueryPositions response sent: " << response["data"].size() << " positions\n";
+    ENG_LOG_DEBUG("[FrontendBridge] QueryPositions response sent: " << response["data"].size() << " positions");
     
-    ws_server_->send(hdl, response.dump(), websocketpp::frame::opcode::text);
+    send_response(hdl, response.dump());
   } catch (const std::exception& e) {
-    std::cerr << "[FrontendBridge] QueryPositions error: " << e.what() << "\n";
+    ENG_LOG_ERROR("[FrontendBridge] QueryPositions error: " << e.what());
     
     try {
       json error_response;
@@ -817,21 +866,33 @@ void FrontendBridge::handle_query_positions(websocketpp::connection_hdl hdl, con
       error_response["requestId"] = request_id;
       error_response["error"] = e.what();
       
-      ws_server_->send(hdl, error_response.dump(), websocketpp::frame::opcode::text);
+      send_response(hdl, error_response.dump());
     } catch (const std::exception& e2) {
-      std::cerr << "[FrontendBridge] Failed to send error response: " << e2.what() << "\n";
+      ENG_LOG_ERROR("[FrontendBridge] Failed to send error response: " << e2.what());
     }
   }
 }
 
-void FrontendBridge::handle_query_orders(websocketpp::connection_hdl hdl, const std::string& request_id) {
+void FrontendBridge::handle_query_orders(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id) {
   try {
-    auto orders = broker_.get_orders();
+    // Optional paging: orders with id > sinceId, at most limit of them.
+    // Without either, the whole history is returned as before.
+    uint64_t since_id = 0;
+    size_t limit = 0;
+    if (query.contains("data") && query["data"].is_object()) {
+      const auto& data = query["data"];
+      if (data.contains("sinceId")) since_id = data["sinceId"].get<uint64_t>();
+      if (data.contains("limit")) limit = data["limit"].get<size_t>();
+    }
+    auto orders = broker_.get_orders_since(since_id, limit);
     
     json response;
     response["type"] = "QueryOrdersResponse";
     response["requestId"] = request_id;
     response["data"] = json::array();
+    // Pass nextSinceId back as sinceId to fetch the next page / only new orders
+    response["nextSinceId"] = orders.empty() ? since_id : orders.back().id;
+    response["hasMore"] = limit != 0 && orders.size() == limit;
     
     // Convert each order to JSON
     for (const auto& order : orders) {
@@ -858,11 +919,11 @@ void FrontendBridge::handle_query_orders(websocketpp::connection_hdl hdl, const
       response["data"].push_back(order_json);
     }
     
-    std::cout << "[FrontendBridge] QueryOrders response sent: " << response["data"].size() << " orders\n";
+    ENG_LOG_DEBUG("[FrontendBridge] QueryOrders response sent: " << response["data"].size() << " orders");
     
-    ws_server_->send(hdl, response.dump(), websocketpp::frame::opcode::text);
+    send_response(hdl, response.dump());
   } catch (const std::exception& e) {
-    std::cerr << "[FrontendBridge] QueryOrders error: " << e.what() << "\n";
+    ENG_LOG_ERROR("[FrontendBridge] QueryOrders error: " << e.what());
     
     try {
       json error_response;
@@ -870,9 +931,60 @@ void FrontendBridge::handle_query_orders(websocketpp::connection_hdl hdl, const
       error_response["requestId"] = request_id;
       error_response["error"] = e.what();
       
-      ws_server_->send(hdl, error_response.dump(), websocketpp::frame::opcode::text);
+      send_response(hdl, error_response.dump());
+    } catch (const std::exception& e2) {
+      ENG_LOG_ERROR("[FrontendBridge] Failed to send error response: " << e2.what());
+    }
+  }
+}
+
+void FrontendBridge::handle_query_metrics(websocketpp::connection_hdl hdl, const json& query, const std::string& request_id) {
+  try {
+    auto& metrics = eng::Metrics::instance();
+
+    json response;
+    response["type"] = "QueryMetricsResponse";
+    response["requestId"] = request_id;
+    response["data"]["enabled"] = eng::Metrics::enabled();
+    response["data"]["stages"] = json::array();
+
+    // Latency percentiles per hot-path stage, in nanoseconds
+    for (const auto& m : metrics.snapshot()) {
+      const auto& h = m.latency_ns;
+      json stage;
+      stage["stage"] = m.stage;
+      stage["count"] = h.count;
+      stage["meanNs"] = h.mean;
+      stage["minNs"] = h.min;
+      stage["p50Ns"] = h.p50;
+      stage["p90Ns"] = h.p90;
+      stage["p99Ns"] = h.p99;
+      stage["p999Ns"] = h.p999;
+      stage["maxNs"] = h.max;
+      response["data"]["stages"].push_back(stage);
+    }
+
+    // Optional: {"data": {"reset": true}} starts a fresh measurement window
+    if (query.contains("data") && query["data"].is_object() &&
+        query["data"].value("reset", false)) {
+      metrics.reset();
+    }
+
+    ENG_LOG_DEBUG("[FrontendBridge] QueryMetrics response sent: " << response["data"]["stages"].size() << " stages");
+
+    send_response(hdl, response.dump());
+  } catch (const std::exception& e) {
+    ENG_LOG_ERROR("[FrontendBridge] QueryMetrics error: " << e.what());
+
+    try {
+      json error_response;
+      error_response["type"] = "QueryMetricsResponse";
+      error_response["requestId"] = request_id;
+      error_response["error"] = e.what();
+
+      send_response(hdl, error_response.dump());
     } catch (const std::exception& e2) {
-      std::cerr << "[FrontendBridge] Failed to send error response: " << e2.what() << "\n";
+      ENG_LOG_ERROR("[FrontendBridge] Failed to send error response: " << e2.what());
     }
   }
 }
@@ -891,15 +1003,15 @@ void FrontendBridge::handle_query_default_viewport(websocketpp::connection_hdl h
         std::chrono::system_clock::now().time_since_epoch()).count();
     long long end_range = now_ms + (365LL * 24 * 60 * 60 * 1000); // Up to 1 year in future
     
-    std::cout << "[FrontendBridge] QueryDefaultViewport: Querying for BTCUSD, resolution=1000ms, range=" 
-              << start_range << " to " << end_range << "\n";
+    ENG_LOG_DEBUG("[FrontendBridge] QueryDefaultViewport: Querying for BTCUSD, resolution=1000ms, range=" 
+                  << start_range << " to " << end_range);
     auto candles = candle_store_->query_candles("BTCUSD", 1000, start_range, end_range);
-    std::cout << "[FrontendBridge] QueryDefaultViewport: Query returned " << candles.size() << " candles\n";
+    ENG_LOG_DEBUG("[FrontendBridge] QueryDefaultViewport: Query returned " << candles.size() << " candles");
     
     if (candles.empty()) {
       // No data available yet - return error status
       response["error"] = "NoDataYet";
-      std::cout << "[FrontendBridge] QueryDefaultViewport: No data available in database, returning NoDataYet\n";
+      ENG_LOG_DEBUG("[FrontendBridge] QueryDefaultViewport: No data available in database, returning NoDataYet");
     } else {
       // Data exists! Return the range covered by the data
       // Use the earliest and latest candle timestamps
@@ -908,8 +1020,8 @@ void FrontendBridge::handle_query_default_viewport(websocketpp::connection_hdl h
       long long latest_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
           candles.back().open_time.time_since_epoch()).count();
       
-      std::cout << "[FrontendBridge] QueryDefaultViewport: Data range from " << earliest_ms 
-                << " to " << latest_ms << " (span: " << (latest_ms - earliest_ms) / 1000.0 << " seconds)\n";
+      ENG_LOG_DEBUG("[FrontendBridge] QueryDefaultViewport: Data range from " << earliest_ms 
+                    << " to " << latest_ms << " (span: " << (latest_ms - earliest_ms) / 1000.0 << " seconds)");
       
       // For better UX, show the last 24 hours if we have more than that
       long long one_day_ms = 24 * 60 * 60 * 1000LL;
@@ -920,13 +1032,13 @@ void FrontendBridge::handle_query_default_viewport(websocketpp::connection_hdl h
       response["data"]["startMs"] = start_ms;
       response["data"]["endMs"] = end_ms;
       
-      std::cout << "[FrontendBridge] QueryDefaultViewport: Returning viewport " << start_ms 
-                << " to " << end_ms << "\n";
+      ENG_LOG_DEBUG("[FrontendBridge] QueryDefaultViewport: Returning viewport " << start_ms 
+                    << " to " << end_ms);
     }
 
-    ws_server_->send(hdl, response.dump(), websocketpp::frame::opcode::text);
+    send_response(hdl, response.dump());
   } catch (const std::exception& e) {
-    std::cerr << "[FrontendBridge] QueryDefaultViewport error: " << e.what() << "\n";
+    ENG_LOG_ERROR("[FrontendBridge] QueryDefaultViewport error: " << e.what());
     
     try {
       json error_response;
@@ -934,10 +1046,312 @@ void FrontendBridge::handle_query_default_viewport(websocketpp::connection_hdl h
       error_response["requestId"] = request_id;
       error_response["error"] = e.what();
       
-      ws_server_->send(hdl, error_response.dump(), websocketpp::frame::opcode::text);
+      send_response(hdl, error_response.dump());
     } catch (const std::exception& e2) {
-      std::cerr << "[FrontendBridge] Failed to send error response: " << e2.what() << "\n";
+      ENG_LOG_ERROR("[FrontendBridge] Failed to send error response: " << e2.what());
+    }
+  }
+}
+
+void FrontendBridge::handle_subscribe_candles(websocketpp::connection_hdl hdl, const json& query,
+                                              const std::string& request_id,
+                                              const QueryExecutor::CancelToken& token) {
+  json response;
+  response["type"] = "SubscribeCandlesResponse";
+  response["requestId"] = request_id;
+
+  try {
+    std::string symbol = query["data"]["symbol"].get<std::string>();
+    long long resolution_ms = query["data"]["resolutionMs"].get<long long>();
+    long long from_ms = query["data"].value("fromMs", 0LL);
+    size_t max_points = query["data"].value("maxPoints", size_t{10000});
+    double rate_hz = std::min(query["data"].value("maxRateHz", max_delta_rate_hz_), max_delta_rate_hz_);
+    const bool sparse = query["data"].value("sparse", false);
+
+    if (symbol.empty()) {
+      throw std::runtime_error("Symbol is required");
+    }
+    if (resolution_ms <= 0) {
+      throw std::runtime_error("Resolution must be positive");
+    }
+    if (max_points == 0) {
+      throw std::runtime_error("maxPoints must be positive");
+    }
+    if (!(rate_hz > 0.0)) {
+      throw std::runtime_error("maxRateHz must be positive");
+    }
+
+    connection_ptr conn;
+    {
+      std::lock_guard<std::mutex> lock(ws_mutex_);
+      if (!ws_server_) return;
+      websocketpp::lib::error_code ec;
+      conn = ws_server_->get_con_from_hdl(hdl, ec);
+      if (ec || !conn) return;   // Client already gone
+    }
+
+    // Backfill: the newest max_points bars at this resolution since fromMs,
+    // so the stream never changes bar width under the client
+    const long long latest_ms = tick_store_ && tick_store_->size(symbol) > 0
+        ? to_ms(tick_store_->last_time(symbol))
+        : to_ms(std::chrono::system_clock::now());
+    const long long span_ms = resolution_ms * static_cast<long long>(std::min<size_t>(max_points, 1 << 20));
+    const long long start_ms = std::max(from_ms, (latest_ms / resolution_ms + 1) * resolution_ms - span_ms);
+    auto result = candle_store_->query_candles_downsampled(symbol, resolution_ms, start_ms, latest_ms,
+                                                           max_points, token.get());
+    if (result.cancelled || token->load()) return;
+    std::vector<eng::Candle> bars = std::move(result.candles);
+
+    auto sub = std::make_shared<CandleSubscription>();
+    sub->conn = conn;
+    sub->client = hdl.lock().get();
+    sub->id = request_id;
+    sub->symbol = symbol;
+    sub->resolution_ms = resolution_ms;
+    sub->min_interval = std::chrono::milliseconds(static_cast<long long>(1000.0 / rate_hz));
+
+    {
+      // Held while seeding so no tick reaches this symbol's subscriptions
+      // in between. Ticks before seed_ts are in the backfill, later ones are
+      // applied live; of those at seed_ts, the ones already stored (and not
+      // yet handed to us) are skipped by count, so a trade sharing the
+      // timestamp but appended after the seed isn't lost
+      std::lock_guard<std::mutex> lock(subs_mutex_);
+      if (token->load()) return;   // Unsubscribed while the backfill ran
+      if (tick_store_) {
+        // The store's writer lags by up to a flush interval; the TickStore
+        // has every trade, so rebuild the bars from the newest stored one on
+        const eng::TimePoint seed_ts = tick_store_->last_time(symbol);
+        size_t at_seed_ts = 0;
+        long long tail_from_ms = start_ms;
+        if (!bars.empty()) tail_from_ms = std::max(tail_from_ms, to_ms(bars.back().open_time));
+        tail_from_ms = (tail_from_ms / resolution_ms) * resolution_ms;
+
+        std::vector<eng::Candle> tail;
+        tick_store_->scan(symbol, eng::TimePoint(std::chrono::milliseconds(tail_from_ms)),
+                          seed_ts + eng::TimePoint::duration(1),
+                          [&](eng::TimePoint ts, double px, double qty, eng::TradeSide) {
+          if (ts == seed_ts) ++at_seed_ts;
+          const long long bucket_ms = (to_ms(ts) / resolution_ms) * resolution_ms;
+          if (tail.empty() || to_ms(tail.back().open_time) != bucket_ms) {
+            eng::Candle c;
+            c.symbol = symbol;
+            c.open_time = eng::TimePoint(std::chrono::milliseconds(bucket_ms));
+            c.open = c.high = c.low = c.close = px;
+            c.volume = qty;
+            tail.push_back(c);
+            return;
+          }
+          eng::Candle& c = tail.back();
+          c.high = std::max(c.high, px);
+          c.low = std::min(c.low, px);
+          c.close = px;
+          c.volume += qty;
+        });
+        if (!tail.empty()) {
+          const auto cut = tail.front().open_time;
+          bars.erase(std::find_if(bars.begin(), bars.end(),
+                                  [cut](const eng::Candle& c) { return c.open_time >= cut; }),
+                     bars.end());
+          bars.insert(bars.end(), tail.begin(), tail.end());
+        }
+        const auto mark = tick_marks_.find(symbol);
+        const size_t delivered = mark != tick_marks_.end() && mark->second.ts == seed_ts
+            ? mark->second.count : 0;
+        sub->seed_ts = seed_ts;
+        sub->seed_pending = at_seed_ts > delivered ? at_seed_ts - delivered : 0;
+      }
+      // The newest bar may still be open: live ticks continue it
+      if (!bars.empty()) {
+        sub->bar = bars.back();
+        sub->has_bar = true;
+      }
+
+      auto& subs = subs_by_symbol_[symbol];
+      auto same = std::find_if(subs.begin(), subs.end(), [&](const auto& s) {
+        return s->client == sub->client && s->id == request_id;
+      });
+      if (same != subs.end()) {
+        *same = sub;   // Resubscribing under the same requestId replaces it
+      } else {
+        subs.push_back(sub);
+        subscription_count_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    response["data"]["subscriptionId"] = request_id;
+    response["data"]["symbol"] = symbol;
+    response["data"]["resolutionMs"] = resolution_ms;
+    response["data"]["isTruncated"] = start_ms > from_ms;
+    if (sparse) response["data"]["sparse"] = true;
+    response["data"]["candles"] = bars_to_json(bars, symbol, resolution_ms, sparse);
+    response["data"]["count"] = response["data"]["candles"].size();
+    ENG_LOG_DEBUG("[FrontendBridge] SubscribeCandles " << request_id << ": " << symbol << " @ "
+                  << resolution_ms << "ms, " << response["data"]["count"] << " bars backfilled");
+
+    // The backfill goes out on the io thread, and only then may the
+    // subscription's deltas follow it (they are sent from there too)
+    auto payload = std::make_shared<const std::string>(response.dump());
+    std::lock_guard<std::mutex> lock(ws_mutex_);
+    if (!ws_server_) return;
+    ws_server_->get_io_service().post([this, sub, payload, token]() {
+      if (token && token->load()) return;   // Unsubscribed or superseded meanwhile
+      auto ec = sub->conn->send(*payload, websocketpp::frame::opcode::text);
+      if (ec) {
+        ENG_LOG_ERROR("[FrontendBridge] Failed to send candle backfill: " << ec.message());
+      }
+      std::lock_guard<std::mutex> lock(subs_mutex_);
+      sub->live = true;
+    });
+
+  } catch (const std::exception& e) {
+    response["data"]["error"] = true;
+    response["data"]["errorCode"] = "QUERY_ERROR";
+    response["data"]["errorMessage"] = e.what();
+
+    send_response(hdl, response.dump(), websocketpp::frame::opcode::text, token);
+
+    ENG_LOG_ERROR("[FrontendBridge] SubscribeCandles error: " << e.what());
+  }
+}
+
+bool FrontendBridge::remove_subscription(const void* client, const std::string& id) {
+  std::lock_guard<std::mutex> lock(subs_mutex_);
+  for (auto& [symbol, subs] : subs_by_symbol_) {
+    auto it = std::find_if(subs.begin(), subs.end(), [&](const auto& s) {
+      return s->client == client && s->id == id;
+    });
+    if (it != subs.end()) {
+      subs.erase(it);
+      subscription_count_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void FrontendBridge::remove_client_subscriptions(const void* client) {
+  std::lock_guard<std::mutex> lock(subs_mutex_);
+  for (auto& [symbol, subs] : subs_by_symbol_) {
+    const size_t before = subs.size();
+    subs.erase(std::remove_if(subs.begin(), subs.end(),
+                              [client](const auto& s) { return s->client == client; }),
+               subs.end());
+    subscription_count_.fetch_sub(before - subs.size(), std::memory_order_relaxed);
+  }
+}
+
+void FrontendBridge::update_candle_subscriptions(const eng::Tick& tick) {
+  if (!tick_store_ && subscription_count_.load(std::memory_order_relaxed) == 0) return;
+
+  std::lock_guard<std::mutex> lock(subs_mutex_);
+  if (tick_store_) {
+    // Kept with or without subscriptions: the next seed needs it
+    TickMark& mark = tick_marks_[tick.symbol];
+    if (tick.ts == mark.ts) {
+      ++mark.count;
+    } else {
+      mark.ts = tick.ts;
+      mark.count = 1;
+    }
+  }
+  if (subscription_count_.load(std::memory_order_relaxed) == 0) return;
+
+  auto found = subs_by_symbol_.find(tick.symbol);
+  if (found == subs_by_symbol_.end()) return;
+
+  const long long ts_ms = to_ms(tick.ts);
+  for (const auto& sub : found->second) {
+    // Already in the backfill
+    if (tick.ts < sub->seed_ts) continue;
+    if (tick.ts == sub->seed_ts && sub->seed_pending > 0) {
+      --sub->seed_pending;
+      continue;
+    }
+    const long long bucket_ms = (ts_ms / sub->resolution_ms) * sub->resolution_ms;
+    eng::Candle& bar = sub->bar;
+
+    if (sub->has_bar && bucket_ms > to_ms(bar.open_time)) {
+      // Bucket rolled: the old bar is final
+      if (sub->closed.size() < MAX_PENDING_CLOSED_BARS) {
+        sub->closed.push_back(bar);
+      } else {
+        sub->resync = true;
+      }
+      sub->has_bar = false;
+    }
+
+    if (!sub->has_bar) {
+      bar.symbol = tick.symbol;
+      bar.open_time = eng::TimePoint(std::chrono::milliseconds(bucket_ms));
+      bar.open = bar.high = bar.low = bar.close = tick.last;
+      bar.volume = tick.qty;
+      sub->has_bar = true;
+    } else {
+      // Same bucket (or a late tick, folded into the open bar)
+      bar.high = std::max(bar.high, tick.last);
+      bar.low = std::min(bar.low, tick.last);
+      bar.close = tick.last;
+      bar.volume += tick.qty;
+    }
+    sub->dirty = true;
+  }
+}
+
+void FrontendBridge::schedule_delta_timer() {
+  ws_server_->set_timer(DELTA_TIMER_MS, [this](const websocketpp::lib::error_code& ec) {
+    if (ec) return;   // Server stopping
+    flush_candle_deltas();
+    schedule_delta_timer();
+  });
+}
+
+void FrontendBridge::flush_candle_deltas() {
+  if (subscription_count_.load(std::memory_order_relaxed) == 0) return;
+
+  const auto now = std::chrono::steady_clock::now();
+  std::vector<std::pair<connection_ptr, std::string>> out;
+  {
+    std::lock_guard<std::mutex> lock(subs_mutex_);
+    for (const auto& [symbol, subs] : subs_by_symbol_) {
+      for (const auto& sub : subs) {
+        if (!sub->live || !sub->dirty || now < sub->next_send) continue;
+        // Slow client: keep coalescing until its socket drains
+        if (sub->conn->get_buffered_amount() > max_client_buffered_bytes_) continue;
+
+        json msg;
+        msg["type"] = "CandleDelta";
+        msg["data"]["subscriptionId"] = sub->id;
+        msg["data"]["symbol"] = sub->symbol;
+        msg["data"]["resolutionMs"] = sub->resolution_ms;
+        msg["data"]["candles"] = json::array();
+        for (const auto& c : sub->closed) {
+          json candle_json = candle_to_json(c);
+          candle_json["final"] = true;
+          msg["data"]["candles"].push_back(std::move(candle_json));
+        }
+        if (sub->has_bar) {
+          json candle_json = candle_to_json(sub->bar);
+          candle_json["final"] = false;
+          msg["data"]["candles"].push_back(std::move(candle_json));
+        }
+        if (sub->resync) msg["data"]["resync"] = true;   // Bars were skipped
+
+        out.emplace_back(sub->conn, msg.dump());
+        sub->closed.clear();
+        sub->dirty = false;
+        sub->resync = false;
+        sub->next_send = now + sub->min_interval;
+      }
+    }
+  }
+
+  for (const auto& [conn, payload] : out) {
+    auto ec = conn->send(payload, websocketpp::frame::opcode::text);
+    if (ec) {
+      ENG_LOG_ERROR("[FrontendBridge] Failed to send candle delta: " << ec.message());
     }
   }
 }
+
 } // namespace server
@@ -0,0 +1,120 @@
+#include "server/QueryExecutor.hpp"
+#include "engine/Logger.hpp"
+
+namespace server {
+
+QueryExecutor::QueryExecutor(size_t num_threads) {
+  if (num_threads == 0) num_threads = 1;
+  workers_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back([this]() { worker_loop(); });
+  }
+}
+
+QueryExecutor::~QueryExecutor() {
+  stop();
+}
+
+QueryExecutor::CancelToken QueryExecutor::submit(const void* client, const std::string& request_id, Task task) {
+  auto token = std::make_shared<std::atomic<bool>>(false);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+      token->store(true);
+      return token;
+    }
+
+    Key key{client, request_id};
+    if (!request_id.empty()) {
+      auto it = active_.find(key);
+      if (it != active_.end()) {
+        it->second->store(true);
+        stats_.superseded++;
+        it->second = token;
+      } else {
+        active_.emplace(key, token);
+      }
+    }
+
+    queue_.push_back(Job{std::move(key), token, std::move(task)});
+    stats_.submitted++;
+  }
+  cv_.notify_one();
+  return token;
+}
+
+bool QueryExecutor::cancel(const void* client, const std::string& request_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = active_.find(Key{client, request_id});
+  if (it == active_.end()) return false;
+  it->second->store(true);
+  active_.erase(it);
+  return true;
+}
+
+void QueryExecutor::cancel_client(const void* client) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = active_.begin(); it != active_.end();) {
+    if (it->first.client == client) {
+      it->second->store(true);
+      it = active_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void QueryExecutor::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ && workers_.empty()) return;
+    stopping_ = true;
+    for (auto& [key, token] : active_) token->store(true);
+    active_.clear();
+    queue_.clear();
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) worker.join();
+  }
+  workers_.clear();
+}
+
+QueryExecutor::Stats QueryExecutor::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats s = stats_;
+  s.pending = queue_.size();
+  return s;
+}
+
+void QueryExecutor::worker_loop() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+      if (stopping_) return;
+      job = std::move(queue_.front());
+      queue_.pop_front();
+      if (job.token->load()) {
+        stats_.skipped++;
+        continue;
+      }
+    }
+
+    try {
+      job.task(job.token);
+    } catch (const std::exception& e) {
+      ENG_LOG_ERROR("[QueryExecutor] Task for request '" << job.key.request_id << "' failed: " << e.what());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.completed++;
+    auto it = active_.find(job.key);
+    if (it != active_.end() && it->second == job.token) {
+      active_.erase(it);
+    }
+  }
+}
+
+}  // namespace server
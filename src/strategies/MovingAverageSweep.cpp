@@ -0,0 +1,171 @@
+#include "strategies/MovingAverageSweep.hpp"
+#include "strategies/Indicators.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace strategy {
+
+namespace {
+
+// Engine only sends a Sell when the strategy's net position exceeds this
+constexpr double kMinSellPosition = 0.001;
+
+size_t resolve_threads(size_t requested) {
+    if (requested > 0) return requested;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+// Run job(i) for i in [0, count) on up to num_threads threads
+template <typename Fn>
+void parallel_for(size_t count, size_t num_threads, Fn&& job) {
+    num_threads = std::min(num_threads, count);
+    if (num_threads <= 1) {
+        for (size_t i = 0; i < count; ++i) job(i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads);
+    for (size_t t = 0; t < num_threads; ++t) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < count; i = next++) {
+                try {
+                    job(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) error = std::current_exception();
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    if (error) std::rethrow_exception(error);
+}
+
+
+// One tick for every lane of a window group. The decision is the same as
+// MovingAverageStrategy + Engine, written as 0/1 masks so the loop has no
+// branches: Buy wins if both fire, a Buy fills only if covered, a Sell closes
+// the whole position. Multiplying by a 0/1 mask is exact, so balances match
+// a real engine run to the bit. The lane arrays never overlap; __restrict
+// spares the vectorizer the runtime alias checks it would otherwise give up on.
+void step_lanes(size_t lanes, double p, double s,
+                const double* __restrict threshold, const double* __restrict qty,
+                double* __restrict cash, double* __restrict position,
+                double* __restrict buys, double* __restrict sells,
+                double* __restrict rejected, double* __restrict skipped) {
+    for (size_t l = 0; l < lanes; ++l) {
+        const double cost = p * qty[l];
+        const double buy = (p > s + threshold[l]) ? 1.0 : 0.0;
+        const double sell = (1.0 - buy) * ((p < s - threshold[l]) ? 1.0 : 0.0);
+        const double fill_buy = buy * ((cash[l] >= cost) ? 1.0 : 0.0);
+        const double fill_sell = sell * ((position[l] > kMinSellPosition) ? 1.0 : 0.0);
+
+        cash[l] = (cash[l] + fill_sell * (p * position[l])) - fill_buy * cost;
+        position[l] = (1.0 - fill_sell) * (position[l] + fill_buy * qty[l]);
+        buys[l] += fill_buy;
+        sells[l] += fill_sell;
+        rejected[l] += buy - fill_buy;
+        skipped[l] += sell - fill_sell;
+    }
+}
+
+}  // namespace
+
+MovingAverageSweep::MovingAverageSweep(std::vector<MovingAverageParams> lanes)
+    : MovingAverageSweep(std::move(lanes), Config{}) {}
+
+MovingAverageSweep::MovingAverageSweep(std::vector<MovingAverageParams> lanes, Config config)
+    : lanes_(std::move(lanes)), config_(config) {
+    // Group lanes by window so each group shares one running SMA
+    std::map<size_t, size_t> group_of_window;
+    for (size_t i = 0; i < lanes_.size(); ++i) {
+        const auto& p = lanes_[i];
+        if (p.window == 0) throw std::invalid_argument("MovingAverageSweep window must be positive");
+
+        auto [it, inserted] = group_of_window.emplace(p.window, groups_.size());
+        if (inserted) groups_.push_back(WindowGroup{p.window, {}, {}, {}});
+
+        WindowGroup& g = groups_[it->second];
+        g.lane_index.push_back(i);
+        g.threshold.push_back(p.threshold);
+        g.qty.push_back(p.qty);
+    }
+}
+
+std::vector<MovingAverageParams> MovingAverageSweep::grid(const std::vector<size_t>& windows,
+                                                          const std::vector<double>& thresholds,
+                                                          double qty) {
+    std::vector<MovingAverageParams> out;
+    out.reserve(windows.size() * thresholds.size());
+    for (size_t w : windows) {
+        for (double t : thresholds) out.push_back(MovingAverageParams{w, t, qty});
+    }
+    return out;
+}
+
+std::vector<std::vector<SweepLaneResult>> MovingAverageSweep::run(size_t num_days, const DayLoader& load) const {
+    size_t num_threads = resolve_threads(config_.num_threads);
+
+    // Days are independent, so load them in parallel first
+    std::vector<std::vector<double>> days(num_days);
+    parallel_for(num_days, num_threads, [&](size_t d) { days[d] = load(d); });
+
+    // Then split the evaluation by (day, window group) so a single long day
+    // or a single window still spreads across threads
+    std::vector<std::vector<SweepLaneResult>> results(num_days, std::vector<SweepLaneResult>(lanes_.size()));
+    size_t jobs = num_days * groups_.size();
+    parallel_for(jobs, num_threads, [&](size_t j) {
+        size_t d = j / groups_.size();
+        const WindowGroup& g = groups_[j % groups_.size()];
+        evaluate_group(g, days[d].data(), days[d].size(), results[d]);
+    });
+    return results;
+}
+
+std::vector<SweepLaneResult> MovingAverageSweep::run_day(const std::vector<double>& prices) const {
+    std::vector<SweepLaneResult> results(lanes_.size());
+    for (const auto& g : groups_) evaluate_group(g, prices.data(), prices.size(), results);
+    return results;
+}
+
+void MovingAverageSweep::evaluate_group(const WindowGroup& group, const double* prices, size_t n,
+                                        std::vector<SweepLaneResult>& out) const {
+    const size_t lanes = group.lane_index.size();
+
+    // Struct-of-arrays lane state; the counters are doubles so the whole
+    // lane loop stays in one vector width
+    std::vector<double> cash(lanes, config_.initial_balance);
+    std::vector<double> position(lanes, 0.0);
+    std::vector<double> buys(lanes, 0.0), sells(lanes, 0.0), rejected(lanes, 0.0), skipped(lanes, 0.0);
+
+    indicators::Sma sma(group.window);
+    for (size_t i = 0; i < n; ++i) {
+        const double p = prices[i];
+        step_lanes(lanes, p, sma.update(p), group.threshold.data(), group.qty.data(),
+                   cash.data(), position.data(), buys.data(), sells.data(), rejected.data(), skipped.data());
+    }
+
+    const double last = n ? prices[n - 1] : 0.0;
+    for (size_t l = 0; l < lanes; ++l) {
+        SweepLaneResult& r = out[group.lane_index[l]];
+        r.balance = cash[l];
+        r.position = position[l];
+        r.equity = cash[l] + position[l] * last;
+        r.buys = static_cast<uint32_t>(buys[l]);
+        r.sells = static_cast<uint32_t>(sells[l]);
+        r.rejected_buys = static_cast<uint32_t>(rejected[l]);
+        r.skipped_sells = static_cast<uint32_t>(skipped[l]);
+    }
+}
+
+}  // namespace strategy
@@ -0,0 +1,196 @@
+// strategy_sweep.cpp
+//
+// In-process MovingAverageStrategy parameter sweep over recorded days.
+// Each day is loaded once into a flat price column and every window x
+// threshold combination is evaluated over it (see MovingAverageSweep),
+// instead of launching one trading_engine per configuration.
+//
+// Usage: strategy_sweep --symbol XBTUSD --windows 5:100:5 --thresholds 0.5:25:0.5
+//                       [--qty 0.01] [--balance 1000000] [--threads N]
+//                       [--top 10] [--output report.json] <day files...>
+//
+// Lists are comma separated ("5,10,20") or inclusive ranges ("start:stop:step").
+// Day files are .trades archives or Kraken .jsonl.gz days.
+
+#include "adapters/PriceColumnLoader.hpp"
+#include "strategies/MovingAverageSweep.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<double> parse_list(const std::string& spec) {
+    std::vector<double> out;
+    auto colon = spec.find(':');
+    if (colon != std::string::npos) {
+        auto colon2 = spec.find(':', colon + 1);
+        if (colon2 == std::string::npos) throw std::invalid_argument("Range must be start:stop:step: " + spec);
+        double start = std::stod(spec.substr(0, colon));
+        double stop = std::stod(spec.substr(colon + 1, colon2 - colon - 1));
+        double step = std::stod(spec.substr(colon2 + 1));
+        if (!(step > 0.0)) throw std::invalid_argument("Range step must be positive: " + spec);
+        // Index-based so repeated adds don't drift past stop
+        for (size_t i = 0; start + i * step <= stop + step * 1e-9; ++i) out.push_back(start + i * step);
+        return out;
+    }
+    size_t pos = 0;
+    while (pos <= spec.size()) {
+        size_t comma = spec.find(',', pos);
+        if (comma == std::string::npos) comma = spec.size();
+        if (comma > pos) out.push_back(std::stod(spec.substr(pos, comma - pos)));
+        pos = comma + 1;
+    }
+    return out;
+}
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " --symbol <symbol> --windows <list> --thresholds <list>\n"
+              << "       [--qty 0.01] [--balance 1000000] [--threads N] [--top 10] [--output report.json]\n"
+              << "       <day files...>\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string symbol = "BTCUSD";
+    std::string windows_spec = "5";
+    std::string thresholds_spec = "1.0";
+    std::string output;
+    double qty = 0.01;
+    size_t top = 10;
+    strategy::MovingAverageSweep::Config config;
+    std::vector<std::string> files;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--symbol" && i + 1 < argc) symbol = argv[++i];
+            else if (arg == "--windows" && i + 1 < argc) windows_spec = argv[++i];
+            else if (arg == "--thresholds" && i + 1 < argc) thresholds_spec = argv[++i];
+            else if (arg == "--qty" && i + 1 < argc) qty = std::stod(argv[++i]);
+            else if (arg == "--balance" && i + 1 < argc) config.initial_balance = std::stod(argv[++i]);
+            else if (arg == "--threads" && i + 1 < argc) config.num_threads = std::stoul(argv[++i]);
+            else if (arg == "--top" && i + 1 < argc) top = std::stoul(argv[++i]);
+            else if (arg == "--output" && i + 1 < argc) output = argv[++i];
+            else if (arg.rfind("--", 0) == 0) { usage(argv[0]); return 1; }
+            else files.push_back(arg);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[strategy_sweep] ERROR: bad argument: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (files.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<size_t> windows;
+    std::vector<double> thresholds;
+    try {
+        for (double w : parse_list(windows_spec)) {
+            if (w < 1.0) throw std::invalid_argument("windows must be >= 1");
+            windows.push_back(static_cast<size_t>(w));
+        }
+        thresholds = parse_list(thresholds_spec);
+    } catch (const std::exception& e) {
+        std::cerr << "[strategy_sweep] ERROR: " << e.what() << "\n";
+        return 1;
+    }
+
+    strategy::MovingAverageSweep sweep(strategy::MovingAverageSweep::grid(windows, thresholds, qty), config);
+    const auto& lanes = sweep.lanes();
+    std::cout << "[strategy_sweep] " << lanes.size() << " configurations (" << windows.size() << " windows x "
+              << thresholds.size() << " thresholds) over " << files.size() << " day(s) of " << symbol << "\n";
+
+    std::vector<size_t> day_trades(files.size(), 0);
+    std::vector<std::vector<strategy::SweepLaneResult>> results;
+    auto t0 = std::chrono::steady_clock::now();
+    try {
+        results = sweep.run(files.size(), [&](size_t d) {
+            auto prices = adapter::load_price_column(files[d], symbol);
+            day_trades[d] = prices.size();
+            return prices;
+        });
+    } catch (const std::exception& e) {
+        std::cerr << "[strategy_sweep] ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    size_t total_trades = std::accumulate(day_trades.begin(), day_trades.end(), size_t{0});
+    std::cout << "[strategy_sweep] Evaluated " << total_trades << " trades x " << lanes.size()
+              << " configurations in " << secs << "s\n";
+
+    // Total P&L per configuration across days
+    std::vector<double> total_pnl(lanes.size(), 0.0);
+    for (const auto& day : results) {
+        for (size_t l = 0; l < lanes.size(); ++l) total_pnl[l] += day[l].equity - config.initial_balance;
+    }
+
+    std::vector<size_t> order(lanes.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return total_pnl[a] > total_pnl[b]; });
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (size_t rank = 0; rank < std::min(top, order.size()); ++rank) {
+        size_t l = order[rank];
+        uint64_t buys = 0, sells = 0;
+        for (const auto& day : results) { buys += day[l].buys; sells += day[l].sells; }
+        std::cout << "[strategy_sweep] #" << rank + 1 << " window=" << lanes[l].window
+                  << " threshold=" << lanes[l].threshold << " pnl=" << total_pnl[l]
+                  << " buys=" << buys << " sells=" << sells << "\n";
+    }
+
+    if (!output.empty()) {
+        nlohmann::json report;
+        report["symbol"] = symbol;
+        report["initial_balance"] = config.initial_balance;
+        report["elapsed_s"] = secs;
+        report["days"] = nlohmann::json::array();
+        for (size_t d = 0; d < files.size(); ++d) {
+            report["days"].push_back({{"data_file", files[d]}, {"trades", day_trades[d]}});
+        }
+        report["configurations"] = nlohmann::json::array();
+        for (size_t l : order) {
+            nlohmann::json daily = nlohmann::json::array();
+            for (const auto& day : results) {
+                const auto& r = day[l];
+                daily.push_back({
+                    {"pnl", r.equity - config.initial_balance},
+                    {"balance", r.balance},
+                    {"position", r.position},
+                    {"buys", r.buys},
+                    {"sells", r.sells},
+                    {"rejected_buys", r.rejected_buys},
+                    {"skipped_sells", r.skipped_sells},
+                });
+            }
+            report["configurations"].push_back({
+                {"window", lanes[l].window},
+                {"threshold", lanes[l].threshold},
+                {"qty", lanes[l].qty},
+                {"total_pnl", total_pnl[l]},
+                {"daily", std::move(daily)},
+            });
+        }
+
+        std::ofstream out(output);
+        if (!out) {
+            std::cerr << "[strategy_sweep] ERROR: cannot write " << output << "\n";
+            return 1;
+        }
+        out << report.dump(2) << "\n";
+        std::cout << "[strategy_sweep] Report written to " << output << "\n";
+    }
+
+    return 0;
+}
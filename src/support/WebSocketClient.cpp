@@ -2,4 +2,493 @@
 
 #include "support/WebSocketClient.hpp"
 
-// TODO: implement
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+#include <openssl/ssl.h>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+struct WebSocketClient::Tls {
+    SSL_CTX* ctx{nullptr};
+    SSL* ssl{nullptr};
+
+    ~Tls() {
+        if (ssl) SSL_free(ssl);
+        if (ctx) SSL_CTX_free(ctx);
+    }
+};
+
+namespace {
+
+enum Opcode : uint8_t {
+    kContinuation = 0x0,
+    kText = 0x1,
+    kBinary = 0x2,
+    kClose = 0x8,
+    kPing = 0x9,
+    kPong = 0xA,
+};
+
+// Milliseconds left until `deadline`, at least 0
+int remaining_ms(std::chrono::steady_clock::time_point deadline) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return left.count() > 0 ? static_cast<int>(left.count()) : 0;
+}
+
+std::string base64(const unsigned char* data, size_t n) {
+    std::string out(4 * ((n + 2) / 3), '\0');
+    const int len = EVP_EncodeBlock(reinterpret_cast<unsigned char*>(&out[0]), data, static_cast<int>(n));
+    out.resize(static_cast<size_t>(len));
+    return out;
+}
+
+std::string openssl_error() {
+    const unsigned long e = ERR_get_error();
+    if (e == 0) return "unknown TLS error";
+    char buf[256];
+    ERR_error_string_n(e, buf, sizeof(buf));
+    return buf;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+// Value of a response header, or empty
+std::string_view header_value(std::string_view headers, std::string_view name) {
+    size_t pos = headers.find("\r\n");
+    while (pos != std::string_view::npos && pos + 2 < headers.size()) {
+        const size_t start = pos + 2;
+        const size_t eol = headers.find("\r\n", start);
+        const std::string_view line = headers.substr(start, eol == std::string_view::npos ? std::string_view::npos : eol - start);
+        const size_t colon = line.find(':');
+        if (colon != std::string_view::npos && iequals(line.substr(0, colon), name)) {
+            std::string_view value = line.substr(colon + 1);
+            while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+            while (!value.empty() && value.back() == ' ') value.remove_suffix(1);
+            return value;
+        }
+        pos = eol;
+    }
+    return {};
+}
+
+}  // namespace
+
+WebSocketClient::WebSocketClient() = default;
+
+WebSocketClient::~WebSocketClient() { close(); }
+
+void WebSocketClient::connect(const std::string& uri, int timeout_ms) {
+    close();
+    error_.clear();
+
+    // ws[s]://host[:port][/path]
+    const size_t scheme_end = uri.find("://");
+    if (scheme_end == std::string::npos) throw std::runtime_error("WebSocketClient: bad URI " + uri);
+    const std::string scheme = uri.substr(0, scheme_end);
+    const bool secure = scheme == "wss";
+    if (!secure && scheme != "ws") throw std::runtime_error("WebSocketClient: unsupported scheme in " + uri);
+
+    const size_t host_start = scheme_end + 3;
+    const size_t path_start = uri.find('/', host_start);
+    std::string authority = uri.substr(host_start, path_start == std::string::npos ? std::string::npos : path_start - host_start);
+    const std::string path = path_start == std::string::npos ? "/" : uri.substr(path_start);
+    std::string host = authority;
+    std::string port = secure ? "443" : "80";
+    const size_t colon = authority.rfind(':');
+    if (colon != std::string::npos && authority.find(']') == std::string::npos) {
+        host = authority.substr(0, colon);
+        port = authority.substr(colon + 1);
+    }
+    if (host.empty()) throw std::runtime_error("WebSocketClient: no host in " + uri);
+
+    try {
+        open_socket(host, port, timeout_ms);
+        if (secure) start_tls(host, timeout_ms);
+        handshake(host, port, path, timeout_ms);
+    } catch (...) {
+        reset();
+        throw;
+    }
+}
+
+void WebSocketClient::open_socket(const std::string& host, const std::string& port, int timeout_ms) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addrs = nullptr;
+    const int rc = getaddrinfo(host.c_str(), port.c_str(), &hints, &addrs);
+    if (rc != 0) throw std::runtime_error("WebSocketClient: resolve " + host + ": " + gai_strerror(rc));
+
+    std::string last = "no addresses";
+    for (addrinfo* a = addrs; a; a = a->ai_next) {
+        const int fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) continue;
+        // Non-blocking throughout: connect and every read/write wait in poll()
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+        int err = 0;
+        if (::connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+            err = errno;
+            if (err == EINPROGRESS) {
+                pollfd pfd{fd, POLLOUT, 0};
+                if (::poll(&pfd, 1, timeout_ms) == 1) {
+                    socklen_t len = sizeof(err);
+                    ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                } else {
+                    err = ETIMEDOUT;
+                }
+            }
+        }
+        if (err == 0) {
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            fd_ = fd;
+            break;
+        }
+        last = std::strerror(err);
+        ::close(fd);
+    }
+    freeaddrinfo(addrs);
+    if (fd_ < 0) throw std::runtime_error("WebSocketClient: connect " + host + ":" + port + ": " + last);
+}
+
+void WebSocketClient::start_tls(const std::string& host, int timeout_ms) {
+    tls_ = std::make_unique<Tls>();
+    tls_->ctx = SSL_CTX_new(TLS_client_method());
+    if (!tls_->ctx) throw std::runtime_error("WebSocketClient: " + openssl_error());
+    SSL_CTX_set_default_verify_paths(tls_->ctx);
+    SSL_CTX_set_verify(tls_->ctx, SSL_VERIFY_PEER, nullptr);
+    SSL_CTX_set_mode(tls_->ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+    tls_->ssl = SSL_new(tls_->ctx);
+    if (!tls_->ssl) throw std::runtime_error("WebSocketClient: " + openssl_error());
+    SSL_set_fd(tls_->ssl, fd_);
+    SSL_set_tlsext_host_name(tls_->ssl, host.c_str());
+    SSL_set1_host(tls_->ssl, host.c_str());
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        const int rc = SSL_connect(tls_->ssl);
+        if (rc == 1) break;
+        const int err = SSL_get_error(tls_->ssl, rc);
+        if ((err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) ||
+            !wait(err == SSL_ERROR_WANT_WRITE, remaining_ms(deadline))) {
+            const long verify = SSL_get_verify_result(tls_->ssl);
+            throw std::runtime_error("WebSocketClient: TLS handshake with " + host + " failed: " +
+                                     (verify != X509_V_OK ? X509_verify_cert_error_string(verify) : openssl_error()));
+        }
+    }
+}
+
+void WebSocketClient::handshake(const std::string& host, const std::string& port, const std::string& path,
+                                int timeout_ms) {
+    unsigned char nonce[16];
+    RAND_bytes(nonce, sizeof(nonce));
+    const std::string key = base64(nonce, sizeof(nonce));
+
+    std::string request = "GET " + path + " HTTP/1.1\r\n";
+    request += "Host: " + host + ((port == "443" || port == "80") ? "" : ":" + port) + "\r\n";
+    request += "Upgrade: websocket\r\nConnection: Upgrade\r\n";
+    request += "Sec-WebSocket-Key: " + key + "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    if (!write_all(request.data(), request.size())) {
+        throw std::runtime_error("WebSocketClient: sending handshake: " + error_);
+    }
+
+    // Read the response headers; anything after them is already frame data
+    rx_.resize(kInitialBuffer);
+    rx_begin_ = rx_end_ = 0;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    size_t header_end = std::string_view::npos;
+    while (header_end == std::string_view::npos) {
+        if (rx_end_ == rx_.size()) throw std::runtime_error("WebSocketClient: handshake response too large");
+        const long n = read_raw(rx_.data() + rx_end_, rx_.size() - rx_end_);
+        if (n < 0) throw std::runtime_error("WebSocketClient: connection closed during handshake");
+        if (n == 0) {
+            if (!wait(false, remaining_ms(deadline))) throw std::runtime_error("WebSocketClient: handshake timed out");
+            continue;
+        }
+        rx_end_ += static_cast<size_t>(n);
+        header_end = std::string_view(rx_.data(), rx_end_).find("\r\n\r\n");
+    }
+
+    const std::string_view headers(rx_.data(), header_end + 2);
+    const std::string_view status = headers.substr(0, headers.find("\r\n"));
+    if (status.size() < 12 || status.substr(9, 3) != "101") {
+        throw std::runtime_error("WebSocketClient: upgrade refused: " + std::string(status));
+    }
+
+    static const char* kGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    const std::string accept_src = key + kGuid;
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    SHA1(reinterpret_cast<const unsigned char*>(accept_src.data()), accept_src.size(), digest);
+    if (header_value(headers, "Sec-WebSocket-Accept") != base64(digest, sizeof(digest))) {
+        throw std::runtime_error("WebSocketClient: bad Sec-WebSocket-Accept from server");
+    }
+    rx_begin_ = header_end + 4;
+}
+
+bool WebSocketClient::send(std::string_view text) {
+    return send_frame(kText, text.data(), text.size());
+}
+
+bool WebSocketClient::poll(int timeout_ms) {
+    if (fd_ < 0) return false;
+    // Frames that arrived with the handshake response
+    if (rx_end_ > rx_begin_ && !dispatch_frames()) return false;
+    if (!wait(false, timeout_ms)) return fd_ >= 0;
+    if (!fill()) return false;
+    return dispatch_frames();
+}
+
+void WebSocketClient::close(uint16_t code) {
+    if (fd_ < 0) return;
+    const char payload[2] = {static_cast<char>(code >> 8), static_cast<char>(code & 0xff)};
+    send_frame(kClose, payload, sizeof(payload));
+    if (tls_ && tls_->ssl) SSL_shutdown(tls_->ssl);
+    reset();
+}
+
+bool WebSocketClient::fill() {
+    while (true) {
+        if (rx_end_ == rx_.size()) {
+            // Hand off the complete frames first, so a backlog of small ones
+            // doesn't grow the buffer; then slide the partial frame left to
+            // the front, or grow if it alone fills the buffer
+            if (!dispatch_frames()) return false;
+            if (rx_begin_ > 0) {
+                std::memmove(rx_.data(), rx_.data() + rx_begin_, rx_end_ - rx_begin_);
+                rx_end_ -= rx_begin_;
+                rx_begin_ = 0;
+            } else if (rx_end_ == rx_.size()) {
+                if (rx_.size() >= kMaxMessage + 16) {
+                    fail("frame larger than " + std::to_string(kMaxMessage) + " bytes");
+                    return false;
+                }
+                rx_.resize(rx_.size() * 2);
+            }
+        }
+        const long n = read_raw(rx_.data() + rx_end_, rx_.size() - rx_end_);
+        if (n < 0) {
+            fail(error_.empty() ? "connection closed by peer" : error_);
+            return false;
+        }
+        if (n == 0) return true;
+        rx_end_ += static_cast<size_t>(n);
+    }
+}
+
+bool WebSocketClient::dispatch_frames() {
+    while (fd_ >= 0) {
+        const size_t avail = rx_end_ - rx_begin_;
+        if (avail < 2) break;
+        const auto* p = reinterpret_cast<const unsigned char*>(rx_.data() + rx_begin_);
+
+        const bool fin = (p[0] & 0x80) != 0;
+        const uint8_t opcode = p[0] & 0x0f;
+        const bool masked = (p[1] & 0x80) != 0;
+        uint64_t len = p[1] & 0x7f;
+        size_t header = 2;
+        if (len == 126) {
+            if (avail < 4) break;
+            len = (uint64_t{p[2]} << 8) | p[3];
+            header = 4;
+        } else if (len == 127) {
+            if (avail < 10) break;
+            len = 0;
+            for (int i = 0; i < 8; ++i) len = (len << 8) | p[2 + i];
+            header = 10;
+        }
+        if (masked) {
+            fail("masked frame from server");
+            return false;
+        }
+        if (len > kMaxMessage) {
+            fail("frame larger than " + std::to_string(kMaxMessage) + " bytes");
+            return false;
+        }
+        if (avail < header + len) break;   // Rest of the frame still in flight
+
+        const char* payload = rx_.data() + rx_begin_ + header;
+        const size_t n = static_cast<size_t>(len);
+        rx_begin_ += header + n;
+
+        switch (opcode) {
+            case kText:
+            case kBinary:
+                if (fragmented_) {
+                    fail("new message inside a fragmented one");
+                    return false;
+                }
+                if (fin) {
+                    if (on_message_) on_message_(std::string_view(payload, n));
+                } else {
+                    fragments_.assign(payload, n);
+                    fragmented_ = true;
+                }
+                break;
+            case kContinuation:
+                if (!fragmented_) {
+                    fail("continuation without a message");
+                    return false;
+                }
+                if (fragments_.size() + n > kMaxMessage) {
+                    fail("message larger than " + std::to_string(kMaxMessage) + " bytes");
+                    return false;
+                }
+                fragments_.append(payload, n);
+                if (fin) {
+                    fragmented_ = false;
+                    if (on_message_) on_message_(fragments_);
+                    fragments_.clear();
+                }
+                break;
+            case kPing:
+                if (!send_frame(kPong, payload, n)) return false;
+                break;
+            case kPong:
+                break;
+            case kClose: {
+                const unsigned code = n >= 2 ? (static_cast<unsigned char>(payload[0]) << 8) |
+                                                   static_cast<unsigned char>(payload[1])
+                                             : 1005;
+                send_frame(kClose, payload, n >= 2 ? 2 : 0);
+                fail("closed by server (code " + std::to_string(code) + ")");
+                return false;
+            }
+            default:
+                fail("unknown opcode " + std::to_string(opcode));
+                return false;
+        }
+    }
+    if (rx_begin_ == rx_end_) rx_begin_ = rx_end_ = 0;
+    return fd_ >= 0;
+}
+
+bool WebSocketClient::send_frame(uint8_t opcode, const char* data, size_t n) {
+    if (fd_ < 0) return false;
+
+    // Client frames are always masked (RFC 6455 5.3)
+    tx_.clear();
+    tx_.push_back(static_cast<char>(0x80 | opcode));
+    if (n < 126) {
+        tx_.push_back(static_cast<char>(0x80 | n));
+    } else if (n <= 0xffff) {
+        tx_.push_back(static_cast<char>(0x80 | 126));
+        tx_.push_back(static_cast<char>(n >> 8));
+        tx_.push_back(static_cast<char>(n & 0xff));
+    } else {
+        tx_.push_back(static_cast<char>(0x80 | 127));
+        for (int i = 7; i >= 0; --i) tx_.push_back(static_cast<char>((static_cast<uint64_t>(n) >> (8 * i)) & 0xff));
+    }
+    unsigned char mask[4];
+    RAND_bytes(mask, sizeof(mask));
+    tx_.insert(tx_.end(), mask, mask + 4);
+    const size_t base = tx_.size();
+    tx_.resize(base + n);
+    for (size_t i = 0; i < n; ++i) tx_[base + i] = static_cast<char>(data[i] ^ mask[i & 3]);
+
+    return write_all(tx_.data(), tx_.size());
+}
+
+long WebSocketClient::read_raw(char* buf, size_t n) {
+    if (tls_) {
+        const int rc = SSL_read(tls_->ssl, buf, static_cast<int>(n));
+        if (rc > 0) return rc;
+        const int err = SSL_get_error(tls_->ssl, rc);
+        if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) return 0;
+        if (err != SSL_ERROR_ZERO_RETURN) error_ = "TLS read: " + openssl_error();
+        return -1;
+    }
+    const ssize_t rc = ::recv(fd_, buf, n, 0);
+    if (rc > 0) return static_cast<long>(rc);
+    if (rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+    if (rc < 0) error_ = std::string("read: ") + std::strerror(errno);
+    return -1;
+}
+
+long WebSocketClient::write_raw(const char* buf, size_t n) {
+    if (tls_) {
+        const int rc = SSL_write(tls_->ssl, buf, static_cast<int>(n));
+        if (rc > 0) return rc;
+        const int err = SSL_get_error(tls_->ssl, rc);
+        if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) return 0;
+        error_ = "TLS write: " + openssl_error();
+        return -1;
+    }
+    const ssize_t rc = ::send(fd_, buf, n, MSG_NOSIGNAL);
+    if (rc >= 0) return static_cast<long>(rc);
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return 0;
+    error_ = std::string("write: ") + std::strerror(errno);
+    return -1;
+}
+
+bool WebSocketClient::wait(bool for_write, int timeout_ms) {
+    if (fd_ < 0) return false;
+    // Decrypted bytes already buffered inside OpenSSL won't show up in poll()
+    if (!for_write && tls_ && SSL_pending(tls_->ssl) > 0) return true;
+    pollfd pfd{fd_, static_cast<short>(for_write ? POLLOUT : POLLIN), 0};
+    const int rc = ::poll(&pfd, 1, timeout_ms);
+    if (rc < 0 && errno == EINTR) return false;
+    if (rc < 0) {
+        fail(std::string("poll: ") + std::strerror(errno));
+        return false;
+    }
+    return rc == 1;
+}
+
+bool WebSocketClient::write_all(const char* data, size_t n) {
+    static constexpr int kWriteTimeoutMs = 5000;
+    while (n > 0) {
+        const long rc = write_raw(data, n);
+        if (rc < 0) {
+            fail(error_);
+            return false;
+        }
+        if (rc == 0) {
+            if (!wait(true, kWriteTimeoutMs)) {
+                if (fd_ >= 0) fail("write timed out");
+                return false;
+            }
+            continue;
+        }
+        data += rc;
+        n -= static_cast<size_t>(rc);
+    }
+    return true;
+}
+
+void WebSocketClient::fail(std::string why) {
+    error_ = std::move(why);
+    reset();
+}
+
+void WebSocketClient::reset() {
+    tls_.reset();
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    rx_begin_ = rx_end_ = 0;
+    fragments_.clear();
+    fragmented_ = false;
+}
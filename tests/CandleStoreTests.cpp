@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include "engine/CandleStore.hpp"
+#include <sqlite3.h>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace {
+
+constexpr long long kBaseMs = eng::CandleStore::kBaseResolutionMs;
+
+eng::Candle candle(long long open_ms, double price, double volume = 1.0) {
+    eng::Candle c;
+    c.symbol = "XBTUSD";
+    c.open_time = eng::TimePoint(std::chrono::milliseconds(open_ms));
+    c.open = c.high = c.low = c.close = price;
+    c.volume = volume;
+    c.instrument_id = 1;
+    return c;
+}
+
+// A store on a scratch database whose writer only commits on flush_all()
+class CandleStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = (std::filesystem::path(::testing::TempDir()) /
+                 (std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".db")).string();
+        remove_db();
+        config_.db_path = path_;
+        config_.flush_interval_ms = 60'000;
+        store_ = std::make_unique<eng::CandleStore>(config_);
+    }
+
+    // A fresh start on the same database, as after a restart without --resume
+    void reopen() {
+        store_.reset();
+        store_ = std::make_unique<eng::CandleStore>(config_);
+    }
+
+    void TearDown() override {
+        store_.reset();
+        remove_db();
+    }
+
+    void remove_db() {
+        for (const char* suffix : {"", "-wal", "-shm"}) std::filesystem::remove(path_ + suffix);
+    }
+
+    std::string path_;
+    eng::CandleStoreConfig config_;
+    std::unique_ptr<eng::CandleStore> store_;
+};
+
+}  // namespace
+
+TEST_F(CandleStoreTest, QueryBeforeCommit_CachedRangeGetsTheCandleOnCommit) {
+    store_->add_candle("XBTUSD", kBaseMs, candle(5000, 100.0), "backtest");
+
+    // Still in the write buffer: not in the database yet
+    EXPECT_TRUE(store_->query_candles("XBTUSD", kBaseMs, 0, 10'000).empty());
+
+    store_->flush_all();
+    auto rows = store_->query_candles("XBTUSD", kBaseMs, 0, 10'000);
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_DOUBLE_EQ(rows[0].close, 100.0);
+
+    auto minute = store_->query_candles("XBTUSD", 60'000, 0, 60'000);
+    ASSERT_EQ(minute.size(), 1u);
+    EXPECT_DOUBLE_EQ(minute[0].volume, 1.0);
+}
+
+TEST_F(CandleStoreTest, CommittedCandle_IsAppliedToTheCachedRange) {
+    store_->add_candle("XBTUSD", kBaseMs, candle(5000, 100.0), "backtest");
+    store_->flush_all();
+    ASSERT_EQ(store_->query_candles("XBTUSD", kBaseMs, 0, 10'000).size(), 1u);
+    const uint64_t misses = store_->candle_cache_stats().misses;
+
+    store_->add_candle("XBTUSD", kBaseMs, candle(6000, 101.0), "backtest");
+    store_->add_candle("XBTUSD", kBaseMs, candle(5000, 99.0), "backtest");   // Re-persisted
+    store_->flush_all();
+
+    auto rows = store_->query_candles("XBTUSD", kBaseMs, 0, 10'000);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_DOUBLE_EQ(rows[0].close, 99.0);
+    EXPECT_DOUBLE_EQ(rows[1].close, 101.0);
+    EXPECT_EQ(store_->candle_cache_stats().misses, misses) << "should be served from the cache";
+}
+
+TEST_F(CandleStoreTest, RollupOfRepersistedMiddleCandle_ReplacesItsContribution) {
+    store_->add_candle("XBTUSD", kBaseMs, candle(0, 100.0), "backtest");
+    store_->add_candle("XBTUSD", kBaseMs, candle(1000, 101.0), "backtest");
+    store_->add_candle("XBTUSD", kBaseMs, candle(2000, 102.0), "backtest");
+
+    // The 1s bar flushed early, then stored again after more trades
+    eng::Candle again = candle(1000, 101.0, 3.0);
+    again.high = 110.0;
+    again.low = 95.0;
+    store_->add_candle("XBTUSD", kBaseMs, again, "backtest");
+    store_->flush_all();
+
+    for (long long tier : {60'000LL, 300'000LL, 3'600'000LL, 86'400'000LL}) {
+        auto rows = store_->query_candles("XBTUSD", tier, 0, 86'400'000);
+        ASSERT_EQ(rows.size(), 1u) << tier;
+        EXPECT_DOUBLE_EQ(rows[0].volume, 5.0) << tier;
+        EXPECT_DOUBLE_EQ(rows[0].high, 110.0) << tier;
+        EXPECT_DOUBLE_EQ(rows[0].low, 95.0) << tier;
+        EXPECT_DOUBLE_EQ(rows[0].open, 100.0) << tier;
+        EXPECT_DOUBLE_EQ(rows[0].close, 102.0) << tier;
+    }
+}
+
+TEST_F(CandleStoreTest, LateCandle_IsStoredAndCountedButNotRolledUp) {
+    store_->add_candle("XBTUSD", kBaseMs, candle(0, 100.0), "backtest");
+    store_->add_candle("XBTUSD", kBaseMs, candle(61'000, 101.0), "backtest");
+    store_->add_candle("XBTUSD", kBaseMs, candle(5000, 99.0), "backtest");   // Its minute is closed
+    store_->flush_all();
+
+    EXPECT_EQ(store_->writer_stats().late_rollup_candles, 1u);
+    EXPECT_EQ(store_->query_candles("XBTUSD", kBaseMs, 0, 120'000).size(), 3u);
+    auto minutes = store_->query_candles("XBTUSD", 60'000, 0, 120'000);
+    ASSERT_EQ(minutes.size(), 2u);
+    EXPECT_DOUBLE_EQ(minutes[0].volume, 1.0);
+    auto hour = store_->query_candles("XBTUSD", 3'600'000, 0, 3'600'000);
+    ASSERT_EQ(hour.size(), 1u);
+    EXPECT_DOUBLE_EQ(hour[0].volume, 2.0);
+}
+
+TEST_F(CandleStoreTest, RestartMidBucket_RollupsKeepTheStoredParts) {
+    store_->add_candle("XBTUSD", kBaseMs, candle(0, 100.0), "backtest");
+    store_->add_candle("XBTUSD", kBaseMs, candle(61'000, 105.0), "backtest");
+    store_->flush_all();
+
+    reopen();
+    store_->add_candle("XBTUSD", kBaseMs, candle(62'000, 98.0), "backtest");
+    store_->flush_all();
+
+    auto minutes = store_->query_candles("XBTUSD", 60'000, 0, 120'000);
+    ASSERT_EQ(minutes.size(), 2u);
+    EXPECT_DOUBLE_EQ(minutes[1].volume, 2.0);
+    EXPECT_DOUBLE_EQ(minutes[1].open, 105.0);
+    EXPECT_DOUBLE_EQ(minutes[1].close, 98.0);
+
+    for (long long tier : {300'000LL, 3'600'000LL, 86'400'000LL}) {
+        auto rows = store_->query_candles("XBTUSD", tier, 0, 86'400'000);
+        ASSERT_EQ(rows.size(), 1u) << tier;
+        EXPECT_DOUBLE_EQ(rows[0].volume, 3.0) << tier;
+        EXPECT_DOUBLE_EQ(rows[0].high, 105.0) << tier;
+        EXPECT_DOUBLE_EQ(rows[0].low, 98.0) << tier;
+        EXPECT_DOUBLE_EQ(rows[0].open, 100.0) << tier;
+        EXPECT_DOUBLE_EQ(rows[0].close, 98.0) << tier;
+    }
+}
+
+TEST_F(CandleStoreTest, EventsMigration_KeepsInvalidPayloadsAndTheOrderQty) {
+    // A v2 database, as the engine left it before typed event columns
+    store_.reset();
+    remove_db();
+    sqlite3* db = nullptr;
+    ASSERT_EQ(sqlite3_open(path_.c_str(), &db), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(db, R"SQL(
+        CREATE TABLE schema_version(version INTEGER NOT NULL);
+        INSERT INTO schema_version(version) VALUES (2);
+        CREATE TABLE candles(
+          symbol TEXT NOT NULL,
+          resolution_ms INTEGER NOT NULL,
+          open_time_ms INTEGER NOT NULL,
+          source TEXT NOT NULL,
+          open REAL NOT NULL,
+          high REAL NOT NULL,
+          low REAL NOT NULL,
+          close REAL NOT NULL,
+          volume REAL NOT NULL,
+          trade_count INTEGER,
+          ingestion_time DATETIME DEFAULT CURRENT_TIMESTAMP,
+          PRIMARY KEY(symbol, resolution_ms, open_time_ms, source)
+        );
+        CREATE TABLE events(
+          event_id INTEGER PRIMARY KEY AUTOINCREMENT,
+          event_type TEXT NOT NULL,
+          timestamp_ms INTEGER NOT NULL,
+          symbol TEXT NOT NULL,
+          source TEXT NOT NULL,
+          data TEXT NOT NULL,
+          ingestion_time DATETIME DEFAULT CURRENT_TIMESTAMP
+        );
+        INSERT INTO events(event_type, timestamp_ms, symbol, source, data) VALUES
+          ('OrderFilled', 1000, 'XBTUSD', 'backtest', '{"orderId":7,"qty":2.0,"filledQty":0.5,"fillPrice":100.0}'),
+          ('OrderPlaced', 2000, 'XBTUSD', 'backtest', 'not json');
+    )SQL", nullptr, nullptr, nullptr), SQLITE_OK) << sqlite3_errmsg(db);
+    sqlite3_close(db);
+
+    reopen();
+    auto events = store_->query_events("XBTUSD", 0, 10'000, {});
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].order_id, 7);
+    EXPECT_DOUBLE_EQ(events[0].qty, 0.5);
+    EXPECT_DOUBLE_EQ(events[0].extra.value("qty", 0.0), 2.0);
+    EXPECT_EQ(events[1].event_type, "OrderPlaced");
+    EXPECT_EQ(events[1].extra.value("data", ""), "not json");
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "engine/EventBus.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Seq {
+    int n{0};
+};
+
+// Async handler that records what it sees and holds the worker on the first
+// event until released, so the queue behind it fills up
+class GatedHandler {
+public:
+    void operator()(const Seq& s) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            seen_.push_back(s.n);
+        }
+        started_.store(true, std::memory_order_release);
+        while (!released_.load(std::memory_order_acquire)) std::this_thread::yield();
+    }
+
+    void wait_started() const {
+        while (!started_.load(std::memory_order_acquire)) std::this_thread::yield();
+    }
+    void release() { released_.store(true, std::memory_order_release); }
+
+    std::vector<int> seen() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return seen_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<int> seen_;
+    std::atomic<bool> started_{false};
+    std::atomic<bool> released_{false};
+};
+
+eng::EventBus::AsyncOptions options(eng::EventBus::Backpressure policy) {
+    eng::EventBus::AsyncOptions opts;
+    opts.name = "test";
+    opts.capacity = 2;
+    opts.policy = policy;
+    return opts;
+}
+
+// Event 1 parks the worker; 2 and 3 fill the queue; 4 and 5 overflow it
+void publish_past_capacity(eng::EventBus& bus, GatedHandler& handler) {
+    bus.publish(Seq{1});
+    handler.wait_started();
+    for (int n = 2; n <= 5; ++n) bus.publish(Seq{n});
+}
+
+}  // namespace
+
+TEST(EventBusTests, AsyncBlock_FullQueue_WaitsAndLosesNothing) {
+    eng::EventBus bus;
+    GatedHandler handler;
+    bus.subscribe_async<Seq>([&handler](const Seq& s) { handler(s); },
+                             options(eng::EventBus::Backpressure::Block));
+
+    std::atomic<bool> published{false};
+    std::thread producer([&] {
+        publish_past_capacity(bus, handler);
+        published.store(true, std::memory_order_release);
+    });
+
+    handler.wait_started();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(published.load(std::memory_order_acquire)) << "publisher should wait for space";
+
+    handler.release();
+    producer.join();
+    bus.wait_idle();
+
+    EXPECT_EQ(handler.seen(), (std::vector<int>{1, 2, 3, 4, 5}));
+    auto stats = bus.queue_stats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].dropped, 0u);
+    EXPECT_EQ(stats[0].processed, 5u);
+}
+
+TEST(EventBusTests, AsyncDropNewest_FullQueue_DiscardsPublishedEvent) {
+    eng::EventBus bus;
+    GatedHandler handler;
+    bus.subscribe_async<Seq>([&handler](const Seq& s) { handler(s); },
+                             options(eng::EventBus::Backpressure::DropNewest));
+
+    publish_past_capacity(bus, handler);
+    handler.release();
+    bus.wait_idle();
+
+    EXPECT_EQ(handler.seen(), (std::vector<int>{1, 2, 3}));
+    auto stats = bus.queue_stats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].dropped, 2u);
+    EXPECT_EQ(stats[0].enqueued, 3u);
+    EXPECT_EQ(stats[0].processed, 3u);
+}
+
+TEST(EventBusTests, AsyncDropOldest_FullQueue_EvictsQueuedEvents) {
+    eng::EventBus bus;
+    GatedHandler handler;
+    bus.subscribe_async<Seq>([&handler](const Seq& s) { handler(s); },
+                             options(eng::EventBus::Backpressure::DropOldest));
+
+    publish_past_capacity(bus, handler);
+    handler.release();
+    bus.wait_idle();
+
+    EXPECT_EQ(handler.seen(), (std::vector<int>{1, 4, 5}));
+    auto stats = bus.queue_stats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].dropped, 2u);
+    EXPECT_EQ(stats[0].processed, 3u);
+}
+
+TEST(EventBusTests, AsyncSubscriber_ManyEvents_DeliveredInPublishOrder) {
+    eng::EventBus bus;
+    std::vector<int> seen;
+    eng::EventBus::AsyncOptions opts;
+    opts.capacity = 8;
+    bus.subscribe_async<Seq>([&seen](const Seq& s) { seen.push_back(s.n); }, opts);
+
+    for (int n = 0; n < 10000; ++n) bus.publish(Seq{n});
+    bus.wait_idle();
+
+    ASSERT_EQ(seen.size(), 10000u);
+    for (int n = 0; n < 10000; ++n) ASSERT_EQ(seen[n], n);
+}
+
+TEST(EventBusTests, Unsubscribe_AsyncSubscriber_DrainsQueueFirst) {
+    eng::EventBus bus;
+    std::atomic<int> handled{0};
+    auto id = bus.subscribe_async<Seq>([&handled](const Seq&) { handled.fetch_add(1); });
+
+    for (int n = 0; n < 100; ++n) bus.publish(Seq{n});
+    EXPECT_TRUE(bus.unsubscribe<Seq>(id));
+    EXPECT_EQ(handled.load(), 100);
+
+    bus.publish(Seq{100});
+    EXPECT_EQ(handled.load(), 100);
+}
+
+TEST(EventBusTests, PublishRacingUnsubscribe_EveryQueuedEventIsHandled) {
+    eng::EventBus bus;
+    std::atomic<uint64_t> handled{0};
+    auto id = bus.subscribe_async<Seq>([&handled](const Seq&) { handled.fetch_add(1); },
+                                       options(eng::EventBus::Backpressure::DropNewest));
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> publishers;
+    for (int t = 0; t < 4; ++t) {
+        publishers.emplace_back([&bus, &done]() {
+            while (!done.load(std::memory_order_relaxed)) bus.publish(Seq{1});
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_TRUE(bus.unsubscribe<Seq>(id));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    done.store(true);
+    for (auto& t : publishers) t.join();
+
+    auto stats = bus.queue_stats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].enqueued, stats[0].processed);
+    EXPECT_EQ(handled.load(), stats[0].processed);
+}
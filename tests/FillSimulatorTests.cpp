@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include "brokers/FillSimulator.hpp"
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using broker::FillSimulator;
+using Side = eng::Order::Side;
+
+constexpr eng::InstrumentId kId = 1;
+const std::string kSymbol = "XBTUSD";
+
+eng::TimePoint at_ms(long long ms) { return eng::TimePoint(std::chrono::milliseconds(ms)); }
+
+class FillSimulatorTest : public ::testing::Test {
+protected:
+    std::vector<FillSimulator::Execution> trade(FillSimulator& sim, double price, double qty,
+                                                eng::TradeSide aggressor, long long ms) {
+        std::vector<FillSimulator::Execution> out;
+        sim.on_trade(kId, kSymbol, price, qty, aggressor, at_ms(ms), out);
+        return out;
+    }
+};
+
+}  // namespace
+
+TEST_F(FillSimulatorTest, QueueAhead_TradesAtOurPrice_EatQueueThenFillPartially) {
+    FillSimulator::Config cfg;
+    cfg.queue_ahead = 2.0;
+    FillSimulator sim(cfg);
+    sim.submit(1, 10, kId, kSymbol, Side::Buy, 100.0, 1.0, at_ms(0));
+
+    // 1.5 of the 2.0 ahead of us
+    EXPECT_TRUE(trade(sim, 100.0, 1.5, eng::TradeSide::Sell, 1).empty());
+
+    // Last 0.5 ahead, then 0.5 for us
+    auto fills = trade(sim, 100.0, 1.0, eng::TradeSide::Sell, 2);
+    ASSERT_EQ(fills.size(), 1u);
+    EXPECT_EQ(fills[0].order_id, 1u);
+    EXPECT_EQ(fills[0].tag, 10u);
+    EXPECT_DOUBLE_EQ(fills[0].qty, 0.5);
+    EXPECT_DOUBLE_EQ(fills[0].price, 100.0);
+    EXPECT_DOUBLE_EQ(fills[0].remaining, 0.5);
+    EXPECT_FALSE(fills[0].taker);
+    EXPECT_EQ(sim.open_orders(), 1u);
+
+    fills = trade(sim, 100.0, 5.0, eng::TradeSide::Sell, 3);
+    ASSERT_EQ(fills.size(), 1u);
+    EXPECT_DOUBLE_EQ(fills[0].qty, 0.5);
+    EXPECT_DOUBLE_EQ(fills[0].remaining, 0.0);
+    EXPECT_EQ(sim.open_orders(), 0u);
+}
+
+TEST_F(FillSimulatorTest, QueueAtLevel_IsFifoAcrossOrders) {
+    FillSimulator sim;
+    sim.submit(1, 1, kId, kSymbol, Side::Sell, 100.0, 1.0, at_ms(0));
+    sim.submit(2, 2, kId, kSymbol, Side::Sell, 100.0, 1.0, at_ms(0));
+
+    auto fills = trade(sim, 100.0, 1.5, eng::TradeSide::Buy, 1);
+    ASSERT_EQ(fills.size(), 2u);
+    EXPECT_EQ(fills[0].order_id, 1u);
+    EXPECT_DOUBLE_EQ(fills[0].qty, 1.0);
+    EXPECT_DOUBLE_EQ(fills[0].remaining, 0.0);
+    EXPECT_EQ(fills[1].order_id, 2u);
+    EXPECT_DOUBLE_EQ(fills[1].qty, 0.5);
+    EXPECT_DOUBLE_EQ(fills[1].remaining, 0.5);
+}
+
+TEST_F(FillSimulatorTest, QueueAtLevel_SameSideAggressor_DoesNotTouchIt) {
+    FillSimulator sim;
+    sim.submit(1, 1, kId, kSymbol, Side::Buy, 100.0, 1.0, at_ms(0));
+
+    // A buyer lifting the offer at our bid price doesn't trade with bids
+    EXPECT_TRUE(trade(sim, 100.0, 5.0, eng::TradeSide::Buy, 1).empty());
+    // Unknown aggressor touches both sides
+    EXPECT_EQ(trade(sim, 100.0, 5.0, eng::TradeSide::Unknown, 2).size(), 1u);
+}
+
+TEST_F(FillSimulatorTest, TradeThrough_FillsWholeOrderAtItsLimit) {
+    FillSimulator sim;
+    sim.submit(1, 1, kId, kSymbol, Side::Buy, 100.0, 3.0, at_ms(0));
+    sim.submit(2, 2, kId, kSymbol, Side::Buy, 99.5, 1.0, at_ms(0));
+    EXPECT_TRUE(trade(sim, 100.5, 1.0, eng::TradeSide::Sell, 1).empty());   // Now resting
+
+    // Prints below both bids, for less than their size
+    auto fills = trade(sim, 99.4, 0.1, eng::TradeSide::Buy, 2);
+    ASSERT_EQ(fills.size(), 2u);
+    EXPECT_EQ(fills[0].order_id, 1u);   // Best bid first
+    EXPECT_DOUBLE_EQ(fills[0].qty, 3.0);
+    EXPECT_DOUBLE_EQ(fills[0].price, 100.0);
+    EXPECT_EQ(fills[1].order_id, 2u);
+    EXPECT_DOUBLE_EQ(fills[1].price, 99.5);
+    EXPECT_EQ(sim.open_orders(), 0u);
+}
+
+TEST_F(FillSimulatorTest, TradeAwayFromOrder_LeavesItResting) {
+    FillSimulator sim;
+    sim.submit(1, 1, kId, kSymbol, Side::Buy, 100.0, 1.0, at_ms(0));
+    sim.submit(2, 2, kId, kSymbol, Side::Sell, 101.0, 1.0, at_ms(0));
+
+    EXPECT_TRUE(trade(sim, 100.5, 10.0, eng::TradeSide::Unknown, 1).empty());
+    EXPECT_EQ(sim.open_orders(), 2u);
+}
+
+TEST_F(FillSimulatorTest, CrossingOnArrival_TakesAtTradePriceAfterLatency) {
+    FillSimulator::Config cfg;
+    cfg.latency = std::chrono::milliseconds(10);
+    FillSimulator sim(cfg);
+    sim.submit(1, 1, kId, kSymbol, Side::Buy, 101.0, 1.0, at_ms(0));
+
+    // Not live yet
+    EXPECT_TRUE(trade(sim, 100.0, 1.0, eng::TradeSide::Sell, 5).empty());
+
+    auto fills = trade(sim, 100.2, 0.01, eng::TradeSide::Buy, 10);
+    ASSERT_EQ(fills.size(), 1u);
+    EXPECT_TRUE(fills[0].taker);
+    EXPECT_DOUBLE_EQ(fills[0].qty, 1.0);
+    EXPECT_DOUBLE_EQ(fills[0].price, 100.2);
+}
+
+TEST_F(FillSimulatorTest, TimeInForce_ExpiresTheUnfilledRemainder) {
+    FillSimulator::Config cfg;
+    cfg.time_in_force = std::chrono::milliseconds(100);
+    FillSimulator sim(cfg);
+    sim.submit(1, 1, kId, kSymbol, Side::Sell, 100.0, 1.0, at_ms(0));
+
+    EXPECT_EQ(trade(sim, 100.0, 0.25, eng::TradeSide::Buy, 50).size(), 1u);
+    auto out = trade(sim, 99.0, 1.0, eng::TradeSide::Buy, 100);
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_TRUE(out[0].expired);
+    EXPECT_DOUBLE_EQ(out[0].remaining, 0.75);
+    EXPECT_EQ(sim.open_orders(), 0u);
+}
+
+TEST_F(FillSimulatorTest, Cancel_RemovesRestingOrder) {
+    FillSimulator sim;
+    sim.submit(1, 7, kId, kSymbol, Side::Buy, 100.0, 1.0, at_ms(0));
+    EXPECT_TRUE(trade(sim, 100.5, 1.0, eng::TradeSide::Sell, 1).empty());   // Now resting
+
+    FillSimulator::Execution e;
+    ASSERT_TRUE(sim.cancel(1, &e));
+    EXPECT_EQ(e.tag, 7u);
+    EXPECT_DOUBLE_EQ(e.remaining, 1.0);
+    EXPECT_FALSE(sim.cancel(1));
+    EXPECT_TRUE(trade(sim, 99.0, 1.0, eng::TradeSide::Sell, 2).empty());
+}
+
+TEST_F(FillSimulatorTest, TickSize_PerSymbol_KeepsNearbyPricesOnSeparateLevels) {
+    FillSimulator::Config cfg;
+    cfg.tick_sizes[kSymbol] = 0.01;
+    FillSimulator sim(cfg);
+    sim.submit(1, 1, kId, kSymbol, Side::Buy, 0.52, 1.0, at_ms(0));
+    sim.submit(2, 2, 2, "ETHUSD", Side::Buy, 0.52, 1.0, at_ms(0));   // Default 0.1 grid
+
+    // 0.54 is tick 54 against our 52: above the bid, no fill
+    EXPECT_TRUE(trade(sim, 0.54, 1.0, eng::TradeSide::Sell, 1).empty());
+    auto fills = trade(sim, 0.52, 1.0, eng::TradeSide::Sell, 2);
+    ASSERT_EQ(fills.size(), 1u);
+    EXPECT_EQ(fills[0].order_id, 1u);
+
+    // On the 0.1 grid both prices are tick 5, so 0.54 works the queue at 0.52
+    std::vector<FillSimulator::Execution> out;
+    sim.on_trade(2, "ETHUSD", 0.54, 1.0, eng::TradeSide::Sell, at_ms(1), out);
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(out[0].order_id, 2u);
+}
+
+TEST_F(FillSimulatorTest, Submit_FarFromMarket_IsRefused) {
+    FillSimulator::Config cfg;
+    cfg.max_ticks_from_market = 1000;   // 100.0 each way on the 0.1 grid
+    FillSimulator sim(cfg);
+    EXPECT_TRUE(trade(sim, 100.0, 1.0, eng::TradeSide::Buy, 0).empty());
+
+    EXPECT_TRUE(sim.accepts(kId, kSymbol, 199.0));
+    EXPECT_FALSE(sim.accepts(kId, kSymbol, 201.0));
+    EXPECT_FALSE(sim.submit(1, 1, kId, kSymbol, Side::Sell, 1e12, 1.0, at_ms(1)));
+    EXPECT_FALSE(sim.submit(2, 2, kId, kSymbol, Side::Buy, std::numeric_limits<double>::infinity(),
+                            1.0, at_ms(1)));
+    EXPECT_EQ(sim.open_orders(), 0u);
+
+    // The band follows the tape
+    EXPECT_TRUE(trade(sim, 150.0, 1.0, eng::TradeSide::Buy, 2).empty());
+    EXPECT_TRUE(sim.submit(3, 3, kId, kSymbol, Side::Sell, 249.0, 1.0, at_ms(2)));
+    EXPECT_EQ(sim.open_orders(), 1u);
+}
+
+TEST(FillSimulatorTests, ParseTickSizeFlag_DefaultAndPerSymbol) {
+    FillSimulator::Config cfg;
+    broker::parse_tick_size_flag("0.5", cfg);
+    broker::parse_tick_size_flag("XRPUSD=0.0001", cfg);
+    EXPECT_DOUBLE_EQ(cfg.tick_size, 0.5);
+    EXPECT_DOUBLE_EQ(cfg.tick_sizes.at("XRPUSD"), 0.0001);
+
+    EXPECT_THROW(broker::parse_tick_size_flag("0", cfg), std::invalid_argument);
+    EXPECT_THROW(broker::parse_tick_size_flag("XRPUSD=", cfg), std::invalid_argument);
+    EXPECT_THROW(broker::parse_tick_size_flag("=0.1", cfg), std::invalid_argument);
+    EXPECT_THROW(broker::parse_tick_size_flag("0.1x", cfg), std::invalid_argument);
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "brokers/NullBroker.hpp"
+#include "engine/EventBus.hpp"
+#include "engine/StrategyFanOut.hpp"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr eng::InstrumentId kId = 1;
+
+// Buys on every tick at its trigger price and records the fills it is given
+class TriggerStrategy : public eng::IStrategy {
+public:
+    explicit TriggerStrategy(double trigger) : trigger_(trigger) {}
+
+    void on_price_tick(const eng::PriceData& pd) override {
+        ++ticks;
+        action_ = pd.last == trigger_ ? eng::TradeAction::Buy : eng::TradeAction::None;
+    }
+    eng::TradeAction get_trade_action() override { return action_; }
+    void on_order_fill(const eng::Order& order) override {
+        fills.push_back(order);
+        action_ = eng::TradeAction::None;
+    }
+
+    size_t ticks{0};
+    std::vector<eng::Order> fills;
+
+private:
+    double trigger_;
+    eng::TradeAction action_{eng::TradeAction::None};
+};
+
+eng::Tick tick(double price, long long ms) {
+    eng::Tick t;
+    t.symbol = "XBTUSD";
+    t.instrument_id = kId;
+    t.last = price;
+    t.ts = eng::TimePoint(std::chrono::milliseconds(ms));
+    return t;
+}
+
+TriggerStrategy& strategy_at(eng::StrategyFanOut& fan, size_t slot) {
+    return dynamic_cast<TriggerStrategy&>(fan.strategy(slot));
+}
+
+}  // namespace
+
+TEST(StrategyFanOutTests, ImmediateFills_RouteToThePlacingStrategy) {
+    broker::NullBroker broker;
+    broker.set_verbose(false);
+    eng::StrategyFanOut fan(64);
+    const size_t w0 = fan.add_worker();
+    const size_t w1 = fan.add_worker();
+    const size_t a = fan.add_strategy(std::make_unique<TriggerStrategy>(101.0), w0);
+    const size_t b = fan.add_strategy(std::make_unique<TriggerStrategy>(102.0), w1);
+    const size_t c = fan.add_strategy(std::make_unique<TriggerStrategy>(0.0), w1);   // Never trades
+    fan.start(broker, false);
+
+    // More ticks than the ring holds, so the publisher has to wait on the workers
+    long long ms = 0;
+    for (int round = 0; round < 10; ++round) {
+        for (double px : {100.0, 101.0, 100.0, 102.0, 100.0}) {
+            for (int i = 0; i < 20; ++i) fan.publish(tick(i == 0 ? px : 100.0, ++ms));
+        }
+    }
+    fan.wait_idle();
+
+    EXPECT_EQ(strategy_at(fan, a).ticks, 1000u);
+    EXPECT_EQ(strategy_at(fan, b).ticks, 1000u);
+    EXPECT_EQ(strategy_at(fan, c).ticks, 1000u);
+    ASSERT_EQ(strategy_at(fan, a).fills.size(), 10u);
+    ASSERT_EQ(strategy_at(fan, b).fills.size(), 10u);
+    EXPECT_TRUE(strategy_at(fan, c).fills.empty());
+    for (const auto& f : strategy_at(fan, a).fills) EXPECT_EQ(f.client_tag, a + 1);
+    for (const auto& f : strategy_at(fan, b).fills) EXPECT_EQ(f.client_tag, b + 1);
+    EXPECT_EQ(broker.get_orders().size(), 20u);
+    fan.stop();
+}
+
+TEST(StrategyFanOutTests, RestingFills_RouteByClientTag) {
+    eng::EventBus bus;
+    broker::NullBroker broker(bus);
+    broker.set_verbose(false);
+    broker.enable_fill_simulation();
+    eng::StrategyFanOut fan;
+    broker.set_fill_handler([&fan](const eng::Order& fill) { fan.on_fill(fill); });
+
+    const size_t w = fan.add_worker();
+    const size_t a = fan.add_strategy(std::make_unique<TriggerStrategy>(101.0), w);
+    const size_t b = fan.add_strategy(std::make_unique<TriggerStrategy>(102.0), fan.add_worker());
+    fan.start(broker, false);
+
+    // Both buy limits go to the book; a print above them makes them rest
+    fan.publish(tick(101.0, 1));
+    fan.publish(tick(102.0, 2));
+    fan.wait_idle();
+    fan.publish(tick(110.0, 3));
+    fan.wait_idle();
+    EXPECT_TRUE(strategy_at(fan, a).fills.empty());
+    EXPECT_TRUE(strategy_at(fan, b).fills.empty());
+    EXPECT_EQ(broker.open_orders(), 2u);
+
+    // A print below both bids fills them on the router; the fills go back by tag
+    fan.publish(tick(90.0, 4));
+    fan.wait_idle();
+    EXPECT_EQ(broker.open_orders(), 0u);
+    ASSERT_EQ(strategy_at(fan, a).fills.size(), 1u);
+    ASSERT_EQ(strategy_at(fan, b).fills.size(), 1u);
+    EXPECT_DOUBLE_EQ(strategy_at(fan, a).fills[0].fill_price, 101.0);
+    EXPECT_DOUBLE_EQ(strategy_at(fan, b).fills[0].fill_price, 102.0);
+    fan.stop();
+}
+
+TEST(StrategyFanOutTests, UntaggedFill_IsDropped) {
+    broker::NullBroker broker;
+    eng::StrategyFanOut fan;
+    const size_t a = fan.add_strategy(std::make_unique<TriggerStrategy>(101.0), fan.add_worker());
+    fan.start(broker, false);
+
+    eng::Order fill;
+    fill.qty = 0.01;
+    fan.on_fill(fill);   // client_tag 0: no strategy to give it to
+    fan.wait_idle();
+    EXPECT_TRUE(strategy_at(fan, a).fills.empty());
+    fan.stop();
+}
+
+TEST(StrategyFanOutTests, Registration_AfterStart_Throws) {
+    broker::NullBroker broker;
+    eng::StrategyFanOut fan;
+    fan.add_strategy(std::make_unique<TriggerStrategy>(1.0), fan.add_worker());
+    fan.start(broker, false);
+    EXPECT_THROW(fan.add_worker(), std::runtime_error);
+    EXPECT_THROW(fan.add_strategy(std::make_unique<TriggerStrategy>(1.0), 0), std::runtime_error);
+    fan.stop();
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "engine/TickStore.hpp"
+#include <chrono>
+#include <string>
+
+namespace {
+
+eng::TradePrint trade(const std::string& symbol, eng::InstrumentId id, long long ms, double price) {
+    eng::TradePrint tp;
+    tp.symbol = symbol;
+    tp.instrument_id = id;
+    tp.ts = eng::TimePoint(std::chrono::milliseconds(ms));
+    tp.price = price;
+    tp.qty = 0.5;
+    tp.side = eng::TradeSide::Sell;
+    return tp;
+}
+
+}  // namespace
+
+TEST(TickStoreTests, SaveState_LoadState_RestoresEveryTrade) {
+    eng::TickStoreConfig config;
+    config.chunk_ticks = 4;   // Several chunks, the last one partial
+    eng::TickStore store(config);
+    for (int i = 0; i < 10; ++i) store.append(trade("XBTUSD", 1, 1000 * i, 100.0 + i));
+    store.append(trade("ETHUSD", 2, 500, 2000.0));
+
+    eng::CheckpointWriter out;
+    store.save_state(out);
+
+    eng::TickStore restored;
+    eng::CheckpointReader in("ticks", out.bytes());
+    restored.load_state(in);
+
+    EXPECT_EQ(restored.size("XBTUSD"), 10u);
+    EXPECT_EQ(restored.size("ETHUSD"), 1u);
+    EXPECT_EQ(restored.last_time("XBTUSD"), eng::TimePoint(std::chrono::milliseconds(9000)));
+    size_t seen = 0;
+    restored.scan("XBTUSD", eng::TimePoint{}, eng::TimePoint::max(),
+                  [&seen](eng::TimePoint, double price, double qty, eng::TradeSide side) {
+        EXPECT_DOUBLE_EQ(price, 100.0 + seen);
+        EXPECT_DOUBLE_EQ(qty, 0.5);
+        EXPECT_EQ(side, eng::TradeSide::Sell);
+        ++seen;
+    });
+    EXPECT_EQ(seen, 10u);
+
+    // The store carries on appending after the restored trades
+    restored.append(trade("XBTUSD", 1, 10'000, 110.0));
+    auto candles = restored.candles("XBTUSD", 60'000, eng::TimePoint{});
+    ASSERT_EQ(candles.size(), 1u);
+    EXPECT_DOUBLE_EQ(candles[0].volume, 5.5);
+}
+
+TEST(TickStoreTests, LoadState_Truncated_Throws) {
+    eng::TickStore store;
+    store.append(trade("XBTUSD", 1, 0, 100.0));
+    eng::CheckpointWriter out;
+    store.save_state(out);
+
+    const std::string cut = out.bytes().substr(0, out.bytes().size() - 1);
+    eng::TickStore restored;
+    eng::CheckpointReader in("ticks", cut);
+    EXPECT_THROW(restored.load_state(in), std::runtime_error);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "engine/TradeMerger.hpp"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Trades as (timestamp ms, price); the price tags each trade so the tests
+// can tell them apart
+using Spec = std::vector<std::pair<long long, double>>;
+
+class VectorSource : public eng::ITradeSource {
+public:
+    VectorSource(std::string symbol, const Spec& spec) : symbol_(std::move(symbol)) {
+        for (const auto& [ms, price] : spec) {
+            eng::TradePrint tp;
+            tp.symbol = symbol_;
+            tp.price = price;
+            tp.qty = 1.0;
+            tp.ts = eng::TimePoint(std::chrono::milliseconds(ms));
+            trades_.push_back(tp);
+        }
+    }
+
+    size_t read(eng::TradePrint* out, size_t max_trades) override {
+        size_t n = 0;
+        while (n < max_trades && next_ < trades_.size()) out[n++] = trades_[next_++];
+        return n;
+    }
+
+    std::string name() const override { return symbol_; }
+
+private:
+    std::string symbol_;
+    std::vector<eng::TradePrint> trades_;
+    size_t next_{0};
+};
+
+std::vector<double> drain(eng::TradeMerger& merger, size_t skip = 0, size_t* total = nullptr) {
+    std::vector<double> prices;
+    size_t n = merger.run([&prices](const eng::TradePrint& tp) { prices.push_back(tp.price); },
+                          0.0, nullptr, skip);
+    if (total) *total = n;
+    return prices;
+}
+
+}  // namespace
+
+TEST(TradeMergerTests, Run_InterleavedSources_EmitsInTimestampOrder) {
+    eng::TradeMerger merger(2);
+    merger.add_source(std::make_unique<VectorSource>("A", Spec{{1, 1.0}, {4, 4.0}, {5, 5.0}, {9, 9.0}}));
+    merger.add_source(std::make_unique<VectorSource>("B", Spec{{2, 2.0}, {3, 3.0}, {8, 8.0}}));
+    merger.add_source(std::make_unique<VectorSource>("C", Spec{{6, 6.0}, {7, 7.0}}));
+
+    EXPECT_EQ(drain(merger), (std::vector<double>{1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    EXPECT_EQ(merger.emitted_from(0), 4u);
+    EXPECT_EQ(merger.emitted_from(1), 3u);
+    EXPECT_EQ(merger.emitted_from(2), 2u);
+}
+
+TEST(TradeMergerTests, Run_EqualTimestamps_FirstAddedSourceWinsAndSourceOrderIsKept) {
+    eng::TradeMerger merger(1);   // Refill after every trade
+    merger.add_source(std::make_unique<VectorSource>("A", Spec{{5, 1.0}, {5, 2.0}}));
+    merger.add_source(std::make_unique<VectorSource>("B", Spec{{5, 3.0}, {5, 4.0}}));
+    merger.add_source(std::make_unique<VectorSource>("C", Spec{{4, 0.0}, {5, 5.0}}));
+
+    EXPECT_EQ(drain(merger), (std::vector<double>{0, 1, 2, 3, 4, 5}));
+}
+
+TEST(TradeMergerTests, Run_EmptyAndExhaustedSources_AreDropped) {
+    eng::TradeMerger merger;
+    merger.add_source(std::make_unique<VectorSource>("A", Spec{}));
+    merger.add_source(std::make_unique<VectorSource>("B", Spec{{1, 1.0}}));
+
+    EXPECT_EQ(drain(merger), (std::vector<double>{1}));
+    EXPECT_EQ(merger.emitted_from(0), 0u);
+}
+
+TEST(TradeMergerTests, Run_WithSkip_ResumesAtTheSamePositionInTheMerge) {
+    eng::TradeMerger merger(2);
+    merger.add_source(std::make_unique<VectorSource>("A", Spec{{1, 1.0}, {3, 3.0}, {5, 5.0}}));
+    merger.add_source(std::make_unique<VectorSource>("B", Spec{{2, 2.0}, {3, 3.5}, {6, 6.0}}));
+
+    size_t total = 0;
+    EXPECT_EQ(drain(merger, 3, &total), (std::vector<double>{3.5, 5, 6}));
+    EXPECT_EQ(total, 6u);   // Skipped trades count towards the position
+}
+
+TEST(TradeMergerTests, Run_StopFlagCleared_StopsBeforeTheNextTrade) {
+    eng::TradeMerger merger;
+    merger.add_source(std::make_unique<VectorSource>("A", Spec{{1, 1.0}, {2, 2.0}, {3, 3.0}}));
+
+    std::atomic<bool> running{true};
+    std::vector<double> prices;
+    merger.run([&](const eng::TradePrint& tp) {
+        prices.push_back(tp.price);
+        if (prices.size() == 2) running = false;
+    }, 0.0, &running);
+
+    EXPECT_EQ(prices, (std::vector<double>{1, 2}));
+}